@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+/*
+-------------------------------------------------------------------
+  BENCH  -----------------------------------------------------------
+
+  The benchmarks are plain executables that print their numbers;
+  they are built with everything else but not run by ctest. Time
+  them in a Release build (-DCMAKE_BUILD_TYPE=Release): the default
+  Debug build is unoptimized and says so in the header line.
+-------------------------------------------------------------------
+*/
+namespace bench
+{
+using Clock = std::chrono::steady_clock;
+
+inline void header(const char *name)
+{
+#ifdef NDEBUG
+    std::printf("%s\n", name);
+#else
+    std::printf("%s (unoptimized build, configure with -DCMAKE_BUILD_TYPE=Release to time it)\n", name);
+#endif
+}
+
+// Best of `repeats` runs of `run`, in seconds
+template <typename Run>
+double bestOf(int repeats, Run &&run)
+{
+    double best = 1e30;
+    for (int i = 0; i < repeats; ++i)
+    {
+        const Clock::time_point start = Clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+// Keeps a result alive so the optimizer can't drop the work that produced it
+template <typename T>
+inline void keep(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+} // namespace bench
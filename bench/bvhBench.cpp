@@ -0,0 +1,150 @@
+#include "bench.h"
+#include "../src/Culling/bvh.h"
+#include "../src/Culling/frustum.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+  Scene BVH over `count` small boxes (100K by default) scattered through a 20-unit cube:
+  build, full refit, per-primitive refit of 1% of them, a frustum query of the unit clip
+  volume and closest-box rays, the last two against brute-force loops over every box.
+
+  Usage: bvhBench [count]
+*/
+namespace
+{
+Aabb randomBox(std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f), size(0.01f, 0.2f);
+    Aabb box;
+    for (int c = 0; c < 3; ++c)
+    {
+        box.min[c] = position(random);
+        box.max[c] = box.min[c] + size(random);
+    }
+    return box;
+}
+
+bool outsideFrustum(const Frustum &frustum, const Aabb &box)
+{
+    for (const float *plane : frustum.planes)
+    {
+        float far = plane[3];
+        for (int c = 0; c < 3; ++c)
+            far += plane[c] * (plane[c] >= 0.0f ? box.max[c] : box.min[c]);
+        if (far < 0.0f)
+            return true;
+    }
+    return false;
+}
+
+Ray randomRay(std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    Ray ray;
+    float length = 0.0f;
+    for (int c = 0; c < 3; ++c)
+    {
+        ray.origin[c] = 12.0f * unit(random);
+        ray.direction[c] = unit(random);
+        length += ray.direction[c] * ray.direction[c];
+    }
+    for (float &d : ray.direction)
+        d /= std::sqrt(length);
+    return ray;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    bench::header("Scene BVH");
+
+    std::mt19937 random(32);
+    std::vector<Aabb> boxes(count);
+    for (Aabb &box : boxes)
+        box = randomBox(random);
+
+    Bvh bvh;
+    const double buildSeconds = bench::bestOf(3, [&] { bvh.build(boxes); });
+    const double refitSeconds = bench::bestOf(5, [&] { bvh.refit(boxes); });
+    std::printf("  %zu boxes, %zu nodes: build %.2f ms, full refit %.3f ms\n", count, bvh.getNodeCount(),
+                buildSeconds * 1e3, refitSeconds * 1e3);
+
+    // 1% of the boxes nudged, one refitPrimitive each
+    const size_t moved = std::max<size_t>(1, count / 100);
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(count - 1));
+    std::vector<uint32_t> movedIds(moved);
+    for (uint32_t &id : movedIds)
+        id = pick(random);
+    const double partialSeconds = bench::bestOf(5, [&] {
+        for (uint32_t id : movedIds)
+        {
+            Aabb &box = boxes[id];
+            for (int c = 0; c < 3; ++c)
+            {
+                box.min[c] += 0.001f;
+                box.max[c] += 0.001f;
+            }
+            bvh.refitPrimitive(id, box);
+        }
+    });
+    std::printf("  refitPrimitive x %zu: %.3f ms (%.2f us each)\n", moved, partialSeconds * 1e3,
+                partialSeconds * 1e6 / moved);
+
+    const Frustum frustum = extractFrustum(Eigen::Matrix4f::Identity());
+    std::vector<uint32_t> visible;
+    size_t bvhVisible = 0, bruteVisible = 0;
+    const double querySeconds = bench::bestOf(20, [&] {
+        visible.clear();
+        bvhVisible = bvh.queryFrustum(frustum, visible);
+    });
+    const double bruteQuerySeconds = bench::bestOf(5, [&] {
+        bruteVisible = 0;
+        for (const Aabb &box : boxes)
+            bruteVisible += !outsideFrustum(frustum, box);
+    });
+    std::printf("  frustum query: %zu visible in %.1f us (brute force %zu in %.1f us)\n", bvhVisible,
+                querySeconds * 1e6, bruteVisible, bruteQuerySeconds * 1e6);
+
+    const size_t rays = 10000;
+    std::vector<Ray> rayList(rays);
+    for (Ray &ray : rayList)
+        ray = randomRay(random);
+    size_t hits = 0, bruteHits = 0, mismatches = 0;
+    std::vector<uint32_t> bvhHitIds(rays);
+    const double raySeconds = bench::bestOf(5, [&] {
+        hits = 0;
+        for (size_t r = 0; r < rays; ++r)
+        {
+            const RayHit hit = bvh.raycastBounds(rayList[r]);
+            bvhHitIds[r] = hit.primitive;
+            hits += hit.valid();
+        }
+    });
+    const size_t bruteRays = std::min<size_t>(rays, 200);
+    const double bruteRaySeconds = bench::bestOf(1, [&] {
+        for (size_t r = 0; r < bruteRays; ++r)
+        {
+            uint32_t closest = UINT32_MAX;
+            float closestT = rayList[r].tMax;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float t = intersectAabb(rayList[r], boxes[i]);
+                if (t < closestT)
+                {
+                    closestT = t;
+                    closest = static_cast<uint32_t>(i);
+                }
+            }
+            bruteHits += closest != UINT32_MAX;
+            mismatches += closest != bvhHitIds[r];
+        }
+    });
+    std::printf("  raycastBounds: %.2f rays/us, %zu of %zu hit (brute force %.4f rays/us, %zu mismatches in %zu)\n",
+                rays / raySeconds / 1e6, hits, rays, bruteRays / bruteRaySeconds / 1e6, mismatches, bruteRays);
+    return bvhVisible == bruteVisible && mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include "bench.h"
+#include "../src/Culling/frustum.h"
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+  Frustum culling of `count` bounding spheres (1M by default, about half of them visible):
+  cullSpheres on the structure-of-arrays input against a plain one-sphere-at-a-time loop.
+
+  Usage: cullingBench [count]
+*/
+namespace
+{
+size_t cullScalar(const Frustum &frustum, const SphereSoA &spheres, std::vector<uint32_t> &visible)
+{
+    visible.clear();
+    for (size_t i = 0; i < spheres.size(); ++i)
+    {
+        bool inside = true;
+        for (const float *plane : frustum.planes)
+        {
+            const float distance = plane[0] * spheres.centerX[i] + plane[1] * spheres.centerY[i] +
+                                   plane[2] * spheres.centerZ[i] + plane[3];
+            if (distance < -spheres.radius[i])
+            {
+                inside = false;
+                break;
+            }
+        }
+        if (inside)
+            visible.push_back(static_cast<uint32_t>(i));
+    }
+    return visible.size();
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    bench::header("Frustum culling");
+
+    std::mt19937 random(31);
+    std::uniform_real_distribution<float> xy(-1.5f, 1.5f), z(-0.25f, 1.25f), radius(0.001f, 0.05f);
+    SphereSoA spheres;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float center[3] = {xy(random), xy(random), z(random)};
+        spheres.push(center, radius(random));
+    }
+    const Frustum frustum = extractFrustum(Eigen::Matrix4f::Identity());
+
+    std::vector<uint32_t> visible, reference;
+    visible.reserve(count);
+    reference.reserve(count);
+    size_t visibleCount = 0, referenceCount = 0;
+    const double simdSeconds = bench::bestOf(10, [&] {
+        visible.clear();
+        visibleCount = cullSpheres(frustum, spheres, visible);
+    });
+    const double scalarSeconds = bench::bestOf(10, [&] { referenceCount = cullScalar(frustum, spheres, reference); });
+
+    std::printf("  %zu spheres, %zu visible (scalar loop: %zu)\n", count, visibleCount, referenceCount);
+    std::printf("  cullSpheres: %.2f ms, %.0f objects/us\n", simdSeconds * 1e3, count / simdSeconds / 1e6);
+    std::printf("  scalar loop: %.2f ms, %.0f objects/us\n", scalarSeconds * 1e3, count / scalarSeconds / 1e6);
+    return visibleCount == referenceCount ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+#include "bench.h"
+#include "../src/Tessellation/curveFlattener.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+  Curve flattening, headless: `count` random quadratics, cubics and elliptical arcs (100K by
+  default) spanning up to 1000, 100 and 10 pixels, flattened to a quarter pixel. Reported per
+  kind and size: M curves/s and M points/s, points per curve, and the segments saved against
+  two fixed strategies that meet the same tolerance or try to:
+    uniform   equal parameter steps, as many as the curve's worst bend needs (Wang's formula):
+              what the quadratic and arc paths already do; cubics split where they bend
+              instead, which lands a little above it (negative savings)
+    fixed 64  the same count for every curve, whatever its size on screen
+
+  Usage: curveFlattenerBench [count]
+*/
+namespace
+{
+constexpr float kTolerance = 0.25f;
+constexpr double kFixedSegments = 64.0;
+
+// Wang's formula: steps of 1/n keep a degree-d curve within |second difference| * d(d-1) / 8 / n^2
+double uniformQuadratic(const float *c)
+{
+    const double dx = c[0] - 2.0 * c[2] + c[4], dy = c[1] - 2.0 * c[3] + c[5];
+    return std::max(1.0, std::ceil(std::sqrt(std::sqrt(dx * dx + dy * dy) / (4.0 * kTolerance))));
+}
+
+double uniformCubic(const float *c)
+{
+    double worst = 0.0;
+    for (int k = 0; k < 2; ++k)
+    {
+        const double dx = c[2 * k] - 2.0 * c[2 * k + 2] + c[2 * k + 4];
+        const double dy = c[2 * k + 1] - 2.0 * c[2 * k + 3] + c[2 * k + 5];
+        worst = std::max(worst, dx * dx + dy * dy);
+    }
+    return std::max(1.0, std::ceil(std::sqrt(0.75 * std::sqrt(worst) / kTolerance)));
+}
+
+// Equal angle steps bend at most as much as a circle of the larger radius: what flattenArc does
+double uniformArc(const EllipticalArc &arc)
+{
+    return arcSegmentCount(std::max(arc.radius[0], arc.radius[1]), arc.sweep, kTolerance);
+}
+
+void report(const char *kind, float span, size_t count, double seconds, const FlattenStats &stats, double uniform)
+{
+    const double points = static_cast<double>(stats.points);
+    std::printf("  %-10s %6.0f px %9.2f %9.2f %10.2f %8.1f%% %8.1f%%\n", kind, span, count / seconds / 1e6,
+                points / seconds / 1e6, points / count, 100.0 * (1.0 - points / uniform),
+                100.0 * (1.0 - points / (count * kFixedSegments)));
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    bench::header("Curve flattening: throughput and segments saved at a quarter pixel");
+    std::printf("  %-10s %9s %9s %9s %10s %9s %9s\n", "", "span", "M curves", "M points", "per curve", "uniform",
+                "fixed 64");
+    std::printf("  %-10s %9s %9s %9s %10s %9s %9s\n", "", "", "/s", "/s", "", "saved", "saved");
+
+    std::mt19937 random(46);
+    std::vector<float> xy;
+    xy.reserve(count * 2 * 256);
+    for (float span : {1000.0f, 100.0f, 10.0f})
+    {
+        std::uniform_real_distribution<float> coordinate(0.0f, span);
+        std::vector<std::array<float, 8>> curves(count);
+        for (auto &c : curves)
+            for (float &v : c)
+                v = coordinate(random);
+
+        std::uniform_real_distribution<float> radius(0.05f * span, 0.5f * span), angle(-6.2831853f, 6.2831853f);
+        std::vector<EllipticalArc> arcs(count);
+        for (EllipticalArc &arc : arcs)
+            arc = {{0.5f * span, 0.5f * span}, {radius(random), radius(random)}, angle(random), angle(random),
+                   angle(random)};
+
+        FlattenStats stats;
+        double seconds = bench::bestOf(3, [&] {
+            xy.clear();
+            stats = {};
+            for (const auto &c : curves)
+                flattenQuadratic(&c[0], &c[2], &c[4], kTolerance, xy, &stats);
+        });
+        double uniform = 0.0;
+        for (const auto &c : curves)
+            uniform += uniformQuadratic(c.data());
+        report("quadratic", span, count, seconds, stats, uniform);
+
+        seconds = bench::bestOf(3, [&] {
+            xy.clear();
+            stats = {};
+            for (const auto &c : curves)
+                flattenCubic(&c[0], &c[2], &c[4], &c[6], kTolerance, xy, &stats);
+        });
+        uniform = 0.0;
+        for (const auto &c : curves)
+            uniform += uniformCubic(c.data());
+        report("cubic", span, count, seconds, stats, uniform);
+
+        seconds = bench::bestOf(3, [&] {
+            xy.clear();
+            stats = {};
+            for (const EllipticalArc &arc : arcs)
+                flattenArc(arc, kTolerance, xy, &stats);
+        });
+        uniform = 0.0;
+        for (const EllipticalArc &arc : arcs)
+            uniform += uniformArc(arc);
+        report("arc", span, count, seconds, stats, uniform);
+        bench::keep(xy.data());
+    }
+    return 0;
+}
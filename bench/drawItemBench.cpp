@@ -0,0 +1,205 @@
+#include "bench.h"
+#include "../src/Draw/drawEncoding.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+/*
+  CPU cost per draw for `count` objects of three kinds, through the same recording encoder:
+    virtual    what the frame loop did before DrawItems: per object, the virtual
+               encodeRenderCommands (validity checks, pipeline and buffers bound every time)
+               then the virtual draw, on individually allocated primitives
+    items      encodeDrawItems, DrawList's loop, over the contiguous compiled items
+  The encoder's calls are out of line, standing in for Metal's message sends. Beyond dispatch and
+  data layout, items also skip rebinding a pipeline that is already bound.
+
+  Usage: drawItemBench [count]
+*/
+namespace
+{
+// Counts and folds every call so none of them can be dropped
+struct RecordingEncoder
+{
+    uint64_t calls{0};
+    uint64_t hash{0};
+
+    __attribute__((noinline)) void setPipeline(MTL::RenderPipelineState *pipeline) { record(pipeline, 0); }
+    __attribute__((noinline)) void setCullBack(bool cullBack) { record(nullptr, cullBack); }
+    __attribute__((noinline)) void setVertexBuffer(MTL::Buffer *buffer, size_t offset, uint32_t index)
+    {
+        record(buffer, offset + index);
+    }
+    __attribute__((noinline)) void setVertexBytes(const void *bytes, size_t length, uint32_t index)
+    {
+        record(bytes, length + index);
+    }
+    __attribute__((noinline)) void drawIndexed(uint32_t count, bool index32, MTL::Buffer *indices, size_t offset,
+                                               uint32_t instances)
+    {
+        record(indices, count + index32 + offset + instances);
+    }
+    __attribute__((noinline)) void draw(uint32_t count, uint32_t instances) { record(nullptr, count + instances); }
+
+    void record(const void *pointer, uint64_t value)
+    {
+        ++calls;
+        hash = (hash ^ reinterpret_cast<uintptr_t>(pointer) ^ value) * 0x100000001B3ull;
+    }
+};
+
+// Stand-ins for buffers and pipelines; only their addresses are used
+char fakeObjects[64];
+template <typename T>
+T *fake(size_t i)
+{
+    return reinterpret_cast<T *>(fakeObjects + i);
+}
+
+/*
+    The pre-DrawItem primitives
+*/
+class LegacyPrimitive
+{
+public:
+    virtual ~LegacyPrimitive() = default;
+
+    virtual void encodeRenderCommands(RecordingEncoder *encoder) const
+    {
+        if (!pipelineState)
+            throw std::runtime_error("No Pipeline State");
+        if (!vertexBuffer)
+            throw std::runtime_error("No Vertex Buffer");
+        if (!encoder)
+            return;
+
+        encoder->setPipeline(pipelineState);
+        encoder->setVertexBuffer(vertexBuffer, 0, 0);
+        encoder->setVertexBuffer(colorBuffer, 0, 1);
+        encoder->setVertexBytes(matrix.data(), sizeof(Eigen::Matrix4f), 11);
+    }
+    virtual void draw(RecordingEncoder *encoder) = 0;
+
+    MTL::RenderPipelineState *pipelineState{nullptr};
+    MTL::Buffer *vertexBuffer{nullptr};
+    MTL::Buffer *colorBuffer{nullptr};
+    MTL::Buffer *indexBuffer{nullptr};
+    Eigen::Matrix4f matrix{Eigen::Matrix4f::Identity()};
+    char state[160]{};                  // The rest of a Primitive: layout, bounds, stats...
+};
+
+class LegacyTriangle final : public LegacyPrimitive
+{
+public:
+    void draw(RecordingEncoder *encoder) override { encoder->drawIndexed(3, false, indexBuffer, 0, 1); }
+};
+
+class LegacyQuad final : public LegacyPrimitive
+{
+public:
+    void draw(RecordingEncoder *encoder) override
+    {
+        if (!indexBuffer)
+            throw std::runtime_error("Index buffer failed to create");
+        encoder->drawIndexed(6, false, indexBuffer, 0, 1);
+    }
+};
+
+class LegacyCircle final : public LegacyPrimitive
+{
+public:
+    void draw(RecordingEncoder *encoder) override { encoder->draw(300, 1); }
+};
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    bench::header("Per-draw CPU cost: virtual Primitive calls vs DrawItems");
+
+    // Individually allocated, mixed kinds, with other allocations in between as in a real scene
+    std::mt19937 random(41);
+    std::vector<std::unique_ptr<LegacyPrimitive>> scene;
+    std::vector<std::unique_ptr<char[]>> spacers;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const unsigned kind = random() % 3;
+        std::unique_ptr<LegacyPrimitive> primitive;
+        if (kind == 0)
+            primitive = std::make_unique<LegacyTriangle>();
+        else if (kind == 1)
+            primitive = std::make_unique<LegacyQuad>();
+        else
+            primitive = std::make_unique<LegacyCircle>();
+        primitive->pipelineState = fake<MTL::RenderPipelineState>(kind);
+        primitive->vertexBuffer = fake<MTL::Buffer>(8 + i % 16);
+        primitive->colorBuffer = fake<MTL::Buffer>(24 + i % 16);
+        primitive->indexBuffer = kind == 2 ? nullptr : fake<MTL::Buffer>(40 + kind);
+        primitive->matrix(0, 3) = static_cast<float>(i);
+        scene.push_back(std::move(primitive));
+        spacers.push_back(std::make_unique<char[]>(32 + random() % 512));
+    }
+    std::shuffle(scene.begin(), scene.end(), random);
+
+    // The same scene compiled once into items
+    std::vector<DrawItem> items(count);
+    std::vector<Eigen::Matrix4f> transforms(count);
+    std::vector<VertexDequant> dequants(count);
+    std::vector<MTL::RenderPipelineState *> pipelines = {fake<MTL::RenderPipelineState>(0), fake<MTL::RenderPipelineState>(1),
+                                                         fake<MTL::RenderPipelineState>(2)};
+    for (size_t i = 0; i < count; ++i)
+    {
+        const LegacyPrimitive &primitive = *scene[i];
+        DrawItem &item = items[i];
+        item.vertexBuffer = primitive.vertexBuffer;
+        item.colorBuffer = primitive.colorBuffer;
+        item.indexBuffer = primitive.indexBuffer;
+        item.pipeline = static_cast<uint32_t>(std::find(pipelines.begin(), pipelines.end(), primitive.pipelineState) - pipelines.begin());
+        item.count = dynamic_cast<const LegacyCircle *>(&primitive) ? 300 : (dynamic_cast<const LegacyQuad *>(&primitive) ? 6 : 3);
+        item.transformSlot = static_cast<uint32_t>(i);
+        transforms[i] = primitive.matrix;
+    }
+    std::vector<uint32_t> visible(count);
+    std::iota(visible.begin(), visible.end(), 0u);
+
+    RecordingEncoder legacy;
+    const double legacySeconds = bench::bestOf(5, [&] {
+        for (const std::unique_ptr<LegacyPrimitive> &primitive : scene)
+        {
+            primitive->encodeRenderCommands(&legacy);
+            primitive->draw(&legacy);
+        }
+    });
+
+    RecordingEncoder encoder;
+    DrawStats stats;
+    const double itemSeconds = bench::bestOf(5, [&] {
+        stats = encodeDrawItems(encoder, items, visible, pipelines, transforms, dequants);
+    });
+
+    // Scene order mixes the kinds, so most draws above change pipeline; sorted, only one per kind does
+    std::vector<uint32_t> sorted = visible;
+    std::stable_sort(sorted.begin(), sorted.end(), [&items](uint32_t a, uint32_t b) { return items[a].pipeline < items[b].pipeline; });
+    RecordingEncoder sortedEncoder;
+    DrawStats sortedStats;
+    const double sortedSeconds = bench::bestOf(5, [&] {
+        sortedStats = encodeDrawItems(sortedEncoder, items, sorted, pipelines, transforms, dequants);
+    });
+
+    std::printf("  %zu draws\n", count);
+    std::printf("  virtual: %.1f ns/draw (%.2f ms), %.1f encoder calls/draw\n", legacySeconds / count * 1e9,
+                legacySeconds * 1e3, static_cast<double>(legacy.calls) / 5 / count);
+    std::printf("  items:   %.1f ns/draw (%.2f ms), %zu pipeline changes, %.2fx faster\n", itemSeconds / count * 1e9,
+                itemSeconds * 1e3, stats.pipelineChanges, legacySeconds / itemSeconds);
+    std::printf("  items sorted by pipeline: %.1f ns/draw, %zu pipeline changes, %.2fx faster\n",
+                sortedSeconds / count * 1e9, sortedStats.pipelineChanges, legacySeconds / sortedSeconds);
+    bench::keep(legacy.hash);
+    bench::keep(encoder.hash);
+    bench::keep(sortedEncoder.hash);
+    return 0;
+}
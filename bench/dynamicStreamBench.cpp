@@ -0,0 +1,132 @@
+#include "bench.h"
+#include "../src/Primitive/streamRing.h"
+#include "../src/VertexFormat/vertexFormat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+/*
+  Bytes uploaded per frame by dynamic streams under partial updates, on a CPU backend: a
+  `vertices` position stream in a 3-slice StreamRing, as Primitive::makeDynamic sets it up, where
+  the upload is a memcpy of each coalesced dirty range into a separate device copy (what
+  didModifyRange publishes on Metal). Each morphing workload runs `frames` frames of
+  advance, encoded writes (as updateVertices) and flush, in Float4 and Half4:
+    corners     3 vertices, the same ones every frame (the renderer's MORPH quad)
+    block       1% of the stream in one run, in place
+    wave        a 10% window sliding 1% per frame
+    scattered   1% of the vertices one at a time, at random
+    all         the whole stream
+  Reported per frame: update calls, bytes written, bytes uploaded and the uploads they took,
+  the share of the stream that is, and CPU time.
+
+  Usage: dynamicStreamBench [vertices] [frames]
+*/
+namespace
+{
+constexpr size_t kSlots = 3;
+
+struct VertexRun
+{
+    size_t first;
+    size_t count;
+};
+
+using Workload = std::function<void(size_t frame, std::vector<VertexRun> &runs)>;
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t frames = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 300;
+    bench::header("Dynamic streams: bytes uploaded per frame under partial updates");
+
+    std::vector<float> positions(count * 4);
+    for (size_t i = 0; i < count; ++i)
+    {
+        positions[i * 4 + 0] = static_cast<float>(i % 1000) * 0.001f;
+        positions[i * 4 + 1] = static_cast<float>(i / 1000) * 0.001f;
+        positions[i * 4 + 2] = 0.5f;
+        positions[i * 4 + 3] = 1.0f;
+    }
+    const VertexDequant dequant = computeDequant(positions.data(), count);
+
+    const size_t percent = std::max<size_t>(count / 100, 1);
+    std::mt19937 random(38);
+    std::uniform_int_distribution<size_t> anywhere(0, count - 1);
+    const struct
+    {
+        const char *name;
+        Workload runs;
+    } workloads[] = {
+        {"corners", [](size_t, std::vector<VertexRun> &runs) { runs.push_back({0, 3}); }},
+        {"block", [&](size_t, std::vector<VertexRun> &runs) { runs.push_back({count / 2, percent}); }},
+        {"wave", [&](size_t frame, std::vector<VertexRun> &runs) {
+             const size_t window = std::min(10 * percent, count);
+             runs.push_back({(frame * percent) % (count - window + 1), window});
+         }},
+        {"scattered", [&](size_t, std::vector<VertexRun> &runs) {
+             for (size_t i = 0; i < percent; ++i)
+                 runs.push_back({anywhere(random), 1});
+         }},
+        {"all", [&](size_t, std::vector<VertexRun> &runs) { runs.push_back({0, count}); }},
+    };
+
+    std::printf("  %zu vertices, %zu frames, %zu slices\n", count, frames, kSlots);
+    std::printf("  %-10s %-6s %8s %12s %12s %9s %10s %9s\n", "", "", "updates", "bytes written", "uploaded", "uploads",
+                "of stream", "ms/frame");
+    for (PositionFormat format : {PositionFormat::Float4, PositionFormat::Half4})
+    {
+        const size_t stride = positionStride(format);
+        const size_t bytes = count * stride;
+        for (const auto &workload : workloads)
+        {
+            // Every slice and the device copy start as the stream
+            std::vector<char> memory(StreamRing<kSlots>::sliceStride(bytes) * kSlots);
+            std::vector<char> device(memory.size());
+            StreamRing<kSlots> ring(memory.data(), bytes);
+
+            std::vector<VertexRun> runs;
+            uint64_t updates = 0, written = 0, uploaded = 0, uploads = 0;
+            const bench::Clock::time_point start = bench::Clock::now();
+            for (size_t frame = 0; frame < frames; ++frame)
+            {
+                runs.clear();
+                workload.runs(frame, runs);
+                ring.advance();
+                for (const VertexRun &run : runs)
+                {
+                    char *target = ring.getSlice() + run.first * stride;
+                    if (format == PositionFormat::Float4)
+                        std::memcpy(target, positions.data() + run.first * 4, run.count * stride);
+                    else
+                        encodePositions(format, positions.data() + run.first * 4, run.count, dequant, target);
+                    ring.add(run.first * stride, (run.first + run.count) * stride);
+                    written += run.count * stride;
+                }
+                updates += runs.size();
+
+                for (const ByteRange &range : ring.getDirty().coalesce())
+                {
+                    std::memcpy(device.data() + range.begin, memory.data() + range.begin, range.size());
+                    uploaded += range.size();
+                    ++uploads;
+                }
+                ring.getDirty().clear();
+            }
+            const double seconds = std::chrono::duration<double>(bench::Clock::now() - start).count();
+            bench::keep(device.data());
+
+            const double perFrame = 1.0 / static_cast<double>(frames);
+            std::printf("  %-10s %-6s %8.0f %13.0f %12.0f %9.1f %9.2f%% %9.3f\n", workload.name,
+                        format == PositionFormat::Float4 ? "Float4" : "Half4", updates * perFrame,
+                        written * perFrame, uploaded * perFrame, uploads * perFrame,
+                        100.0 * uploaded * perFrame / static_cast<double>(bytes), seconds * perFrame * 1e3);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include "bench.h"
+#include "../src/Loader/gltfLoader.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+  loadGlb on a synthetic .glb of about `megabytes` MB (256 by default) written to the temp
+  directory: 256 x 256 vertex grids, alternating between two layouts,
+    in place    float VEC3 positions, normalized ubyte VEC4 colors and uint indices, each tightly
+                packed in its own view: every stream used straight from the mapping
+    converted   positions and float VEC3 colors interleaved in one strided view, ushort indices:
+                both vertex streams rewritten, the indices in place
+  and every grid under its own node in a chain, so the world matrices compose down the file.
+  The file is streamed out mesh by mesh, so writing it doesn't raise the high-water mark.
+  Reported (GltfLoadStats): load time and MB/s, peak resident bytes before and after the load,
+  and zero-copy against converted stream bytes. Mapped pages count as resident once touched, and
+  every index is read to validate it (the kernel maps cached pages around each fault), so the
+  peak grows with the file whatever the zero-copy share; zero copy saves the owned copies.
+
+  Usage: gltfLoadBench [megabytes]
+*/
+namespace
+{
+constexpr uint32_t kGridSide = 256;
+constexpr uint32_t kGridVertices = kGridSide * kGridSide;
+constexpr uint32_t kGridIndices = (kGridSide - 1) * (kGridSide - 1) * 6;
+
+constexpr size_t kInPlaceBytes = kGridVertices * 12 + kGridVertices * 4 + kGridIndices * 4;
+constexpr size_t kConvertedBytes = kGridVertices * 24 + kGridIndices * 2;
+
+size_t peakResident()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;       // KB on Linux
+}
+
+void append32(std::string &out, uint32_t value)
+{
+    out.append(reinterpret_cast<const char *>(&value), 4);
+}
+
+std::string view(size_t offset, size_t length, size_t stride = 0)
+{
+    return R"({"buffer":0,"byteOffset":)" + std::to_string(offset) + R"(,"byteLength":)" + std::to_string(length) +
+           (stride ? R"(,"byteStride":)" + std::to_string(stride) : std::string()) + "}";
+}
+
+std::string accessor(size_t bufferView, size_t offset, int componentType, size_t count, const char *type,
+                     bool normalized = false, bool bounds = false)
+{
+    return R"({"bufferView":)" + std::to_string(bufferView) + R"(,"byteOffset":)" + std::to_string(offset) +
+           R"(,"componentType":)" + std::to_string(componentType) + R"(,"count":)" + std::to_string(count) +
+           R"(,"type":")" + type + "\"" + (normalized ? R"(,"normalized":true)" : "") +
+           (bounds ? R"(,"min":[0,0,0],"max":[1,1,0])" : "") + "}";
+}
+
+// Grid vertices in [0, 1]^2, xyz, optionally followed by an rgb float color each
+void writePositions(std::ofstream &out, bool interleavedColors)
+{
+    std::vector<float> row;
+    for (uint32_t y = 0; y < kGridSide; ++y)
+    {
+        row.clear();
+        for (uint32_t x = 0; x < kGridSide; ++x)
+        {
+            const float u = float(x) / (kGridSide - 1), v = float(y) / (kGridSide - 1);
+            row.insert(row.end(), {u, v, 0.0f});
+            if (interleavedColors)
+                row.insert(row.end(), {u, v, 0.5f});
+        }
+        out.write(reinterpret_cast<const char *>(row.data()), static_cast<std::streamsize>(row.size() * 4));
+    }
+}
+
+template <typename Index>
+void writeIndices(std::ofstream &out)
+{
+    std::vector<Index> row;
+    for (uint32_t y = 0; y + 1 < kGridSide; ++y)
+    {
+        row.clear();
+        for (uint32_t x = 0; x + 1 < kGridSide; ++x)
+        {
+            const Index a = static_cast<Index>(y * kGridSide + x), b = static_cast<Index>(a + 1);
+            const Index c = static_cast<Index>(a + kGridSide + 1), d = static_cast<Index>(a + kGridSide);
+            row.insert(row.end(), {a, b, c, c, d, a});
+        }
+        out.write(reinterpret_cast<const char *>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(Index)));
+    }
+}
+
+void writeGlb(const std::filesystem::path &path, size_t meshes)
+{
+    std::string views, accessors, meshList, nodes;
+    size_t offset = 0;
+    for (size_t m = 0; m < meshes; ++m)
+    {
+        const size_t firstView = m * 3, firstAccessor = m * 3;
+        const std::string sep = m ? "," : "";
+        if (m % 2 == 0)
+        {
+            views += sep + view(offset, kGridVertices * 12) + "," + view(offset + kGridVertices * 12, kGridVertices * 4) +
+                     "," + view(offset + kGridVertices * 16, kGridIndices * 4);
+            accessors += sep + accessor(firstView, 0, 5126, kGridVertices, "VEC3", false, true) + "," +
+                         accessor(firstView + 1, 0, 5121, kGridVertices, "VEC4", true) + "," +
+                         accessor(firstView + 2, 0, 5125, kGridIndices, "SCALAR");
+            offset += kInPlaceBytes;
+        }
+        else
+        {
+            // A third, empty-handed view keeps three per mesh so the numbering stays simple
+            views += sep + view(offset, kGridVertices * 24, 24) + "," + view(offset + kGridVertices * 24, kGridIndices * 2) +
+                     "," + view(offset, 4);
+            accessors += sep + accessor(firstView, 0, 5126, kGridVertices, "VEC3", false, true) + "," +
+                         accessor(firstView, 12, 5126, kGridVertices, "VEC3") + "," +
+                         accessor(firstView + 1, 0, 5123, kGridIndices, "SCALAR");
+            offset += kConvertedBytes;
+        }
+        meshList += sep + R"({"primitives":[{"attributes":{"POSITION":)" + std::to_string(firstAccessor) +
+                    R"(,"COLOR_0":)" + std::to_string(firstAccessor + 1) + R"(},"indices":)" +
+                    std::to_string(firstAccessor + 2) + "}]}";
+        nodes += sep + R"({"mesh":)" + std::to_string(m) + R"(,"translation":[0.01,0,0])" +
+                 (m + 1 < meshes ? R"(,"children":[)" + std::to_string(m + 1) + "]" : "") + "}";
+    }
+    std::string json = R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":)" + std::to_string(offset) +
+                       R"(}],"bufferViews":[)" + views + R"(],"accessors":[)" + accessors + R"(],"meshes":[)" +
+                       meshList + R"(],"nodes":[)" + nodes + R"(],"scenes":[{"nodes":[0]}],"scene":0})";
+    json.resize((json.size() + 3) & ~size_t{3}, ' ');
+
+    std::string header;
+    append32(header, 0x46546C67u);
+    append32(header, 2);
+    append32(header, static_cast<uint32_t>(12 + 8 + json.size() + 8 + offset));
+    append32(header, static_cast<uint32_t>(json.size()));
+    append32(header, 0x4E4F534Au);
+    header += json;
+    append32(header, static_cast<uint32_t>(offset));
+    append32(header, 0x004E4942u);
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    const std::vector<uint8_t> colors(kGridVertices * 4, 0xff);
+    for (size_t m = 0; m < meshes; ++m)
+    {
+        if (m % 2 == 0)
+        {
+            writePositions(out, false);
+            out.write(reinterpret_cast<const char *>(colors.data()), static_cast<std::streamsize>(colors.size()));
+            writeIndices<uint32_t>(out);
+        }
+        else
+        {
+            writePositions(out, true);
+            writeIndices<uint16_t>(out);
+        }
+    }
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+    bench::header("glTF loader: load time, peak memory and zero-copy share of a large .glb");
+
+    const size_t meshes = std::max<size_t>(megabytes * 2000000 / (kInPlaceBytes + kConvertedBytes), 1);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "gltfLoadBench.glb";
+    writeGlb(path, meshes);
+    const size_t fileBytes = std::filesystem::file_size(path);
+    std::printf("  %.1f MB, %zu meshes of %u vertices, half in place, half converted\n", fileBytes / 1e6, meshes,
+                kGridVertices);
+
+    const size_t residentBefore = peakResident();
+    GltfLoadStats stats;
+    {
+        const std::shared_ptr<const GltfAsset> asset = loadGlb(path.string());
+        stats = asset->stats;
+        bench::keep(asset->nodes.back().world);
+    }
+    std::printf("  load: %.1f ms, %.0f MB/s (warm page cache, just written)\n", stats.seconds * 1e3,
+                stats.bytes / stats.seconds / 1e6);
+    std::printf("  peak resident: %.1f MB before, %.1f MB after (+%.1f MB)\n", residentBefore / 1e6,
+                stats.peakResidentBytes / 1e6, (stats.peakResidentBytes - residentBefore) / 1e6);
+    const double streams = static_cast<double>(stats.zeroCopyBytes + stats.convertedBytes);
+    std::printf("  streams: %.1f MB zero copy (%.1f%%), %.1f MB converted (%.1f%%)\n", stats.zeroCopyBytes / 1e6,
+                100.0 * stats.zeroCopyBytes / streams, stats.convertedBytes / 1e6, 100.0 * stats.convertedBytes / streams);
+
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "bench.h"
+#include "../src/Simulation/sceneSimulation.h"
+#include "../src/common/tripleBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/*
+  The simulation-to-render handoff, headless:
+    triple buffer   publish + acquire on one thread (the uncontended cost), then `publishes`
+                    values from a writer thread against a spinning reader, checking every read
+                    is whole and never older than the one before
+    simulation      SceneSimulation ticking `bodies` at 120 Hz while a render loop paced at 30,
+                    60 and 144 Hz acquires and interpolates each frame: ticks/s, publish to
+                    acquire latency and the render thread's acquire + interpolate cost
+
+  Usage: handoffBench [bodies] [seconds per rate] [publishes]
+*/
+namespace
+{
+// Every field holds the same sequence number, so a torn read shows as a mismatch
+struct Stamp
+{
+    uint64_t values[8]{};
+};
+
+void tripleBuffer(uint64_t publishes)
+{
+    TripleBuffer<Stamp> buffer;
+    const uint64_t rounds = 10000000;
+    const double seconds = bench::bestOf(3, [&] {
+        for (uint64_t i = 0; i < rounds; ++i)
+        {
+            buffer.back().values[0] = i;
+            buffer.publish();
+            buffer.acquire();
+            bench::keep(buffer.front().values[0]);
+        }
+    });
+    std::printf("  triple buffer: publish + acquire %.1f ns uncontended\n", seconds / rounds * 1e9);
+
+    TripleBuffer<Stamp> shared;
+    std::atomic<bool> done{false};
+    uint64_t fresh = 0, torn = 0, backwards = 0;
+    std::thread reader([&] {
+        uint64_t last = 0;
+        for (;;)
+        {
+            const bool finished = done.load(std::memory_order_acquire);
+            if (!shared.acquire())
+            {
+                if (finished)
+                    break;
+                continue;
+            }
+            ++fresh;
+            const Stamp &stamp = shared.front();
+            for (uint64_t value : stamp.values)
+                torn += value != stamp.values[0];
+            backwards += stamp.values[0] < last;
+            last = stamp.values[0];
+        }
+    });
+    for (uint64_t i = 1; i <= publishes; ++i)
+    {
+        Stamp &stamp = shared.back();
+        for (uint64_t &value : stamp.values)
+            value = i;
+        shared.publish();
+        // Lets the reader in often even on one core, where it would otherwise see a value per time slice
+        if (i % 64 == 0)
+            std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    std::printf("  %llu publishes against a spinning reader: %llu fresh reads, %llu torn, %llu out of order\n",
+                static_cast<unsigned long long>(publishes), static_cast<unsigned long long>(fresh),
+                static_cast<unsigned long long>(torn), static_cast<unsigned long long>(backwards));
+}
+
+void simulation(size_t bodies, double seconds, double renderHz)
+{
+    SceneSimulation simulation(1.0 / 120.0);
+    for (size_t i = 0; i < bodies; ++i)
+    {
+        SimPose pose;
+        pose.position[0] = static_cast<float>(i % 32) / 16.0f - 1.0f;
+        SimMotion motion;
+        motion.velocity[0] = 0.3f;
+        motion.velocity[1] = 0.1f * static_cast<float>(i % 7);
+        motion.spin = 1.0f;
+        motion.bounds = 1.0f;
+        simulation.addBody(pose, motion);
+    }
+
+    std::vector<Eigen::Matrix4f> matrices;
+    double renderSeconds = 0.0;
+    size_t frames = 0;
+    simulation.start();
+    const SceneSimulation::Clock::time_point begin = SceneSimulation::Clock::now();
+    const SceneSimulation::Clock::time_point end = begin + std::chrono::duration_cast<SceneSimulation::Clock::duration>(
+                                                               std::chrono::duration<double>(seconds));
+    SceneSimulation::Clock::time_point next = begin;
+    while (next < end)
+    {
+        const SceneSimulation::Clock::time_point start = SceneSimulation::Clock::now();
+        simulation.acquire();
+        simulation.interpolate(start, matrices);
+        renderSeconds += std::chrono::duration<double>(SceneSimulation::Clock::now() - start).count();
+        ++frames;
+        bench::keep(matrices.data());
+
+        next += std::chrono::duration_cast<SceneSimulation::Clock::duration>(std::chrono::duration<double>(1.0 / renderHz));
+        std::this_thread::sleep_until(next);
+    }
+    const double elapsed = std::chrono::duration<double>(SceneSimulation::Clock::now() - begin).count();
+    simulation.stop();
+
+    const SimulationStats stats = simulation.getStats();
+    const HandoffStats &handoff = simulation.getHandoffStats();
+    std::printf("  render %3.0f Hz: %.1f ticks/s, %llu skipped; latency mean %.2f ms, max %.2f ms; "
+                "%llu of %llu snapshots replaced unread; acquire + interpolate %.1f us/frame\n",
+                renderHz, stats.ticks / elapsed, static_cast<unsigned long long>(stats.skippedTicks),
+                handoff.latencyMeanMs, handoff.latencyMaxMs, static_cast<unsigned long long>(stats.replaced),
+                static_cast<unsigned long long>(stats.published), renderSeconds / frames * 1e6);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t bodies = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+    const double seconds = argc > 2 ? std::strtod(argv[2], nullptr) : 2.0;
+    const uint64_t publishes = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 3000000;
+    bench::header("Simulation handoff: triple buffer and fixed-tick snapshots");
+
+    tripleBuffer(publishes);
+    std::printf("  %zu bodies at 120 Hz, %.1f s per render rate\n", bodies, seconds);
+    for (double renderHz : {30.0, 60.0, 144.0})
+        simulation(bodies, seconds, renderHz);
+    return 0;
+}
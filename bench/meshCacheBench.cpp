@@ -0,0 +1,85 @@
+#include "bench.h"
+#include "../src/Loader/meshCache.h"
+#include "../src/Loader/objLoader.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+/*
+  Startup cost of loadMeshCached on the same mesh, cold then warm: a generated icosphere
+  (`segments` 100 by default: 100K vertices, 200K faces) written as OBJ to the temp directory.
+    cold   no cache next to the source: hash, parseObj, optimize (and LODs), write the cache
+    warm   the cache written by the cold run: hash, map and validate it, used in place
+  Both with and without LODs; the files stay in the page cache between runs, so this times the
+  work the cache skips, not the disk. Reported: source and cache size, the hash and load time of
+  each run (MeshCacheStats), the whole call, and the warm speed-up.
+
+  Usage: meshCacheBench [segments]
+*/
+namespace
+{
+std::string sphereObj(uint32_t segments)
+{
+    const std::shared_ptr<const SphereGeometry> sphere = getSphere(SphereType::Icosphere, segments);
+    std::string text;
+    text.reserve(sphere->vertexCount() * 40 + sphere->indices.size() * 10);
+    char line[128];
+    for (size_t i = 0; i < sphere->vertexCount(); ++i)
+    {
+        const float *p = &sphere->positions[i * 4];
+        text.append(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", p[0], p[1], p[2]));
+    }
+    for (size_t i = 0; i < sphere->indices.size(); i += 3)
+    {
+        const uint32_t *f = &sphere->indices[i];
+        text.append(line, std::snprintf(line, sizeof(line), "f %u %u %u\n", f[0] + 1, f[1] + 1, f[2] + 1));
+    }
+    return text;
+}
+
+void report(const char *run, const MeshCacheStats &stats, double seconds)
+{
+    std::printf("  %-5s %-4s %9.2f %9.2f %9.2f\n", run, stats.hit ? "hit" : "miss", stats.hashSeconds * 1e3,
+                stats.loadSeconds * 1e3, seconds * 1e3);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const uint32_t segments = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 100;
+    bench::header("Mesh cache: cold (parse + bake + write) against warm (mapped cache) load");
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "meshCacheBench.obj";
+    const std::string cachePath = path.string() + ".meshcache";
+    {
+        const std::string text = sphereObj(segments);
+        std::ofstream(path, std::ios::binary).write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+    const MeshImporter importer = [](const char *data, size_t size) { return parseObj(data, size); };
+
+    for (bool lods : {false, true})
+    {
+        MeshCacheStats cold, warm;
+        const double coldSeconds = bench::bestOf(3, [&] {
+            std::filesystem::remove(cachePath);
+            bench::keep(loadMeshCached(path.string(), importer, lods, &cold));
+        });
+        const double warmSeconds =
+            bench::bestOf(3, [&] { bench::keep(loadMeshCached(path.string(), importer, lods, &warm)); });
+
+        std::printf("  %s: %.1f MB of OBJ, %.1f MB cached\n", lods ? "with LODs" : "without LODs",
+                    cold.sourceBytes / 1e6, cold.cacheBytes / 1e6);
+        std::printf("  %-5s %-4s %9s %9s %9s\n", "", "", "hash ms", "load ms", "total ms");
+        report("cold", cold, coldSeconds);
+        report("warm", warm, warmSeconds);
+        std::printf("  warm is %.0fx faster\n", coldSeconds / warmSeconds);
+    }
+
+    std::filesystem::remove(cachePath);
+    std::filesystem::remove(path);
+    return 0;
+}
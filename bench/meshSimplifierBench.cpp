@@ -0,0 +1,87 @@
+#include "bench.h"
+#include "../src/common/Transform.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+#include "../src/MeshOptimizer/meshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+  Quadric simplification, headless:
+    throughput  simplifyMesh of spheres to half and to a tenth of their triangles, and a whole
+                buildLodChain, in M input triangles/s (the error budget lifted so the target
+                decides where each stops)
+    scene       `objects` unit icospheres sharing one LOD chain, scaled as if spread from 1 to
+                100 units away (log-uniform: as many per decade) on a 1920 x 1080 viewport,
+                each drawn at the LOD Mesh::selectLod would pick: objects and triangles per
+                level against drawing LOD 0 everywhere
+
+  Usage: meshSimplifierBench [objects]
+*/
+int main(int argc, char **argv)
+{
+    const size_t objects = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+    bench::header("Mesh simplifier: throughput and triangles saved by LODs");
+
+    SimplifyOptions unbounded;
+    unbounded.targetError = 1e9f;
+    const struct
+    {
+        const char *name;
+        SphereType type;
+        uint32_t segments;
+    } spheres[] = {{"ico 64", SphereType::Icosphere, 64},
+                   {"ico 160", SphereType::Icosphere, 160},
+                   {"uv 512", SphereType::UvSphere, 512}};
+    std::printf("  %-8s %9s %14s %14s %22s\n", "", "triangles", "to 1/2", "to 1/10", "LOD chain");
+    for (const auto &sphere : spheres)
+    {
+        const MeshData mesh = getSphere(sphere.type, sphere.segments)->toMeshData();
+        const size_t triangles = mesh.triangleCount();
+        std::printf("  %-8s %9zu", sphere.name, triangles);
+
+        std::vector<uint32_t> simplified;
+        for (size_t divisor : {2, 10})
+        {
+            const double seconds = bench::bestOf(3, [&] {
+                simplifyMesh(simplified, mesh, mesh.indices, triangles / divisor * 3, unbounded);
+            });
+            std::printf(" %8.2f M/s  ", triangles / seconds / 1e6);
+        }
+
+        LodChain chain;
+        const double seconds = bench::bestOf(3, [&] { chain = buildLodChain(mesh, 8, 0.5f, unbounded); });
+        std::printf(" %6.2f M/s, %zu levels\n", triangles / seconds / 1e6, chain.levels.size());
+    }
+
+    // The scene: the default error budget, as Mesh builds its chains
+    const MeshData mesh = getSphere(SphereType::Icosphere, 64)->toMeshData();
+    const LodChain chain = buildLodChain(mesh);
+    std::vector<size_t> objectsPerLevel(chain.levels.size(), 0);
+    std::mt19937 random(28);
+    std::uniform_real_distribution<float> decades(0.0f, 2.0f);
+    Transform transform;
+    size_t drawn = 0;
+    for (size_t i = 0; i < objects; ++i)
+    {
+        // No projection yet: distance shows up as scale
+        const float scale = std::pow(10.0f, -decades(random));
+        transform.reset();
+        transform.setScale(scale, scale, scale);
+        const size_t level = selectLod(chain, pixelsPerUnit(transform.getMatrix(), 1920.0f));
+        ++objectsPerLevel[level];
+        drawn += chain.levels[level].indexCount / 3;
+    }
+    const size_t full = objects * mesh.triangleCount();
+    std::printf("  scene: %zu ico 64 spheres 1 to 100 units away, %zu levels\n", objects, chain.levels.size());
+    for (size_t level = 0; level < chain.levels.size(); ++level)
+        std::printf("    LOD %zu: %6u triangles, error %.4f, %5zu objects\n", level, chain.levels[level].indexCount / 3,
+                    chain.levels[level].error, objectsPerLevel[level]);
+    std::printf("  triangles drawn: %.2fM of %.2fM at LOD 0 (%.1f%% saved)\n", drawn / 1e6, full / 1e6,
+                100.0 * (1.0 - static_cast<double>(drawn) / static_cast<double>(full)));
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "bench.h"
+#include "../src/Culling/frustum.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+#include "../src/MeshOptimizer/meshOptimizer.h"
+#include "../src/MeshOptimizer/meshlets.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/*
+  Meshlets, headless:
+    build   buildMeshlets on optimized spheres, in M triangles/s, with the meshlets' average fill
+            against the 64-vertex / 124-triangle limits
+    cull    cullMeshlets of the largest sphere (scaled to 0.5, no camera: clip space is the
+            transform, as in Mesh::cullClusters) in view, half off the side and mostly off it,
+            with frustum culling, backface culling and both: share of triangles culled and
+            M input triangles/s
+
+  Usage: meshletBench [scale]   (multiplies the segment counts, 1 by default)
+*/
+namespace
+{
+ClusterCullParams cullParams(float offsetX, bool frustum, bool backface)
+{
+    Eigen::Matrix4f m = Eigen::Matrix4f::Identity();
+    m(0, 0) = m(1, 1) = m(2, 2) = 0.5f;
+    m(0, 3) = offsetX;
+    m(2, 3) = 0.5f;
+    ClusterCullParams params;
+    const Frustum planes = extractFrustum(m);
+    std::copy(&planes.planes[0][0], &planes.planes[0][0] + 24, &params.planes[0][0]);
+    // Uniform positive scale: the object-space view direction is the clip-space one
+    params.viewDirection[0] = params.viewDirection[1] = 0.0f;
+    params.viewDirection[2] = 1.0f;
+    params.frustumCulling = frustum;
+    params.backfaceCulling = backface;
+    return params;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const uint32_t scale = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1;
+    bench::header("Meshlets: build throughput and triangles culled per cluster");
+
+    const struct
+    {
+        const char *name;
+        SphereType type;
+        uint32_t segments;
+    } spheres[] = {{"uv", SphereType::UvSphere, 128},
+                   {"uv", SphereType::UvSphere, 512},
+                   {"ico", SphereType::Icosphere, 64},
+                   {"ico", SphereType::Icosphere, 160}};
+    std::printf("  %-10s %9s %9s %13s %15s %12s\n", "", "triangles", "meshlets", "vertices/64", "triangles/124",
+                "M tris/s");
+    MeshData largest;
+    MeshletSet largestSet;
+    for (const auto &sphere : spheres)
+    {
+        MeshData mesh = getSphere(sphere.type, sphere.segments * scale)->toMeshData();
+        optimizeMesh(mesh);
+        MeshletSet set;
+        const double seconds = bench::bestOf(3, [&] { set = buildMeshlets(mesh); });
+
+        size_t vertices = 0;
+        for (const Meshlet &meshlet : set.meshlets)
+            vertices += meshlet.vertexCount;
+        const double meshlets = static_cast<double>(set.meshlets.size());
+        char label[32];
+        std::snprintf(label, sizeof(label), "%s %u", sphere.name, sphere.segments * scale);
+        std::printf("  %-10s %9zu %9zu %13.1f %15.1f %12.2f\n", label, mesh.triangleCount(), set.meshlets.size(),
+                    vertices / meshlets, mesh.triangleCount() / meshlets, mesh.triangleCount() / seconds / 1e6);
+        if (mesh.triangleCount() > largest.triangleCount())
+        {
+            largest = std::move(mesh);
+            largestSet = std::move(set);
+        }
+    }
+
+    std::printf("\n  culling %zu triangles in %zu meshlets\n", largest.triangleCount(), largestSet.meshlets.size());
+    std::printf("  %-16s %-10s %9s %12s\n", "placement", "culling", "culled", "M tris/s");
+    const struct
+    {
+        const char *name;
+        float offsetX;
+    } placements[] = {{"in view", 0.0f}, {"half off", 1.0f}, {"mostly off", 1.4f}};
+    const struct
+    {
+        const char *name;
+        bool frustum, backface;
+    } modes[] = {{"frustum", true, false}, {"backface", false, true}, {"both", true, true}};
+    std::vector<uint32_t> indices(largest.indices.size());
+    for (const auto &placement : placements)
+        for (const auto &mode : modes)
+        {
+            const ClusterCullParams params = cullParams(placement.offsetX, mode.frustum, mode.backface);
+            ClusterCullStats stats;
+            const double seconds =
+                bench::bestOf(5, [&] { cullMeshlets(indices.data(), largestSet, params, &stats); });
+            bench::keep(indices.data());
+            std::printf("  %-16s %-10s %8.1f%% %12.2f\n", placement.name, mode.name,
+                        100.0 * (1.0 - static_cast<double>(stats.visibleTriangles) / stats.totalTriangles),
+                        stats.totalTriangles / seconds / 1e6);
+        }
+    return 0;
+}
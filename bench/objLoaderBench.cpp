@@ -0,0 +1,73 @@
+#include "bench.h"
+#include "../src/Loader/objLoader.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+/*
+  OBJ parse throughput on a generated icosphere of about `megabytes` MB of text (1024 by
+  default: about 13M vertices and 26M faces, and some 4 GB of memory at the peak) from memory
+  with one thread and with every core, and through loadObj from a file in the temp directory.
+
+  Usage: objLoaderBench [megabytes]
+*/
+namespace
+{
+// An icosphere has 10 s^2 vertices and 20 s^2 faces, at roughly 30 and 24 bytes a line
+constexpr double kBytesPerSegmentSq = 780.0;
+
+std::string sphereObj(uint32_t segments)
+{
+    const std::shared_ptr<const SphereGeometry> sphere = getSphere(SphereType::Icosphere, segments);
+    std::string text;
+    text.reserve(sphere->vertexCount() * 40 + sphere->indices.size() * 10);
+    char line[128];
+    for (size_t i = 0; i < sphere->vertexCount(); ++i)
+    {
+        const float *p = &sphere->positions[i * 4];
+        text.append(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", p[0], p[1], p[2]));
+    }
+    for (size_t i = 0; i < sphere->indices.size(); i += 3)
+    {
+        const uint32_t *f = &sphere->indices[i];
+        text.append(line, std::snprintf(line, sizeof(line), "f %u %u %u\n", f[0] + 1, f[1] + 1, f[2] + 1));
+    }
+    return text;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024;
+    const uint32_t segments = std::max(1u, static_cast<uint32_t>(std::sqrt(megabytes * 1e6 / kBytesPerSegmentSq)));
+    bench::header("OBJ loader");
+
+    const std::string text = sphereObj(segments);
+    std::printf("  %.1f MB of OBJ text\n", text.size() / 1e6);
+
+    for (unsigned threads : {1u, 0u})
+    {
+        ObjLoadOptions options;
+        options.threads = threads;
+        ObjLoadStats stats;
+        MeshData mesh;
+        const double seconds = bench::bestOf(3, [&] { mesh = parseObj(text.data(), text.size(), options, &stats); });
+        std::printf("  parseObj, %u thread(s), %u chunks: %.1f ms, %.0f MB/s, %zu vertices, %zu triangles\n",
+                    threads ? threads : std::max(1u, std::thread::hardware_concurrency()), stats.chunks,
+                    seconds * 1e3, text.size() / seconds / 1e6, mesh.positions.size(), mesh.indices.size() / 3);
+    }
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "objLoaderBench.obj";
+    std::ofstream(path, std::ios::binary).write(text.data(), static_cast<std::streamsize>(text.size()));
+    const double fileSeconds = bench::bestOf(3, [&] { bench::keep(loadObj(path.string())); });
+    std::printf("  loadObj (mapped file, warm cache): %.1f ms, %.0f MB/s\n", fileSeconds * 1e3,
+                text.size() / fileSeconds / 1e6);
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "bench.h"
+#include "../src/Draw/softwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+  Fragments shaded and overdraw for opaque geometry through the SoftwareRasterizer, standing in
+  for the Metal pass: `quads` random quads at random depths, together covering about 8x a
+  1920 x 1080 screen, each drawn with its own transform like a Primitive, in four ways:
+    no depth         no depth attachment, every covered pixel shades (the pass before DEPTH)
+    unsorted         depth test in scene order
+    front to back    depth test, nearest first (DEPTH's opaque pass)
+    back to front    depth test, farthest first (the worst case)
+  Overdraw is fragments shaded per covered pixel; tiles rejected is the share of triangle / tile
+  pairs the hierarchical Z dropped without testing a pixel.
+
+  Usage: overdrawBench [quads] [width] [height]
+*/
+namespace
+{
+struct Quad
+{
+    Eigen::Matrix4f transform;
+    float depth;
+};
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+    const uint32_t width = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1920;
+    const uint32_t height = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1080;
+    bench::header("Overdraw: fragments shaded with and without depth, by draw order");
+
+    // A unit quad, as Quad's buffers hold it
+    const std::vector<float> positions = {-0.5f, -0.5f, 0.0f, 1.0f, 0.5f, -0.5f, 0.0f, 1.0f,
+                                          0.5f,  0.5f,  0.0f, 1.0f, -0.5f, 0.5f, 0.0f, 1.0f};
+    const std::vector<uint32_t> indices = {0, 1, 2, 2, 3, 0};
+
+    // Clip space is 2 x 2, so quads of this side sum to about 8x its area
+    const float side = std::sqrt(32.0f / static_cast<float>(count));
+    std::mt19937 random(49);
+    std::uniform_real_distribution<float> center(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.5f * side, 1.5f * side);
+    std::uniform_real_distribution<float> depth(0.05f, 0.95f);
+    std::vector<Quad> scene(count);
+    for (Quad &quad : scene)
+    {
+        quad.depth = depth(random);
+        quad.transform.setIdentity();
+        quad.transform(0, 0) = size(random);
+        quad.transform(1, 1) = size(random);
+        quad.transform.col(3).head<3>() << center(random), center(random), quad.depth;
+    }
+
+    std::vector<Quad> frontToBack = scene;
+    std::sort(frontToBack.begin(), frontToBack.end(), [](const Quad &a, const Quad &b) { return a.depth < b.depth; });
+    std::vector<Quad> backToFront(frontToBack.rbegin(), frontToBack.rend());
+
+    SoftwareRasterizer rasterizer(width, height);
+    std::printf("  %zu quads on %u x %u\n", count, width, height);
+    std::printf("  %-14s %10s %9s %15s %9s\n", "", "shaded", "overdraw", "tiles rejected", "time");
+
+    const struct
+    {
+        const char *name;
+        const std::vector<Quad> *order;
+        bool depthTest;
+    } passes[] = {{"no depth", &scene, false},
+                  {"unsorted", &scene, true},
+                  {"front to back", &frontToBack, true},
+                  {"back to front", &backToFront, true}};
+    for (const auto &pass : passes)
+    {
+        const double seconds = bench::bestOf(3, [&] {
+            rasterizer.clear();
+            for (const Quad &quad : *pass.order)
+                rasterizer.drawTriangles(positions, indices, quad.transform, pass.depthTest);
+        });
+        const RasterStats &stats = rasterizer.getStats();
+        std::printf("  %-14s %9.2fM %9.2f ", pass.name, stats.fragmentsShaded / 1e6, rasterizer.getOverdraw());
+        if (pass.depthTest)
+            std::printf("%14.1f%%", stats.tilesTested ? 100.0 * stats.tilesRejected / stats.tilesTested : 0.0);
+        else
+            std::printf("%15s", "-");
+        std::printf(" %7.1f ms\n", seconds * 1e3);
+    }
+    std::printf("  covered pixels: %llu of %llu\n", static_cast<unsigned long long>(rasterizer.getCoveredPixels()),
+                static_cast<unsigned long long>(width) * height);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "bench.h"
+#include "../src/Particles/particleSystem.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/*
+  ParticleSystem throughput from 100K to `max` live particles (x10 steps), all alive for the
+  whole run so every step integrates the full set:
+    update   one 1/60 s step (integration kernel + kill pass), one thread and every hardware thread
+    write    writeInstances into a preallocated array, what Particles::describeDraw does per frame
+
+  Usage: particleBench [max]
+*/
+int main(int argc, char **argv)
+{
+    const size_t largest = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    bench::header("Particles: update and instance writes per ms");
+    std::printf("  %s kernel\n", ParticleSystem::getKernelName());
+
+    ParticleEmitter emitter;
+    emitter.lifetimeMin = emitter.lifetimeMax = 1e6f;
+    ParticleForces forces;
+    forces.drag = 0.4f;
+    const unsigned hardware = std::thread::hardware_concurrency();
+
+    for (size_t count = 100000; count <= largest; count *= 10)
+    {
+        ParticleSystem system(count);
+        system.emit(emitter, count);
+        std::vector<ProceduralInstance> instances(count);
+
+        const double single = bench::bestOf(5, [&] { bench::keep(system.update(1.0f / 60.0f, forces, 1)); });
+        const double parallel =
+            hardware > 1 ? bench::bestOf(5, [&] { bench::keep(system.update(1.0f / 60.0f, forces, 0)); }) : single;
+        const double write = bench::bestOf(5, [&] { bench::keep(system.writeInstances(instances)); });
+
+        std::printf("  %8zu particles: update %7.0f /ms (%.2f ms)", count, count / (single * 1e3), single * 1e3);
+        if (hardware > 1)
+            std::printf(", %u threads %7.0f /ms", hardware, count / (parallel * 1e3));
+        std::printf(", write %7.0f /ms (%.2f ms)\n", count / (write * 1e3), write * 1e3);
+        bench::keep(instances.data());
+    }
+    return 0;
+}
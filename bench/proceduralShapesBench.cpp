@@ -0,0 +1,131 @@
+#include "bench.h"
+#include "../src/Procedural/proceduralShapes.h"
+#include "../src/Tessellation/curveFlattener.h"
+#include "../src/VertexFormat/vertexFormat.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/*
+  Procedural circles against the buffer-based Circle, for `count` circles of 100 segments:
+    memory   32-byte instance records vs the fan's vertex, color and 16-bit index streams
+             (default Float4 layout and the Half4 / Unorm8x4 one)
+    build    filling the instance array vs flattening and writing every fan's streams
+    expand   vertices per second of the CPU reference, the work vertex_procedural moves to the GPU
+
+  Usage: proceduralShapesBench [count]
+*/
+namespace
+{
+constexpr uint32_t kSegments = 100;
+
+std::vector<ProceduralInstance> buildInstances(const std::vector<float> &centers)
+{
+    std::vector<ProceduralInstance> instances(centers.size() / 2);
+    const uint32_t color = packColor(0.4f, 0.2f, 0.3f, 1.0f);
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        ProceduralInstance &instance = instances[i];
+        instance.center[0] = centers[2 * i];
+        instance.center[1] = centers[2 * i + 1];
+        instance.radius = 0.01f;
+        instance.kind = static_cast<uint32_t>(ShapeKind::Circle);
+        instance.segments = kSegments;
+        instance.color = color;
+    }
+    return instances;
+}
+
+// What Circle::createOutlineBuffers writes per circle, back to back for all of them
+size_t buildFans(const std::vector<float> &centers, std::vector<float> &positions, std::vector<float> &colors,
+                 std::vector<uint16_t> &indices)
+{
+    const size_t count = centers.size() / 2, vertices = kSegments + 1;
+    positions.resize(count * vertices * 4);
+    colors.resize(count * vertices * 4);
+    indices.resize(count * kSegments * 3);
+
+    std::vector<float> outline;
+    EllipticalArc arc;
+    arc.radius[0] = arc.radius[1] = 0.01f;
+    for (size_t c = 0; c < count; ++c)
+    {
+        outline.assign({0.01f, 0.0f});
+        flattenArcSegments(arc, kSegments, outline);
+        float *position = positions.data() + c * vertices * 4;
+        *position++ = centers[2 * c]; *position++ = centers[2 * c + 1]; *position++ = 0.0f; *position++ = 1.0f;
+        for (uint32_t i = 0; i < kSegments; ++i)
+        {
+            *position++ = centers[2 * c] + outline[2 * i];
+            *position++ = centers[2 * c + 1] + outline[2 * i + 1];
+            *position++ = 0.0f;
+            *position++ = 1.0f;
+        }
+        float *color = colors.data() + c * vertices * 4;
+        for (size_t i = 0; i < vertices; ++i, color += 4)
+        {
+            color[0] = 0.4f; color[1] = 0.2f; color[2] = 0.3f; color[3] = 1.0f;
+        }
+        uint16_t *index = indices.data() + c * kSegments * 3;
+        for (uint32_t i = 1; i <= kSegments; ++i)
+        {
+            *index++ = 0;
+            *index++ = static_cast<uint16_t>(i);
+            *index++ = static_cast<uint16_t>(i == kSegments ? 1 : i + 1);
+        }
+    }
+    return positions.size() * sizeof(float) + colors.size() * sizeof(float) + indices.size() * sizeof(uint16_t);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    bench::header("Procedural shapes vs buffer-based circles");
+
+    std::mt19937 random(30);
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+    std::vector<float> centers(count * 2);
+    for (float &value : centers)
+        value = coordinate(random);
+
+    // Memory per circle
+    const size_t vertices = kSegments + 1, indexBytes = 3 * kSegments * sizeof(uint16_t);
+    const size_t floatBytes = vertices * (positionStride(PositionFormat::Float4) + colorStride(ColorFormat::Float4));
+    const size_t packedBytes = vertices * (positionStride(PositionFormat::Half4) + colorStride(ColorFormat::Unorm8x4));
+    std::printf("  memory per circle: procedural %zu B, buffers %zu B (Float4) / %zu B (Half4 + Unorm8x4)\n",
+                sizeof(ProceduralInstance), floatBytes + indexBytes, packedBytes + indexBytes);
+    std::printf("  %zu circles: procedural %.1f MB, buffers %.1f MB / %.1f MB\n", count,
+                count * sizeof(ProceduralInstance) / 1e6, count * (floatBytes + indexBytes) / 1e6,
+                count * (packedBytes + indexBytes) / 1e6);
+
+    // CPU time to produce what the GPU reads
+    std::vector<ProceduralInstance> instances;
+    const double instanceSeconds = bench::bestOf(5, [&] {
+        instances = buildInstances(centers);
+        bench::keep(instances);
+    });
+    std::vector<float> positions, colors;
+    std::vector<uint16_t> indices;
+    size_t fanBytes = 0;
+    const double fanSeconds = bench::bestOf(3, [&] {
+        fanBytes = buildFans(centers, positions, colors, indices);
+        bench::keep(positions);
+    });
+    std::printf("  build: procedural %.2f ms (%.1f M circles/s), buffers %.2f ms (%.1f M circles/s, %.0f MB/s)\n",
+                instanceSeconds * 1e3, count / instanceSeconds / 1e6, fanSeconds * 1e3, count / fanSeconds / 1e6,
+                fanBytes / fanSeconds / 1e6);
+
+    // The per-vertex work moved to the vertex stage, on one CPU core
+    const size_t expanded = std::min<size_t>(count, 10000);
+    std::vector<ProceduralInstance> sample(instances.begin(), instances.begin() + static_cast<ptrdiff_t>(expanded));
+    std::vector<ProceduralVertex> geometry;
+    const double expandSeconds = bench::bestOf(3, [&] {
+        generateProceduralGeometry(geometry, sample, 3 * kSegments);
+        bench::keep(geometry);
+    });
+    std::printf("  expand (CPU reference): %.1f M vertices/s\n", expanded * 3.0 * kSegments / expandSeconds / 1e6);
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "bench.h"
+#include "../src/common/radixSort.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+  Sorting draw indices by depth, as the transparent pass does: `count` uniform float keys with a
+  uint32 index each, through FloatRadixSort (one thread and every hardware thread) against
+  std::sort and std::stable_sort of the indices by key. Then a frame-sized sort of 200 keys.
+  Every run sorts a fresh copy of the same keys.
+
+  Usage: radixSortBench [count]
+*/
+namespace
+{
+void report(const char *name, double seconds, size_t count)
+{
+    std::printf("  %-22s %8.2f ms %7.1f M keys/s\n", name, seconds * 1e3, count / seconds / 1e6);
+}
+
+// Best of 7 of `sort` over a fresh copy of `keys` and their indices; the copies aren't timed
+template <typename Sort>
+double timeSort(const std::vector<float> &keys, Sort &&sort)
+{
+    std::vector<float> work(keys.size());
+    std::vector<uint32_t> values(keys.size());
+    double best = 1e30;
+    for (int i = 0; i < 7; ++i)
+    {
+        work = keys;
+        std::iota(values.begin(), values.end(), 0u);
+        best = std::min(best, bench::bestOf(1, [&] { sort(work, values); }));
+    }
+    bench::keep(values.data());
+    return best;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t{1} << 20;
+    bench::header("Radix sort: float keys with uint32 values");
+
+    std::mt19937 random(50);
+    std::uniform_real_distribution<float> depth(-1.0f, 1.0f);
+    std::vector<float> keys(count);
+    for (float &key : keys)
+        key = depth(random);
+    std::printf("  %zu uniform keys\n", count);
+
+    FloatRadixSort single(1);
+    report("FloatRadixSort 1 thread", timeSort(keys, [&](std::vector<float> &k, std::vector<uint32_t> &v) {
+               single.sort(k, v);
+           }), count);
+    const unsigned hardware = std::thread::hardware_concurrency();
+    if (hardware > 1)
+    {
+        FloatRadixSort parallel;
+        const double seconds = timeSort(keys, [&](std::vector<float> &k, std::vector<uint32_t> &v) { parallel.sort(k, v); });
+        report(("FloatRadixSort " + std::to_string(hardware) + " threads").c_str(), seconds, count);
+    }
+    report("std::sort (indices)", timeSort(keys, [](std::vector<float> &k, std::vector<uint32_t> &v) {
+               std::sort(v.begin(), v.end(), [&k](uint32_t a, uint32_t b) { return k[a] < k[b]; });
+           }), count);
+    report("std::stable_sort", timeSort(keys, [](std::vector<float> &k, std::vector<uint32_t> &v) {
+               std::stable_sort(v.begin(), v.end(), [&k](uint32_t a, uint32_t b) { return k[a] < k[b]; });
+           }), count);
+    std::printf("  %u of 4 passes skipped\n", single.getStats().skippedPasses);
+
+    // A frame's worth of transparent draws, sorted every frame by the same sorter
+    const std::vector<float> frame(keys.begin(), keys.begin() + std::min<size_t>(200, count));
+    std::vector<float> work;
+    std::vector<uint32_t> values(frame.size());
+    const int rounds = 10000;
+    const double seconds = bench::bestOf(5, [&] {
+        for (int i = 0; i < rounds; ++i)
+        {
+            work = frame;
+            std::iota(values.begin(), values.end(), 0u);
+            single.sort(work, values);
+        }
+    });
+    std::printf("  %zu keys per frame: %.2f us per sort (copy included)\n", frame.size(), seconds / rounds * 1e6);
+    bench::keep(values.data());
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "bench.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/*
+  generateSphere into preallocated buffers, UV spheres from 10 x 10 to `maxSegments` x
+  `maxSegments` (4096 by default: 16.8M vertices, about 870 MB of positions, normals and indices),
+  on one thread and on every hardware thread. Reported: time and M vertices/s for each, and the
+  speed-up. Icospheres with about as many vertices follow for comparison.
+
+  Usage: sphereGenerationBench [maxSegments]
+*/
+namespace
+{
+struct Buffers
+{
+    std::vector<float> positions, normals;
+    std::vector<uint32_t> indices;
+};
+
+void run(const char *name, SphereType type, uint32_t segments, Buffers &buffers)
+{
+    const SphereCounts counts = sphereCounts(type, segments);
+    buffers.positions.resize(counts.vertexCount * 4);
+    buffers.normals.resize(counts.vertexCount * 3);
+    buffers.indices.resize(counts.indexCount);
+
+    const int repeats = counts.vertexCount > 1000000 ? 2 : 5;
+    double seconds[2];
+    for (unsigned threads : {1u, 0u})
+        seconds[threads == 0] = bench::bestOf(repeats, [&] {
+            generateSphere(type, segments, 1.0f, buffers.positions.data(), buffers.normals.data(),
+                           buffers.indices.data(), threads);
+        });
+    bench::keep(buffers.indices.data());
+
+    char label[32];
+    std::snprintf(label, sizeof(label), "%s %u", name, segments);
+    const double vertices = static_cast<double>(counts.vertexCount);
+    std::printf("  %-10s %11zu %11.3f ms %9.1f M/s %11.3f ms %9.1f M/s %7.1fx\n", label, counts.vertexCount,
+                seconds[0] * 1e3, vertices / seconds[0] / 1e6, seconds[1] * 1e3, vertices / seconds[1] / 1e6,
+                seconds[0] / seconds[1]);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const uint32_t maxSegments = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 4096;
+    bench::header("Sphere generation: UV spheres 10 x 10 and up, one thread against all");
+    std::printf("  %u hardware threads\n", std::thread::hardware_concurrency());
+    std::printf("  %-10s %11s %27s %27s %8s\n", "", "vertices", "1 thread", "all threads", "speed-up");
+
+    Buffers buffers;
+    for (uint32_t segments : {10u, 32u, 128u, 512u, 1024u, 2048u, 4096u})
+        if (segments <= maxSegments)
+            run("uv", SphereType::UvSphere, segments, buffers);
+
+    // 10 * s^2 + 2 vertices against (s + 1)^2
+    for (uint32_t segments : {3u, 10u, 40u, 162u, 324u, 648u, 1295u})
+        if (segments * 3 <= maxSegments)
+            run("ico", SphereType::Icosphere, segments, buffers);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "bench.h"
+#include "../src/Sprite/skylinePacker.h"
+#include "../src/Sprite/spriteBatch.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+/*
+  The CPU side of drawing sprites, without Metal:
+    packing   `images` random images (8 to 128 texels a side, 1 texel border) into 2048 pages
+              the way TextureAtlas does, first page with room; occupancy per page
+    batching  buildSpriteBatches over `sprites` rotated, tinted sprites of random images on one
+              thread, in submission order (pages interleaved) and then sorted by page;
+              sprites/s and the batches each order breaks into
+
+  Usage: spriteBench [sprites] [images]
+*/
+namespace
+{
+constexpr uint32_t kPageSize = 2048;
+constexpr uint32_t kPadding = 1;
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    const size_t images = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+    bench::header("Sprites: skyline packing and batch building");
+
+    // Packing, as TextureAtlas::add
+    std::mt19937 random(44);
+    std::uniform_int_distribution<uint32_t> side(8, 128);
+    std::vector<std::pair<uint32_t, uint32_t>> sizes(images);
+    for (auto &size : sizes)
+        size = {side(random), side(random)};
+
+    std::vector<SkylinePacker> pages;
+    std::vector<AtlasRegion> regions;
+    const double packSeconds = bench::bestOf(5, [&] {
+        pages.clear();
+        regions.clear();
+        for (const auto &[width, height] : sizes)
+        {
+            PackedRect placed;
+            size_t page = 0;
+            while (page < pages.size() && !pages[page].insert(width + 2 * kPadding, height + 2 * kPadding, placed))
+                ++page;
+            if (page == pages.size())
+            {
+                pages.emplace_back(kPageSize, kPageSize);
+                pages.back().insert(width + 2 * kPadding, height + 2 * kPadding, placed);
+            }
+            const float scale = 1.0f / kPageSize;
+            regions.push_back({static_cast<uint32_t>(page), (placed.x + kPadding) * scale, (placed.y + kPadding) * scale,
+                               (placed.x + kPadding + width) * scale, (placed.y + kPadding + height) * scale, width,
+                               height});
+        }
+    });
+    std::printf("  packing: %zu images in %.2f ms (%.2f us/image), %zu pages, occupancy", images, packSeconds * 1e3,
+                packSeconds / images * 1e6, pages.size());
+    for (const SkylinePacker &page : pages)
+        std::printf(" %.0f%%", page.getOccupancy() * 100.0f);
+    std::printf("\n");
+
+    // Batching
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::uniform_int_distribution<uint32_t> image(0, static_cast<uint32_t>(images - 1));
+    std::vector<Sprite> sprites(count);
+    for (Sprite &sprite : sprites)
+    {
+        sprite.x = position(random);
+        sprite.y = position(random);
+        sprite.width = sprite.height = 0.02f;
+        sprite.rotation = angle(random);
+        sprite.color = static_cast<uint32_t>(random());
+        sprite.region = image(random);
+    }
+    std::vector<Sprite> byPage = sprites;
+    std::stable_sort(byPage.begin(), byPage.end(),
+                     [&regions](const Sprite &a, const Sprite &b) { return regions[a.region].page < regions[b.region].page; });
+
+    std::vector<SpriteVertex> vertices(count * 4);
+    std::vector<SpriteBatch> batches;
+    for (const auto &[name, input] : {std::pair{"submission order", &sprites}, std::pair{"sorted by page", &byPage}})
+    {
+        SpriteBatchStats stats;
+        const double seconds = bench::bestOf(5, [&] {
+            stats = buildSpriteBatches(*input, regions, vertices, batches, 1);
+        });
+        std::printf("  %s: %.1f M sprites/s (%.2f ms for %zu), %zu batches (%zu page breaks)\n", name,
+                    count / seconds / 1e6, seconds * 1e3, count, stats.batches, stats.pageBreaks);
+        bench::keep(vertices.data());
+    }
+    return 0;
+}
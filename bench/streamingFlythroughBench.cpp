@@ -0,0 +1,173 @@
+#include "bench.h"
+#include "../src/Loader/objLoader.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+#include "../src/Streaming/assetStreamer.h"
+#include "../src/Streaming/frameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+  Headless fly-through: `assets` generated icosphere OBJs (8 to 32 segments) line a corridor and
+  the eye flies down it at 60 Hz, doing per frame what Renderer::updateStreaming does: request
+  what is within view distance by projected size, evict over budget, take the staged meshes and
+  upload them (a copy into owned memory, as newCopiedBuffer; cache hits are drawn in place and
+  cost nothing here). Reported per pass, cold (no .meshcache yet) and warm:
+    frame    main-thread streaming time per frame, percentiles and hitches (FrameTimeRecorder)
+    pop-in   frames where a wanted asset was not resident yet
+    memory   peak bytes charged against the budget
+
+  Usage: streamingFlythroughBench [assets] [budget MB] [frames]
+*/
+namespace
+{
+constexpr float kSpacing = 1.0f;
+constexpr float kViewDistance = 4.0f;
+constexpr float kRadius = 0.4f;
+constexpr double kFrameSeconds = 1.0 / 60.0;
+
+void writeSphereObj(const std::string &path, uint32_t segments)
+{
+    const std::shared_ptr<const SphereGeometry> sphere = getSphere(SphereType::Icosphere, segments);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    char line[128];
+    for (size_t i = 0; i < sphere->vertexCount(); ++i)
+    {
+        const float *p = &sphere->positions[i * 4];
+        out.write(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", p[0], p[1], p[2]));
+    }
+    for (size_t i = 0; i < sphere->indices.size(); i += 3)
+    {
+        const uint32_t *f = &sphere->indices[i];
+        out.write(line, std::snprintf(line, sizeof(line), "f %u %u %u\n", f[0] + 1, f[1] + 1, f[2] + 1));
+    }
+}
+
+struct Resident
+{
+    StreamedMesh mesh;
+    std::vector<char> buffer;           // Stands in for the uploaded vertex/index buffers
+};
+
+struct PassResult
+{
+    FrameTimeSummary frame;
+    size_t popInFrames{0};
+    size_t peakCharged{0};
+    StreamingStats stats;
+};
+
+PassResult flyThrough(const std::vector<std::string> &paths, size_t budget, size_t frames)
+{
+    StreamingOptions options;
+    options.memoryBudgetBytes = budget;
+    AssetStreamer streamer(
+        [](const char *data, size_t size) {
+            ObjLoadOptions load;
+            load.threads = 1;
+            return parseObj(data, size, load);
+        },
+        options);
+
+    std::vector<AssetId> ids;
+    for (const std::string &path : paths)
+        ids.push_back(streamer.add(path));
+    std::vector<Resident> resident(paths.size());
+
+    PassResult result;
+    FrameTimeRecorder recorder;
+    const float length = static_cast<float>(paths.size() - 1) * kSpacing;
+    bench::Clock::time_point next = bench::Clock::now();
+    for (size_t frame = 0; frame < frames; ++frame)
+    {
+        const float eye = -kViewDistance + (length + 2.0f * kViewDistance) * static_cast<float>(frame) / static_cast<float>(frames - 1);
+        const bench::Clock::time_point start = bench::Clock::now();
+
+        streamer.beginFrame();
+        bool missing = false;
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            const float dx = static_cast<float>(i) * kSpacing - eye;
+            const float dy = (i % 2 ? 0.5f : -0.5f);
+            const float distance = std::sqrt(dx * dx + dy * dy + 1.0f);
+            if (std::abs(dx) > kViewDistance)
+                continue;
+            streamer.request(ids[i], streamingPriority(distance, kRadius));
+            missing = missing || resident[i].mesh.bytes == 0;
+        }
+        for (AssetId id : streamer.evict())
+            resident[id] = Resident{};
+        for (StreamedMesh &upload : streamer.takeStaged())
+        {
+            Resident &slot = resident[upload.id];
+            const BakedMesh &baked = upload.baked;
+            if (!baked.cache)
+            {
+                const size_t positions = baked.positions().size_bytes(), colors = baked.colors().size_bytes();
+                slot.buffer.resize(positions + colors + baked.lodIndices().size_bytes());
+                std::memcpy(slot.buffer.data(), baked.positions().data(), positions);
+                if (colors)
+                    std::memcpy(slot.buffer.data() + positions, baked.colors().data(), colors);
+                std::memcpy(slot.buffer.data() + positions + colors, baked.lodIndices().data(), baked.lodIndices().size_bytes());
+            }
+            slot.mesh = std::move(upload);
+        }
+
+        recorder.record(std::chrono::duration<double>(bench::Clock::now() - start).count());
+        result.popInFrames += missing;
+        result.peakCharged = std::max(result.peakCharged, streamer.getStats().chargedBytes);
+
+        // The rest of the frame belongs to the loader threads
+        next += std::chrono::duration_cast<bench::Clock::duration>(std::chrono::duration<double>(kFrameSeconds));
+        std::this_thread::sleep_until(next);
+    }
+    result.frame = recorder.summarize();
+    result.stats = streamer.getStats();
+    return result;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 48;
+    const size_t budget = (argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 8) << 20;
+    const size_t frames = std::max<size_t>(2, argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 600);
+    bench::header("Streaming fly-through");
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "streamingFlythroughBench";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::vector<std::string> paths;
+    size_t sourceBytes = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::filesystem::path path = directory / ("asset" + std::to_string(i) + ".obj");
+        writeSphereObj(path.string(), 8 + 8 * static_cast<uint32_t>(i % 4));
+        sourceBytes += std::filesystem::file_size(path);
+        paths.push_back(path.string());
+    }
+    std::printf("  %zu assets, %.1f MB of OBJ, budget %zu MB, %zu frames at 60 Hz\n", count, sourceBytes / 1e6,
+                budget >> 20, frames);
+
+    for (const char *pass : {"cold", "warm"})
+    {
+        const PassResult r = flyThrough(paths, budget, frames);
+        std::printf("  %s: frame ms p50 %.3f, p95 %.3f, p99 %.3f, max %.3f, %zu hitches; pop-in %zu frames\n", pass,
+                    r.frame.p50Ms, r.frame.p95Ms, r.frame.p99Ms, r.frame.maxMs, r.frame.hitches, r.popInFrames);
+        std::printf("        %llu loads (%llu cache hits), %llu evictions, %llu cancelled, %llu failed, peak %.1f / %zu MB\n",
+                    static_cast<unsigned long long>(r.stats.loads), static_cast<unsigned long long>(r.stats.cacheHits),
+                    static_cast<unsigned long long>(r.stats.evictions), static_cast<unsigned long long>(r.stats.cancellations),
+                    static_cast<unsigned long long>(r.stats.failures), r.peakCharged / 1048576.0, budget >> 20);
+    }
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "bench.h"
+#include "../src/Tessellation/stroker.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+  Stroke throughput on a GIS-style random walk of `points` points (steps of varying length,
+  heading drifting with the odd sharp turn), per join: the Stroker's construction (cleaning,
+  directions, counting) plus writing every vertex and uint32 index into preallocated memory,
+  as Stroke does into its buffers. Single-threaded, then on every hardware thread.
+
+  Usage: strokeBench [points]
+*/
+namespace
+{
+std::vector<float> randomWalk(size_t points)
+{
+    std::mt19937 random(43);
+    std::uniform_real_distribution<float> step(0.5f, 2.0f);
+    std::normal_distribution<float> drift(0.0f, 0.3f);
+    std::uniform_real_distribution<float> sharp(0.0f, 1.0f);
+
+    std::vector<float> xy(points * 2);
+    float x = 0.0f, y = 0.0f, heading = 0.0f;
+    for (size_t i = 0; i < points; ++i)
+    {
+        heading += drift(random) + (sharp(random) < 0.05f ? 2.5f : 0.0f);
+        x += step(random) * std::cos(heading);
+        y += step(random) * std::sin(heading);
+        xy[2 * i] = x;
+        xy[2 * i + 1] = y;
+    }
+    return xy;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t points = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    bench::header("Stroke throughput: construct + write vertices and indices");
+
+    const std::vector<float> walk = randomWalk(points);
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<unsigned> threadCounts = {1};
+    if (std::thread::hardware_concurrency() > 1)
+        threadCounts.push_back(std::thread::hardware_concurrency());
+    std::printf("  %zu points, random walk\n", points);
+
+    const struct
+    {
+        const char *name;
+        LineJoin join;
+        LineCap cap;
+    } styles[] = {{"miter", LineJoin::Miter, LineCap::Butt},
+                  {"bevel", LineJoin::Bevel, LineCap::Butt},
+                  {"round", LineJoin::Round, LineCap::Round}};
+
+    for (const auto &s : styles)
+        for (unsigned threads : threadCounts)
+        {
+            StrokeStyle style;
+            style.width = 0.4f;
+            style.join = s.join;
+            style.cap = s.cap;
+            style.tolerance = 0.01f;
+            style.threads = threads;
+
+            StrokeStats stats;
+            const double seconds = bench::bestOf(3, [&] {
+                const Stroker stroker(walk, style);
+                vertices.resize(stroker.getVertexCount() * 4);
+                indices.resize(stroker.getIndexCount());
+                stroker.writeVertices(vertices);
+                stroker.writeIndices(indices);
+                stats = stroker.getStats();
+            });
+            std::printf("  %-5s %2u thread%s: %6.2f M points/s (%.1f ms), %zu vertices, %zu triangles, %zu miters, "
+                        "%zu bevels, %zu round joins\n",
+                        s.name, threads, threads == 1 ? " " : "s", points / seconds / 1e6, seconds * 1e3, stats.vertices,
+                        stats.indices / 3, stats.miters, stats.bevels, stats.roundJoins);
+            bench::keep(vertices.data());
+            bench::keep(indices.data());
+        }
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "bench.h"
+#include "../src/Streaming/frameStats.h"
+#include "../src/Terrain/terrain.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+  Per-frame terrain cost on the render thread, headless: the eye flies diagonally across a
+  `samples`^2 noise map just above its highest point, at 60 Hz, doing what Renderer::updateTerrain
+  does minus the uploads: update(eye), evict(), takeBuilt(), getDraws(). The build threads work in
+  the rest of each frame. Reported:
+    update   Terrain::update alone (selection, balance, queueing), percentiles of wall time and of
+             the render thread's own CPU time (wall time includes waiting for a core the build
+             threads hold, which dominates the tail when they outnumber the cores)
+    frame    all four calls
+    drawn    chunks and triangles per frame against the full-resolution triangle count
+    built    chunks the build threads finished, and how many per second of flight
+
+  Usage: terrainBench [samples] [frames] [build threads]
+*/
+namespace
+{
+double threadSeconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const uint32_t samples = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 16385;
+    const size_t frames = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 600;
+    const unsigned buildThreads = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 2;
+    bench::header("Terrain: per-frame update cost while flying");
+
+    auto heights = std::make_shared<HeightmapTiles>(samples, samples,
+                                                    noiseHeightmapSampler(samples, samples, 7, samples / 8.0f));
+    TerrainOptions options;
+    options.heightScale = samples / 16.0f;
+    options.buildThreads = buildThreads;
+    Terrain terrain(heights, options);
+    std::printf("  %u^2 samples, %u-cell chunks, %u levels, %u build threads, %zu frames at 60 Hz\n", samples,
+                options.chunkCells, terrain.getLevelCount(), buildThreads, frames);
+
+    FrameTimeRecorder updateTimes;
+    FrameTimeRecorder updateCpuTimes;
+    FrameTimeRecorder frameTimes;
+    size_t drawnMin = SIZE_MAX, drawnMax = 0, trianglesMin = SIZE_MAX, trianglesMax = 0;
+    size_t taken = 0;
+
+    const bench::Clock::time_point begin = bench::Clock::now();
+    bench::Clock::time_point next = begin;
+    for (size_t frame = 0; frame < frames; ++frame)
+    {
+        const float t = static_cast<float>(frame) / static_cast<float>(std::max<size_t>(frames - 1, 1));
+        const float along = (0.1f + 0.8f * t) * static_cast<float>(samples - 1);
+        const float eye[3] = {along, along, options.heightScale * 1.1f};
+
+        const bench::Clock::time_point start = bench::Clock::now();
+        const double cpuStart = threadSeconds();
+        terrain.update(eye);
+        updateCpuTimes.record(threadSeconds() - cpuStart);
+        const bench::Clock::time_point updated = bench::Clock::now();
+        bench::keep(terrain.evict());
+        taken += terrain.takeBuilt().size();
+        bench::keep(terrain.getDraws().data());
+        const bench::Clock::time_point end = bench::Clock::now();
+
+        updateTimes.record(std::chrono::duration<double>(updated - start).count());
+        frameTimes.record(std::chrono::duration<double>(end - start).count());
+
+        // Chunks still building draw their ancestors; count once the first ones are in
+        const TerrainStats stats = terrain.getStats();
+        if (stats.drawn > 0)
+        {
+            drawnMin = std::min(drawnMin, stats.drawn);
+            drawnMax = std::max(drawnMax, stats.drawn);
+            trianglesMin = std::min(trianglesMin, stats.triangles);
+            trianglesMax = std::max(trianglesMax, stats.triangles);
+        }
+
+        next += std::chrono::duration_cast<bench::Clock::duration>(std::chrono::duration<double>(1.0 / 60.0));
+        std::this_thread::sleep_until(next);
+    }
+    const double elapsed = std::chrono::duration<double>(bench::Clock::now() - begin).count();
+
+    const FrameTimeSummary update = updateTimes.summarize();
+    const FrameTimeSummary updateCpu = updateCpuTimes.summarize();
+    const FrameTimeSummary frame = frameTimes.summarize();
+    const TerrainStats stats = terrain.getStats();
+    const double fullTriangles = 2.0 * (samples - 1.0) * (samples - 1.0);
+    std::printf("  update ms: p50 %.3f, p95 %.3f, p99 %.3f, max %.3f\n", update.p50Ms, update.p95Ms, update.p99Ms,
+                update.maxMs);
+    std::printf("  update CPU ms: p50 %.3f, p95 %.3f, p99 %.3f, max %.3f\n", updateCpu.p50Ms, updateCpu.p95Ms,
+                updateCpu.p99Ms, updateCpu.maxMs);
+    std::printf("  frame ms:  p50 %.3f, p95 %.3f, p99 %.3f, max %.3f, %zu hitches\n", frame.p50Ms, frame.p95Ms,
+                frame.p99Ms, frame.maxMs, frame.hitches);
+    std::printf("  drawn: %zu-%zu chunks, %.2f-%.2fM triangles (full resolution %.0fM)\n", drawnMin, drawnMax,
+                trianglesMin / 1e6, trianglesMax / 1e6, fullTriangles / 1e6);
+    std::printf("  built %llu chunks (%.0f/s; %zu taken, %llu evicted, %llu cancelled), tiles %.1f MB\n",
+                static_cast<unsigned long long>(stats.built), stats.built / elapsed, taken,
+                static_cast<unsigned long long>(stats.evicted), static_cast<unsigned long long>(stats.cancelled),
+                stats.tiles.bytes / 1048576.0);
+    return 0;
+}
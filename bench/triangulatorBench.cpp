@@ -0,0 +1,117 @@
+#include "bench.h"
+#include "../src/Tessellation/triangulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+  triangulatePolygon on outlines of 10K, 100K and 1M vertices (up to `maxVertices`):
+    circle      convex, the best case
+    wavy        a circle with a few hundred sine waves along it: long runs of reflex vertices
+    noisy star  jittered radius, every other vertex pulled in: dense reflex vertices
+    holes       a circle around a grid of 256-vertex circular holes, half the vertices in holes
+                (bridging is O(holes * n), so many small holes would measure that instead)
+  Reported: time, ns per vertex, the triangle count and the area error (triangulationAreaError,
+  0 when the triangles cover the polygon exactly).
+
+  Usage: triangulatorBench [maxVertices]
+*/
+namespace
+{
+struct Polygon
+{
+    std::vector<float> xy;
+    std::vector<uint32_t> holeStarts;
+};
+
+Polygon circle(size_t vertices, float waves, float amplitude)
+{
+    Polygon polygon;
+    for (size_t i = 0; i < vertices; ++i)
+    {
+        const double angle = 2.0 * M_PI * double(i) / double(vertices);
+        const double radius = 1.0 + amplitude * std::sin(waves * angle);
+        polygon.xy.push_back(static_cast<float>(radius * std::cos(angle)));
+        polygon.xy.push_back(static_cast<float>(radius * std::sin(angle)));
+    }
+    return polygon;
+}
+
+Polygon noisyStar(size_t vertices)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> jitter(0.9, 1.0);
+    Polygon polygon;
+    for (size_t i = 0; i < vertices; ++i)
+    {
+        const double angle = 2.0 * M_PI * double(i) / double(vertices);
+        const double radius = (i % 2 ? 0.6 : 1.0) * jitter(random);
+        polygon.xy.push_back(static_cast<float>(radius * std::cos(angle)));
+        polygon.xy.push_back(static_cast<float>(radius * std::sin(angle)));
+    }
+    return polygon;
+}
+
+// A circle of vertices / 2 points around a grid of 256-vertex circular holes holding the rest
+Polygon circleWithHoles(size_t vertices)
+{
+    constexpr size_t kHoleVertices = 256;
+    Polygon polygon = circle(vertices / 2, 0.0f, 0.0f);
+    const size_t holes = std::max<size_t>(vertices / 2 / kHoleVertices, 1);
+    const size_t grid = static_cast<size_t>(std::ceil(std::sqrt(double(holes))));
+    const double cell = 1.4 / grid, radius = cell * 0.35;
+    for (size_t h = 0; h < holes; ++h)
+    {
+        polygon.holeStarts.push_back(static_cast<uint32_t>(polygon.xy.size() / 2));
+        const double cx = -0.7 + (h % grid + 0.5) * cell, cy = -0.7 + (h / grid + 0.5) * cell;
+        for (size_t i = 0; i < kHoleVertices; ++i)
+        {
+            const double angle = 2.0 * M_PI * double(i) / double(kHoleVertices);
+            polygon.xy.push_back(static_cast<float>(cx + radius * std::cos(angle)));
+            polygon.xy.push_back(static_cast<float>(cy + radius * std::sin(angle)));
+        }
+    }
+    return polygon;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t maxVertices = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    bench::header("Triangulator: time per vertex on 10K to 1M-vertex outlines");
+    std::printf("  %-12s %9s %7s %12s %10s %10s %11s\n", "", "vertices", "holes", "time", "ns/vertex", "triangles",
+                "area error");
+
+    std::vector<uint32_t> indices;
+    for (size_t vertices : {size_t{10000}, size_t{100000}, size_t{1000000}})
+    {
+        if (vertices > maxVertices)
+            break;
+        const struct
+        {
+            const char *name;
+            Polygon polygon;
+        } shapes[] = {{"circle", circle(vertices, 0.0f, 0.0f)},
+                      {"wavy", circle(vertices, 300.0f, 0.1f)},
+                      {"noisy star", noisyStar(vertices)},
+                      {"holes", circleWithHoles(vertices)}};
+        for (const auto &shape : shapes)
+        {
+            const Polygon &polygon = shape.polygon;
+            const size_t count = polygon.xy.size() / 2;
+            TriangulationStats stats;
+            const double seconds = bench::bestOf(vertices >= 1000000 ? 1 : 3, [&] {
+                triangulatePolygon(polygon.xy, polygon.holeStarts, indices, &stats);
+            });
+            bench::keep(indices.data());
+            std::printf("  %-12s %9zu %7zu %9.2f ms %10.1f %10zu %11.1e\n", shape.name, count, stats.holes,
+                        seconds * 1e3, seconds * 1e9 / count, stats.triangles,
+                        triangulationAreaError(polygon.xy, polygon.holeStarts, indices));
+        }
+    }
+    return 0;
+}
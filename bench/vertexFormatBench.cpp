@@ -0,0 +1,104 @@
+#include "bench.h"
+#include "../src/VertexFormat/vertexFormat.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+  Vertex format conversion over `count` vertices (1M by default): bytes per vertex of each
+  position and color format, and encode / decode speed in GB/s of float xyzw / rgba data
+  (16 bytes per vertex) going in or coming out.
+
+  The kernels are picked at compile time, so this is built once per kernel set (see
+  CMakeLists.txt): vertexFormatBench with whatever the core was built with (SSE2 on x86-64,
+  NEON on arm64), vertexFormatScalarBench with the scalar fallback, and vertexFormatF16CBench
+  with F16C half conversion where the compiler has it. Run them side by side to compare.
+
+  Usage: vertexFormat[Scalar|F16C]Bench [count]
+*/
+namespace
+{
+#if defined(VERTEX_FORMAT_SCALAR)
+constexpr const char *kKernels = "scalar";
+#elif defined(__F16C__)
+constexpr const char *kKernels = "SSE2 + F16C";
+#elif defined(__SSE2__)
+constexpr const char *kKernels = "SSE2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+constexpr const char *kKernels = "NEON";
+#else
+constexpr const char *kKernels = "scalar (no SIMD on this target)";
+#endif
+
+const char *name(PositionFormat format)
+{
+    switch (format)
+    {
+    case PositionFormat::Float4: return "Float4";
+    case PositionFormat::PackedFloat3: return "PackedFloat3";
+    case PositionFormat::Half4: return "Half4";
+    case PositionFormat::Snorm16x4: return "Snorm16x4";
+    }
+    return "?";
+}
+
+void report(const char *stream, const char *format, size_t stride, size_t count, double encode, double decode)
+{
+    const double bytes = 16.0 * count;
+    std::printf("  %-9s %-13s %6zu %12.2f %12.2f\n", stream, format, stride, bytes / encode / 1e9, bytes / decode / 1e9);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+#if defined(__F16C__) && !defined(VERTEX_FORMAT_SCALAR)
+    if (!__builtin_cpu_supports("f16c"))
+    {
+        std::printf("F16C unsupported on this CPU, skipped\n");
+        return 0;
+    }
+#endif
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    bench::header("Vertex formats: bytes per vertex and conversion speed");
+    std::printf("  kernels: %s, %zu vertices\n", kKernels, count);
+    std::printf("  %-9s %-13s %6s %12s %12s\n", "stream", "format", "bytes", "encode GB/s", "decode GB/s");
+
+    std::mt19937 random(26);
+    std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f), unit(0.0f, 1.0f);
+    std::vector<float> source(count * 4), decoded(count * 4);
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+            source[i * 4 + c] = coordinate(random);
+        source[i * 4 + 3] = 1.0f;
+    }
+    const VertexDequant dequant = computeDequant(source.data(), count);
+    std::vector<unsigned char> encoded(count * 16);
+
+    for (PositionFormat format : {PositionFormat::Float4, PositionFormat::PackedFloat3, PositionFormat::Half4,
+                                  PositionFormat::Snorm16x4})
+    {
+        const double encode =
+            bench::bestOf(5, [&] { encodePositions(format, source.data(), count, dequant, encoded.data()); });
+        bench::keep(encoded.data());
+        const double decode =
+            bench::bestOf(5, [&] { decodePositions(format, encoded.data(), count, dequant, decoded.data()); });
+        bench::keep(decoded.data());
+        report("position", name(format), positionStride(format), count, encode, decode);
+    }
+
+    for (float &value : source)
+        value = unit(random);
+    for (ColorFormat format : {ColorFormat::Float4, ColorFormat::Unorm8x4})
+    {
+        const double encode = bench::bestOf(5, [&] { encodeColors(format, source.data(), count, encoded.data()); });
+        bench::keep(encoded.data());
+        const double decode = bench::bestOf(5, [&] { decodeColors(format, encoded.data(), count, decoded.data()); });
+        bench::keep(decoded.data());
+        report("color", format == ColorFormat::Float4 ? "Float4" : "Unorm8x4", colorStride(format), count, encode,
+               decode);
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "bounds.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+Bounds computeBounds(const float *positions, size_t count)
+{
+    Bounds bounds;
+    if (count == 0)
+        return bounds;
+
+    // xyzw positions map one vertex onto one 4-wide register; w is ignored afterwards
+    float lo[4];
+    float hi[4];
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128 vmin = _mm_set1_ps(FLT_MAX);
+    __m128 vmax = _mm_set1_ps(-FLT_MAX);
+    for (; i < count; ++i)
+    {
+        const __m128 p = _mm_loadu_ps(positions + i * 4);
+        vmin = _mm_min_ps(vmin, p);
+        vmax = _mm_max_ps(vmax, p);
+    }
+    _mm_storeu_ps(lo, vmin);
+    _mm_storeu_ps(hi, vmax);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t vmin = vdupq_n_f32(FLT_MAX);
+    float32x4_t vmax = vdupq_n_f32(-FLT_MAX);
+    for (; i < count; ++i)
+    {
+        const float32x4_t p = vld1q_f32(positions + i * 4);
+        vmin = vminq_f32(vmin, p);
+        vmax = vmaxq_f32(vmax, p);
+    }
+    vst1q_f32(lo, vmin);
+    vst1q_f32(hi, vmax);
+#else
+    std::fill(lo, lo + 4, FLT_MAX);
+    std::fill(hi, hi + 4, -FLT_MAX);
+    for (; i < count; ++i)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            lo[c] = std::min(lo[c], positions[i * 4 + c]);
+            hi[c] = std::max(hi[c], positions[i * 4 + c]);
+        }
+    }
+#endif
+
+    float radiusSq = 0.0f;
+    for (int c = 0; c < 3; ++c)
+    {
+        bounds.box.min[c] = lo[c];
+        bounds.box.max[c] = hi[c];
+        bounds.sphere.center[c] = 0.5f * (lo[c] + hi[c]);
+    }
+    for (size_t v = 0; v < count; ++v)
+    {
+        const float dx = positions[v * 4 + 0] - bounds.sphere.center[0];
+        const float dy = positions[v * 4 + 1] - bounds.sphere.center[1];
+        const float dz = positions[v * 4 + 2] - bounds.sphere.center[2];
+        radiusSq = std::max(radiusSq, dx * dx + dy * dy + dz * dz);
+    }
+    bounds.sphere.radius = std::sqrt(radiusSq);
+    return bounds;
+}
+
+Bounds transformBounds(const Bounds &local, const Eigen::Matrix4f &matrix)
+{
+    Bounds world;
+
+    // Arvo: each output axis accumulates min/max of every input axis' contribution
+    for (int row = 0; row < 3; ++row)
+    {
+        world.box.min[row] = world.box.max[row] = matrix(row, 3);
+        for (int column = 0; column < 3; ++column)
+        {
+            const float a = matrix(row, column) * local.box.min[column];
+            const float b = matrix(row, column) * local.box.max[column];
+            world.box.min[row] += std::min(a, b);
+            world.box.max[row] += std::max(a, b);
+        }
+    }
+
+    const Eigen::Vector4f center = matrix * Eigen::Vector4f(local.sphere.center[0], local.sphere.center[1],
+                                                            local.sphere.center[2], 1.0f);
+    const float maxScale = matrix.block<3, 3>(0, 0).colwise().norm().maxCoeff();
+    for (int c = 0; c < 3; ++c)
+        world.sphere.center[c] = center[c];
+    world.sphere.radius = local.sphere.radius * maxScale;
+    return world;
+}
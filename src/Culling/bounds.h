@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+#include <eigen/Eigen/Dense>
+
+/*
+-------------------------------------------------------------------
+  BOUNDS  ----------------------------------------------------------
+
+  Axis-aligned box and bounding sphere of a vertex stream, computed
+  once when a Primitive creates its vertex buffer and re-derived in
+  world space whenever its Transform changes.
+-------------------------------------------------------------------
+*/
+struct Aabb {
+    float min[3]{0.0f, 0.0f, 0.0f};
+    float max[3]{0.0f, 0.0f, 0.0f};
+};
+
+struct BoundingSphere {
+    float center[3]{0.0f, 0.0f, 0.0f};
+    float radius{0.0f};
+};
+
+struct Bounds {
+    Aabb box;
+    BoundingSphere sphere;
+};
+
+/**
+ * @brief Box (SIMD min/max) and sphere around the box center for tightly packed xyzw positions.
+ */
+Bounds computeBounds(const float *positions, size_t count);
+
+/**
+ * @brief Bounds of `local` after an affine transform.
+ *
+ * The box is re-fit from the transformed corners' extents (Arvo) and the sphere
+ * radius is scaled by the largest axis scale, so both stay conservative.
+ */
+Bounds transformBounds(const Bounds &local, const Eigen::Matrix4f &matrix);
@@ -0,0 +1,449 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace
+{
+constexpr uint32_t kNoParent = UINT32_MAX;
+
+float surfaceArea(const float min[3], const float max[3])
+{
+    const float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+struct Bin {
+    float min[3]{FLT_MAX, FLT_MAX, FLT_MAX};
+    float max[3]{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    uint32_t count{0};
+
+    void grow(const float otherMin[3], const float otherMax[3])
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            min[c] = std::min(min[c], otherMin[c]);
+            max[c] = std::max(max[c], otherMax[c]);
+        }
+    }
+};
+
+// Slab test, returns the entry distance or INFINITY on a miss
+float intersectBox(const Ray &ray, const float inverse[3], const float min[3], const float max[3])
+{
+    float tNear = 0.0f;
+    float tFar = ray.tMax;
+    for (int c = 0; c < 3; ++c)
+    {
+        float t0 = (min[c] - ray.origin[c]) * inverse[c];
+        float t1 = (max[c] - ray.origin[c]) * inverse[c];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tNear = std::max(tNear, t0);
+        tFar = std::min(tFar, t1);
+        if (tNear > tFar)
+            return INFINITY;
+    }
+    return tNear;
+}
+} // namespace
+
+/*
+-------------------------------------------------------------------
+  BUILD  -----------------------------------------------------------
+-------------------------------------------------------------------
+*/
+void Bvh::build(const std::vector<Aabb> &bounds)
+{
+    primitiveBounds = bounds;
+    nodes.clear();
+    parents.clear();
+    const uint32_t count = static_cast<uint32_t>(bounds.size());
+    order.resize(count);
+    leafOf.assign(count, 0);
+    if (count == 0)
+        return;
+
+    std::vector<float> centroids(count * 3);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        order[i] = i;
+        for (int c = 0; c < 3; ++c)
+            centroids[i * 3 + c] = 0.5f * (bounds[i].min[c] + bounds[i].max[c]);
+    }
+
+    nodes.reserve(2 * count);
+    parents.reserve(2 * count);
+    buildNode(0, count, centroids);
+}
+
+uint32_t Bvh::buildNode(uint32_t first, uint32_t count, std::vector<float> &centroids)
+{
+    const uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({});
+    parents.push_back(kNoParent);
+
+    Node node{};
+    node.rightOrFirst = first;
+    node.count = count;
+    fitNode(node);
+    nodes[index] = node;
+
+    const auto makeLeaf = [&]() {
+        for (uint32_t i = first; i < first + count; ++i)
+            leafOf[order[i]] = index;
+        return index;
+    };
+
+    if (count <= kMaxLeafSize)
+        return makeLeaf();
+
+    // Centroid bounds decide the bin ranges
+    float cmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float cmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            cmin[c] = std::min(cmin[c], centroids[order[i] * 3 + c]);
+            cmax[c] = std::max(cmax[c], centroids[order[i] * 3 + c]);
+        }
+    }
+
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = FLT_MAX;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float extent = cmax[axis] - cmin[axis];
+        if (extent <= 0.0f)
+            continue;
+
+        Bin bins[kBins];
+        const float scale = kBins / extent;
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            const uint32_t p = order[i];
+            const int b = std::min(kBins - 1, static_cast<int>((centroids[p * 3 + axis] - cmin[axis]) * scale));
+            bins[b].grow(primitiveBounds[p].min, primitiveBounds[p].max);
+            ++bins[b].count;
+        }
+
+        // Sweep: right-to-left areas first, then evaluate each split left-to-right
+        float rightArea[kBins - 1];
+        uint32_t rightCount[kBins - 1];
+        Bin right;
+        for (int b = kBins - 1; b > 0; --b)
+        {
+            right.grow(bins[b].min, bins[b].max);
+            right.count += bins[b].count;
+            rightArea[b - 1] = right.count ? surfaceArea(right.min, right.max) : 0.0f;
+            rightCount[b - 1] = right.count;
+        }
+
+        Bin left;
+        for (int b = 0; b < kBins - 1; ++b)
+        {
+            left.grow(bins[b].min, bins[b].max);
+            left.count += bins[b].count;
+            if (left.count == 0 || rightCount[b] == 0)
+                continue;
+            const float cost = left.count * surfaceArea(left.min, left.max) + rightCount[b] * rightArea[b];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    const float leafCost = count * surfaceArea(node.min, node.max);
+    if (bestAxis >= 0 && bestCost >= leafCost && count <= 2 * kMaxLeafSize)
+        return makeLeaf();
+
+    uint32_t leftCount;
+    if (bestAxis >= 0)
+    {
+        const float scale = kBins / (cmax[bestAxis] - cmin[bestAxis]);
+        uint32_t *middle = std::partition(&order[first], &order[first] + count, [&](uint32_t p) {
+            const int b = std::min(kBins - 1, static_cast<int>((centroids[p * 3 + bestAxis] - cmin[bestAxis]) * scale));
+            return b <= bestSplit;
+        });
+        leftCount = static_cast<uint32_t>(middle - &order[first]);
+    }
+    else
+    {
+        leftCount = 0;      // every centroid coincides: split by count
+    }
+    if (leftCount == 0 || leftCount == count)
+        leftCount = count / 2;
+
+    const uint32_t left = buildNode(first, leftCount, centroids);
+    const uint32_t right = buildNode(first + leftCount, count - leftCount, centroids);
+    parents[left] = index;
+    parents[right] = index;
+
+    nodes[index].rightOrFirst = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+/*
+-------------------------------------------------------------------
+  REFIT  -----------------------------------------------------------
+-------------------------------------------------------------------
+*/
+void Bvh::fitNode(Node &node) const
+{
+    Bin box;
+    if (node.count > 0)
+    {
+        for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; ++i)
+            box.grow(primitiveBounds[order[i]].min, primitiveBounds[order[i]].max);
+    }
+    else
+    {
+        const Node &left = nodes[&node - nodes.data() + 1];
+        const Node &right = nodes[node.rightOrFirst];
+        box.grow(left.min, left.max);
+        box.grow(right.min, right.max);
+    }
+    std::copy(box.min, box.min + 3, node.min);
+    std::copy(box.max, box.max + 3, node.max);
+}
+
+void Bvh::refit(const std::vector<Aabb> &bounds)
+{
+    primitiveBounds = bounds;
+    // Children always follow their parent, so a reverse sweep is bottom-up
+    for (size_t i = nodes.size(); i-- > 0;)
+        fitNode(nodes[i]);
+}
+
+void Bvh::refitPrimitive(uint32_t primitive, const Aabb &bounds)
+{
+    primitiveBounds[primitive] = bounds;
+    for (uint32_t index = leafOf[primitive]; index != kNoParent; index = parents[index])
+    {
+        Node &node = nodes[index];
+        const Node previous = node;
+        fitNode(node);
+        if (std::equal(node.min, node.min + 3, previous.min) && std::equal(node.max, node.max + 3, previous.max))
+            break;
+    }
+}
+
+/*
+-------------------------------------------------------------------
+  QUERIES  ---------------------------------------------------------
+-------------------------------------------------------------------
+*/
+void Bvh::collectLeaves(uint32_t nodeIndex, std::vector<uint32_t> &visible) const
+{
+    // Leaves of a subtree are contiguous in `order`, find the first and last
+    uint32_t lo = nodeIndex;
+    while (nodes[lo].count == 0)
+        lo = lo + 1;
+    uint32_t hi = nodeIndex;
+    while (nodes[hi].count == 0)
+        hi = nodes[hi].rightOrFirst;
+    visible.insert(visible.end(), order.begin() + nodes[lo].rightOrFirst,
+                   order.begin() + nodes[hi].rightOrFirst + nodes[hi].count);
+}
+
+size_t Bvh::queryFrustum(const Frustum &frustum, std::vector<uint32_t> &visible) const
+{
+    const size_t before = visible.size();
+    if (nodes.empty())
+        return 0;
+
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const uint32_t index = stack.back();
+        stack.pop_back();
+        const Node &node = nodes[index];
+
+        bool inside = true;
+        bool outside = false;
+        for (const float *plane : frustum.planes)
+        {
+            // Farthest corner along the plane normal decides "outside", nearest decides "fully inside"
+            float far = plane[3];
+            float near = plane[3];
+            for (int c = 0; c < 3; ++c)
+            {
+                far += plane[c] * (plane[c] >= 0.0f ? node.max[c] : node.min[c]);
+                near += plane[c] * (plane[c] >= 0.0f ? node.min[c] : node.max[c]);
+            }
+            if (far < 0.0f)
+            {
+                outside = true;
+                break;
+            }
+            inside &= near >= 0.0f;
+        }
+        if (outside)
+            continue;
+
+        if (inside || node.count > 0)
+        {
+            if (node.count > 0 && !inside)
+            {
+                // Partially visible leaf: test its primitives individually
+                for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; ++i)
+                {
+                    const Aabb &box = primitiveBounds[order[i]];
+                    bool primitiveOutside = false;
+                    for (const float *plane : frustum.planes)
+                    {
+                        float far = plane[3];
+                        for (int c = 0; c < 3; ++c)
+                            far += plane[c] * (plane[c] >= 0.0f ? box.max[c] : box.min[c]);
+                        if (far < 0.0f)
+                        {
+                            primitiveOutside = true;
+                            break;
+                        }
+                    }
+                    if (!primitiveOutside)
+                        visible.push_back(order[i]);
+                }
+            }
+            else
+            {
+                collectLeaves(index, visible);
+            }
+            continue;
+        }
+
+        stack.push_back(node.rightOrFirst);
+        stack.push_back(index + 1);
+    }
+    return visible.size() - before;
+}
+
+RayHit Bvh::raycast(const Ray &ray, const RayPrimitiveTest &test) const
+{
+    RayHit hit;
+    if (nodes.empty())
+        return hit;
+
+    Ray current = ray;
+    float inverse[3];
+    for (int c = 0; c < 3; ++c)
+        inverse[c] = 1.0f / ray.direction[c];       // +-inf for axis-parallel rays is handled by the slab test
+
+    struct Entry {
+        uint32_t node;
+        float t;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    const float rootT = intersectBox(current, inverse, nodes[0].min, nodes[0].max);
+    if (rootT == INFINITY)
+        return hit;
+    stack.push_back({0, rootT});
+
+    while (!stack.empty())
+    {
+        const Entry entry = stack.back();
+        stack.pop_back();
+        if (entry.t >= current.tMax)
+            continue;
+        const Node &node = nodes[entry.node];
+
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; ++i)
+            {
+                const float t = test(order[i], current);
+                if (t < current.tMax)
+                {
+                    current.tMax = t;
+                    hit.t = t;
+                    hit.primitive = order[i];
+                }
+            }
+            continue;
+        }
+
+        const uint32_t left = entry.node + 1;
+        const uint32_t right = node.rightOrFirst;
+        const float tLeft = intersectBox(current, inverse, nodes[left].min, nodes[left].max);
+        const float tRight = intersectBox(current, inverse, nodes[right].min, nodes[right].max);
+
+        // Push the farther child first so the nearer one is visited next
+        Entry near{left, tLeft};
+        Entry far{right, tRight};
+        if (tRight < tLeft)
+            std::swap(near, far);
+        if (far.t != INFINITY)
+            stack.push_back(far);
+        if (near.t != INFINITY)
+            stack.push_back(near);
+    }
+    return hit;
+}
+
+RayHit Bvh::raycastBounds(const Ray &ray) const
+{
+    float inverse[3];
+    for (int c = 0; c < 3; ++c)
+        inverse[c] = 1.0f / ray.direction[c];
+
+    return raycast(ray, [&](uint32_t index, const Ray &current) {
+        const Aabb &box = primitiveBounds[index];
+        const float t = intersectBox(current, inverse, box.min, box.max);
+        return t == INFINITY ? current.tMax : t;
+    });
+}
+
+float intersectAabb(const Ray &ray, const Aabb &box)
+{
+    float inverse[3];
+    for (int c = 0; c < 3; ++c)
+        inverse[c] = 1.0f / ray.direction[c];
+    const float t = intersectBox(ray, inverse, box.min, box.max);
+    return t == INFINITY ? ray.tMax : t;
+}
+
+float intersectTriangles(const Ray &ray, const float *positions, const uint32_t *indices, size_t indexCount)
+{
+    float closest = ray.tMax;
+    const float *o = ray.origin;
+    const float *d = ray.direction;
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        const float *a = positions + indices[i] * 4;
+        const float *b = positions + indices[i + 1] * 4;
+        const float *c = positions + indices[i + 2] * 4;
+
+        const float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        const float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        const float p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+        const float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        if (std::fabs(det) < 1e-12f)
+            continue;       // parallel or degenerate (double sided, no culling)
+
+        const float invDet = 1.0f / det;
+        const float s[3] = {o[0] - a[0], o[1] - a[1], o[2] - a[2]};
+        const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+        if (u < 0.0f || u > 1.0f)
+            continue;
+
+        const float q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+        const float v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * invDet;
+        if (v < 0.0f || u + v > 1.0f)
+            continue;
+
+        const float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+        if (t >= 0.0f && t < closest)
+            closest = t;
+    }
+    return closest;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "bounds.h"
+#include "frustum.h"
+
+/*
+-------------------------------------------------------------------
+  BVH  -------------------------------------------------------------
+
+  Bounding volume hierarchy over world-space primitive boxes.
+    - built top-down with binned SAH (kBins centroid bins per axis)
+    - refit bottom-up when boxes move, either fully or per primitive
+      (walks parents until a box stops growing or shrinking)
+    - frustum queries skip plane tests below fully-inside nodes
+    - closest-hit ray queries against the boxes, or against the real
+      geometry through a per-primitive intersection callback
+
+  Refits keep the topology, so quality degrades after large motions;
+  call build() again when that matters.
+-------------------------------------------------------------------
+*/
+struct Ray {
+    float origin[3];
+    float direction[3];
+    float tMax{INFINITY};
+};
+
+struct RayHit {
+    uint32_t primitive{UINT32_MAX};
+    float t{INFINITY};
+
+    bool valid() const { return primitive != UINT32_MAX; }
+};
+
+/*
+    Returns the hit distance along `ray` for primitive `index`, or a value >= ray.tMax
+    when it is missed. Called only for primitives whose box the ray enters.
+*/
+using RayPrimitiveTest = std::function<float(uint32_t index, const Ray &ray)>;
+
+class Bvh final {
+public:
+    static constexpr int kBins = 16;
+    static constexpr uint32_t kMaxLeafSize = 4;
+
+    void build(const std::vector<Aabb> &primitiveBounds);
+
+    // Recomputes every node from new primitive boxes (same count as build)
+    void refit(const std::vector<Aabb> &primitiveBounds);
+
+    // Updates one primitive's box and the boxes of its ancestors
+    void refitPrimitive(uint32_t primitive, const Aabb &bounds);
+
+    size_t queryFrustum(const Frustum &frustum, std::vector<uint32_t> &visible) const;
+
+    RayHit raycastBounds(const Ray &ray) const;
+    RayHit raycast(const Ray &ray, const RayPrimitiveTest &test) const;
+
+    size_t getNodeCount() const { return nodes.size(); }
+    size_t getPrimitiveCount() const { return primitiveBounds.size(); }
+
+private:
+    struct Node {
+        float min[3];
+        uint32_t rightOrFirst;      // Right child (left is always index + 1), or first entry in `order`
+        float max[3];
+        uint32_t count;             // 0 for interior nodes
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> order;            // Primitive indices grouped by leaf
+    std::vector<uint32_t> leafOf;           // Primitive -> leaf node
+    std::vector<Aabb> primitiveBounds;
+
+    uint32_t buildNode(uint32_t first, uint32_t count, std::vector<float> &centroids);
+    void fitNode(Node &node) const;
+    void collectLeaves(uint32_t nodeIndex, std::vector<uint32_t> &visible) const;
+};
+
+/**
+ * @brief Slab test of a ray against a box.
+ *
+ * @return Entry distance (0 when the origin is inside), or ray.tMax on a miss.
+ */
+float intersectAabb(const Ray &ray, const Aabb &box);
+
+/**
+ * @brief Möller-Trumbore closest hit over an indexed triangle list (xyzw positions).
+ *
+ * @return Hit distance, or ray.tMax when nothing is hit.
+ */
+float intersectTriangles(const Ray &ray, const float *positions, const uint32_t *indices, size_t indexCount);
@@ -0,0 +1,145 @@
+#include "frustum.h"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+Frustum extractFrustum(const Eigen::Matrix4f &matrix)
+{
+    const Eigen::Vector4f r0 = matrix.row(0).transpose(), r1 = matrix.row(1).transpose();
+    const Eigen::Vector4f r2 = matrix.row(2).transpose(), r3 = matrix.row(3).transpose();
+    const Eigen::Vector4f planes[6] = {
+        r3 + r0,    // left
+        r3 - r0,    // right
+        r3 + r1,    // bottom
+        r3 - r1,    // top
+        r2,         // near (z >= 0)
+        r3 - r2     // far
+    };
+
+    Frustum frustum{};
+    for (int i = 0; i < 6; ++i)
+    {
+        const float length = planes[i].head<3>().norm();
+        const float scale = length > 0.0f ? 1.0f / length : 1.0f;
+        for (int k = 0; k < 4; ++k)
+            frustum.planes[i][k] = planes[i][k] * scale;
+    }
+    return frustum;
+}
+
+void SphereSoA::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+}
+
+void SphereSoA::push(const float center[3], float r)
+{
+    centerX.push_back(center[0]);
+    centerY.push_back(center[1]);
+    centerZ.push_back(center[2]);
+    radius.push_back(r);
+}
+
+namespace
+{
+// Bit i set when lane i is inside all planes
+unsigned cullBlock8(const Frustum &frustum, const float *x, const float *y, const float *z, const float *r)
+{
+#if defined(__AVX__)
+    const __m256 cx = _mm256_loadu_ps(x), cy = _mm256_loadu_ps(y), cz = _mm256_loadu_ps(z);
+    const __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(r));
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (const float *plane : frustum.planes)
+    {
+        __m256 d = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane[0])), _mm256_set1_ps(plane[3]));
+        d = _mm256_add_ps(d, _mm256_mul_ps(cy, _mm256_set1_ps(plane[1])));
+        d = _mm256_add_ps(d, _mm256_mul_ps(cz, _mm256_set1_ps(plane[2])));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negRadius, _CMP_GE_OQ));
+    }
+    return static_cast<unsigned>(_mm256_movemask_ps(inside));
+#elif defined(__SSE2__)
+    unsigned mask = 0;
+    for (int half = 0; half < 2; ++half)
+    {
+        const int o = half * 4;
+        const __m128 cx = _mm_loadu_ps(x + o), cy = _mm_loadu_ps(y + o), cz = _mm_loadu_ps(z + o);
+        const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + o));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const float *plane : frustum.planes)
+        {
+            __m128 d = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane[0])), _mm_set1_ps(plane[3]));
+            d = _mm_add_ps(d, _mm_mul_ps(cy, _mm_set1_ps(plane[1])));
+            d = _mm_add_ps(d, _mm_mul_ps(cz, _mm_set1_ps(plane[2])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negRadius));
+        }
+        mask |= static_cast<unsigned>(_mm_movemask_ps(inside)) << o;
+    }
+    return mask;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    static const uint32_t laneBits[4] = {1, 2, 4, 8};
+    const uint32x4_t bits = vld1q_u32(laneBits);
+    unsigned mask = 0;
+    for (int half = 0; half < 2; ++half)
+    {
+        const int o = half * 4;
+        const float32x4_t cx = vld1q_f32(x + o), cy = vld1q_f32(y + o), cz = vld1q_f32(z + o);
+        const float32x4_t negRadius = vnegq_f32(vld1q_f32(r + o));
+        uint32x4_t inside = vdupq_n_u32(~0u);
+        for (const float *plane : frustum.planes)
+        {
+            float32x4_t d = vmlaq_n_f32(vdupq_n_f32(plane[3]), cx, plane[0]);
+            d = vmlaq_n_f32(d, cy, plane[1]);
+            d = vmlaq_n_f32(d, cz, plane[2]);
+            inside = vandq_u32(inside, vcgeq_f32(d, negRadius));
+        }
+        mask |= vaddvq_u32(vandq_u32(inside, bits)) << o;
+    }
+    return mask;
+#else
+    unsigned mask = 0;
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        bool inside = true;
+        for (const float *plane : frustum.planes)
+            inside &= plane[0] * x[lane] + plane[1] * y[lane] + plane[2] * z[lane] + plane[3] >= -r[lane];
+        mask |= static_cast<unsigned>(inside) << lane;
+    }
+    return mask;
+#endif
+}
+} // namespace
+
+size_t cullSpheres(const Frustum &frustum, const SphereSoA &spheres, std::vector<uint32_t> &visible)
+{
+    const size_t count = spheres.size();
+    const size_t before = visible.size();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        unsigned mask = cullBlock8(frustum, &spheres.centerX[i], &spheres.centerY[i], &spheres.centerZ[i], &spheres.radius[i]);
+        while (mask)
+        {
+            const unsigned lane = static_cast<unsigned>(__builtin_ctz(mask));
+            visible.push_back(static_cast<uint32_t>(i + lane));
+            mask &= mask - 1;
+        }
+    }
+
+    for (; i < count; ++i)
+    {
+        bool inside = true;
+        for (const float *plane : frustum.planes)
+            inside &= plane[0] * spheres.centerX[i] + plane[1] * spheres.centerY[i] +
+                      plane[2] * spheres.centerZ[i] + plane[3] >= -spheres.radius[i];
+        if (inside)
+            visible.push_back(static_cast<uint32_t>(i));
+    }
+    return visible.size() - before;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <eigen/Eigen/Dense>
+
+/*
+-------------------------------------------------------------------
+  FRUSTUM CULLING  -------------------------------------------------
+
+  Six planes extracted from a matrix that maps into Metal clip space
+  (x, y in [-w, w], z in [0, w]). A point p is inside when
+  dot(plane.xyz, p) + plane.w >= 0 for every plane.
+
+  Sphere tests run on structure-of-arrays input, 8 bounds per step
+  (one AVX register, or two SSE/NEON registers).
+-------------------------------------------------------------------
+*/
+struct Frustum {
+    float planes[6][4];
+};
+
+/**
+ * @brief Gribb/Hartmann plane extraction, planes normalized so distances are metric.
+ */
+Frustum extractFrustum(const Eigen::Matrix4f &matrix);
+
+// Bounding spheres in structure-of-arrays form, ready for the 8-wide test
+struct SphereSoA {
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+
+    void clear();
+    void push(const float center[3], float r);
+    size_t size() const { return radius.size(); }
+};
+
+/**
+ * @brief Appends the index of every sphere that intersects the frustum to `visible`.
+ *
+ * @return Number of visible spheres.
+ */
+size_t cullSpheres(const Frustum &frustum, const SphereSoA &spheres, std::vector<uint32_t> &visible);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <eigen/Eigen/Dense>
+
+#include "drawItem.h"
+#include "../VertexFormat/vertexFormat.h"
+
+// What one encode() did
+struct DrawStats
+{
+    size_t draws{0};
+    size_t skipped{0};              // Visible items with nothing to draw (e.g. every cluster culled)
+    size_t pipelineChanges{0};
+    size_t dynamicUpdates{0};       // prepareDraw calls made by the last prepare()
+};
+
+/*
+-------------------------------------------------------------------
+  DRAW ENCODING  ---------------------------------------------------
+
+  DrawList's per-frame loop over its items, for any `Encoder` with
+
+    setPipeline(MTL::RenderPipelineState *)
+    setCullBack(bool)               counter-clockwise front faces when set
+    setVertexBuffer(MTL::Buffer *, size_t offset, uint32_t index)
+    setVertexBytes(const void *, size_t bytes, uint32_t index)
+    drawIndexed(uint32_t count, bool index32, MTL::Buffer *, size_t offset, uint32_t instances)
+    draw(uint32_t count, uint32_t instances)
+
+  DrawList binds it to a Metal render encoder; the draw benchmark
+  binds it to a recording one, so the loop is timed without a GPU.
+-------------------------------------------------------------------
+*/
+template <typename Encoder>
+DrawStats encodeDrawItems(Encoder &encoder, std::span<const DrawItem> items, std::span<const uint32_t> visible,
+                          std::span<MTL::RenderPipelineState *const> pipelines,
+                          std::span<const Eigen::Matrix4f> transforms, std::span<const VertexDequant> dequants)
+{
+    DrawStats stats;
+    uint32_t boundPipeline = UINT32_MAX;
+    bool cullingBack = false;
+    encoder.setCullBack(false);
+
+    for (uint32_t index : visible)
+    {
+        const DrawItem &item = items[index];
+        if (item.count == 0)
+        {
+            ++stats.skipped;
+            continue;
+        }
+
+        if (item.pipeline != boundPipeline)
+        {
+            encoder.setPipeline(pipelines[item.pipeline]);
+            boundPipeline = item.pipeline;
+            ++stats.pipelineChanges;
+        }
+
+        const bool cullBack = item.flags & kDrawCullBack;
+        if (cullBack != cullingBack)
+        {
+            encoder.setCullBack(cullBack);
+            cullingBack = cullBack;
+        }
+
+        encoder.setVertexBuffer(item.vertexBuffer, item.vertexOffset, 0);
+        encoder.setVertexBuffer(item.colorBuffer, item.colorOffset, 1);
+        encoder.setVertexBytes(transforms[item.transformSlot].data(), sizeof(Eigen::Matrix4f), 11);
+        if (item.flags & kDrawDequant)
+            encoder.setVertexBytes(&dequants[item.transformSlot], sizeof(VertexDequant), 12);
+
+        if (item.indexBuffer)
+            encoder.drawIndexed(item.count, item.flags & kDrawIndex32, item.indexBuffer, item.indexOffset,
+                                item.instanceCount);
+        else
+            encoder.draw(item.count, item.instanceCount);
+        ++stats.draws;
+    }
+
+    if (cullingBack)
+        encoder.setCullBack(false);
+    return stats;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Only pointers are stored, so items (and the loop drawing them) don't need metal-cpp
+namespace MTL
+{
+class Buffer;
+class RenderPipelineState;
+}
+
+/*
+-------------------------------------------------------------------
+  DRAW ITEM  -------------------------------------------------------
+
+  Everything one draw call needs, compiled from a Primitive when it is
+  added to a DrawList: no virtual calls, no validity checks and no
+  pointer chasing into the Primitive while the frame is encoded.
+
+  Buffers are borrowed from the Primitive (its Handles keep them
+  alive); an item is only valid while its Primitive is.
+
+  Items flagged kDrawDynamic (LOD switching, per-frame cluster culling,
+  dynamic streams) are re-described by their Primitive before each
+  frame that draws them; every other item is written once.
+-------------------------------------------------------------------
+*/
+enum DrawItemFlags : uint8_t
+{
+    kDrawIndex32 = 1u << 0,     // uint32 indices (uint16 otherwise)
+    kDrawDequant = 1u << 1,     // Binds the VertexDequant at buffer(12)
+    kDrawCullBack = 1u << 2,    // Counter-clockwise front faces, back faces culled
+    kDrawDynamic = 1u << 3,     // Primitive::prepareDraw runs before each frame that draws it
+    kDrawBlended = 1u << 4,     // Pipeline blends (see BlendMode): drawn in the transparent pass
+};
+
+struct DrawItem
+{
+    MTL::Buffer *vertexBuffer{nullptr};     // buffer(0)
+    MTL::Buffer *colorBuffer{nullptr};      // buffer(1), may be null
+    MTL::Buffer *indexBuffer{nullptr};      // null for non-indexed draws
+    size_t vertexOffset{0};                 // Byte offsets into the buffers above
+    size_t colorOffset{0};
+    size_t indexOffset{0};
+    uint32_t count{0};                      // Indices, or vertices per instance when not indexed; 0 skips the draw
+    uint32_t instanceCount{1};
+    uint32_t pipeline{0};                   // Index into the DrawList's pipeline table
+    uint32_t transformSlot{0};              // Index into the DrawList's transforms and dequants
+    uint8_t flags{0};
+};
+
+static_assert(std::is_trivially_copyable_v<DrawItem> && std::is_standard_layout_v<DrawItem>,
+              "DrawItems are stored and copied as plain data");
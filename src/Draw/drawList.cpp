@@ -0,0 +1,148 @@
+#include "drawList.h"
+#include "../Primitive/primitive.h"
+
+#include <stdexcept>
+
+namespace
+{
+// encodeDrawItems' view of a Metal render encoder
+struct MetalDrawEncoder
+{
+    MTL::RenderCommandEncoder *encoder;
+
+    void setPipeline(MTL::RenderPipelineState *pipeline) { encoder->setRenderPipelineState(pipeline); }
+
+    void setCullBack(bool cullBack)
+    {
+        encoder->setFrontFacingWinding(MTL::WindingCounterClockwise);
+        encoder->setCullMode(cullBack ? MTL::CullModeBack : MTL::CullModeNone);
+    }
+
+    void setVertexBuffer(MTL::Buffer *buffer, size_t offset, uint32_t index)
+    {
+        encoder->setVertexBuffer(buffer, offset, index);
+    }
+
+    void setVertexBytes(const void *bytes, size_t length, uint32_t index)
+    {
+        encoder->setVertexBytes(bytes, length, index);
+    }
+
+    void drawIndexed(uint32_t count, bool index32, MTL::Buffer *indices, size_t offset, uint32_t instances)
+    {
+        encoder->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle, count,
+                                       index32 ? MTL::IndexType::IndexTypeUInt32 : MTL::IndexType::IndexTypeUInt16,
+                                       indices, offset, instances);
+    }
+
+    void draw(uint32_t count, uint32_t instances)
+    {
+        encoder->drawPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle, NS::UInteger(0), count, instances);
+    }
+};
+} // namespace
+
+/*
+-------------------------------------------------------------------
+  BUILD  -----------------------------------------------------------
+-------------------------------------------------------------------
+*/
+void DrawList::build(std::span<Primitive *const> scene)
+{
+    clear();
+    items.reserve(scene.size());
+    primitives.assign(scene.begin(), scene.end());
+    transforms.resize(scene.size());
+    transformVersions.assign(scene.size(), UINT64_MAX);     // Copied on the first prepare
+    dequants.resize(scene.size());
+
+    for (size_t i = 0; i < scene.size(); ++i)
+    {
+        Primitive *primitive = scene[i];
+        DrawItem item = primitive->compileDrawItem();
+        item.pipeline = internPipeline(primitive->getPipelineState());
+        item.transformSlot = static_cast<uint32_t>(i);
+        dequants[i] = primitive->getDequant();
+        dynamicCount += (item.flags & kDrawDynamic) != 0;
+        items.push_back(item);
+    }
+}
+
+void DrawList::clear()
+{
+    items.clear();
+    primitives.clear();
+    transforms.clear();
+    transformVersions.clear();
+    dequants.clear();
+    pipelines.clear();
+    pipelineIds.clear();
+    dynamicCount = 0;
+}
+
+uint32_t DrawList::internPipeline(MTL::RenderPipelineState *pipeline)
+{
+    const auto [it, inserted] = pipelineIds.try_emplace(pipeline, static_cast<uint32_t>(pipelines.size()));
+    if (inserted)
+        pipelines.push_back(pipeline);
+    return it->second;
+}
+
+size_t DrawList::size() const
+{
+    return items.size();
+}
+
+bool DrawList::empty() const
+{
+    return items.empty();
+}
+
+const DrawItem &DrawList::operator[](size_t index) const
+{
+    return items[index];
+}
+
+size_t DrawList::getPipelineCount() const
+{
+    return pipelines.size();
+}
+
+size_t DrawList::getDynamicCount() const
+{
+    return dynamicCount;
+}
+
+/*
+-------------------------------------------------------------------
+  PER FRAME  -------------------------------------------------------
+-------------------------------------------------------------------
+*/
+void DrawList::prepare(std::span<const uint32_t> visible)
+{
+    dynamicUpdates = 0;
+    for (uint32_t index : visible)
+    {
+        DrawItem &item = items[index];
+        Transform &transform = primitives[index]->getTransform();
+        if (transform.getVersion() != transformVersions[item.transformSlot])
+        {
+            transformVersions[item.transformSlot] = transform.getVersion();
+            transforms[item.transformSlot] = transform.getMatrix();
+        }
+
+        if (item.flags & kDrawDynamic)
+        {
+            primitives[index]->prepareDraw(item);
+            ++dynamicUpdates;
+        }
+    }
+}
+
+DrawStats DrawList::encode(MTL::RenderCommandEncoder *encoder, std::span<const uint32_t> visible)
+{
+    MetalDrawEncoder metal{encoder};
+    DrawStats stats = encodeDrawItems(metal, items, visible, pipelines, transforms, dequants);
+    stats.dynamicUpdates = dynamicUpdates;
+    return stats;
+}
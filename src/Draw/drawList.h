@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <Metal/Metal.hpp>
+#include <eigen/Eigen/Dense>
+
+#include "drawItem.h"
+#include "drawEncoding.h"
+#include "../VertexFormat/vertexFormat.h"
+
+class Primitive;
+
+/*
+-------------------------------------------------------------------
+  DRAW LIST  -------------------------------------------------------
+
+  The scene compiled into contiguous DrawItems, item i drawn for
+  primitive i. Per frame:
+
+    prepare(visible)   refreshes changed transforms and re-describes
+                       dynamic items, only for what will be drawn
+    encode(visible)    one tight loop over the items; the pipeline and
+                       cull state are only set when they change
+                       (encodeDrawItems, drawEncoding.h)
+
+  Pipelines are interned into a table so items carry a small id.
+  Rebuild the list whenever primitives are added, removed or
+  reordered: items borrow the primitives' buffers.
+-------------------------------------------------------------------
+*/
+class DrawList
+{
+public:
+    /**
+     * @brief Compiles one item per primitive. Throws std::runtime_error for a primitive that can't draw.
+     */
+    void build(std::span<Primitive *const> primitives);
+    void clear();
+
+    size_t size() const;
+    bool empty() const;
+    const DrawItem &operator[](size_t index) const;
+
+    void prepare(std::span<const uint32_t> visible);
+    DrawStats encode(MTL::RenderCommandEncoder *encoder, std::span<const uint32_t> visible);
+
+    size_t getPipelineCount() const;
+    size_t getDynamicCount() const;
+
+private:
+    std::vector<DrawItem> items;
+    std::vector<Primitive *> primitives;            // Only touched for dynamic items and transform refreshes
+    std::vector<Eigen::Matrix4f> transforms;        // By transform slot
+    std::vector<uint64_t> transformVersions;
+    std::vector<VertexDequant> dequants;            // By transform slot (only read with kDrawDequant)
+    std::vector<MTL::RenderPipelineState *> pipelines;
+    std::unordered_map<MTL::RenderPipelineState *, uint32_t> pipelineIds;
+    size_t dynamicCount{0};
+    size_t dynamicUpdates{0};
+
+    uint32_t internPipeline(MTL::RenderPipelineState *pipeline);
+};
@@ -0,0 +1,74 @@
+#include "renderTarget.h"
+
+#include <stdexcept>
+
+namespace
+{
+RenderTargetFormat targetFormat;
+} // namespace
+
+void setRenderTargetFormat(const RenderTargetFormat &format)
+{
+    targetFormat = format;
+}
+
+const RenderTargetFormat &getRenderTargetFormat()
+{
+    return targetFormat;
+}
+
+void applyRenderTargetFormat(MTL::RenderPipelineDescriptor *descriptor)
+{
+    descriptor->colorAttachments()->object(0)->setPixelFormat(targetFormat.color);
+    descriptor->setDepthAttachmentPixelFormat(targetFormat.depth);
+}
+
+void applyBlendMode(MTL::RenderPipelineColorAttachmentDescriptor *attachment, BlendMode mode)
+{
+    attachment->setBlendingEnabled(mode != BlendMode::Opaque);
+    attachment->setRgbBlendOperation(MTL::BlendOperationAdd);
+    attachment->setAlphaBlendOperation(MTL::BlendOperationAdd);
+    attachment->setSourceRGBBlendFactor(MTL::BlendFactorSourceAlpha);
+    attachment->setSourceAlphaBlendFactor(MTL::BlendFactorOne);
+    const MTL::BlendFactor destination =
+        mode == BlendMode::Additive ? MTL::BlendFactorOne : MTL::BlendFactorOneMinusSourceAlpha;
+    attachment->setDestinationRGBBlendFactor(destination);
+    attachment->setDestinationAlphaBlendFactor(destination);
+}
+
+/*
+-------------------------------------------------------------------
+  DEPTH STATES  ----------------------------------------------------
+-------------------------------------------------------------------
+*/
+DepthStates::DepthStates(MTL::Device *device)
+{
+    struct Setup
+    {
+        DepthMode mode;
+        MTL::CompareFunction compare;
+        bool write;
+    };
+    constexpr Setup kSetups[] = {
+        {DepthMode::Off, MTL::CompareFunctionAlways, false},
+        {DepthMode::Opaque, MTL::CompareFunctionLess, true},
+        {DepthMode::ReadOnly, MTL::CompareFunctionLessEqual, false},
+    };
+
+    for (const Setup &setup : kSetups)
+    {
+        Handle<MTL::DepthStencilDescriptor> descriptor(MTL::DepthStencilDescriptor::alloc()->init());
+        descriptor->setDepthCompareFunction(setup.compare);
+        descriptor->setDepthWriteEnabled(setup.write);
+
+        Handle<MTL::DepthStencilState> &state = states[static_cast<size_t>(setup.mode)];
+        state = Handle<MTL::DepthStencilState>(device->newDepthStencilState(descriptor.get()));
+        if (!state)
+            throw std::runtime_error("Failed to create depth stencil state");
+    }
+}
+
+MTL::DepthStencilState *DepthStates::get(DepthMode mode) const
+{
+    return states[static_cast<size_t>(mode)].get();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+#include <Metal/Metal.hpp>
+
+#include "../Resource/handle.h"
+
+/*
+-------------------------------------------------------------------
+  RENDER TARGET  ---------------------------------------------------
+
+  Attachment formats of the main render pass. Pipelines are compiled
+  against them, so they are chosen once at startup, before the first
+  Primitive or SpriteBatcher builds its pipeline, and every pass that
+  draws those pipelines has to use the same formats.
+
+  With a depth format set, DepthStates holds the depth-stencil state
+  objects passes switch between:
+
+    Off        no test, no write (overlays drawn on top of everything)
+    Opaque     less, writes: the opaque pass, drawn front to back so
+               early depth testing rejects hidden fragments unshaded
+    ReadOnly   less-equal, no write: blended surfaces, hidden behind
+               opaque ones (but not by a coplanar one) and hiding nothing
+
+  Color blending is part of the pipeline, so each BlendMode a
+  primitive draws with is its own pipeline variant.
+-------------------------------------------------------------------
+*/
+struct RenderTargetFormat
+{
+    MTL::PixelFormat color{MTL::PixelFormat::PixelFormatBGRA8Unorm};
+    MTL::PixelFormat depth{MTL::PixelFormat::PixelFormatInvalid};      // Invalid: no depth attachment
+
+    bool hasDepth() const { return depth != MTL::PixelFormat::PixelFormatInvalid; }
+};
+
+void setRenderTargetFormat(const RenderTargetFormat &format);
+const RenderTargetFormat &getRenderTargetFormat();
+
+// Sets color attachment 0's and the depth attachment's pixel formats
+void applyRenderTargetFormat(MTL::RenderPipelineDescriptor *descriptor);
+
+enum class DepthMode : uint8_t
+{
+    Off,
+    Opaque,
+    ReadOnly,
+};
+
+class DepthStates
+{
+public:
+    // Throws std::runtime_error if a state can't be created
+    explicit DepthStates(MTL::Device *device);
+
+    MTL::DepthStencilState *get(DepthMode mode) const;
+
+private:
+    Handle<MTL::DepthStencilState> states[3];
+};
+
+enum class BlendMode : uint8_t
+{
+    Opaque,     // Overwrites the color buffer
+    Alpha,      // src * a + dst * (1 - a)
+    Additive,   // src * a + dst
+};
+
+// Blend state of a color attachment for `mode`
+void applyBlendMode(MTL::RenderPipelineColorAttachmentDescriptor *attachment, BlendMode mode);
@@ -0,0 +1,209 @@
+#include "softwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+// Twice the signed area of (a, b, p); positive when p is left of a -> b (counter-clockwise, y down)
+float edge(const float *a, const float *b, float px, float py)
+{
+    return (b[0] - a[0]) * (py - a[1]) - (b[1] - a[1]) * (px - a[0]);
+}
+
+// Pixels exactly on an edge belong to one of the two triangles sharing it: the one it's a top / left edge of
+bool ownsEdge(const float *a, const float *b)
+{
+    const float dy = b[1] - a[1];
+    return dy < 0.0f || (dy == 0.0f && b[0] - a[0] > 0.0f);
+}
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(uint32_t width, uint32_t height) : width(width), height(height)
+{
+    if (width == 0 || height == 0)
+        throw std::invalid_argument("Rasterizer target must be at least 1 x 1");
+    tilesX = (width + kTileSize - 1) / kTileSize;
+    tilesY = (height + kTileSize - 1) / kTileSize;
+    depth.resize(size_t{width} * height);
+    tileFarthest.resize(size_t{tilesX} * tilesY);
+    covered.resize(depth.size());
+    clear();
+}
+
+void SoftwareRasterizer::clear()
+{
+    std::fill(depth.begin(), depth.end(), 1.0f);
+    std::fill(tileFarthest.begin(), tileFarthest.end(), 1.0f);
+    std::fill(covered.begin(), covered.end(), 0);
+    coveredPixels = 0;
+    stats = {};
+}
+
+void SoftwareRasterizer::drawTriangles(std::span<const float> xyzw, std::span<const uint32_t> indices,
+                                       const Eigen::Matrix4f &transform, bool depthTest)
+{
+    const size_t vertexCount = xyzw.size() / 4;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        ++stats.triangles;
+        float screen[3][3];
+        bool valid = true;
+        for (int k = 0; k < 3 && valid; ++k)
+        {
+            const uint32_t index = indices[t + k];
+            if (index >= vertexCount)
+                throw std::out_of_range("Triangle index past the end of the positions");
+
+            const Eigen::Vector4f clip = transform * Eigen::Vector4f::Map(xyzw.data() + size_t{index} * 4);
+            valid = clip[3] > 0.0f;
+            const float inverseW = 1.0f / clip[3];
+            screen[k][0] = (clip[0] * inverseW + 1.0f) * 0.5f * static_cast<float>(width);
+            screen[k][1] = (1.0f - clip[1] * inverseW) * 0.5f * static_cast<float>(height);
+            screen[k][2] = clip[2] * inverseW;
+        }
+        if (!valid)
+        {
+            ++stats.trianglesRejected;
+            continue;
+        }
+        rasterizeTriangle(screen, depthTest);
+    }
+}
+
+void SoftwareRasterizer::rasterizeTriangle(const float (&screen)[3][3], bool depthTest)
+{
+    // Counter-clockwise (in y-down pixels) from here on; both faces draw
+    const float *v0 = screen[0], *v1 = screen[1], *v2 = screen[2];
+    float area = edge(v0, v1, v2[0], v2[1]);
+    if (area < 0.0f)
+    {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    const float minZ = std::min({v0[2], v1[2], v2[2]});
+    const float maxZ = std::max({v0[2], v1[2], v2[2]});
+    const float minX = std::max(std::floor(std::min({v0[0], v1[0], v2[0]})), 0.0f);
+    const float minY = std::max(std::floor(std::min({v0[1], v1[1], v2[1]})), 0.0f);
+    const float maxX = std::min(std::ceil(std::max({v0[0], v1[0], v2[0]})), static_cast<float>(width));
+    const float maxY = std::min(std::ceil(std::max({v0[1], v1[1], v2[1]})), static_cast<float>(height));
+    if (!(area > 0.0f) || minX >= maxX || minY >= maxY || minZ > 1.0f || maxZ < 0.0f)
+    {
+        ++stats.trianglesRejected;
+        return;
+    }
+
+    // Depth plane z = zx * x + zy * y + z0 (pixel coordinates)
+    const float zx = ((v1[2] - v0[2]) * (v2[1] - v0[1]) - (v2[2] - v0[2]) * (v1[1] - v0[1])) / area;
+    const float zy = ((v2[2] - v0[2]) * (v1[0] - v0[0]) - (v1[2] - v0[2]) * (v2[0] - v0[0])) / area;
+    const float z0 = v0[2] - zx * v0[0] - zy * v0[1];
+
+    const bool owns12 = ownsEdge(v1, v2), owns20 = ownsEdge(v2, v0), owns01 = ownsEdge(v0, v1);
+    const uint32_t pixelX0 = static_cast<uint32_t>(minX), pixelX1 = static_cast<uint32_t>(maxX);
+    const uint32_t pixelY0 = static_cast<uint32_t>(minY), pixelY1 = static_cast<uint32_t>(maxY);
+
+    bool drewAny = false;
+    for (uint32_t tileY = pixelY0 / kTileSize; tileY <= (pixelY1 - 1) / kTileSize; ++tileY)
+    {
+        const uint32_t y0 = std::max(tileY * kTileSize, pixelY0), y1 = std::min((tileY + 1) * kTileSize, pixelY1);
+        for (uint32_t tileX = pixelX0 / kTileSize; tileX <= (pixelX1 - 1) / kTileSize; ++tileX)
+        {
+            const uint32_t x0 = std::max(tileX * kTileSize, pixelX0), x1 = std::min((tileX + 1) * kTileSize, pixelX1);
+            const size_t tile = size_t{tileY} * tilesX + tileX;
+            ++stats.tilesTested;
+
+            if (depthTest)
+            {
+                // Nearest the plane gets over the pixel centers here (a plane's minimum is at a corner)
+                const float cx0 = static_cast<float>(x0) + 0.5f, cx1 = static_cast<float>(x1) - 0.5f;
+                const float cy0 = static_cast<float>(y0) + 0.5f, cy1 = static_cast<float>(y1) - 0.5f;
+                const float nearest = std::max(minZ, z0 + std::min(zx * cx0, zx * cx1) + std::min(zy * cy0, zy * cy1));
+                if (nearest >= tileFarthest[tile])
+                {
+                    ++stats.tilesRejected;
+                    continue;
+                }
+            }
+
+            bool wrote = false;
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                const float py = static_cast<float>(y) + 0.5f;
+                for (uint32_t x = x0; x < x1; ++x)
+                {
+                    const float px = static_cast<float>(x) + 0.5f;
+                    const float e12 = edge(v1, v2, px, py), e20 = edge(v2, v0, px, py), e01 = edge(v0, v1, px, py);
+                    if (e12 < 0.0f || e20 < 0.0f || e01 < 0.0f || (e12 == 0.0f && !owns12) ||
+                        (e20 == 0.0f && !owns20) || (e01 == 0.0f && !owns01))
+                        continue;
+
+                    const float z = z0 + zx * px + zy * py;
+                    if (z < 0.0f || z > 1.0f)
+                        continue;
+
+                    const size_t pixel = size_t{y} * width + x;
+                    ++stats.fragmentsTested;
+                    if (depthTest && !(z < depth[pixel]))
+                        continue;
+
+                    ++stats.fragmentsShaded;
+                    coveredPixels += covered[pixel] == 0;
+                    covered[pixel] = 1;
+                    drewAny = true;
+                    if (depthTest)
+                    {
+                        depth[pixel] = z;
+                        wrote = true;
+                    }
+                }
+            }
+            if (wrote)
+                refreshTile(tileX, tileY);
+        }
+    }
+    if (!drewAny)
+        ++stats.trianglesRejected;
+}
+
+void SoftwareRasterizer::refreshTile(uint32_t tileX, uint32_t tileY)
+{
+    const uint32_t x0 = tileX * kTileSize, x1 = std::min(x0 + kTileSize, width);
+    const uint32_t y0 = tileY * kTileSize, y1 = std::min(y0 + kTileSize, height);
+    float farthest = 0.0f;
+    for (uint32_t y = y0; y < y1; ++y)
+        for (uint32_t x = x0; x < x1; ++x)
+            farthest = std::max(farthest, depth[size_t{y} * width + x]);
+    tileFarthest[size_t{tileY} * tilesX + tileX] = farthest;
+}
+
+const RasterStats &SoftwareRasterizer::getStats() const
+{
+    return stats;
+}
+
+uint64_t SoftwareRasterizer::getCoveredPixels() const
+{
+    return coveredPixels;
+}
+
+double SoftwareRasterizer::getOverdraw() const
+{
+    return coveredPixels ? static_cast<double>(stats.fragmentsShaded) / static_cast<double>(coveredPixels) : 0.0;
+}
+
+uint32_t SoftwareRasterizer::getWidth() const
+{
+    return width;
+}
+
+uint32_t SoftwareRasterizer::getHeight() const
+{
+    return height;
+}
+
+std::span<const float> SoftwareRasterizer::getDepth() const
+{
+    return depth;
+}
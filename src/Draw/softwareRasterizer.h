@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <eigen/Eigen/Dense>
+
+/*
+-------------------------------------------------------------------
+  SOFTWARE RASTERIZER  ---------------------------------------------
+
+  Depth-only triangle rasterization on the CPU, with the same
+  conventions as the Metal pass (clip space from the primitive's
+  Transform, viewport y down, depth = z / w in [0, 1], less test, no
+  face culling), counting the fragments a GPU would shade.
+
+  The screen is split into 8 x 8 pixel tiles, each keeping the
+  farthest depth written inside it (hierarchical Z). Before touching
+  a tile's pixels, the nearest depth the triangle can have over the
+  tile is compared with that: a triangle entirely behind everything
+  already in the tile is rejected for the whole tile at once, which
+  is most of the work saved when opaque geometry arrives front to
+  back.
+
+  Without the depth test (drawTriangles(..., false)) every covered
+  pixel is shaded and nothing is written: a pass with no depth
+  attachment, for overdraw before / after comparisons.
+-------------------------------------------------------------------
+*/
+struct RasterStats
+{
+    uint64_t triangles{0};
+    uint64_t trianglesRejected{0};  // Shaded nothing: degenerate, clipped, between pixel centers or hidden
+    uint64_t tilesTested{0};        // Triangle / tile pairs checked against the tile's depth
+    uint64_t tilesRejected{0};      // ... dropped without testing a pixel
+    uint64_t fragmentsTested{0};    // Covered pixels depth-tested one by one
+    uint64_t fragmentsShaded{0};    // ... that passed
+};
+
+class SoftwareRasterizer
+{
+public:
+    static constexpr uint32_t kTileSize = 8;
+
+    // Throws std::invalid_argument for an empty target
+    SoftwareRasterizer(uint32_t width, uint32_t height);
+
+    // Depth to 1 (far), coverage and stats to 0
+    void clear();
+
+    /**
+     * @brief Rasterizes indexed triangles whose xyzw positions `transform` maps into clip space.
+     *
+     * Triangles with a vertex at w <= 0 (behind the eye) are dropped whole rather than clipped;
+     * transforms in this renderer are affine, so w stays 1. Fragments outside [0, 1] depth are clipped.
+     */
+    void drawTriangles(std::span<const float> xyzw, std::span<const uint32_t> indices,
+                       const Eigen::Matrix4f &transform, bool depthTest = true);
+
+    const RasterStats &getStats() const;
+
+    // Pixels shaded at least once since clear(), and fragments shaded per such pixel
+    uint64_t getCoveredPixels() const;
+    double getOverdraw() const;
+
+    uint32_t getWidth() const;
+    uint32_t getHeight() const;
+    std::span<const float> getDepth() const;
+
+private:
+    uint32_t width;
+    uint32_t height;
+    uint32_t tilesX;
+    uint32_t tilesY;
+    std::vector<float> depth;
+    std::vector<float> tileFarthest;    // Hierarchical Z: farthest depth in each tile
+    std::vector<uint8_t> covered;
+    uint64_t coveredPixels{0};
+    RasterStats stats;
+
+    void rasterizeTriangle(const float (&screen)[3][3], bool depthTest);
+    void refreshTile(uint32_t tileX, uint32_t tileY);
+};
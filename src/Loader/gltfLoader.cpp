@@ -0,0 +1,747 @@
+#include "gltfLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/resource.h>
+
+namespace
+{
+/*
+-------------------------------------------------------------------
+  JSON  ------------------------------------------------------------
+
+  Just enough of a DOM for the glTF header: numbers are doubles,
+  objects keep their key order, \u escapes are decoded to UTF-8.
+-------------------------------------------------------------------
+*/
+struct JsonValue
+{
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type{Type::Null};
+    bool boolean{false};
+    double number{0.0};
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    const JsonValue *find(const char *key) const
+    {
+        for (const auto &[name, value] : object)
+            if (name == key)
+                return &value;
+        return nullptr;
+    }
+
+    double numberOr(const char *key, double fallback) const
+    {
+        const JsonValue *value = find(key);
+        return value && value->type == Type::Number ? value->number : fallback;
+    }
+
+    // The number as an integer in [low, high]; fractions, NaN and anything out of range are malformed
+    double integer(const char *what, double low, double high) const
+    {
+        if (type != Type::Number || !(number >= low && number <= high) || number != std::floor(number))
+            throw std::runtime_error(std::string("glTF: ") + what + " must be an integer in range");
+        return number;
+    }
+
+    int asInt(const char *what) const
+    {
+        return static_cast<int>(integer(what, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()));
+    }
+
+    int intOr(const char *key, int fallback) const
+    {
+        const JsonValue *value = find(key);
+        return value ? value->asInt(key) : fallback;
+    }
+
+    // Offsets, lengths, strides and counts: non-negative and below 2^53, so sums of two never wrap
+    size_t sizeOr(const char *key, size_t fallback) const
+    {
+        const JsonValue *value = find(key);
+        return value ? static_cast<size_t>(value->integer(key, 0.0, 0x1p53)) : fallback;
+    }
+
+    std::string stringOr(const char *key, const char *fallback) const
+    {
+        const JsonValue *value = find(key);
+        return value && value->type == Type::String ? value->string : fallback;
+    }
+
+    const std::vector<JsonValue> &arrayOf(const char *key) const
+    {
+        static const std::vector<JsonValue> empty;
+        const JsonValue *value = find(key);
+        return value && value->type == Type::Array ? value->array : empty;
+    }
+};
+
+class JsonParser
+{
+public:
+    JsonParser(const char *begin, const char *end) : p(begin), end(end) {}
+
+    JsonValue parseDocument()
+    {
+        JsonValue value = parseValue(0);
+        skipWhitespace();
+        if (p != end && *p != '\0')
+            fail("trailing characters");
+        return value;
+    }
+
+private:
+    static constexpr int kMaxDepth = 128;
+
+    const char *p;
+    const char *end;
+
+    [[noreturn]] void fail(const char *what) const
+    {
+        throw std::runtime_error(std::string("glTF JSON: ") + what);
+    }
+
+    void skipWhitespace()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            ++p;
+    }
+
+    void expect(char c)
+    {
+        skipWhitespace();
+        if (p >= end || *p != c)
+            fail("unexpected character");
+        ++p;
+    }
+
+    bool consume(const char *literal)
+    {
+        const size_t length = std::strlen(literal);
+        if (static_cast<size_t>(end - p) < length || std::memcmp(p, literal, length) != 0)
+            return false;
+        p += length;
+        return true;
+    }
+
+    JsonValue parseValue(int depth)
+    {
+        if (depth > kMaxDepth)
+            fail("nesting too deep");
+
+        skipWhitespace();
+        if (p >= end)
+            fail("unexpected end");
+
+        JsonValue value;
+        switch (*p)
+        {
+        case '{':
+            value.type = JsonValue::Type::Object;
+            ++p;
+            skipWhitespace();
+            if (p < end && *p == '}')
+            {
+                ++p;
+                break;
+            }
+            do
+            {
+                skipWhitespace();
+                std::string key = parseString();
+                expect(':');
+                value.object.emplace_back(std::move(key), parseValue(depth + 1));
+                skipWhitespace();
+            } while (p < end && *p == ',' && ++p);
+            expect('}');
+            break;
+        case '[':
+            value.type = JsonValue::Type::Array;
+            ++p;
+            skipWhitespace();
+            if (p < end && *p == ']')
+            {
+                ++p;
+                break;
+            }
+            do
+            {
+                value.array.push_back(parseValue(depth + 1));
+                skipWhitespace();
+            } while (p < end && *p == ',' && ++p);
+            expect(']');
+            break;
+        case '"':
+            value.type = JsonValue::Type::String;
+            value.string = parseString();
+            break;
+        case 't':
+        case 'f':
+            value.type = JsonValue::Type::Bool;
+            value.boolean = *p == 't';
+            if (!consume(value.boolean ? "true" : "false"))
+                fail("bad literal");
+            break;
+        case 'n':
+            if (!consume("null"))
+                fail("bad literal");
+            break;
+        default:
+        {
+            // The document is an object, so a number never ends the chunk and strtod stops inside the mapping
+            char *stop = nullptr;
+            value.type = JsonValue::Type::Number;
+            value.number = std::strtod(p, &stop);
+            if (stop == p || stop > end)
+                fail("bad number");
+            p = stop;
+            break;
+        }
+        }
+        return value;
+    }
+
+    void appendUtf8(std::string &out, uint32_t codepoint)
+    {
+        if (codepoint < 0x80)
+        {
+            out += static_cast<char>(codepoint);
+        }
+        else if (codepoint < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else if (codepoint < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    uint32_t parseHex4()
+    {
+        if (end - p < 4)
+            fail("bad escape");
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i, ++p)
+        {
+            const char c = *p;
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                value |= c - 'A' + 10;
+            else
+                fail("bad escape");
+        }
+        return value;
+    }
+
+    std::string parseString()
+    {
+        if (p >= end || *p != '"')
+            fail("expected string");
+        ++p;
+
+        std::string out;
+        while (p < end && *p != '"')
+        {
+            if (*p != '\\')
+            {
+                out += *p++;
+                continue;
+            }
+            if (++p >= end)
+                break;
+            const char escape = *p++;
+            switch (escape)
+            {
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u':
+            {
+                uint32_t codepoint = parseHex4();
+                if (codepoint >= 0xD800 && codepoint < 0xDC00 && consume("\\u"))
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (parseHex4() - 0xDC00);
+                appendUtf8(out, codepoint);
+                break;
+            }
+            default: out += escape; break;      // \" \\ \/
+            }
+        }
+        if (p >= end)
+            fail("unterminated string");
+        ++p;
+        return out;
+    }
+};
+
+/*
+-------------------------------------------------------------------
+  ACCESSORS  -------------------------------------------------------
+-------------------------------------------------------------------
+*/
+enum ComponentType : int
+{
+    kByte = 5120,
+    kUnsignedByte = 5121,
+    kShort = 5122,
+    kUnsignedShort = 5123,
+    kUnsignedInt = 5125,
+    kFloat = 5126,
+};
+
+size_t componentSize(int componentType)
+{
+    switch (componentType)
+    {
+    case kByte:
+    case kUnsignedByte: return 1;
+    case kShort:
+    case kUnsignedShort: return 2;
+    case kUnsignedInt:
+    case kFloat: return 4;
+    default: throw std::runtime_error("glTF: unknown component type " + std::to_string(componentType));
+    }
+}
+
+int componentCount(const std::string &type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT4") return 16;
+    throw std::runtime_error("glTF: unsupported accessor type " + type);
+}
+
+// Resolved accessor: where its elements live inside the mapping
+struct AccessorView
+{
+    const uint8_t *data{nullptr};
+    size_t fileOffset{0};
+    size_t count{0};
+    size_t stride{0};
+    size_t elementSize{0};
+    int componentType{0};
+    int components{0};
+    bool normalized{false};
+    const JsonValue *json{nullptr};
+
+    bool tightlyPacked() const { return stride == elementSize; }
+};
+
+class GlbReader
+{
+public:
+    GlbReader(const JsonValue &root, const uint8_t *fileBase, size_t binOffset, size_t binSize, GltfLoadStats &stats)
+        : root(root), fileBase(fileBase), binOffset(binOffset), binSize(binSize), stats(stats) {}
+
+    AccessorView accessor(int index) const
+    {
+        const std::vector<JsonValue> &accessors = root.arrayOf("accessors");
+        if (index < 0 || static_cast<size_t>(index) >= accessors.size())
+            throw std::runtime_error("glTF: accessor index out of range");
+        const JsonValue &json = accessors[index];
+        if (json.find("sparse"))
+            throw std::runtime_error("glTF: sparse accessors are not supported");
+
+        AccessorView view;
+        view.json = &json;
+        view.componentType = json.intOr("componentType", 0);
+        view.components = componentCount(json.stringOr("type", ""));
+        view.count = json.sizeOr("count", 0);
+        view.normalized = json.find("normalized") && json.find("normalized")->boolean;
+        view.elementSize = componentSize(view.componentType) * view.components;
+
+        const int viewIndex = json.intOr("bufferView", -1);
+        const std::vector<JsonValue> &bufferViews = root.arrayOf("bufferViews");
+        if (viewIndex < 0 || static_cast<size_t>(viewIndex) >= bufferViews.size())
+            throw std::runtime_error("glTF: accessors without a buffer view are not supported");
+        const JsonValue &bufferView = bufferViews[viewIndex];
+        if (bufferView.intOr("buffer", 0) != 0)
+            throw std::runtime_error("glTF: only the embedded GLB buffer is supported");
+
+        const size_t viewOffset = bufferView.sizeOr("byteOffset", 0);
+        const size_t viewLength = bufferView.sizeOr("byteLength", 0);
+        view.stride = bufferView.sizeOr("byteStride", 0);
+        if (view.stride == 0)
+            view.stride = view.elementSize;
+        else if (view.stride < view.elementSize)
+            throw std::runtime_error("glTF: byteStride smaller than the accessor's element");
+
+        // (count - 1) * stride + elementSize bytes from the accessor's offset, checked without overflow
+        const size_t accessorOffset = json.sizeOr("byteOffset", 0);
+        if (viewOffset > binSize || viewLength > binSize - viewOffset || accessorOffset > viewLength)
+            throw std::runtime_error("glTF: buffer view outside the BIN chunk");
+        const size_t available = viewLength - accessorOffset;
+        if (view.count && (view.elementSize > available || (view.count - 1) > (available - view.elementSize) / view.stride))
+            throw std::runtime_error("glTF: accessor outside its buffer view");
+
+        view.fileOffset = binOffset + viewOffset + accessorOffset;
+        view.data = fileBase + view.fileOffset;
+        return view;
+    }
+
+    // Keeps the accessor in place when `usable`, else fills the stream through `convert`
+    template <typename Convert>
+    void fill(GltfStream &stream, const AccessorView &view, bool usable, size_t convertedElementSize, Convert &&convert) const
+    {
+        if (usable)
+        {
+            stream.data = view.data;
+            stream.byteSize = view.count * view.elementSize;
+            stream.fileOffset = view.fileOffset;
+            stream.zeroCopy = true;
+            stats.zeroCopyBytes += stream.byteSize;
+        }
+        else
+        {
+            stream.owned.resize(view.count * convertedElementSize);
+            for (size_t i = 0; i < view.count; ++i)
+                convert(view.data + i * view.stride, stream.owned.data() + i * convertedElementSize);
+            stream.data = stream.owned.data();
+            stream.byteSize = stream.owned.size();
+            stats.convertedBytes += stream.byteSize;
+        }
+    }
+
+private:
+    const JsonValue &root;
+    const uint8_t *fileBase;
+    size_t binOffset;
+    size_t binSize;
+    GltfLoadStats &stats;
+};
+
+// Reads component `c` of an element as float, applying glTF's normalization rules
+float readComponent(const uint8_t *element, int componentType, bool normalized, int c)
+{
+    switch (componentType)
+    {
+    case kFloat:
+    {
+        float value;
+        std::memcpy(&value, element + c * 4, 4);
+        return value;
+    }
+    case kUnsignedByte:
+        return normalized ? element[c] / 255.0f : element[c];
+    case kByte:
+    {
+        const float value = static_cast<int8_t>(element[c]);
+        return normalized ? std::max(value / 127.0f, -1.0f) : value;
+    }
+    case kUnsignedShort:
+    {
+        uint16_t value;
+        std::memcpy(&value, element + c * 2, 2);
+        return normalized ? value / 65535.0f : value;
+    }
+    case kShort:
+    {
+        int16_t value;
+        std::memcpy(&value, element + c * 2, 2);
+        return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+    }
+    case kUnsignedInt:
+    {
+        uint32_t value;
+        std::memcpy(&value, element + c * 4, 4);
+        return static_cast<float>(value);
+    }
+    default:
+        return 0.0f;
+    }
+}
+
+uint32_t readIndex(const uint8_t *element, int componentType)
+{
+    if (componentType == kUnsignedByte)
+        return element[0];
+    if (componentType == kUnsignedShort)
+    {
+        uint16_t value;
+        std::memcpy(&value, element, 2);
+        return value;
+    }
+    uint32_t value;
+    std::memcpy(&value, element, 4);
+    return value;
+}
+
+// Metal binds device-space streams at offsets aligned to the element's scalar type
+bool alignedFor(const AccessorView &view, size_t alignment)
+{
+    return view.fileOffset % alignment == 0;
+}
+
+GltfPrimitive readPrimitive(const GlbReader &reader, const JsonValue &json)
+{
+    if (json.intOr("mode", 4) != 4)
+        throw std::runtime_error("glTF: only triangle-list primitives are supported");
+
+    const JsonValue *attributes = json.find("attributes");
+    const JsonValue *position = attributes ? attributes->find("POSITION") : nullptr;
+    if (!position)
+        throw std::runtime_error("glTF: primitive without POSITION");
+
+    GltfPrimitive primitive;
+
+    /*
+        Positions: packed float3 in place, anything else converted to it
+    */
+    const AccessorView positions = reader.accessor(position->asInt("POSITION"));
+    if (positions.components != 3)
+        throw std::runtime_error("glTF: POSITION must be VEC3");
+    primitive.vertexCount = positions.count;
+    reader.fill(primitive.positions, positions,
+                positions.componentType == kFloat && positions.tightlyPacked() && alignedFor(positions, 4),
+                3 * sizeof(float), [&](const uint8_t *src, uint8_t *dst) {
+                    float xyz[3];
+                    for (int c = 0; c < 3; ++c)
+                        xyz[c] = readComponent(src, positions.componentType, positions.normalized, c);
+                    std::memcpy(dst, xyz, sizeof(xyz));
+                });
+
+    // min/max are required on POSITION, so bounds never need a pass over the data
+    const std::vector<JsonValue> &minimum = positions.json->arrayOf("min");
+    const std::vector<JsonValue> &maximum = positions.json->arrayOf("max");
+    if (minimum.size() < 3 || maximum.size() < 3)
+        throw std::runtime_error("glTF: POSITION accessor without min/max");
+    for (int c = 0; c < 3; ++c)
+    {
+        primitive.bounds.min[c] = static_cast<float>(minimum[c].number);
+        primitive.bounds.max[c] = static_cast<float>(maximum[c].number);
+    }
+
+    /*
+        Colors: float4 or unorm8x4 in place, everything else converted to unorm8x4
+    */
+    if (const JsonValue *color = attributes->find("COLOR_0"))
+    {
+        const AccessorView colors = reader.accessor(color->asInt("COLOR_0"));
+        if (colors.count != primitive.vertexCount)
+            throw std::runtime_error("glTF: COLOR_0 count differs from POSITION");
+
+        const bool float4 = colors.componentType == kFloat && colors.components == 4;
+        const bool unorm4 = colors.componentType == kUnsignedByte && colors.normalized && colors.components == 4;
+        const bool usable = (float4 || unorm4) && colors.tightlyPacked() && alignedFor(colors, 4);
+        primitive.colorFormat = usable && float4 ? ColorFormat::Float4 : ColorFormat::Unorm8x4;
+        reader.fill(primitive.colors, colors, usable, 4, [&](const uint8_t *src, uint8_t *dst) {
+            for (int c = 0; c < 4; ++c)
+            {
+                const float value = c < colors.components ? readComponent(src, colors.componentType, colors.normalized, c) : 1.0f;
+                dst[c] = static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+            }
+        });
+    }
+
+    /*
+        Indices: ushort / uint in place, ubyte widened to ushort
+    */
+    const int indexAccessor = json.intOr("indices", -1);
+    if (indexAccessor >= 0)
+    {
+        const AccessorView indices = reader.accessor(indexAccessor);
+        if (indices.components != 1)
+            throw std::runtime_error("glTF: indices must be SCALAR");
+        if (indices.componentType != kUnsignedByte && indices.componentType != kUnsignedShort &&
+            indices.componentType != kUnsignedInt)
+            throw std::runtime_error("glTF: indices must be unsigned integers");
+
+        // The GPU fetches whatever the indices name, in place or not: every one must be a vertex
+        for (size_t i = 0; i < indices.count; ++i)
+            if (readIndex(indices.data + i * indices.stride, indices.componentType) >= primitive.vertexCount)
+                throw std::runtime_error("glTF: index out of range of the POSITION count");
+
+        const bool usable = (indices.componentType == kUnsignedShort || indices.componentType == kUnsignedInt) &&
+                            indices.tightlyPacked() && alignedFor(indices, 4);
+        primitive.indexCount = indices.count;
+        primitive.indexSize = indices.componentType == kUnsignedInt ? 4 : 2;
+        const uint32_t indexSize = primitive.indexSize;
+        reader.fill(primitive.indices, indices, usable, indexSize, [&](const uint8_t *src, uint8_t *dst) {
+            const uint32_t index = readIndex(src, indices.componentType);
+            if (indexSize == 2)
+            {
+                const uint16_t narrow = static_cast<uint16_t>(index);
+                std::memcpy(dst, &narrow, 2);
+            }
+            else
+            {
+                std::memcpy(dst, &index, 4);
+            }
+        });
+    }
+    return primitive;
+}
+
+Eigen::Matrix4f readLocalMatrix(const JsonValue &node)
+{
+    Eigen::Matrix4f local = Eigen::Matrix4f::Identity();
+
+    const std::vector<JsonValue> &matrix = node.arrayOf("matrix");
+    if (matrix.size() == 16)
+    {
+        for (int i = 0; i < 16; ++i)
+            local(i % 4, i / 4) = static_cast<float>(matrix[i].number);       // column major
+        return local;
+    }
+
+    const std::vector<JsonValue> &t = node.arrayOf("translation");
+    const std::vector<JsonValue> &r = node.arrayOf("rotation");
+    const std::vector<JsonValue> &s = node.arrayOf("scale");
+
+    Eigen::Affine3f trs = Eigen::Affine3f::Identity();
+    if (t.size() == 3)
+        trs.translate(Eigen::Vector3f(t[0].number, t[1].number, t[2].number));
+    if (r.size() == 4)      // glTF stores xyzw, Eigen's constructor takes wxyz
+        trs.rotate(Eigen::Quaternionf(r[3].number, r[0].number, r[1].number, r[2].number).normalized());
+    if (s.size() == 3)
+        trs.scale(Eigen::Vector3f(s[0].number, s[1].number, s[2].number));
+    return trs.matrix();
+}
+
+size_t peakResidentBytes()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);            // bytes
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;     // kilobytes
+#endif
+}
+
+uint32_t readU32(const uint8_t *p)
+{
+    uint32_t value;
+    std::memcpy(&value, p, 4);
+    return value;
+}
+} // namespace
+
+/*
+-------------------------------------------------------------------
+  LOADING  ---------------------------------------------------------
+-------------------------------------------------------------------
+*/
+std::shared_ptr<const GltfAsset> loadGlb(const std::string &path)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    auto asset = std::make_shared<GltfAsset>();
+    asset->file = MappedFile(path);
+    const auto *bytes = reinterpret_cast<const uint8_t *>(asset->file.data());
+    const size_t size = asset->file.size();
+
+    // 12-byte header, then a JSON chunk and an optional BIN chunk, each with an 8-byte chunk header
+    if (size < 20 || readU32(bytes) != 0x46546C67u /* "glTF" */ || readU32(bytes + 4) != 2)
+        throw std::runtime_error("glTF: " + path + " is not a version 2 .glb");
+    const size_t length = std::min<size_t>(readU32(bytes + 8), size);
+
+    const size_t jsonLength = readU32(bytes + 12);
+    if (readU32(bytes + 16) != 0x4E4F534Au /* "JSON" */ || 20 + jsonLength > length)
+        throw std::runtime_error("glTF: missing JSON chunk");
+    const char *jsonBegin = reinterpret_cast<const char *>(bytes + 20);
+
+    size_t binOffset = 0;
+    size_t binSize = 0;
+    const size_t binHeader = 20 + jsonLength;
+    if (binHeader + 8 <= length && readU32(bytes + binHeader + 4) == 0x004E4942u /* "BIN\0" */)
+    {
+        binOffset = binHeader + 8;
+        binSize = std::min<size_t>(readU32(bytes + binHeader), length - binOffset);
+    }
+
+    const JsonValue root = JsonParser(jsonBegin, jsonBegin + jsonLength).parseDocument();
+    GlbReader reader(root, bytes, binOffset, binSize, asset->stats);
+
+    for (const JsonValue &mesh : root.arrayOf("meshes"))
+    {
+        GltfMesh &out = asset->meshes.emplace_back();
+        out.name = mesh.stringOr("name", "");
+        for (const JsonValue &primitive : mesh.arrayOf("primitives"))
+            out.primitives.push_back(readPrimitive(reader, primitive));
+    }
+
+    /*
+        Nodes: local matrices, parent links, then world matrices top-down from the scene roots
+    */
+    const std::vector<JsonValue> &nodes = root.arrayOf("nodes");
+    asset->nodes.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        GltfNode &node = asset->nodes[i];
+        node.name = nodes[i].stringOr("name", "");
+        node.mesh = nodes[i].intOr("mesh", -1);
+        if (node.mesh >= static_cast<int>(asset->meshes.size()))
+            throw std::runtime_error("glTF: node mesh index out of range");
+        node.local = readLocalMatrix(nodes[i]);
+        for (const JsonValue &child : nodes[i].arrayOf("children"))
+        {
+            const int index = child.asInt("children");
+            if (index < 0 || static_cast<size_t>(index) >= nodes.size() || asset->nodes[index].parent >= 0)
+                throw std::runtime_error("glTF: invalid node hierarchy");
+            node.children.push_back(index);
+            asset->nodes[index].parent = static_cast<int>(i);
+        }
+    }
+
+    const std::vector<JsonValue> &scenes = root.arrayOf("scenes");
+    const int sceneIndex = root.intOr("scene", 0);
+    if (sceneIndex >= 0 && static_cast<size_t>(sceneIndex) < scenes.size())
+    {
+        for (const JsonValue &node : scenes[sceneIndex].arrayOf("nodes"))
+            asset->roots.push_back(node.asInt("nodes"));
+    }
+    else
+    {
+        for (size_t i = 0; i < asset->nodes.size(); ++i)
+            if (asset->nodes[i].parent < 0)
+                asset->roots.push_back(static_cast<int>(i));
+    }
+
+    std::vector<int> stack(asset->roots.rbegin(), asset->roots.rend());
+    size_t visited = 0;
+    while (!stack.empty())
+    {
+        const int index = stack.back();
+        stack.pop_back();
+        if (index < 0 || static_cast<size_t>(index) >= asset->nodes.size() || ++visited > asset->nodes.size())
+            throw std::runtime_error("glTF: invalid scene node");
+
+        GltfNode &node = asset->nodes[index];
+        node.world = node.parent >= 0 ? Eigen::Matrix4f(asset->nodes[node.parent].world * node.local) : node.local;
+        stack.insert(stack.end(), node.children.rbegin(), node.children.rend());
+    }
+
+    asset->stats.bytes = size;
+    asset->stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    asset->stats.peakResidentBytes = peakResidentBytes();
+    return asset;
+}
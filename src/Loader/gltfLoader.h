@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <eigen/Eigen/Dense>
+
+#include "mappedFile.h"
+#include "../VertexFormat/vertexFormat.h"
+#include "../Culling/bounds.h"
+
+/*
+-------------------------------------------------------------------
+  GLB LOADER  ------------------------------------------------------
+
+  Binary glTF 2.0 (.glb, single embedded buffer) into GPU-ready streams.
+
+  The file stays mapped for the lifetime of the asset. An accessor whose
+  bytes already match what vertex_main_quantized reads is used in place
+  (zero copy), everything else is converted once into an owned stream:
+    POSITION  float VEC3, tightly packed      -> PackedFloat3 in place
+    COLOR_0   float VEC4 / normalized ubyte VEC4, tightly packed
+                                              -> Float4 / Unorm8x4 in place
+              other types, VEC3               -> converted to Unorm8x4
+    indices   ushort / uint                   -> in place
+              ubyte                           -> converted to ushort
+  Interleaved (strided) views are always converted.
+
+  Node hierarchies are flattened: every node gets its world matrix from
+  its TRS or matrix and its parents'. Triangle-list primitives only;
+  sparse accessors and external buffers are rejected.
+-------------------------------------------------------------------
+*/
+struct GltfStream
+{
+    const uint8_t *data{nullptr};       // Into the mapping, or owned.data()
+    size_t byteSize{0};
+    size_t fileOffset{0};               // Offset into the mapping when zeroCopy
+    bool zeroCopy{false};
+    std::vector<uint8_t> owned;
+
+    bool empty() const { return byteSize == 0; }
+};
+
+struct GltfPrimitive
+{
+    size_t vertexCount{0};
+    GltfStream positions;               // packed float3
+    GltfStream colors;                  // colorFormat per vertex, empty when the source has none
+    ColorFormat colorFormat{ColorFormat::Unorm8x4};
+
+    GltfStream indices;                 // empty for non-indexed primitives
+    size_t indexCount{0};
+    uint32_t indexSize{2};              // 2 or 4 bytes
+
+    Aabb bounds;                        // From the POSITION accessor's min/max
+};
+
+struct GltfMesh
+{
+    std::string name;
+    std::vector<GltfPrimitive> primitives;
+};
+
+struct GltfNode
+{
+    std::string name;
+    int mesh{-1};
+    int parent{-1};
+    std::vector<int> children;
+    Eigen::Matrix4f local{Eigen::Matrix4f::Identity()};     // T * R * S, or the node's matrix
+    Eigen::Matrix4f world{Eigen::Matrix4f::Identity()};
+};
+
+struct GltfLoadStats
+{
+    size_t bytes{0};
+    size_t zeroCopyBytes{0};            // Stream bytes used straight from the mapping
+    size_t convertedBytes{0};           // Stream bytes that had to be rewritten
+    double seconds{0.0};
+    size_t peakResidentBytes{0};        // Process high-water mark after loading (getrusage)
+};
+
+struct GltfAsset
+{
+    MappedFile file;
+    std::vector<GltfMesh> meshes;
+    std::vector<GltfNode> nodes;
+    std::vector<int> roots;             // Nodes of the default scene
+    GltfLoadStats stats;
+};
+
+/**
+ * @brief Maps and parses a .glb file.
+ *
+ * Streams point into the returned asset, so it is shared with whatever uploads them.
+ * Throws std::runtime_error on malformed or unsupported files, including sizes and offsets that
+ * aren't non-negative integers, views outside the BIN chunk and indices past the POSITION count.
+ */
+std::shared_ptr<const GltfAsset> loadGlb(const std::string &path);
@@ -0,0 +1,90 @@
+#include "mappedFile.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open " + path);
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat " + path);
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0)
+    {
+        void *mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            ::close(fd);
+            length = 0;
+            throw std::runtime_error("Failed to map " + path);
+        }
+        bytes = static_cast<const char *>(mapping);
+    }
+    ::close(fd);        // The mapping keeps its own reference to the file
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)), length(std::exchange(other.length, 0))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        unmap();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+size_t MappedFile::pageAlignedSize() const
+{
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return (length + page - 1) / page * page;
+}
+
+void MappedFile::adviseSequential() const
+{
+    if (bytes)
+        ::madvise(const_cast<char *>(bytes), length, MADV_SEQUENTIAL);
+}
+
+void MappedFile::prefetch() const
+{
+    if (!bytes)
+        return;
+    ::madvise(const_cast<char *>(bytes), length, MADV_WILLNEED);
+
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    volatile char sink = 0;
+    for (size_t offset = 0; offset < length; offset += page)
+        sink = sink + bytes[offset];
+}
+
+void MappedFile::unmap()
+{
+    if (bytes)
+        ::munmap(const_cast<char *>(bytes), length);
+    bytes = nullptr;
+    length = 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/*
+-------------------------------------------------------------------
+  MAPPED FILE  -----------------------------------------------------
+
+  Read-only memory map of a whole file (POSIX mmap). Pages are faulted
+  in on first touch, so loaders can hand parts of the mapping straight
+  to the GPU or to worker threads without reading the file up front.
+  Move-only; unmaps on destruction.
+-------------------------------------------------------------------
+*/
+class MappedFile final {
+public:
+    MappedFile() = default;
+
+    // Throws std::runtime_error when the file can't be opened or mapped
+    explicit MappedFile(const std::string &path);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return bytes; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    // Size rounded up to whole pages; the tail past size() reads as zeros (e.g. for no-copy GPU buffers)
+    size_t pageAlignedSize() const;
+
+    // Hint that the mapping will be read front to back (madvise SEQUENTIAL)
+    void adviseSequential() const;
+
+    // Faults every page in now (one read per page), so later readers don't stall on the disk
+    void prefetch() const;
+
+private:
+    const char *bytes{nullptr};
+    size_t length{0};
+
+    void unmap();
+};
@@ -0,0 +1,351 @@
+#include "meshCache.h"
+#include "../MeshOptimizer/meshOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::is_trivially_copyable_v<MeshCacheHeader> && sizeof(MeshCacheHeader) % 16 == 0,
+              "MeshCacheHeader is written as raw bytes and keeps the sections aligned");
+static_assert(sizeof(Position) == 16 && sizeof(Color) == 16 && sizeof(LodLevel) == 12,
+              "Cache sections are raw arrays of these types");
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+
+inline uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t round64(uint64_t accumulator, uint64_t input)
+{
+    return rotl(accumulator + input * kPrime2, 31) * kPrime1;
+}
+
+inline uint64_t align16(uint64_t offset)
+{
+    return (offset + 15) & ~uint64_t{15};
+}
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+} // namespace
+
+/*
+-------------------------------------------------------------------
+  HASH  ------------------------------------------------------------
+-------------------------------------------------------------------
+*/
+uint64_t hashBytes(const void *data, size_t size)
+{
+    const auto *p = static_cast<const uint8_t *>(data);
+    const uint8_t *end = p + size;
+
+    // Four lanes keep four multiplies in flight per 32 bytes
+    uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+    for (; end - p >= 32; p += 32)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            uint64_t word;
+            std::memcpy(&word, p + lane * 8, 8);
+            lanes[lane] = round64(lanes[lane], word);
+        }
+    }
+
+    uint64_t h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18) + size;
+    for (; end - p >= 8; p += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = rotl(h ^ round64(0, word), 27) * kPrime1 + kPrime3;
+    }
+    for (; p < end; ++p)
+        h = rotl(h ^ (*p * kPrime3), 11) * kPrime1;
+
+    // Final avalanche
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+/*
+-------------------------------------------------------------------
+  READ  ------------------------------------------------------------
+-------------------------------------------------------------------
+*/
+std::optional<MeshCacheView> openMeshCache(const std::string &path, uint64_t sourceHash, uint64_t sourceSize,
+                                           uint32_t flags)
+{
+    MeshCacheView view;
+    try
+    {
+        view.file = MappedFile(path);
+    }
+    catch (const std::runtime_error &)
+    {
+        return std::nullopt;        // No cache yet
+    }
+
+    const size_t size = view.file.size();
+    if (size < sizeof(MeshCacheHeader))
+        return std::nullopt;
+
+    // mmap returns page-aligned memory, so the header and 16-byte aligned sections can be used in place
+    const auto *header = reinterpret_cast<const MeshCacheHeader *>(view.file.data());
+    if (header->magic != kMeshCacheMagic || header->version != kMeshCacheVersion ||
+        header->sourceHash != sourceHash || header->sourceSize != sourceSize || header->flags != flags ||
+        header->fileSize != size)
+        return std::nullopt;
+
+    const auto inBounds = [size](uint64_t offset, uint64_t count, size_t elementSize) {
+        return offset % 16 == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+    const bool hasColors = flags & kMeshCacheColors;
+    if (!inBounds(header->positionsOffset, header->vertexCount, sizeof(Position)) ||
+        (hasColors && !inBounds(header->colorsOffset, header->vertexCount, sizeof(Color))) ||
+        !inBounds(header->indicesOffset, header->indexCount, sizeof(uint32_t)) ||
+        !inBounds(header->levelsOffset, header->levelCount, sizeof(LodLevel)) || header->levelCount == 0)
+        return std::nullopt;
+
+    const char *base = view.file.data();
+    view.header = header;
+    view.positions = reinterpret_cast<const Position *>(base + header->positionsOffset);
+    view.colors = hasColors ? reinterpret_cast<const Color *>(base + header->colorsOffset) : nullptr;
+    view.indices = reinterpret_cast<const uint32_t *>(base + header->indicesOffset);
+    view.levels = reinterpret_cast<const LodLevel *>(base + header->levelsOffset);
+
+    for (uint32_t i = 0; i < header->levelCount; ++i)
+    {
+        const LodLevel &level = view.levels[i];
+        if (uint64_t{level.indexOffset} + level.indexCount > header->indexCount || level.indexCount % 3 != 0)
+            return std::nullopt;
+    }
+
+    // The indices are drawn straight from the mapping; one past the vertices would read outside the stream
+    const uint32_t vertexCount = header->vertexCount;
+    if (std::any_of(view.indices, view.indices + header->indexCount, [vertexCount](uint32_t index) { return index >= vertexCount; }))
+        return std::nullopt;
+    return view;
+}
+
+BakedMesh MeshCacheView::toBakedMesh() const
+{
+    BakedMesh baked;
+    baked.bounds = header->bounds;
+
+    baked.mesh.positions.assign(positions, positions + header->vertexCount);
+    if (colors)
+        baked.mesh.colors.assign(colors, colors + header->vertexCount);
+
+    baked.lods.indices.assign(indices, indices + header->indexCount);
+    baked.lods.levels.assign(levels, levels + header->levelCount);
+    baked.lods.boundingRadius = header->lodBoundingRadius;
+
+    // LOD 0 is the optimized full-detail index list
+    baked.mesh.indices.assign(indices + levels[0].indexOffset, indices + levels[0].indexOffset + levels[0].indexCount);
+    return baked;
+}
+
+std::span<const Position> BakedMesh::positions() const
+{
+    return cache ? std::span<const Position>(cache->positions, cache->header->vertexCount)
+                 : std::span<const Position>(mesh.positions);
+}
+
+std::span<const Color> BakedMesh::colors() const
+{
+    if (cache)
+        return cache->colors ? std::span<const Color>(cache->colors, cache->header->vertexCount) : std::span<const Color>();
+    return mesh.colors;
+}
+
+std::span<const uint32_t> BakedMesh::lodIndices() const
+{
+    return cache ? std::span<const uint32_t>(cache->indices, cache->header->indexCount)
+                 : std::span<const uint32_t>(lods.indices);
+}
+
+std::span<const uint32_t> BakedMesh::indices() const
+{
+    if (!cache)
+        return mesh.indices;
+    return lodIndices().subspan(lods.levels[0].indexOffset, lods.levels[0].indexCount);
+}
+
+/*
+-------------------------------------------------------------------
+  WRITE  -----------------------------------------------------------
+-------------------------------------------------------------------
+*/
+uint64_t writeMeshCache(const std::string &path, uint64_t sourceHash, uint64_t sourceSize, uint32_t flags,
+                        const BakedMesh &baked)
+{
+    const MeshData &mesh = baked.mesh;
+    if (mesh.positions.size() > UINT32_MAX || baked.lods.indices.size() > UINT32_MAX || baked.lods.levels.empty())
+        throw std::runtime_error("Mesh cache: mesh too large or missing LOD 0");
+
+    MeshCacheHeader header;
+    header.sourceHash = sourceHash;
+    header.sourceSize = sourceSize;
+    header.flags = flags;
+    header.vertexCount = static_cast<uint32_t>(mesh.positions.size());
+    header.indexCount = static_cast<uint32_t>(baked.lods.indices.size());
+    header.levelCount = static_cast<uint32_t>(baked.lods.levels.size());
+    header.bounds = baked.bounds;
+    header.lodBoundingRadius = baked.lods.boundingRadius;
+
+    uint64_t offset = sizeof(MeshCacheHeader);
+    header.positionsOffset = offset;
+    offset = align16(offset + mesh.positions.size() * sizeof(Position));
+    if (flags & kMeshCacheColors)
+    {
+        header.colorsOffset = offset;
+        offset = align16(offset + mesh.colors.size() * sizeof(Color));
+    }
+    header.indicesOffset = offset;
+    offset = align16(offset + baked.lods.indices.size() * sizeof(uint32_t));
+    header.levelsOffset = offset;
+    header.fileSize = offset + baked.lods.levels.size() * sizeof(LodLevel);
+
+    // A unique temporary next to the target, so concurrent writers of one cache never share a file
+    std::string temporary = path + ".XXXXXX";
+    const int fd = mkstemp(temporary.data());
+    if (fd < 0)
+        throw std::runtime_error("Mesh cache: failed to create a temporary file for " + path);
+    fchmod(fd, 0644);       // mkstemp creates it owner-only
+    FILE *out = fdopen(fd, "wb");
+    if (!out)
+    {
+        close(fd);
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Mesh cache: failed to open " + temporary);
+    }
+
+    bool ok = true;
+    uint64_t position = 0;
+    const auto writeSection = [&](uint64_t at, const void *data, size_t bytes) {
+        static const char zeros[16] = {};
+        const size_t padding = static_cast<size_t>(at - position);     // alignment padding
+        ok = ok && std::fwrite(zeros, 1, padding, out) == padding;
+        ok = ok && (bytes == 0 || std::fwrite(data, 1, bytes, out) == bytes);
+        position = at + bytes;
+    };
+    writeSection(0, &header, sizeof(header));
+    writeSection(header.positionsOffset, mesh.positions.data(), mesh.positions.size() * sizeof(Position));
+    if (flags & kMeshCacheColors)
+        writeSection(header.colorsOffset, mesh.colors.data(), mesh.colors.size() * sizeof(Color));
+    writeSection(header.indicesOffset, baked.lods.indices.data(), baked.lods.indices.size() * sizeof(uint32_t));
+    writeSection(header.levelsOffset, baked.lods.levels.data(), baked.lods.levels.size() * sizeof(LodLevel));
+
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok)
+    {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Mesh cache: failed to write " + temporary);
+    }
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Mesh cache: failed to move " + temporary + " into place");
+    }
+    return header.fileSize;
+}
+
+/*
+-------------------------------------------------------------------
+  LOAD  ------------------------------------------------------------
+-------------------------------------------------------------------
+*/
+BakedMesh loadMeshCached(const std::string &sourcePath, const MeshImporter &importer, bool generateLods,
+                         MeshCacheStats *stats)
+{
+    const MappedFile source(sourcePath);
+    return loadMeshCached(sourcePath, source.data(), source.size(), importer, generateLods, stats);
+}
+
+BakedMesh loadMeshCached(const std::string &sourcePath, const char *sourceData, size_t sourceSize,
+                         const MeshImporter &importer, bool generateLods, MeshCacheStats *stats)
+{
+    MeshCacheStats local;
+    MeshCacheStats &s = stats ? *stats : local;
+    s = {};
+
+    auto start = Clock::now();
+    const uint64_t sourceHash = hashBytes(sourceData, sourceSize);
+    s.hashSeconds = secondsSince(start);
+    s.sourceBytes = sourceSize;
+
+    const std::string cachePath = sourcePath + ".meshcache";
+    const uint32_t lodFlag = generateLods ? uint32_t{kMeshCacheLods} : 0u;
+
+    // Colors are part of the key only through the cached flags, so try both variants
+    start = Clock::now();
+    for (uint32_t colorFlag : {uint32_t{kMeshCacheColors}, uint32_t{0}})
+    {
+        if (std::optional<MeshCacheView> view = openMeshCache(cachePath, sourceHash, sourceSize, lodFlag | colorFlag))
+        {
+            s.hit = true;
+            s.cacheBytes = view->file.size();
+
+            // Only the level table is copied; the sections stay in the mapping for a no-copy upload
+            BakedMesh baked;
+            baked.bounds = view->header->bounds;
+            baked.lods.levels.assign(view->levels, view->levels + view->header->levelCount);
+            baked.lods.boundingRadius = view->header->lodBoundingRadius;
+            baked.cache = std::make_shared<const MeshCacheView>(std::move(*view));
+            s.loadSeconds = secondsSince(start);
+            return baked;
+        }
+    }
+
+    // Miss: import, bake, write
+    BakedMesh baked;
+    baked.mesh = importer(sourceData, sourceSize);
+    if (baked.mesh.positions.empty() || baked.mesh.indices.empty())
+        throw std::runtime_error("Mesh cache: " + sourcePath + " has no triangles");
+
+    optimizeMesh(baked.mesh);
+    if (generateLods)
+    {
+        baked.lods = buildLodChain(baked.mesh);
+    }
+    else
+    {
+        baked.lods.indices = baked.mesh.indices;
+        baked.lods.levels.push_back({0, static_cast<uint32_t>(baked.mesh.indices.size()), 0.0f});
+    }
+    baked.bounds = computeBounds(&baked.mesh.positions.data()->x, baked.mesh.positions.size());
+
+    const uint32_t flags = lodFlag | (baked.mesh.colors.empty() ? 0u : uint32_t{kMeshCacheColors});
+    try
+    {
+        s.cacheBytes = writeMeshCache(cachePath, sourceHash, sourceSize, flags, baked);
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cerr << error.what() << std::endl;
+    }
+    s.loadSeconds = secondsSince(start);
+    return baked;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "mappedFile.h"
+#include "../common/meshData.h"
+#include "../MeshOptimizer/meshSimplifier.h"
+#include "../Culling/bounds.h"
+
+/*
+-------------------------------------------------------------------
+  MESH CACHE  ------------------------------------------------------
+
+  Baked, ready-to-upload meshes stored next to their source asset
+  (<source>.meshcache) so later runs skip parsing and optimization.
+
+  Layout (little endian, every section 16-byte aligned):
+    MeshCacheHeader
+    positions   vertexCount   x Position (xyzw float)
+    colors      vertexCount   x Color    (only with kMeshCacheColors)
+    indices     indexCount    x uint32   (whole LOD chain, finest first)
+    levels      levelCount    x LodLevel
+
+  A cache is used only when its version, bake flags and the 64-bit hash
+  and size of the source bytes all match and every index names a vertex;
+  anything else re-bakes. A hit is handed out in place: the sections are
+  uploaded from the mapping without a copy.
+-------------------------------------------------------------------
+*/
+constexpr uint32_t kMeshCacheMagic = 0x4348534Du;   // "MSHC"
+constexpr uint32_t kMeshCacheVersion = 1;
+
+enum MeshCacheFlags : uint32_t
+{
+    kMeshCacheColors = 1u << 0,
+    kMeshCacheLods = 1u << 1,
+};
+
+struct MeshCacheHeader
+{
+    uint32_t magic{kMeshCacheMagic};
+    uint32_t version{kMeshCacheVersion};
+    uint64_t sourceHash{0};
+    uint64_t sourceSize{0};
+    uint32_t flags{0};
+    uint32_t vertexCount{0};
+    uint32_t indexCount{0};
+    uint32_t levelCount{0};
+    Bounds bounds;
+    float lodBoundingRadius{0.0f};
+    uint32_t reserved{0};
+    uint64_t positionsOffset{0};
+    uint64_t colorsOffset{0};
+    uint64_t indicesOffset{0};
+    uint64_t levelsOffset{0};
+    uint64_t fileSize{0};
+};
+
+struct MeshCacheView;
+
+// Source geometry plus everything derived from it at bake time
+struct BakedMesh
+{
+    MeshData mesh;                      // Optimized; indices are LOD 0
+    LodChain lods;
+    Bounds bounds;
+
+    // Set on a cache hit instead of the owned sections: `mesh` and `lods.indices` stay empty and the
+    // data is read from the mapping (`lods.levels`, `lods.boundingRadius` and `bounds` are filled)
+    std::shared_ptr<const MeshCacheView> cache;
+
+    // The geometry to upload, owned or in the cache
+    std::span<const Position> positions() const;
+    std::span<const Color> colors() const;          // Empty without vertex colors
+    std::span<const uint32_t> lodIndices() const;   // The whole LOD chain, finest first
+    std::span<const uint32_t> indices() const;      // LOD 0
+};
+
+// Read-only view straight into a mapped cache file
+struct MeshCacheView
+{
+    MappedFile file;
+    const MeshCacheHeader *header{nullptr};
+    const Position *positions{nullptr};
+    const Color *colors{nullptr};       // nullptr without kMeshCacheColors
+    const uint32_t *indices{nullptr};
+    const LodLevel *levels{nullptr};
+
+    // Owned copy of every section
+    BakedMesh toBakedMesh() const;
+};
+
+struct MeshCacheStats
+{
+    bool hit{false};
+    size_t sourceBytes{0};
+    size_t cacheBytes{0};
+    double hashSeconds{0.0};
+    double loadSeconds{0.0};            // Cache read on a hit, import + bake + write on a miss
+};
+
+/**
+ * @brief 64-bit content hash (four independent multiply-rotate lanes, ~memory speed).
+ */
+uint64_t hashBytes(const void *data, size_t size);
+
+/**
+ * @brief Maps `path` and validates it against the source; empty when missing, stale or corrupt.
+ *
+ * Corrupt includes any index at or past the vertex count, so the sections are safe to draw as they are.
+ */
+std::optional<MeshCacheView> openMeshCache(const std::string &path, uint64_t sourceHash, uint64_t sourceSize,
+                                           uint32_t flags);
+
+/**
+ * @brief Writes a cache file atomically (uniquely named temporary file + rename).
+ *
+ * Throws std::runtime_error on I/O errors.
+ *
+ * @return Size of the written file in bytes.
+ */
+uint64_t writeMeshCache(const std::string &path, uint64_t sourceHash, uint64_t sourceSize, uint32_t flags,
+                        const BakedMesh &baked);
+
+using MeshImporter = std::function<MeshData(const char *data, size_t size)>;
+
+/**
+ * @brief Loads `sourcePath` through its cache, baking (optimize + optional LODs) and writing it on a miss.
+ *
+ * `importer` parses the mapped source bytes, e.g. parseObj. A cache that can't be written is
+ * reported and skipped; the baked mesh is returned either way, in place on a hit (see BakedMesh::cache).
+ */
+BakedMesh loadMeshCached(const std::string &sourcePath, const MeshImporter &importer, bool generateLods,
+                         MeshCacheStats *stats = nullptr);
+
+/**
+ * @brief Same, for source bytes the caller already has in memory (e.g. mapped and prefetched elsewhere).
+ */
+BakedMesh loadMeshCached(const std::string &sourcePath, const char *sourceData, size_t sourceSize,
+                         const MeshImporter &importer, bool generateLods, MeshCacheStats *stats = nullptr);
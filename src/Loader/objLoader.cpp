@@ -0,0 +1,475 @@
+#include "objLoader.h"
+#include "mappedFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Relative (negative) face indices are stored as (chunk-local target - kRelativeBias) until the
+// chunk's first global vertex is known; real indices are never that large (parseInt clamps there)
+constexpr int64_t kRelativeBias = int64_t{1} << 48;
+
+constexpr Color kDefaultColor{1.0f, 1.0f, 1.0f, 1.0f};
+
+struct ObjChunk
+{
+    const char *begin{nullptr};
+    const char *end{nullptr};
+
+    std::vector<Position> positions;
+    std::vector<Color> colors;          // One per position
+    std::vector<int64_t> corners;       // Triangulated, 0-based global or biased relative
+    bool hasColors{false};
+    std::exception_ptr error;
+};
+
+/*
+-------------------------------------------------------------------
+  NUMBER PARSING  --------------------------------------------------
+-------------------------------------------------------------------
+*/
+inline bool isDigit(char c)
+{
+    return static_cast<unsigned>(c - '0') < 10u;
+}
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+inline const char *skipBlanks(const char *p, const char *end)
+{
+    while (p < end && isBlank(*p))
+        ++p;
+    return p;
+}
+
+inline const char *skipToken(const char *p, const char *end)
+{
+    while (p < end && !isBlank(*p) && *p != '\n' && *p != '\r')
+        ++p;
+    return p;
+}
+
+// Anything the fast path doesn't understand (nan, inf, hex floats): copy the token and use strtof
+bool parseFloatSlow(const char *&p, const char *end, float &out)
+{
+    char buffer[64];
+    const size_t length = std::min<size_t>(skipToken(p, end) - p, sizeof(buffer) - 1);
+    std::memcpy(buffer, p, length);
+    buffer[length] = '\0';
+
+    char *parsed = nullptr;
+    out = std::strtof(buffer, &parsed);
+    if (parsed == buffer)
+        return false;
+    p += parsed - buffer;
+    return true;
+}
+
+/*
+    Decimal mantissa accumulated into 64 bits (first 19 significant digits), scaled by an exact power
+    of ten when |exponent| <= 22 so the double result is correctly rounded before narrowing to float.
+*/
+bool parseFloat(const char *&p, const char *end, float &out)
+{
+    static constexpr double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+
+    for (; p < end && isDigit(*p); ++p, any = true)
+    {
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            digits += mantissa != 0;
+        }
+        else
+        {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && isDigit(*p); ++p, any = true)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                digits += mantissa != 0;
+                --exponent;
+            }
+        }
+    }
+    if (!any)
+    {
+        p = start;
+        return parseFloatSlow(p, end, out);
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *mark = p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negativeExponent = *p++ == '-';
+        if (p < end && isDigit(*p))
+        {
+            int value = 0;
+            for (; p < end && isDigit(*p); ++p)
+                value = std::min(value * 10 + (*p - '0'), 10000);
+            exponent += negativeExponent ? -value : value;
+        }
+        else
+        {
+            p = mark;       // "1e" is the number 1 followed by junk
+        }
+    }
+
+    double value = static_cast<double>(mantissa);
+    if (mantissa == 0)
+        value = 0.0;
+    else if (exponent >= 0 && exponent <= 22)
+        value *= kPow10[exponent];
+    else if (exponent < 0 && exponent >= -22)
+        value /= kPow10[-exponent];
+    else
+        value *= std::pow(10.0, exponent);
+
+    out = static_cast<float>(negative ? -value : value);
+    return true;
+}
+
+bool parseInt(const char *&p, const char *end, int64_t &out)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    if (p >= end || !isDigit(*p))
+        return false;
+
+    // Clamped, so a run of digits can't overflow; anything past the bias is out of range anyway
+    int64_t value = 0;
+    for (; p < end && isDigit(*p); ++p)
+        value = std::min(value * 10 + (*p - '0'), kRelativeBias);
+    out = negative ? -value : value;
+    return true;
+}
+
+/*
+-------------------------------------------------------------------
+  CHUNK PARSING  ---------------------------------------------------
+-------------------------------------------------------------------
+*/
+[[noreturn]] void throwParseError(const char *what, const char *line, const char *end)
+{
+    const char *lineEnd = std::find(line, end, '\n');
+    throw std::runtime_error(std::string("OBJ: ") + what + " in \"" +
+                             std::string(line, std::min<size_t>(lineEnd - line, 80)) + "\"");
+}
+
+void parseVertex(ObjChunk &chunk, const char *&p, const char *end, const char *line)
+{
+    float values[7];
+    int count = 0;
+    for (p = skipBlanks(p, end); count < 7 && p < end && *p != '\n' && *p != '\r' && *p != '#';
+         p = skipBlanks(p, end))
+    {
+        if (!parseFloat(p, end, values[count]))
+            throwParseError("bad number", line, end);
+        ++count;
+    }
+    if (count < 3)
+        throwParseError("vertex with fewer than 3 coordinates", line, end);
+
+    chunk.positions.push_back(Position{values[0], values[1], values[2], 1.0f});
+    if (count >= 6)
+    {
+        // x y z r g b [a]
+        chunk.colors.push_back(Color{values[3], values[4], values[5], count == 7 ? values[6] : 1.0f});
+        chunk.hasColors = true;
+    }
+    else
+    {
+        chunk.colors.push_back(kDefaultColor);
+    }
+}
+
+void parseFace(ObjChunk &chunk, const char *&p, const char *end, const char *line)
+{
+    const int64_t localCount = static_cast<int64_t>(chunk.positions.size());
+    int64_t first = 0;
+    int64_t previous = 0;
+    int corner = 0;
+
+    for (p = skipBlanks(p, end); p < end && *p != '\n' && *p != '\r' && *p != '#'; p = skipBlanks(p, end))
+    {
+        int64_t index = 0;
+        if (!parseInt(p, end, index) || index == 0)
+            throwParseError("bad face index", line, end);
+        p = skipToken(p, end);      // drop /vt/vn
+
+        const int64_t stored = index > 0 ? index - 1 : localCount + index - kRelativeBias;
+        if (corner == 0)
+        {
+            first = stored;
+        }
+        else if (corner >= 2)
+        {
+            chunk.corners.push_back(first);
+            chunk.corners.push_back(previous);
+            chunk.corners.push_back(stored);
+        }
+        previous = stored;
+        ++corner;
+    }
+}
+
+void parseChunk(ObjChunk &chunk)
+{
+    const char *p = chunk.begin;
+    const char *end = chunk.end;
+
+    // Rough reservation: a typical mesh has ~2 faces per vertex and ~30 bytes per line
+    const size_t estimatedLines = static_cast<size_t>(end - p) / 30;
+    chunk.positions.reserve(estimatedLines / 3);
+    chunk.colors.reserve(estimatedLines / 3);
+    chunk.corners.reserve(estimatedLines * 2);
+
+    while (p < end)
+    {
+        const char *line = p;
+        p = skipBlanks(p, end);
+        if (p + 1 < end && isBlank(p[1]))
+        {
+            if (*p == 'v')
+            {
+                p += 2;
+                parseVertex(chunk, p, end, line);
+            }
+            else if (*p == 'f')
+            {
+                p += 2;
+                parseFace(chunk, p, end, line);
+            }
+        }
+        p = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        p = p ? p + 1 : end;
+    }
+}
+
+/*
+-------------------------------------------------------------------
+  DEDUPLICATION  ---------------------------------------------------
+-------------------------------------------------------------------
+*/
+// Open-addressing table of output vertex ids keyed by the position/color bit patterns
+class VertexDeduplicator
+{
+public:
+    VertexDeduplicator(MeshData &mesh, size_t expected) : mesh(mesh)
+    {
+        size_t capacity = 16;
+        while (capacity < expected * 2)
+            capacity *= 2;
+        slots.assign(capacity, kEmpty);
+        mask = capacity - 1;
+    }
+
+    uint32_t insert(const Position &position, const Color &color)
+    {
+        for (size_t slot = hash(position, color) & mask;; slot = (slot + 1) & mask)
+        {
+            const uint32_t id = slots[slot];
+            if (id == kEmpty)
+            {
+                slots[slot] = static_cast<uint32_t>(mesh.positions.size());
+                mesh.positions.push_back(position);
+                mesh.colors.push_back(color);
+                return slots[slot];
+            }
+            if (std::memcmp(&mesh.positions[id], &position, sizeof(Position)) == 0 &&
+                std::memcmp(&mesh.colors[id], &color, sizeof(Color)) == 0)
+                return id;
+        }
+    }
+
+private:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    MeshData &mesh;
+    std::vector<uint32_t> slots;
+    size_t mask{0};
+
+    static size_t hash(const Position &position, const Color &color)
+    {
+        uint32_t words[8];
+        std::memcpy(words, &position, sizeof(Position));
+        std::memcpy(words + 4, &color, sizeof(Color));
+        uint64_t h = 0x9e3779b97f4a7c15ull;
+        for (uint32_t word : words)
+            h = (h ^ word) * 0xff51afd7ed558ccdull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+};
+
+unsigned workerCount(const ObjLoadOptions &options, size_t size)
+{
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned threads = options.threads ? options.threads : hardware;
+    const size_t bySize = std::max<size_t>(1, size / std::max<size_t>(1, options.minChunkBytes));
+    return static_cast<unsigned>(std::min<size_t>(threads, bySize));
+}
+
+template <typename Fn>
+void runParallel(unsigned count, Fn &&fn)
+{
+    if (count == 1)
+    {
+        fn(0u);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+        workers.emplace_back(fn, i);
+    for (std::thread &worker : workers)
+        worker.join();
+}
+} // namespace
+
+/*
+-------------------------------------------------------------------
+  LOADING  ---------------------------------------------------------
+-------------------------------------------------------------------
+*/
+MeshData parseObj(const char *text, size_t size, const ObjLoadOptions &options, ObjLoadStats *stats)
+{
+    const auto start = Clock::now();
+
+    // Split at line boundaries so no line straddles two chunks
+    const unsigned chunkCount = workerCount(options, size);
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char *cursor = text;
+    const char *end = text + size;
+    for (unsigned i = 0; i < chunkCount; ++i)
+    {
+        const char *target = i + 1 == chunkCount ? end : text + size / chunkCount * (i + 1);
+        target = std::max(target, cursor);
+        const char *newline = target < end ? static_cast<const char *>(std::memchr(target, '\n', end - target)) : nullptr;
+        chunks[i].begin = cursor;
+        chunks[i].end = newline ? newline + 1 : end;
+        cursor = chunks[i].end;
+    }
+
+    runParallel(chunkCount, [&chunks](unsigned i) {
+        try
+        {
+            parseChunk(chunks[i]);
+        }
+        catch (...)
+        {
+            chunks[i].error = std::current_exception();
+        }
+    });
+    for (const ObjChunk &chunk : chunks)
+        if (chunk.error)
+            std::rethrow_exception(chunk.error);
+
+    const auto parsed = Clock::now();
+
+    // Stitch: chunk vertex bases, then merge duplicate vertices in file order
+    std::vector<int64_t> vertexBase(chunkCount + 1, 0);
+    std::vector<size_t> cornerBase(chunkCount + 1, 0);
+    bool hasColors = false;
+    for (unsigned i = 0; i < chunkCount; ++i)
+    {
+        vertexBase[i + 1] = vertexBase[i] + static_cast<int64_t>(chunks[i].positions.size());
+        cornerBase[i + 1] = cornerBase[i] + chunks[i].corners.size();
+        hasColors |= chunks[i].hasColors;
+    }
+    const int64_t sourceVertices = vertexBase[chunkCount];
+    if (sourceVertices > static_cast<int64_t>(UINT32_MAX))
+        throw std::runtime_error("OBJ: more than 2^32 vertices");
+
+    MeshData mesh;
+    std::vector<uint32_t> remap(static_cast<size_t>(sourceVertices));
+    {
+        VertexDeduplicator deduplicator(mesh, static_cast<size_t>(sourceVertices));
+        size_t v = 0;
+        for (ObjChunk &chunk : chunks)
+        {
+            for (size_t k = 0; k < chunk.positions.size(); ++k)
+                remap[v++] = deduplicator.insert(chunk.positions[k], hasColors ? chunk.colors[k] : kDefaultColor);
+            std::vector<Position>().swap(chunk.positions);
+            std::vector<Color>().swap(chunk.colors);
+        }
+    }
+    if (!hasColors)
+        mesh.colors.clear();
+
+    // Resolve and remap the face corners in parallel, each chunk into its own slice
+    mesh.indices.resize(cornerBase[chunkCount]);
+    runParallel(chunkCount, [&](unsigned i) {
+        try
+        {
+            uint32_t *out = mesh.indices.data() + cornerBase[i];
+            for (int64_t stored : chunks[i].corners)
+            {
+                const int64_t index = stored >= 0 ? stored : vertexBase[i] + stored + kRelativeBias;
+                if (index < 0 || index >= sourceVertices)
+                    throw std::runtime_error("OBJ: face index " + std::to_string(index + 1) + " out of range");
+                *out++ = remap[static_cast<size_t>(index)];
+            }
+        }
+        catch (...)
+        {
+            chunks[i].error = std::current_exception();
+        }
+    });
+    for (const ObjChunk &chunk : chunks)
+        if (chunk.error)
+            std::rethrow_exception(chunk.error);
+
+    if (stats)
+    {
+        stats->bytes = size;
+        stats->sourceVertices = static_cast<size_t>(sourceVertices);
+        stats->mergedVertices = static_cast<size_t>(sourceVertices) - mesh.positions.size();
+        stats->chunks = chunkCount;
+        stats->parseSeconds = std::chrono::duration<double>(parsed - start).count();
+        stats->totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    return mesh;
+}
+
+MeshData loadObj(const std::string &path, const ObjLoadOptions &options, ObjLoadStats *stats)
+{
+    const auto start = Clock::now();
+    MappedFile file(path);
+    file.adviseSequential();
+
+    MeshData mesh = parseObj(file.data(), file.size(), options, stats);
+    if (stats)
+        stats->totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return mesh;
+}
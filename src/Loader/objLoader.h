@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "../common/meshData.h"
+
+/*
+-------------------------------------------------------------------
+  OBJ LOADER  ------------------------------------------------------
+
+  Wavefront OBJ to MeshData, ready for Mesh / Primitive upload.
+    1. mmap the file and cut it into chunks at line boundaries
+    2. parse chunks on worker threads (hand-written float/int parsing)
+    3. stitch chunks together: resolve relative (negative) indices,
+       merge identical position/color tuples and remap the faces
+
+  Only geometry is read: `v x y z [w]` or `v x y z r g b` (vertex color
+  extension) and `f` with any of the v, v/vt, v//vn, v/vt/vn forms.
+  Polygons are fan-triangulated; texture coordinates, normals, groups
+  and materials are skipped.
+-------------------------------------------------------------------
+*/
+struct ObjLoadOptions
+{
+    unsigned threads{0};                // 0 = hardware concurrency
+    size_t minChunkBytes{1 << 20};      // Smaller files use fewer threads
+};
+
+struct ObjLoadStats
+{
+    size_t bytes{0};
+    size_t sourceVertices{0};           // `v` lines
+    size_t mergedVertices{0};           // Duplicates removed by deduplication
+    unsigned chunks{0};
+    double parseSeconds{0.0};           // mmap + parallel parse
+    double totalSeconds{0.0};
+
+    double megabytesPerSecond() const { return totalSeconds > 0.0 ? bytes / (totalSeconds * 1e6) : 0.0; }
+};
+
+/**
+ * @brief Loads an OBJ file into an indexed triangle mesh.
+ *
+ * Throws std::runtime_error on I/O errors, malformed numbers or out-of-range indices.
+ * Colors are left empty unless some vertex carries one; uncolored vertices are then white.
+ */
+MeshData loadObj(const std::string &path, const ObjLoadOptions &options = {}, ObjLoadStats *stats = nullptr);
+
+/**
+ * @brief Same as loadObj, for OBJ text already in memory.
+ */
+MeshData parseObj(const char *text, size_t size, const ObjLoadOptions &options = {}, ObjLoadStats *stats = nullptr);
@@ -0,0 +1,448 @@
+#include "meshGenerator.hpp"
+#include "../common/parallel.h"
+
+#include <cmath>
+#include <future>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace
+{
+constexpr uint32_t kMaxUvSegments = 65534;          // (segments + 1)^2 vertices must fit 32-bit indices
+constexpr uint32_t kMaxIcoSegments = 20724;         // 10 * segments^2 + 2 likewise
+
+// Rows of a UV sphere per thread; below this the thread start-up costs more than the work
+constexpr size_t kMinUvRowsPerTask = 32;
+
+void checkSegments(SphereType type, uint32_t segments)
+{
+    const bool uv = type == SphereType::UvSphere;
+    const uint32_t low = uv ? 3 : 1;
+    const uint32_t high = uv ? kMaxUvSegments : kMaxIcoSegments;
+    if (segments < low || segments > high)
+        throw std::invalid_argument("Sphere segments must be in [" + std::to_string(low) + ", " +
+                                    std::to_string(high) + "], got " + std::to_string(segments));
+}
+
+inline void writeVertex(float *positions, float *normals, size_t v, float x, float y, float z, float radius)
+{
+    positions[v * 4 + 0] = x * radius;
+    positions[v * 4 + 1] = y * radius;
+    positions[v * 4 + 2] = z * radius;
+    positions[v * 4 + 3] = 1.0f;
+    if (normals)
+    {
+        normals[v * 3 + 0] = x;
+        normals[v * 3 + 1] = y;
+        normals[v * 3 + 2] = z;
+    }
+}
+
+/*
+-------------------------------------------------------------------
+  UV SPHERE  -------------------------------------------------------
+-------------------------------------------------------------------
+*/
+void generateUvSphere(uint32_t segments, float radius, float *positions, float *normals, uint32_t *indices,
+                      unsigned threads)
+{
+    const size_t columns = segments + 1;        // Seam column duplicated for a clean wrap
+    const size_t rings = segments;              // Bands between the poles
+
+    // Longitude terms are the same for every ring
+    std::vector<float> cosPhi(columns);
+    std::vector<float> sinPhi(columns);
+    for (size_t s = 0; s < columns; ++s)
+    {
+        const double phi = 2.0 * M_PI * double(s) / double(segments);
+        cosPhi[s] = static_cast<float>(std::cos(phi));
+        sinPhi[s] = -static_cast<float>(std::sin(phi));     // negative z keeps the winding counter-clockwise
+    }
+
+    // Band r starts after the top fan (one triangle per column) and r - 1 full bands
+    const auto bandIndexOffset = [segments](size_t r) -> size_t {
+        return r == 0 ? 0 : size_t{3} * segments + (r - 1) * size_t{6} * segments;
+    };
+
+    parallelFor(rings + 1, kMinUvRowsPerTask, threads, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r)
+        {
+            // Ring vertices
+            const double theta = M_PI * double(r) / double(rings);
+            const float y = r == 0 ? 1.0f : r == rings ? -1.0f : static_cast<float>(std::cos(theta));
+            const float ringRadius = r == 0 || r == rings ? 0.0f : static_cast<float>(std::sin(theta));
+            for (size_t s = 0; s < columns; ++s)
+                writeVertex(positions, normals, r * columns + s, ringRadius * cosPhi[s], y, ringRadius * sinPhi[s], radius);
+
+            // Band between this ring and the next
+            if (r == rings)
+                continue;
+            uint32_t *out = indices + bandIndexOffset(r);
+            for (size_t s = 0; s < segments; ++s)
+            {
+                const uint32_t a = static_cast<uint32_t>(r * columns + s);
+                const uint32_t b = static_cast<uint32_t>(a + columns);
+                if (r != 0)
+                {
+                    *out++ = a;
+                    *out++ = b;
+                    *out++ = a + 1;
+                }
+                if (r != rings - 1)
+                {
+                    *out++ = a + 1;
+                    *out++ = b;
+                    *out++ = b + 1;
+                }
+            }
+        }
+    });
+}
+
+/*
+-------------------------------------------------------------------
+  ICOSPHERE  -------------------------------------------------------
+-------------------------------------------------------------------
+*/
+constexpr uint32_t kIcoFaces[20][3] = {
+    {0, 11, 5}, {0, 5, 1},  {0, 1, 7},   {0, 7, 10}, {0, 10, 11}, {1, 5, 9}, {5, 11, 4},
+    {11, 10, 2}, {10, 7, 6}, {7, 1, 8},  {3, 9, 4},  {3, 4, 2},   {3, 2, 6}, {3, 6, 8},
+    {3, 8, 9},  {4, 9, 5},  {2, 4, 11}, {6, 2, 10}, {8, 6, 7},   {9, 8, 1},
+};
+
+struct Icosahedron
+{
+    float corners[12][3];
+    uint32_t edges[30][2];          // (low, high) corner pairs
+    int edgeOf[12][12];             // corner pair -> edge id
+
+    Icosahedron()
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+        const float raw[12][3] = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+                                  {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+        const float scale = 1.0f / std::sqrt(1.0f + t * t);
+        for (int v = 0; v < 12; ++v)
+            for (int c = 0; c < 3; ++c)
+                corners[v][c] = raw[v][c] * scale;
+
+        int count = 0;
+        for (auto &row : edgeOf)
+            for (int &edge : row)
+                edge = -1;
+        for (const auto &face : kIcoFaces)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t u = face[k], v = face[(k + 1) % 3];
+                if (edgeOf[u][v] >= 0)
+                    continue;
+                edges[count][0] = std::min(u, v);
+                edges[count][1] = std::max(u, v);
+                edgeOf[u][v] = edgeOf[v][u] = count++;
+            }
+        }
+    }
+};
+
+const Icosahedron &icosahedron()
+{
+    static const Icosahedron shape;
+    return shape;
+}
+
+/*
+    Vertex numbering for frequency n (no duplicates):
+      [0, 12)                      corners
+      12 + e * (n - 1) + (t - 1)   t-th point from the low corner of edge e, t in [1, n)
+      faceBase + f * perFace + k   interior points of face f, row by row
+*/
+class IcoIndexer
+{
+public:
+    explicit IcoIndexer(uint32_t n)
+        : n(n), faceBase(12 + size_t{30} * (n - 1)), perFace(n >= 2 ? size_t(n - 1) * (n - 2) / 2 : 0) {}
+
+    // Grid point (i, j) of face f: A + (B - A) * i / n + (C - A) * j / n
+    uint32_t index(int f, uint32_t i, uint32_t j) const
+    {
+        const uint32_t *face = kIcoFaces[f];
+        if (i == 0 && j == 0)
+            return face[0];
+        if (i == n)
+            return face[1];
+        if (j == n)
+            return face[2];
+        if (j == 0)
+            return edgePoint(face[0], face[1], i);
+        if (i == 0)
+            return edgePoint(face[0], face[2], j);
+        if (i + j == n)
+            return edgePoint(face[1], face[2], j);
+
+        // Row i holds n - 1 - i interior points (j in [1, n - 1 - i])
+        const size_t rowStart = size_t(i - 1) * (n - 1) - size_t(i - 1) * i / 2;
+        return static_cast<uint32_t>(faceBase + f * perFace + rowStart + (j - 1));
+    }
+
+    uint32_t edgePoint(uint32_t from, uint32_t to, uint32_t t) const
+    {
+        const int edge = icosahedron().edgeOf[from][to];
+        const uint32_t fromLow = from < to ? t : n - t;
+        return static_cast<uint32_t>(12 + size_t(edge) * (n - 1) + (fromLow - 1));
+    }
+
+private:
+    uint32_t n;
+    size_t faceBase;
+    size_t perFace;
+};
+
+inline void writeUnit(float *positions, float *normals, size_t v, float x, float y, float z, float radius)
+{
+    const float inverseLength = 1.0f / std::sqrt(x * x + y * y + z * z);
+    writeVertex(positions, normals, v, x * inverseLength, y * inverseLength, z * inverseLength, radius);
+}
+
+void generateIcosphere(uint32_t n, float radius, float *positions, float *normals, uint32_t *indices, unsigned threads)
+{
+    const Icosahedron &shape = icosahedron();
+    const IcoIndexer indexer(n);
+
+    // Shared vertices first: corners and edge points have exactly one writer
+    for (int v = 0; v < 12; ++v)
+        writeUnit(positions, normals, v, shape.corners[v][0], shape.corners[v][1], shape.corners[v][2], radius);
+    for (int e = 0; e < 30; ++e)
+    {
+        const float *lo = shape.corners[shape.edges[e][0]];
+        const float *hi = shape.corners[shape.edges[e][1]];
+        for (uint32_t t = 1; t < n; ++t)
+        {
+            const float w = float(t) / float(n);
+            writeUnit(positions, normals, indexer.edgePoint(shape.edges[e][0], shape.edges[e][1], t),
+                      lo[0] + (hi[0] - lo[0]) * w, lo[1] + (hi[1] - lo[1]) * w, lo[2] + (hi[2] - lo[2]) * w, radius);
+        }
+    }
+
+    // Faces own their interior points and their n^2 triangles
+    const size_t minFacesPerTask = n >= 64 ? 1 : 20;
+    parallelFor(20, minFacesPerTask, threads, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f)
+        {
+            const int face = static_cast<int>(f);
+            const float *a = shape.corners[kIcoFaces[f][0]];
+            const float *b = shape.corners[kIcoFaces[f][1]];
+            const float *c = shape.corners[kIcoFaces[f][2]];
+
+            for (uint32_t i = 1; i + 1 < n; ++i)
+            {
+                for (uint32_t j = 1; i + j < n; ++j)
+                {
+                    const float u = float(i) / float(n), v = float(j) / float(n);
+                    writeUnit(positions, normals, indexer.index(face, i, j), a[0] + (b[0] - a[0]) * u + (c[0] - a[0]) * v,
+                              a[1] + (b[1] - a[1]) * u + (c[1] - a[1]) * v, a[2] + (b[2] - a[2]) * u + (c[2] - a[2]) * v,
+                              radius);
+                }
+            }
+
+            // Strip between grid rows i and i + 1, each row's vertex ids resolved once
+            std::vector<uint32_t> row(n + 1);
+            std::vector<uint32_t> nextRow(n + 1);
+            for (uint32_t j = 0; j <= n; ++j)
+                row[j] = indexer.index(face, 0, j);
+
+            uint32_t *out = indices + f * size_t(n) * n * 3;
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                for (uint32_t j = 0; i + 1 + j <= n; ++j)
+                    nextRow[j] = indexer.index(face, i + 1, j);
+
+                for (uint32_t j = 0; i + j < n; ++j)
+                {
+                    *out++ = row[j];
+                    *out++ = nextRow[j];
+                    *out++ = row[j + 1];
+                    if (i + j + 1 < n)
+                    {
+                        *out++ = nextRow[j];
+                        *out++ = nextRow[j + 1];
+                        *out++ = row[j + 1];
+                    }
+                }
+                row.swap(nextRow);
+            }
+        }
+    });
+}
+} // namespace
+
+SphereCounts sphereCounts(SphereType type, uint32_t segments)
+{
+    checkSegments(type, segments);
+    const size_t s = segments;
+    if (type == SphereType::UvSphere)
+        return {(s + 1) * (s + 1), 6 * s * (s - 1)};
+    return {10 * s * s + 2, 60 * s * s};
+}
+
+void generateSphere(SphereType type, uint32_t segments, float radius, float *positions, float *normals,
+                    uint32_t *indices, unsigned threads)
+{
+    checkSegments(type, segments);
+    if (type == SphereType::UvSphere)
+        generateUvSphere(segments, radius, positions, normals, indices, threads);
+    else
+        generateIcosphere(segments, radius, positions, normals, indices, threads);
+}
+
+MeshData SphereGeometry::toMeshData() const
+{
+    MeshData mesh;
+    mesh.positions.resize(vertexCount());
+    std::copy(positions.begin(), positions.end(), &mesh.positions.data()->x);
+    mesh.indices = indices;
+    return mesh;
+}
+
+/*
+-------------------------------------------------------------------
+  MEMOIZATION  -----------------------------------------------------
+-------------------------------------------------------------------
+*/
+namespace
+{
+using SphereKey = std::pair<SphereType, uint32_t>;
+using SphereFuture = std::shared_future<std::shared_ptr<const SphereGeometry>>;
+
+constexpr size_t kDefaultSphereCacheBudget = size_t{64} << 20;
+
+struct SphereEntry
+{
+    SphereFuture future;
+    uint64_t id{0};             // Tells a re-inserted key from the one being generated
+    uint64_t lastUse{0};
+    size_t bytes{0};            // 0 while generating
+};
+
+std::mutex sphereCacheMutex;
+std::map<SphereKey, SphereEntry> sphereCache;
+size_t sphereCacheBudget = kDefaultSphereCacheBudget;
+size_t sphereCacheBytes = 0;
+uint64_t sphereCacheClock = 0;
+
+size_t geometryBytes(const SphereGeometry &geometry)
+{
+    return geometry.positions.size() * sizeof(float) + geometry.normals.size() * sizeof(float) +
+           geometry.indices.size() * sizeof(uint32_t);
+}
+
+// Drops the least recently used finished spheres until the cache fits; the lock must be held
+void trimSphereCache()
+{
+    while (sphereCacheBytes > sphereCacheBudget)
+    {
+        auto oldest = sphereCache.end();
+        for (auto it = sphereCache.begin(); it != sphereCache.end(); ++it)
+        {
+            if (it->second.bytes && (oldest == sphereCache.end() || it->second.lastUse < oldest->second.lastUse))
+                oldest = it;
+        }
+        if (oldest == sphereCache.end())
+            return;
+        sphereCacheBytes -= oldest->second.bytes;
+        sphereCache.erase(oldest);
+    }
+}
+} // namespace
+
+std::shared_ptr<const SphereGeometry> getSphere(SphereType type, uint32_t segments)
+{
+    checkSegments(type, segments);
+
+    // The first caller generates outside the lock; concurrent callers for the same key wait on its future
+    const SphereKey key{type, segments};
+    std::promise<std::shared_ptr<const SphereGeometry>> promise;
+    SphereFuture future;
+    uint64_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(sphereCacheMutex);
+        const auto found = sphereCache.find(key);
+        if (found != sphereCache.end())
+        {
+            found->second.lastUse = ++sphereCacheClock;
+            future = found->second.future;
+        }
+        else
+        {
+            id = ++sphereCacheClock;
+            sphereCache.emplace(key, SphereEntry{promise.get_future().share(), id, id, 0});
+        }
+    }
+    if (future.valid())
+        return future.get();
+
+    try
+    {
+        const SphereCounts counts = sphereCounts(type, segments);
+        auto geometry = std::make_shared<SphereGeometry>();
+        geometry->positions.resize(counts.vertexCount * 4);
+        geometry->normals.resize(counts.vertexCount * 3);
+        geometry->indices.resize(counts.indexCount);
+        generateSphere(type, segments, 1.0f, geometry->positions.data(), geometry->normals.data(),
+                       geometry->indices.data());
+        promise.set_value(geometry);
+
+        // Charge it to the budget, unless it was cleared meanwhile; one larger than the whole budget is not kept
+        std::lock_guard<std::mutex> lock(sphereCacheMutex);
+        const auto found = sphereCache.find(key);
+        if (found != sphereCache.end() && found->second.id == id)
+        {
+            const size_t bytes = geometryBytes(*geometry);
+            if (bytes > sphereCacheBudget)
+            {
+                sphereCache.erase(found);
+            }
+            else
+            {
+                found->second.bytes = bytes;
+                sphereCacheBytes += bytes;
+                trimSphereCache();
+            }
+        }
+        return geometry;
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(sphereCacheMutex);
+            const auto found = sphereCache.find(key);
+            if (found != sphereCache.end() && found->second.id == id)
+                sphereCache.erase(found);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+void setSphereCacheBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(sphereCacheMutex);
+    sphereCacheBudget = bytes;
+    trimSphereCache();
+}
+
+size_t getSphereCacheBytes()
+{
+    std::lock_guard<std::mutex> lock(sphereCacheMutex);
+    return sphereCacheBytes;
+}
+
+void clearSphereCache()
+{
+    std::lock_guard<std::mutex> lock(sphereCacheMutex);
+    sphereCache.clear();
+    sphereCacheBytes = 0;
+}
@@ -1,6 +1,81 @@
 #pragma once
 
-#include <Metal/Metal.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
-void createMeshBuffers(MTL::Device* device, MTL::Buffer* vertexBuffer, MTL::Buffer* indexBuffer);
+#include "../common/meshData.h"
 
+/*
+-------------------------------------------------------------------
+  MESH GENERATOR  --------------------------------------------------
+
+  Portable sphere generation (no ModelIO), written straight into
+  caller-provided buffers:
+    positions  xyzw floats (w = 1), the layout vertex_main reads
+    normals    xyz floats, unit length
+    indices    uint32 triangle list, counter-clockwise from outside
+
+  UvSphere   `segments` longitudes x `segments` latitudes; the seam
+             column is duplicated and each pole ring is a triangle fan.
+             Latitude bands are generated in parallel.
+  Icosphere  geodesic: every icosahedron edge split into `segments`
+             (10 * segments^2 + 2 vertices, no duplicates). Shared
+             corners/edges are written first, then the 20 face
+             interiors in parallel.
+-------------------------------------------------------------------
+*/
+enum class SphereType : uint32_t
+{
+    UvSphere,
+    Icosphere,
+};
+
+struct SphereCounts
+{
+    size_t vertexCount{0};
+    size_t indexCount{0};
+};
+
+/**
+ * @brief Buffer sizes generateSphere needs. UV spheres need segments >= 3, icospheres segments >= 1.
+ */
+SphereCounts sphereCounts(SphereType type, uint32_t segments);
+
+/**
+ * @brief Writes a sphere of `radius` into the caller's buffers (sized by sphereCounts).
+ *
+ * `normals` may be null. threads == 0 uses the hardware concurrency.
+ * @throws std::invalid_argument For segment counts outside the supported range.
+ */
+void generateSphere(SphereType type, uint32_t segments, float radius, float *positions, float *normals,
+                    uint32_t *indices, unsigned threads = 0);
+
+// Owned unit-radius sphere, as handed out by the memoized getSphere
+struct SphereGeometry
+{
+    std::vector<float> positions;       // xyzw
+    std::vector<float> normals;         // xyz
+    std::vector<uint32_t> indices;
+
+    size_t vertexCount() const { return positions.size() / 4; }
+
+    // Copy into a MeshData (positions + indices) for Mesh
+    MeshData toMeshData() const;
+};
+
+/**
+ * @brief Unit sphere for (type, segments), generated on first use and shared afterwards. Thread safe.
+ *
+ * The memo holds at most setSphereCacheBudget bytes (64 MB by default), dropping the least recently
+ * used spheres first; a sphere larger than the whole budget is generated every time.
+ */
+std::shared_ptr<const SphereGeometry> getSphere(SphereType type, uint32_t segments);
+
+// Byte budget of the memo, trimmed right away; geometry still held by callers stays valid either way
+void setSphereCacheBudget(size_t bytes);
+size_t getSphereCacheBytes();
+
+// Forgets every memoized sphere
+void clearSphereCache();
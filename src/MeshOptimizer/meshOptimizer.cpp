@@ -0,0 +1,409 @@
+#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/*
+-------------------------------------------------------------------
+  CACHE ANALYSIS  --------------------------------------------------
+-------------------------------------------------------------------
+*/
+VertexCacheStats analyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount,
+                                    unsigned cacheSize)
+{
+    VertexCacheStats stats;
+    if (indexCount == 0 || vertexCount == 0)
+        return stats;
+
+    // FIFO cache: a vertex is resident while (timestamp - insertedAt) < cacheSize
+    std::vector<size_t> insertedAt(vertexCount, 0);
+    size_t timestamp = cacheSize + 1;
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const uint32_t v = indices[i];
+        if (timestamp - insertedAt[v] > cacheSize)
+        {
+            insertedAt[v] = timestamp++;
+            ++stats.transformedVertices;
+        }
+    }
+
+    stats.acmr = static_cast<float>(stats.transformedVertices) / static_cast<float>(indexCount / 3);
+    stats.atvr = static_cast<float>(stats.transformedVertices) / static_cast<float>(vertexCount);
+    return stats;
+}
+
+/*
+-------------------------------------------------------------------
+  FORSYTH VERTEX CACHE OPTIMIZATION  -------------------------------
+-------------------------------------------------------------------
+*/
+namespace
+{
+constexpr int kScoreCacheSize = 32;
+constexpr int kValenceTableSize = 32;
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastTriangleScore = 0.75f;
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+
+struct ScoreTables
+{
+    float cache[kScoreCacheSize];
+    float valence[kValenceTableSize];
+
+    ScoreTables()
+    {
+        for (int i = 0; i < kScoreCacheSize; ++i)
+        {
+            // The three vertices of the last emitted triangle get a fixed score so the
+            // next triangle isn't biased towards which edge it shares.
+            cache[i] = i < 3 ? kLastTriangleScore
+                             : std::pow(1.0f - float(i - 3) / float(kScoreCacheSize - 3), kCacheDecayPower);
+        }
+        valence[0] = 0.0f;
+        for (int i = 1; i < kValenceTableSize; ++i)
+            valence[i] = kValenceBoostScale * std::pow(float(i), -kValenceBoostPower);
+    }
+};
+
+const ScoreTables &scoreTables()
+{
+    static const ScoreTables tables;
+    return tables;
+}
+
+float vertexScore(int cachePosition, uint32_t liveTriangles)
+{
+    if (liveTriangles == 0)
+        return -1.0f;       // No triangles left to emit, never pull it back into the cache
+
+    const ScoreTables &tables = scoreTables();
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+    score += liveTriangles < kValenceTableSize
+                 ? tables.valence[liveTriangles]
+                 : kValenceBoostScale * std::pow(float(liveTriangles), -kValenceBoostPower);
+    return score;
+}
+} // namespace
+
+void optimizeVertexCache(uint32_t *destination, const uint32_t *indices, size_t indexCount, size_t vertexCount)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Copy input so destination may alias indices
+    std::vector<uint32_t> source(indices, indices + triangleCount * 3);
+
+    // Vertex -> triangle adjacency (CSR)
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t index : source)
+        ++liveTriangles[index];
+
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+
+    std::vector<uint32_t> adjacency(source.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t)
+            for (int k = 0; k < 3; ++k)
+                adjacency[fill[source[t * 3 + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScores[v] = vertexScore(-1, liveTriangles[v]);
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; ++t)
+        triangleScores[t] = vertexScores[source[t * 3]] + vertexScores[source[t * 3 + 1]] + vertexScores[source[t * 3 + 2]];
+
+    uint32_t cache[kScoreCacheSize + 3];
+    uint32_t nextCache[kScoreCacheSize + 3];
+    int cacheCount = 0;
+
+    size_t inputCursor = 0;
+    uint32_t best = static_cast<uint32_t>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+
+    for (size_t output = 0; output < triangleCount; ++output)
+    {
+        if (best == UINT32_MAX)
+        {
+            // Dead end: nothing in the cache has live triangles, continue in input order
+            while (emitted[inputCursor])
+                ++inputCursor;
+            best = static_cast<uint32_t>(inputCursor);
+        }
+
+        const uint32_t *triangle = &source[best * 3];
+        std::memcpy(destination + output * 3, triangle, 3 * sizeof(uint32_t));
+        emitted[best] = true;
+
+        // Remove the triangle from its vertices' live lists
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = triangle[k];
+            uint32_t *begin = &adjacency[adjacencyOffset[v]];
+            uint32_t *end = begin + liveTriangles[v];
+            uint32_t *it = std::find(begin, end, best);
+            std::swap(*it, *(end - 1));
+            --liveTriangles[v];
+        }
+
+        // New cache: emitted triangle first, then the previous contents
+        int nextCount = 0;
+        for (int k = 0; k < 3; ++k)
+            nextCache[nextCount++] = triangle[k];
+        for (int i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                nextCache[nextCount++] = v;
+        }
+
+        // Vertices past the scoring window fall out of the cache
+        for (int i = kScoreCacheSize; i < nextCount; ++i)
+            cachePosition[nextCache[i]] = -1;
+
+        best = UINT32_MAX;
+        float bestScore = -1.0f;
+        for (int i = 0; i < nextCount; ++i)
+        {
+            const uint32_t v = nextCache[i];
+            if (i < kScoreCacheSize)
+                cachePosition[v] = i;
+
+            const float score = vertexScore(cachePosition[v], liveTriangles[v]);
+            const float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+
+            const uint32_t *live = &adjacency[adjacencyOffset[v]];
+            for (uint32_t j = 0; j < liveTriangles[v]; ++j)
+            {
+                const uint32_t t = live[j];
+                triangleScores[t] += delta;
+                if (i < kScoreCacheSize && triangleScores[t] > bestScore)
+                {
+                    bestScore = triangleScores[t];
+                    best = t;
+                }
+            }
+        }
+
+        cacheCount = std::min(nextCount, kScoreCacheSize);
+        std::memcpy(cache, nextCache, cacheCount * sizeof(uint32_t));
+    }
+}
+
+/*
+-------------------------------------------------------------------
+  OVERDRAW  --------------------------------------------------------
+-------------------------------------------------------------------
+*/
+namespace
+{
+// Counts cache misses for triangle t against a FIFO cache, inserting the misses.
+unsigned simulateTriangle(const uint32_t *triangle, std::vector<size_t> &insertedAt, size_t &timestamp, unsigned cacheSize)
+{
+    unsigned misses = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+        const uint32_t v = triangle[k];
+        if (timestamp - insertedAt[v] > cacheSize)
+        {
+            insertedAt[v] = timestamp++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+} // namespace
+
+void optimizeOverdraw(uint32_t *destination, const uint32_t *indices, size_t indexCount,
+                      const Position *positions, size_t vertexCount, float threshold)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    std::vector<uint32_t> source(indices, indices + triangleCount * 3);
+    const unsigned cacheSize = kDefaultCacheSize;
+
+    // 1. Hard boundaries: a triangle that misses on all three vertices starts a new strip of locality
+    std::vector<size_t> hardClusters;
+    {
+        std::vector<size_t> insertedAt(vertexCount, 0);
+        size_t timestamp = cacheSize + 1;
+        for (size_t t = 0; t < triangleCount; ++t)
+            if (simulateTriangle(&source[t * 3], insertedAt, timestamp, cacheSize) == 3 || t == 0)
+                hardClusters.push_back(t);
+    }
+    hardClusters.push_back(triangleCount);
+
+    // 2. Soft boundaries: split a hard cluster wherever the running ACMR is already within threshold
+    std::vector<size_t> clusters;
+    {
+        std::vector<size_t> insertedAt(vertexCount, 0);
+        size_t timestamp = cacheSize + 1;
+
+        for (size_t c = 0; c + 1 < hardClusters.size(); ++c)
+        {
+            const size_t begin = hardClusters[c];
+            const size_t end = hardClusters[c + 1];
+
+            timestamp += cacheSize + 1;     // flush
+            unsigned clusterMisses = 0;
+            for (size_t t = begin; t < end; ++t)
+                clusterMisses += simulateTriangle(&source[t * 3], insertedAt, timestamp, cacheSize);
+            const float clusterAcmr = float(clusterMisses) / float(end - begin);
+
+            timestamp += cacheSize + 1;
+            clusters.push_back(begin);
+            unsigned runningMisses = 0;
+            size_t runningStart = begin;
+            for (size_t t = begin; t < end; ++t)
+            {
+                runningMisses += simulateTriangle(&source[t * 3], insertedAt, timestamp, cacheSize);
+                const size_t runningTriangles = t + 1 - runningStart;
+                if (t + 1 < end && float(runningMisses) / float(runningTriangles) <= clusterAcmr * threshold)
+                {
+                    clusters.push_back(t + 1);
+                    runningStart = t + 1;
+                    runningMisses = 0;
+                    timestamp += cacheSize + 1;
+                }
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // 3. Sort clusters by how much they face away from the mesh center (outer surfaces first)
+    double meshCenter[3] = {0.0, 0.0, 0.0};
+    double meshArea = 0.0;
+    const size_t clusterCount = clusters.size() - 1;
+    std::vector<float> sortKey(clusterCount);
+
+    std::vector<double> clusterData(clusterCount * 7, 0.0);     // centroid*area (3), normal (3), area
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        double *data = &clusterData[c * 7];
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            const Position &a = positions[source[t * 3 + 0]];
+            const Position &b = positions[source[t * 3 + 1]];
+            const Position &p = positions[source[t * 3 + 2]];
+
+            const double e1[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+            const double e2[3] = {p.x - a.x, p.y - a.y, p.z - a.z};
+            const double n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            const double area = 0.5 * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            data[0] += area * (a.x + b.x + p.x) / 3.0;
+            data[1] += area * (a.y + b.y + p.y) / 3.0;
+            data[2] += area * (a.z + b.z + p.z) / 3.0;
+            data[3] += n[0];
+            data[4] += n[1];
+            data[5] += n[2];
+            data[6] += area;
+        }
+        for (int k = 0; k < 3; ++k)
+            meshCenter[k] += data[k];
+        meshArea += data[6];
+    }
+    for (double &k : meshCenter)
+        k = meshArea > 0.0 ? k / meshArea : 0.0;
+
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        const double *data = &clusterData[c * 7];
+        const double area = data[6] > 0.0 ? data[6] : 1.0;
+        const double normalLength = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+        double key = 0.0;
+        if (normalLength > 0.0)
+        {
+            for (int k = 0; k < 3; ++k)
+                key += (data[k] / area - meshCenter[k]) * (data[3 + k] / normalLength);
+        }
+        sortKey[c] = static_cast<float>(key);
+    }
+
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+        order[c] = static_cast<uint32_t>(c);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t l, uint32_t r) { return sortKey[l] > sortKey[r]; });
+
+    size_t output = 0;
+    for (uint32_t c : order)
+    {
+        const size_t count = (clusters[c + 1] - clusters[c]) * 3;
+        std::memcpy(destination + output, &source[clusters[c] * 3], count * sizeof(uint32_t));
+        output += count;
+    }
+}
+
+/*
+-------------------------------------------------------------------
+  VERTEX FETCH  ----------------------------------------------------
+-------------------------------------------------------------------
+*/
+size_t buildVertexFetchRemap(std::vector<uint32_t> &remap, const uint32_t *indices, size_t indexCount,
+                             size_t vertexCount)
+{
+    remap.assign(vertexCount, UINT32_MAX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t &slot = remap[indices[i]];
+        if (slot == UINT32_MAX)
+            slot = next++;
+    }
+    return next;
+}
+
+void optimizeVertexFetch(MeshData &mesh)
+{
+    std::vector<uint32_t> remap;
+    const size_t used = buildVertexFetchRemap(remap, mesh.indices.data(), mesh.indices.size(), mesh.vertexCount());
+
+    std::vector<Position> positions(used);
+    std::vector<Color> colors(mesh.colors.empty() ? 0 : used);
+    for (size_t v = 0; v < remap.size(); ++v)
+    {
+        if (remap[v] == UINT32_MAX)
+            continue;
+        positions[remap[v]] = mesh.positions[v];
+        if (!colors.empty())
+            colors[remap[v]] = mesh.colors[v];
+    }
+
+    for (uint32_t &index : mesh.indices)
+        index = remap[index];
+    mesh.positions = std::move(positions);
+    mesh.colors = std::move(colors);
+}
+
+/*
+-------------------------------------------------------------------
+  FULL PIPELINE  ---------------------------------------------------
+-------------------------------------------------------------------
+*/
+MeshOptimizationReport optimizeMesh(MeshData &mesh, float overdrawThreshold)
+{
+    MeshOptimizationReport report;
+    report.before = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount());
+
+    optimizeVertexCache(mesh.indices.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertexCount());
+    optimizeOverdraw(mesh.indices.data(), mesh.indices.data(), mesh.indices.size(),
+                     mesh.positions.data(), mesh.vertexCount(), overdrawThreshold);
+    optimizeVertexFetch(mesh);
+
+    report.after = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount());
+    return report;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../common/meshData.h"
+
+/*
+-------------------------------------------------------------------
+  MESH OPTIMIZER  --------------------------------------------------
+
+  Index/vertex reordering passes run once at geometry-creation time:
+    1. optimizeVertexCache  - Forsyth's linear-speed vertex cache optimization
+    2. optimizeOverdraw     - splits the cache-friendly order into clusters and
+                              sorts them so outward-facing clusters draw first
+    3. optimizeVertexFetch  - renumbers vertices in first-use order so fetches
+                              walk memory linearly
+
+  All index passes work on triangle lists and never change the triangle set.
+-------------------------------------------------------------------
+*/
+
+// Size of the FIFO cache used to report ACMR/ATVR (roughly what current GPUs batch)
+constexpr unsigned kDefaultCacheSize = 16;
+
+struct VertexCacheStats
+{
+    size_t transformedVertices{0};  // Cache misses = vertex shader invocations
+    float acmr{0.0f};               // Average cache miss ratio: misses per triangle (0.5 is ideal)
+    float atvr{0.0f};               // Average transformed vertex ratio: misses per vertex (1.0 is ideal)
+};
+
+/**
+ * @brief Simulates a FIFO post-transform cache over an index buffer.
+ */
+VertexCacheStats analyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount,
+                                    unsigned cacheSize = kDefaultCacheSize);
+
+/**
+ * @brief Reorders triangles for post-transform cache reuse (Tom Forsyth, 2006).
+ *
+ * `destination` may alias `indices`.
+ */
+void optimizeVertexCache(uint32_t *destination, const uint32_t *indices, size_t indexCount, size_t vertexCount);
+
+/**
+ * @brief Reorders clusters of an already cache-optimized index buffer to reduce overdraw.
+ *
+ * @param threshold How much ACMR may degrade (1.05 = 5%) to gain more, smaller clusters.
+ */
+void optimizeOverdraw(uint32_t *destination, const uint32_t *indices, size_t indexCount,
+                      const Position *positions, size_t vertexCount, float threshold = 1.05f);
+
+/**
+ * @brief Builds a remap table old vertex -> new vertex in first-use order.
+ *
+ * Unreferenced vertices map to UINT32_MAX. Returns the number of referenced vertices.
+ */
+size_t buildVertexFetchRemap(std::vector<uint32_t> &remap, const uint32_t *indices, size_t indexCount,
+                             size_t vertexCount);
+
+/**
+ * @brief Applies buildVertexFetchRemap to the mesh streams and indices, dropping unused vertices.
+ */
+void optimizeVertexFetch(MeshData &mesh);
+
+struct MeshOptimizationReport
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+/**
+ * @brief Runs cache, overdraw and fetch optimization in order and reports ACMR/ATVR.
+ */
+MeshOptimizationReport optimizeMesh(MeshData &mesh, float overdrawThreshold = 1.05f);
@@ -0,0 +1,451 @@
+#include "meshSimplifier.h"
+#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+/*
+    QUADRIC
+    Symmetric 4x4 matrix stored as its upper triangle.
+*/
+struct Quadric
+{
+    double a00{0}, a01{0}, a02{0}, a03{0};
+    double a11{0}, a12{0}, a13{0};
+    double a22{0}, a23{0};
+    double a33{0};
+
+    static Quadric fromPlane(double a, double b, double c, double d, double weight)
+    {
+        Quadric q;
+        q.a00 = weight * a * a; q.a01 = weight * a * b; q.a02 = weight * a * c; q.a03 = weight * a * d;
+        q.a11 = weight * b * b; q.a12 = weight * b * c; q.a13 = weight * b * d;
+        q.a22 = weight * c * c; q.a23 = weight * c * d;
+        q.a33 = weight * d * d;
+        return q;
+    }
+
+    Quadric &operator+=(const Quadric &o)
+    {
+        a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+        a11 += o.a11; a12 += o.a12; a13 += o.a13;
+        a22 += o.a22; a23 += o.a23;
+        a33 += o.a33;
+        return *this;
+    }
+
+    double evaluate(const Position &p) const
+    {
+        const double x = p.x, y = p.y, z = p.z;
+        const double e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+                       + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+                       + a22 * z * z + 2 * a23 * z
+                       + a33;
+        return std::max(e, 0.0);
+    }
+};
+
+struct Vec3
+{
+    double x, y, z;
+};
+
+Vec3 sub(const Position &a, const Position &b) { return {double(a.x) - b.x, double(a.y) - b.y, double(a.z) - b.z}; }
+Vec3 cross(const Vec3 &a, const Vec3 &b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+double dot(const Vec3 &a, const Vec3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+double length(const Vec3 &a) { return std::sqrt(dot(a, a)); }
+
+enum class VertexKind : uint8_t { Interior, Border, Locked };
+
+struct Collapse
+{
+    double cost;
+    uint32_t from;
+    uint32_t to;
+    uint32_t fromVersion;
+    uint32_t toVersion;
+
+    bool operator>(const Collapse &o) const { return cost > o.cost; }
+};
+
+constexpr double kBorderWeight = 10.0;
+
+class Simplifier
+{
+public:
+    Simplifier(const MeshData &mesh, const std::vector<uint32_t> &indices, const SimplifyOptions &options)
+        : mesh(mesh), options(options), triangles(indices.begin(), indices.begin() + indices.size() / 3 * 3)
+    {
+        const size_t vertexCount = mesh.vertexCount();
+        const size_t triangleCount = triangles.size() / 3;
+
+        triangleAlive.assign(triangleCount, true);
+        liveTriangles = triangleCount;
+        vertexTriangles.resize(vertexCount);
+        quadrics.resize(vertexCount);
+        version.assign(vertexCount, 0);
+        alive.assign(vertexCount, true);
+        kind.assign(vertexCount, VertexKind::Interior);
+
+        for (uint32_t t = 0; t < triangleCount; ++t)
+            for (int k = 0; k < 3; ++k)
+                vertexTriangles[triangles[t * 3 + k]].push_back(t);
+
+        classifyVertices();
+        buildQuadrics();
+    }
+
+    size_t run(size_t targetTriangles, std::vector<uint32_t> &destination, float *resultError)
+    {
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> heap;
+        for (uint32_t t = 0; t < triangles.size() / 3; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t a = triangles[t * 3 + k];
+                const uint32_t b = triangles[t * 3 + (k + 1) % 3];
+                if (a < b || !hasEdge(b, a))        // visit each undirected edge once where possible
+                    pushCandidate(heap, a, b);
+            }
+        }
+
+        const double maxCost = double(options.targetError) * options.targetError;
+        double worst = 0.0;
+
+        while (liveTriangles > targetTriangles && !heap.empty())
+        {
+            const Collapse c = heap.top();
+            heap.pop();
+            if (c.cost > maxCost)
+                break;
+            if (!alive[c.from] || !alive[c.to] || version[c.from] != c.fromVersion || version[c.to] != c.toVersion)
+                continue;
+            if (!collapseAllowed(c.from, c.to) || flipsTriangles(c.from, c.to))
+                continue;
+
+            apply(c.from, c.to);
+            worst = std::max(worst, c.cost);
+
+            // Re-score every edge around the surviving vertex
+            for (uint32_t t : vertexTriangles[c.to])
+            {
+                if (!triangleAlive[t])
+                    continue;
+                for (int k = 0; k < 3; ++k)
+                {
+                    const uint32_t other = triangles[t * 3 + k];
+                    if (other != c.to)
+                        pushCandidate(heap, c.to, other);
+                }
+            }
+        }
+
+        destination.clear();
+        destination.reserve(liveTriangles * 3);
+        for (size_t t = 0; t < triangleAlive.size(); ++t)
+            if (triangleAlive[t])
+                destination.insert(destination.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+
+        if (resultError)
+            *resultError = static_cast<float>(std::sqrt(worst));
+        return destination.size();
+    }
+
+private:
+    const MeshData &mesh;
+    SimplifyOptions options;
+    std::vector<uint32_t> triangles;
+    std::vector<bool> triangleAlive;
+    size_t liveTriangles{0};
+    std::vector<std::vector<uint32_t>> vertexTriangles;
+    std::vector<Quadric> quadrics;
+    std::vector<uint32_t> version;
+    std::vector<bool> alive;
+    std::vector<VertexKind> kind;
+
+    // True when a live triangle uses the directed edge a->b
+    bool hasEdge(uint32_t a, uint32_t b) const
+    {
+        for (uint32_t t : vertexTriangles[a])
+        {
+            if (!triangleAlive[t])
+                continue;
+            for (int k = 0; k < 3; ++k)
+                if (triangles[t * 3 + k] == a && triangles[t * 3 + (k + 1) % 3] == b)
+                    return true;
+        }
+        return false;
+    }
+
+    bool isBorderEdge(uint32_t a, uint32_t b) const
+    {
+        return hasEdge(a, b) != hasEdge(b, a);
+    }
+
+    void classifyVertices()
+    {
+        // Seams: several vertices at the same position (split for attributes) stay put
+        struct PositionHash
+        {
+            size_t operator()(const Position &p) const
+            {
+                const auto bits = [](float f) { uint32_t u; std::memcpy(&u, &f, 4); return size_t(u); };
+                return bits(p.x) * 73856093u ^ bits(p.y) * 19349663u ^ bits(p.z) * 83492791u;
+            }
+        };
+        struct PositionEqual
+        {
+            bool operator()(const Position &a, const Position &b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+        };
+        std::unordered_map<Position, uint32_t, PositionHash, PositionEqual> firstAt;
+        firstAt.reserve(mesh.vertexCount());
+        for (uint32_t v = 0; v < mesh.vertexCount(); ++v)
+        {
+            if (vertexTriangles[v].empty())
+                continue;
+            auto [it, inserted] = firstAt.emplace(mesh.positions[v], v);
+            if (!inserted)
+            {
+                kind[v] = VertexKind::Locked;
+                kind[it->second] = VertexKind::Locked;
+            }
+        }
+
+        for (uint32_t t = 0; t < triangles.size() / 3; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t a = triangles[t * 3 + k];
+                const uint32_t b = triangles[t * 3 + (k + 1) % 3];
+                if (!hasEdge(b, a))
+                {
+                    for (uint32_t v : {a, b})
+                        if (kind[v] == VertexKind::Interior)
+                            kind[v] = VertexKind::Border;
+                }
+            }
+        }
+    }
+
+    void buildQuadrics()
+    {
+        for (uint32_t t = 0; t < triangles.size() / 3; ++t)
+        {
+            const uint32_t i0 = triangles[t * 3], i1 = triangles[t * 3 + 1], i2 = triangles[t * 3 + 2];
+            const Position &p0 = mesh.positions[i0];
+            const Vec3 n = cross(sub(mesh.positions[i1], p0), sub(mesh.positions[i2], p0));
+            const double len = length(n);
+            if (len <= 0.0)
+                continue;
+
+            const Vec3 u{n.x / len, n.y / len, n.z / len};
+            const Quadric plane = Quadric::fromPlane(u.x, u.y, u.z, -(u.x * p0.x + u.y * p0.y + u.z * p0.z), 1.0);
+            quadrics[i0] += plane;
+            quadrics[i1] += plane;
+            quadrics[i2] += plane;
+
+            // Border edges get a perpendicular constraint plane so outlines don't shrink
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t a = triangles[t * 3 + k];
+                const uint32_t b = triangles[t * 3 + (k + 1) % 3];
+                if (hasEdge(b, a))
+                    continue;
+                const Vec3 edge = sub(mesh.positions[b], mesh.positions[a]);
+                Vec3 side = cross(edge, u);
+                const double sideLength = length(side);
+                if (sideLength <= 0.0)
+                    continue;
+                side = {side.x / sideLength, side.y / sideLength, side.z / sideLength};
+                const Position &pa = mesh.positions[a];
+                const Quadric border = Quadric::fromPlane(side.x, side.y, side.z,
+                                                          -(side.x * pa.x + side.y * pa.y + side.z * pa.z), kBorderWeight);
+                quadrics[a] += border;
+                quadrics[b] += border;
+            }
+        }
+    }
+
+    double attributeCost(uint32_t a, uint32_t b) const
+    {
+        if (mesh.colors.size() != mesh.vertexCount())
+            return 0.0;
+        const Color &ca = mesh.colors[a];
+        const Color &cb = mesh.colors[b];
+        const double dr = ca.r - cb.r, dg = ca.g - cb.g, db = ca.b - cb.b, da = ca.a - cb.a;
+        return options.attributeWeight * (dr * dr + dg * dg + db * db + da * da);
+    }
+
+    bool collapseAllowed(uint32_t from, uint32_t to) const
+    {
+        switch (kind[from])
+        {
+            case VertexKind::Locked:
+                return false;
+            case VertexKind::Border:
+                return kind[to] != VertexKind::Interior && isBorderEdge(from, to);
+            case VertexKind::Interior:
+                return true;
+        }
+        return false;
+    }
+
+    void pushCandidate(std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> &heap, uint32_t a, uint32_t b)
+    {
+        Quadric q = quadrics[a];
+        q += quadrics[b];
+        const double attribute = attributeCost(a, b);
+
+        if (collapseAllowed(a, b))
+            heap.push({q.evaluate(mesh.positions[b]) + attribute, a, b, version[a], version[b]});
+        if (collapseAllowed(b, a))
+            heap.push({q.evaluate(mesh.positions[a]) + attribute, b, a, version[b], version[a]});
+    }
+
+    // Rejects collapses that would turn a triangle over or make it degenerate
+    bool flipsTriangles(uint32_t from, uint32_t to) const
+    {
+        for (uint32_t t : vertexTriangles[from])
+        {
+            if (!triangleAlive[t])
+                continue;
+            const uint32_t *tri = &triangles[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                continue;       // this one disappears
+
+            const Position &p0 = mesh.positions[tri[0]];
+            const Position &p1 = mesh.positions[tri[1]];
+            const Position &p2 = mesh.positions[tri[2]];
+            const Vec3 before = cross(sub(p1, p0), sub(p2, p0));
+
+            const Position &q0 = mesh.positions[tri[0] == from ? to : tri[0]];
+            const Position &q1 = mesh.positions[tri[1] == from ? to : tri[1]];
+            const Position &q2 = mesh.positions[tri[2] == from ? to : tri[2]];
+            const Vec3 after = cross(sub(q1, q0), sub(q2, q0));
+
+            if (dot(before, after) <= 0.25 * length(before) * length(after))
+                return true;
+        }
+        return false;
+    }
+
+    void apply(uint32_t from, uint32_t to)
+    {
+        quadrics[to] += quadrics[from];
+        alive[from] = false;
+        ++version[to];
+
+        for (uint32_t t : vertexTriangles[from])
+        {
+            if (!triangleAlive[t])
+                continue;
+            uint32_t *tri = &triangles[t * 3];
+            const bool touchesTo = tri[0] == to || tri[1] == to || tri[2] == to;
+            for (int k = 0; k < 3; ++k)
+                if (tri[k] == from)
+                    tri[k] = to;
+
+            if (touchesTo)
+            {
+                triangleAlive[t] = false;
+                --liveTriangles;
+            }
+            else
+            {
+                vertexTriangles[to].push_back(t);
+            }
+        }
+        vertexTriangles[from].clear();
+
+        // Drop dead triangles so adjacency scans stay short
+        auto &list = vertexTriangles[to];
+        list.erase(std::remove_if(list.begin(), list.end(), [&](uint32_t t) { return !triangleAlive[t]; }), list.end());
+    }
+};
+} // namespace
+
+/*
+-------------------------------------------------------------------
+  PUBLIC API  ------------------------------------------------------
+-------------------------------------------------------------------
+*/
+size_t simplifyMesh(std::vector<uint32_t> &destination, const MeshData &mesh, const std::vector<uint32_t> &indices,
+                    size_t targetIndexCount, const SimplifyOptions &options, float *resultError)
+{
+    Simplifier simplifier(mesh, indices, options);
+    return simplifier.run(targetIndexCount / 3, destination, resultError);
+}
+
+LodChain buildLodChain(const MeshData &mesh, size_t maxLevels, float reduction, const SimplifyOptions &options)
+{
+    LodChain chain;
+    if (mesh.indices.empty())
+        return chain;
+
+    // Bounding radius around the centroid, used to convert error into screen space
+    double center[3] = {0.0, 0.0, 0.0};
+    for (const Position &p : mesh.positions)
+    {
+        center[0] += p.x;
+        center[1] += p.y;
+        center[2] += p.z;
+    }
+    for (double &c : center)
+        c /= double(mesh.vertexCount());
+    double radius = 0.0;
+    for (const Position &p : mesh.positions)
+    {
+        const double dx = p.x - center[0], dy = p.y - center[1], dz = p.z - center[2];
+        radius = std::max(radius, dx * dx + dy * dy + dz * dz);
+    }
+    chain.boundingRadius = static_cast<float>(std::sqrt(radius));
+
+    chain.indices = mesh.indices;
+    chain.levels.push_back({0, static_cast<uint32_t>(mesh.indices.size()), 0.0f});
+
+    std::vector<uint32_t> previous = mesh.indices;
+    std::vector<uint32_t> simplified;
+    float accumulatedError = 0.0f;
+
+    // Each level is allowed a larger error than the last so coarse levels keep shrinking
+    SimplifyOptions levelOptions = options;
+    for (size_t level = 1; level < maxLevels; ++level)
+    {
+        const size_t target = static_cast<size_t>(double(previous.size() / 3) * reduction) * 3;
+        if (target < 3)
+            break;
+
+        float error = 0.0f;
+        simplifyMesh(simplified, mesh, previous, target, levelOptions, &error);
+        if (simplified.size() > previous.size() * 0.9)     // barely moved, no point keeping it
+            break;
+
+        optimizeVertexCache(simplified.data(), simplified.data(), simplified.size(), mesh.vertexCount());
+
+        accumulatedError += error;
+        chain.levels.push_back({static_cast<uint32_t>(chain.indices.size()),
+                                static_cast<uint32_t>(simplified.size()), accumulatedError});
+        chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+
+        previous.swap(simplified);
+        levelOptions.targetError *= 2.0f;
+    }
+    return chain;
+}
+
+size_t selectLod(const LodChain &chain, float pixelsPerUnit, float pixelThreshold)
+{
+    size_t selected = 0;
+    for (size_t level = 1; level < chain.levels.size(); ++level)
+    {
+        if (chain.levels[level].error * pixelsPerUnit > pixelThreshold)
+            break;
+        selected = level;
+    }
+    return selected;
+}
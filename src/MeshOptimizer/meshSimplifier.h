@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../common/meshData.h"
+
+/*
+-------------------------------------------------------------------
+  MESH SIMPLIFIER  -------------------------------------------------
+
+  Quadric error metric edge collapse (Garland & Heckbert 1997).
+  Vertices collapse onto one of the edge endpoints, so every LOD is
+  just another index list over the original vertex buffer and a whole
+  LOD chain fits in a single index buffer.
+
+  Preservation rules:
+    - border vertices only slide along border edges (open meshes keep their outline)
+    - vertices sharing a position with another vertex (color/UV seams) are locked
+    - collapsing across a color difference is penalized via `attributeWeight`
+-------------------------------------------------------------------
+*/
+
+struct SimplifyOptions
+{
+    float targetError{0.01f};       // Stop once the cheapest collapse exceeds this object-space distance
+    float attributeWeight{0.5f};    // Cost per unit squared RGBA distance between endpoints
+};
+
+/**
+ * @brief Simplifies a triangle list down to `targetIndexCount` indices (or until targetError).
+ *
+ * @param destination Receives the simplified triangle list (indices into mesh.positions).
+ * @param mesh Source vertex streams; `indices` may be a previous LOD instead of mesh.indices.
+ * @param resultError Optional: largest collapse error (object-space distance) that was accepted.
+ * @return Number of indices written.
+ */
+size_t simplifyMesh(std::vector<uint32_t> &destination, const MeshData &mesh, const std::vector<uint32_t> &indices,
+                    size_t targetIndexCount, const SimplifyOptions &options = {}, float *resultError = nullptr);
+
+struct LodLevel
+{
+    uint32_t indexOffset{0};        // First index of this level in LodChain::indices
+    uint32_t indexCount{0};
+    float error{0.0f};              // Object-space geometric error relative to LOD 0
+};
+
+struct LodChain
+{
+    std::vector<uint32_t> indices;  // All levels back to back, finest first
+    std::vector<LodLevel> levels;
+    float boundingRadius{0.0f};     // Object-space radius around the vertex centroid
+};
+
+/**
+ * @brief Builds a LOD chain, each level targeting `reduction` of the previous level's triangles.
+ *
+ * Level 0 is `mesh.indices` unchanged. Generation stops early when a level fails to
+ * reduce the triangle count meaningfully.
+ */
+LodChain buildLodChain(const MeshData &mesh, size_t maxLevels = 6, float reduction = 0.5f,
+                       const SimplifyOptions &options = {});
+
+/**
+ * @brief Picks the coarsest level whose error projects to at most `pixelThreshold` pixels.
+ *
+ * @param pixelsPerUnit Screen pixels covered by one object-space unit at the object's current transform.
+ */
+size_t selectLod(const LodChain &chain, float pixelsPerUnit, float pixelThreshold = 1.0f);
@@ -0,0 +1,229 @@
+#include "meshlets.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+-------------------------------------------------------------------
+  BUILD  -----------------------------------------------------------
+-------------------------------------------------------------------
+*/
+MeshletSet buildMeshlets(const MeshData &mesh, size_t maxVertices, size_t maxTriangles)
+{
+    return buildMeshlets(mesh.positions, mesh.indices, maxVertices, maxTriangles);
+}
+
+MeshletSet buildMeshlets(std::span<const Position> positions, std::span<const uint32_t> indices, size_t maxVertices,
+                         size_t maxTriangles)
+{
+    maxVertices = std::min(maxVertices, size_t(255));       // local indices are 8-bit
+    MeshletSet set;
+    const size_t triangleCount = indices.size() / 3;
+    set.meshlets.reserve(triangleCount / maxTriangles + 1);
+    set.vertices.reserve(triangleCount);
+    set.triangles.reserve(triangleCount * 3);
+
+    // Global vertex -> local slot for the meshlet under construction
+    constexpr uint8_t kUnused = 0xff;
+    std::vector<uint8_t> localIndex(positions.size(), kUnused);
+
+    Meshlet current{0, 0, 0, 0};
+    const auto flush = [&]() {
+        if (current.triangleCount == 0)
+            return;
+        for (uint32_t i = 0; i < current.vertexCount; ++i)
+            localIndex[set.vertices[current.vertexOffset + i]] = kUnused;
+        set.meshlets.push_back(current);
+        current = {static_cast<uint32_t>(set.vertices.size()), static_cast<uint32_t>(set.triangles.size()), 0, 0};
+    };
+
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const uint32_t *tri = &indices[t * 3];
+        uint32_t newVertices = 0;
+        for (int k = 0; k < 3; ++k)
+            if (localIndex[tri[k]] == kUnused && (k < 1 || tri[k] != tri[0]) && (k < 2 || tri[k] != tri[1]))
+                ++newVertices;
+
+        if (current.vertexCount + newVertices > maxVertices || current.triangleCount + 1 > maxTriangles)
+            flush();
+
+        for (int k = 0; k < 3; ++k)
+        {
+            uint8_t &slot = localIndex[tri[k]];
+            if (slot == kUnused)
+            {
+                slot = static_cast<uint8_t>(current.vertexCount++);
+                set.vertices.push_back(tri[k]);
+            }
+            set.triangles.push_back(slot);
+        }
+        ++current.triangleCount;
+    }
+    flush();
+
+    set.bounds.reserve(set.meshlets.size());
+    for (const Meshlet &meshlet : set.meshlets)
+        set.bounds.push_back(computeMeshletBounds(set, meshlet, positions.data()));
+
+    return set;
+}
+
+/*
+-------------------------------------------------------------------
+  BOUNDS  ----------------------------------------------------------
+-------------------------------------------------------------------
+*/
+MeshletBounds computeMeshletBounds(const MeshletSet &set, const Meshlet &meshlet, const Position *positions)
+{
+    MeshletBounds bounds{};
+    const uint32_t *vertices = &set.vertices[meshlet.vertexOffset];
+
+    // Ritter: start from the two most distant points along a rough axis, then grow
+    const auto distanceSq = [](const Position &a, const float *b) {
+        const float dx = a.x - b[0], dy = a.y - b[1], dz = a.z - b[2];
+        return dx * dx + dy * dy + dz * dz;
+    };
+    const Position &first = positions[vertices[0]];
+    const float firstPoint[3] = {first.x, first.y, first.z};
+    uint32_t farA = 0;
+    for (uint32_t i = 1; i < meshlet.vertexCount; ++i)
+        if (distanceSq(positions[vertices[i]], firstPoint) > distanceSq(positions[vertices[farA]], firstPoint))
+            farA = i;
+    const Position &a = positions[vertices[farA]];
+    const float aPoint[3] = {a.x, a.y, a.z};
+    uint32_t farB = farA;
+    for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+        if (distanceSq(positions[vertices[i]], aPoint) > distanceSq(positions[vertices[farB]], aPoint))
+            farB = i;
+    const Position &b = positions[vertices[farB]];
+
+    float center[3] = {(a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, (a.z + b.z) * 0.5f};
+    float radius = std::sqrt(distanceSq(b, aPoint)) * 0.5f;
+
+    for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+    {
+        const Position &p = positions[vertices[i]];
+        const float d = std::sqrt(distanceSq(p, center));
+        if (d > radius)
+        {
+            const float newRadius = (radius + d) * 0.5f;
+            const float shift = (newRadius - radius) / d;
+            center[0] += (p.x - center[0]) * shift;
+            center[1] += (p.y - center[1]) * shift;
+            center[2] += (p.z - center[2]) * shift;
+            radius = newRadius;
+        }
+    }
+
+    std::copy(center, center + 3, bounds.center);
+    bounds.radius = radius;
+
+    // Normal cone: average unit normal, then the widest deviation from it
+    std::vector<float> normals(meshlet.triangleCount * 3, 0.0f);
+    float axis[3] = {0.0f, 0.0f, 0.0f};
+    const uint8_t *triangles = &set.triangles[meshlet.triangleOffset];
+    for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+    {
+        const Position &p0 = positions[vertices[triangles[t * 3 + 0]]];
+        const Position &p1 = positions[vertices[triangles[t * 3 + 1]]];
+        const Position &p2 = positions[vertices[triangles[t * 3 + 2]]];
+        const float e1[3] = {p1.x - p0.x, p1.y - p0.y, p1.z - p0.z};
+        const float e2[3] = {p2.x - p0.x, p2.y - p0.y, p2.z - p0.z};
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length <= 0.0f)
+            continue;       // degenerate triangles don't constrain the cone
+        for (int k = 0; k < 3; ++k)
+        {
+            n[k] /= length;
+            normals[t * 3 + k] = n[k];
+            axis[k] += n[k];
+        }
+    }
+
+    const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    bounds.coneCutoff = 1.0f;       // default: never cull
+    if (axisLength > 0.0f)
+    {
+        for (float &k : axis)
+            k /= axisLength;
+        float minDot = 1.0f;
+        for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+        {
+            const float *n = &normals[t * 3];
+            if (n[0] == 0.0f && n[1] == 0.0f && n[2] == 0.0f)
+                continue;
+            minDot = std::min(minDot, n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]);
+        }
+        // Cones wider than a hemisphere can always show a front face
+        if (minDot > 0.0f)
+            bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+    std::copy(axis, axis + 3, bounds.coneAxis);
+    return bounds;
+}
+
+/*
+-------------------------------------------------------------------
+  CULLING  ---------------------------------------------------------
+-------------------------------------------------------------------
+*/
+bool isMeshletCulled(const MeshletBounds &bounds, const ClusterCullParams &params)
+{
+    if (params.frustumCulling)
+    {
+        for (const float *plane : params.planes)
+        {
+            const float distance = plane[0] * bounds.center[0] + plane[1] * bounds.center[1] +
+                                   plane[2] * bounds.center[2] + plane[3];
+            if (distance < -bounds.radius)
+                return true;
+        }
+    }
+
+    if (params.backfaceCulling && bounds.coneCutoff < 1.0f)
+    {
+        // Every normal in the cone points away from the viewer
+        const float facing = bounds.coneAxis[0] * params.viewDirection[0] +
+                             bounds.coneAxis[1] * params.viewDirection[1] +
+                             bounds.coneAxis[2] * params.viewDirection[2];
+        if (facing < -bounds.coneCutoff)
+            return true;
+    }
+    return false;
+}
+
+template <typename IndexType>
+size_t cullMeshlets(IndexType *destination, const MeshletSet &set, const ClusterCullParams &params,
+                    ClusterCullStats *stats)
+{
+    size_t written = 0;
+    size_t visibleClusters = 0;
+    size_t totalTriangles = 0;
+
+    for (size_t m = 0; m < set.meshlets.size(); ++m)
+    {
+        const Meshlet &meshlet = set.meshlets[m];
+        totalTriangles += meshlet.triangleCount;
+        if (isMeshletCulled(set.bounds[m], params))
+            continue;
+
+        ++visibleClusters;
+        const uint32_t *vertices = &set.vertices[meshlet.vertexOffset];
+        const uint8_t *triangles = &set.triangles[meshlet.triangleOffset];
+        for (uint32_t i = 0; i < meshlet.triangleCount * 3; ++i)
+            destination[written++] = static_cast<IndexType>(vertices[triangles[i]]);
+    }
+
+    if (stats)
+    {
+        stats->visibleClusters = visibleClusters;
+        stats->visibleTriangles = written / 3;
+        stats->totalTriangles = totalTriangles;
+    }
+    return written;
+}
+
+template size_t cullMeshlets<uint16_t>(uint16_t *, const MeshletSet &, const ClusterCullParams &, ClusterCullStats *);
+template size_t cullMeshlets<uint32_t>(uint32_t *, const MeshletSet &, const ClusterCullParams &, ClusterCullStats *);
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../common/meshData.h"
+
+/*
+-------------------------------------------------------------------
+  MESHLETS  --------------------------------------------------------
+
+  Splits an indexed mesh into small clusters that can be culled
+  independently. Each meshlet references at most kMeshletMaxVertices
+  unique vertices through a local index table, so its triangles can be
+  stored as 8-bit local indices.
+
+  Build from a vertex-cache optimized index buffer: the greedy builder
+  walks triangles in order, so cache locality becomes cluster locality.
+-------------------------------------------------------------------
+*/
+constexpr size_t kMeshletMaxVertices = 64;
+constexpr size_t kMeshletMaxTriangles = 124;
+
+struct Meshlet
+{
+    uint32_t vertexOffset;      // Into MeshletSet::vertices
+    uint32_t triangleOffset;    // Into MeshletSet::triangles (in bytes, 3 per triangle)
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+};
+
+struct MeshletBounds
+{
+    float center[3];
+    float radius;
+    float coneAxis[3];          // Average facing direction of the cluster
+    float coneCutoff;           // sin(cone half angle); >= 1 when the cone is too wide to cull
+};
+
+struct MeshletSet
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> vertices;     // Local -> mesh vertex index
+    std::vector<uint8_t> triangles;     // Local vertex indices
+    std::vector<MeshletBounds> bounds;
+};
+
+/**
+ * @brief Greedily groups triangles into meshlets and computes their culling bounds.
+ */
+MeshletSet buildMeshlets(const MeshData &mesh, size_t maxVertices = kMeshletMaxVertices,
+                         size_t maxTriangles = kMeshletMaxTriangles);
+
+// Same over positions and a triangle list held elsewhere (e.g. a mapped mesh cache)
+MeshletSet buildMeshlets(std::span<const Position> positions, std::span<const uint32_t> indices,
+                         size_t maxVertices = kMeshletMaxVertices, size_t maxTriangles = kMeshletMaxTriangles);
+
+/**
+ * @brief Bounding sphere (Ritter) and normal cone for one meshlet.
+ */
+MeshletBounds computeMeshletBounds(const MeshletSet &set, const Meshlet &meshlet, const Position *positions);
+
+/*
+    Per-frame culling input, all in the mesh's object space.
+
+    viewDirection points from the viewer into the scene. Triangles count as front
+    facing when dot(cross(b - a, c - a), viewDirection) > 0, which matches
+    counter-clockwise front faces under the renderer's orthographic clip space.
+*/
+struct ClusterCullParams
+{
+    float planes[6][4];         // Inside when dot(plane.xyz, p) + plane.w >= 0
+    float viewDirection[3];
+    bool frustumCulling{true};
+    bool backfaceCulling{true};
+};
+
+struct ClusterCullStats
+{
+    size_t visibleClusters{0};
+    size_t visibleTriangles{0};
+    size_t totalTriangles{0};
+};
+
+/**
+ * @brief Writes the global indices of every visible meshlet into `destination`.
+ *
+ * @param destination Must hold at least 3 * (total triangles) entries.
+ * @return Number of indices written.
+ */
+template <typename IndexType>
+size_t cullMeshlets(IndexType *destination, const MeshletSet &set, const ClusterCullParams &params,
+                    ClusterCullStats *stats = nullptr);
+
+/**
+ * @brief True when the cluster can be skipped this frame.
+ */
+bool isMeshletCulled(const MeshletBounds &bounds, const ClusterCullParams &params);
@@ -0,0 +1,349 @@
+#include "particleSystem.h"
+#include "../common/parallel.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <mutex>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+constexpr size_t kParticlesPerTask = 65536;
+
+struct Streams
+{
+    float *px, *py, *vx, *vy, *age;
+};
+
+struct Step
+{
+    float dt;
+    float gravityX, gravityY;       // Already scaled by dt
+    float damping;                  // exp(-drag * dt)
+};
+
+struct Extents
+{
+    float min[2]{FLT_MAX, FLT_MAX};
+    float max[2]{-FLT_MAX, -FLT_MAX};
+
+    void merge(const float lo[2], const float hi[2])
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            min[k] = std::min(min[k], lo[k]);
+            max[k] = std::max(max[k], hi[k]);
+        }
+    }
+};
+
+// Reference kernel, also the tail of the vector ones
+void integrateScalar(const Streams &s, size_t begin, size_t end, const Step &step, Extents &extents)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        s.vx[i] = (s.vx[i] + step.gravityX) * step.damping;
+        s.vy[i] = (s.vy[i] + step.gravityY) * step.damping;
+        s.px[i] += s.vx[i] * step.dt;
+        s.py[i] += s.vy[i] * step.dt;
+        s.age[i] += step.dt;
+        const float p[2] = {s.px[i], s.py[i]};
+        extents.merge(p, p);
+    }
+}
+
+#if defined(__SSE2__)
+void integrateSse2(const Streams &s, size_t begin, size_t end, const Step &step, Extents &extents)
+{
+    const __m128 dt = _mm_set1_ps(step.dt);
+    const __m128 gx = _mm_set1_ps(step.gravityX);
+    const __m128 gy = _mm_set1_ps(step.gravityY);
+    const __m128 damping = _mm_set1_ps(step.damping);
+    __m128 minX = _mm_set1_ps(FLT_MAX), minY = minX;
+    __m128 maxX = _mm_set1_ps(-FLT_MAX), maxY = maxX;
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(s.vx + i), gx), damping);
+        const __m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(s.vy + i), gy), damping);
+        const __m128 px = _mm_add_ps(_mm_loadu_ps(s.px + i), _mm_mul_ps(vx, dt));
+        const __m128 py = _mm_add_ps(_mm_loadu_ps(s.py + i), _mm_mul_ps(vy, dt));
+        _mm_storeu_ps(s.vx + i, vx);
+        _mm_storeu_ps(s.vy + i, vy);
+        _mm_storeu_ps(s.px + i, px);
+        _mm_storeu_ps(s.py + i, py);
+        _mm_storeu_ps(s.age + i, _mm_add_ps(_mm_loadu_ps(s.age + i), dt));
+        minX = _mm_min_ps(minX, px);
+        minY = _mm_min_ps(minY, py);
+        maxX = _mm_max_ps(maxX, px);
+        maxY = _mm_max_ps(maxY, py);
+    }
+
+    float lo[2][4], hi[2][4];
+    _mm_storeu_ps(lo[0], minX);
+    _mm_storeu_ps(lo[1], minY);
+    _mm_storeu_ps(hi[0], maxX);
+    _mm_storeu_ps(hi[1], maxY);
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        const float l[2] = {lo[0][lane], lo[1][lane]};
+        const float h[2] = {hi[0][lane], hi[1][lane]};
+        extents.merge(l, h);
+    }
+    integrateScalar(s, i, end, step, extents);
+}
+
+// Compiled for AVX2 + FMA whatever the build flags; only called when the CPU reports both
+__attribute__((target("avx2,fma"))) void integrateAvx2(const Streams &s, size_t begin, size_t end,
+                                                      const Step &step, Extents &extents)
+{
+    const __m256 dt = _mm256_set1_ps(step.dt);
+    const __m256 gx = _mm256_set1_ps(step.gravityX);
+    const __m256 gy = _mm256_set1_ps(step.gravityY);
+    const __m256 damping = _mm256_set1_ps(step.damping);
+    __m256 minX = _mm256_set1_ps(FLT_MAX), minY = minX;
+    __m256 maxX = _mm256_set1_ps(-FLT_MAX), maxY = maxX;
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256 vx = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(s.vx + i), gx), damping);
+        const __m256 vy = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(s.vy + i), gy), damping);
+        const __m256 px = _mm256_fmadd_ps(vx, dt, _mm256_loadu_ps(s.px + i));
+        const __m256 py = _mm256_fmadd_ps(vy, dt, _mm256_loadu_ps(s.py + i));
+        _mm256_storeu_ps(s.vx + i, vx);
+        _mm256_storeu_ps(s.vy + i, vy);
+        _mm256_storeu_ps(s.px + i, px);
+        _mm256_storeu_ps(s.py + i, py);
+        _mm256_storeu_ps(s.age + i, _mm256_add_ps(_mm256_loadu_ps(s.age + i), dt));
+        minX = _mm256_min_ps(minX, px);
+        minY = _mm256_min_ps(minY, py);
+        maxX = _mm256_max_ps(maxX, px);
+        maxY = _mm256_max_ps(maxY, py);
+    }
+
+    float lo[2][8], hi[2][8];
+    _mm256_storeu_ps(lo[0], minX);
+    _mm256_storeu_ps(lo[1], minY);
+    _mm256_storeu_ps(hi[0], maxX);
+    _mm256_storeu_ps(hi[1], maxY);
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        const float l[2] = {lo[0][lane], lo[1][lane]};
+        const float h[2] = {hi[0][lane], hi[1][lane]};
+        extents.merge(l, h);
+    }
+    integrateScalar(s, i, end, step, extents);
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+void integrateNeon(const Streams &s, size_t begin, size_t end, const Step &step, Extents &extents)
+{
+    const float32x4_t dt = vdupq_n_f32(step.dt);
+    const float32x4_t gx = vdupq_n_f32(step.gravityX);
+    const float32x4_t gy = vdupq_n_f32(step.gravityY);
+    const float32x4_t damping = vdupq_n_f32(step.damping);
+    float32x4_t minX = vdupq_n_f32(FLT_MAX), minY = minX;
+    float32x4_t maxX = vdupq_n_f32(-FLT_MAX), maxY = maxX;
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        const float32x4_t vx = vmulq_f32(vaddq_f32(vld1q_f32(s.vx + i), gx), damping);
+        const float32x4_t vy = vmulq_f32(vaddq_f32(vld1q_f32(s.vy + i), gy), damping);
+        const float32x4_t px = vfmaq_f32(vld1q_f32(s.px + i), vx, dt);
+        const float32x4_t py = vfmaq_f32(vld1q_f32(s.py + i), vy, dt);
+        vst1q_f32(s.vx + i, vx);
+        vst1q_f32(s.vy + i, vy);
+        vst1q_f32(s.px + i, px);
+        vst1q_f32(s.py + i, py);
+        vst1q_f32(s.age + i, vaddq_f32(vld1q_f32(s.age + i), dt));
+        minX = vminq_f32(minX, px);
+        minY = vminq_f32(minY, py);
+        maxX = vmaxq_f32(maxX, px);
+        maxY = vmaxq_f32(maxY, py);
+    }
+
+    const float lo[2] = {vminvq_f32(minX), vminvq_f32(minY)};
+    const float hi[2] = {vmaxvq_f32(maxX), vmaxvq_f32(maxY)};
+    extents.merge(lo, hi);
+    integrateScalar(s, i, end, step, extents);
+}
+#endif
+
+using Kernel = void (*)(const Streams &, size_t, size_t, const Step &, Extents &);
+
+struct KernelChoice
+{
+    Kernel kernel;
+    const char *name;
+};
+
+const KernelChoice &chooseKernel()
+{
+    static const KernelChoice choice = [] {
+#if defined(__SSE2__)
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return KernelChoice{integrateAvx2, "avx2"};
+        return KernelChoice{integrateSse2, "sse2"};
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        return KernelChoice{integrateNeon, "neon"};
+#else
+        return KernelChoice{integrateScalar, "scalar"};
+#endif
+    }();
+    return choice;
+}
+} // namespace
+
+ParticleSystem::ParticleSystem(size_t capacity, uint32_t seed)
+    : capacity(capacity), positionX(capacity), positionY(capacity), velocityX(capacity), velocityY(capacity),
+      age(capacity), lifetime(capacity), halfSize(capacity), color(capacity), rngState(seed ? seed : 1)
+{
+}
+
+float ParticleSystem::random()
+{
+    // xorshift32: plenty for spawn jitter, and cheap enough to call per particle field
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return static_cast<float>(rngState >> 8) * 0x1.0p-24f;
+}
+
+size_t ParticleSystem::emit(const ParticleEmitter &emitter, size_t requested)
+{
+    const size_t spawned = std::min(requested, capacity - count);
+    for (size_t i = count; i < count + spawned; ++i)
+    {
+        positionX[i] = emitter.position[0] + (2.0f * random() - 1.0f) * emitter.jitter;
+        positionY[i] = emitter.position[1] + (2.0f * random() - 1.0f) * emitter.jitter;
+        const float angle = emitter.angle + (2.0f * random() - 1.0f) * emitter.spread;
+        const float speed = emitter.speedMin + (emitter.speedMax - emitter.speedMin) * random();
+        velocityX[i] = std::cos(angle) * speed;
+        velocityY[i] = std::sin(angle) * speed;
+        age[i] = 0.0f;
+        lifetime[i] = emitter.lifetimeMin + (emitter.lifetimeMax - emitter.lifetimeMin) * random();
+        halfSize[i] = emitter.size;
+        color[i] = emitter.color;
+    }
+    count += spawned;
+    return spawned;
+}
+
+ParticleUpdateStats ParticleSystem::update(float dt, const ParticleForces &forces, unsigned threads)
+{
+    ParticleUpdateStats stats;
+    stats.updated = count;
+    if (count == 0)
+        return stats;
+
+    const Step step{dt, forces.gravity[0] * dt, forces.gravity[1] * dt, std::exp(-forces.drag * dt)};
+    const Streams streams{positionX.data(), positionY.data(), velocityX.data(), velocityY.data(), age.data()};
+    const Kernel kernel = chooseKernel().kernel;
+
+    // Tasks cover whole 8-particle blocks so only the very last one has a scalar tail
+    Extents extents;
+    std::mutex extentsMutex;
+    const size_t blocks = (count + 7) / 8;
+    parallelFor(blocks, kParticlesPerTask / 8, threads, [&](size_t begin, size_t end) {
+        Extents local;
+        kernel(streams, begin * 8, std::min(end * 8, count), step, local);
+        std::lock_guard<std::mutex> lock(extentsMutex);
+        extents.merge(local.min, local.max);
+    });
+    std::copy(extents.min, extents.min + 2, stats.min);
+    std::copy(extents.max, extents.max + 2, stats.max);
+
+    stats.killed = removeDead();
+    return stats;
+}
+
+size_t ParticleSystem::removeDead()
+{
+    size_t killed = 0;
+    size_t i = 0;
+    while (i < count)
+    {
+        if (age[i] < lifetime[i])
+        {
+            ++i;
+            continue;
+        }
+
+        // The last particle takes the slot; it is checked in turn before moving on
+        const size_t last = --count;
+        positionX[i] = positionX[last];
+        positionY[i] = positionY[last];
+        velocityX[i] = velocityX[last];
+        velocityY[i] = velocityY[last];
+        age[i] = age[last];
+        lifetime[i] = lifetime[last];
+        halfSize[i] = halfSize[last];
+        color[i] = color[last];
+        ++killed;
+    }
+    return killed;
+}
+
+size_t ParticleSystem::writeInstances(std::span<ProceduralInstance> instances) const
+{
+    const size_t written = std::min(count, instances.size());
+    for (size_t i = 0; i < written; ++i)
+    {
+        ProceduralInstance &instance = instances[i];
+        instance.center[0] = positionX[i];
+        instance.center[1] = positionY[i];
+        instance.radius = halfSize[i];
+        instance.kind = static_cast<uint32_t>(ShapeKind::Quad);
+        instance.segments = 0;
+
+        // Alpha fades linearly to 0 at the end of the lifetime; a zero lifetime (dead at the next update) is transparent
+        const float remaining = lifetime[i] > 0.0f ? std::clamp(1.0f - age[i] / lifetime[i], 0.0f, 1.0f) : 0.0f;
+        const uint32_t alpha = static_cast<uint32_t>(static_cast<float>(color[i] >> 24) * remaining + 0.5f);
+        instance.color = (color[i] & 0x00ffffffu) | (alpha << 24);
+        instance.padding[0] = instance.padding[1] = 0;
+    }
+    return written;
+}
+
+void ParticleSystem::clear()
+{
+    count = 0;
+}
+
+size_t ParticleSystem::size() const
+{
+    return count;
+}
+
+size_t ParticleSystem::getCapacity() const
+{
+    return capacity;
+}
+
+std::span<const float> ParticleSystem::getPositionsX() const
+{
+    return std::span<const float>(positionX.data(), count);
+}
+
+std::span<const float> ParticleSystem::getPositionsY() const
+{
+    return std::span<const float>(positionY.data(), count);
+}
+
+std::span<const float> ParticleSystem::getAges() const
+{
+    return std::span<const float>(age.data(), count);
+}
+
+const char *ParticleSystem::getKernelName()
+{
+    return chooseKernel().name;
+}
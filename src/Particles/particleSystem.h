@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../Procedural/proceduralShapes.h"
+
+/*
+-------------------------------------------------------------------
+  PARTICLE SYSTEM  -------------------------------------------------
+
+  Many short-lived 2D points stored as structure of arrays: one
+  array per field, all allocated once for the full capacity, so
+  emitting and dying never allocate or fragment.
+
+    emit     appends at the end
+    update   integrates every particle, then swap-removes the dead
+             (the last live particle moves into the hole)
+
+  Integration is semi-implicit Euler with gravity and exponential
+  drag. The kernel runs 8 particles per step with AVX2 + FMA when the
+  CPU has them (chosen at run time, no build flags needed), else 4
+  with SSE2 or NEON, else scalar; the last few particles always take
+  the scalar path.
+
+  Particles draw as ProceduralInstance quads (vertex_procedural) with
+  one instanced draw; alpha fades out over their lifetime (it shows
+  with BlendMode::Additive, which needs no sorting between particles;
+  the default Opaque pipeline ignores it).
+-------------------------------------------------------------------
+*/
+struct ParticleEmitter
+{
+    float position[2]{0.0f, 0.0f};
+    float jitter{0.0f};             // Spawn inside a square of this half size around `position`
+    float angle{1.5707964f};        // Launch direction in radians (straight up)
+    float spread{0.5f};             // Launch directions vary by +- spread
+    float speedMin{0.3f};
+    float speedMax{0.8f};
+    float lifetimeMin{1.0f};        // Seconds
+    float lifetimeMax{2.0f};
+    float size{0.006f};             // Half size of the drawn quad
+    uint32_t color{0xffffffffu};    // rgba8, r in the low byte
+};
+
+struct ParticleForces
+{
+    float gravity[2]{0.0f, -0.6f};
+    float drag{0.0f};               // Velocity decays by exp(-drag * dt)
+};
+
+// What one update() did
+struct ParticleUpdateStats
+{
+    size_t updated{0};
+    size_t killed{0};
+    float min[2]{0.0f, 0.0f};       // Extents of the live particles' positions (before the kill pass)
+    float max[2]{0.0f, 0.0f};
+};
+
+class ParticleSystem
+{
+public:
+    // `seed` drives the emitter's random spawns
+    explicit ParticleSystem(size_t capacity, uint32_t seed = 1);
+
+    // Spawns up to `count` particles; returns how many fit
+    size_t emit(const ParticleEmitter &emitter, size_t count);
+
+    /**
+     * @brief Advances every particle by `dt` seconds and removes the ones past their lifetime.
+     *
+     * Integration is split across up to `threads` workers (0 uses the hardware concurrency)
+     * once there are enough particles; the kill pass is sequential.
+     */
+    ParticleUpdateStats update(float dt, const ParticleForces &forces, unsigned threads = 0);
+
+    // One Quad instance per live particle into `instances`; returns the number written
+    size_t writeInstances(std::span<ProceduralInstance> instances) const;
+
+    void clear();
+    size_t size() const;
+    size_t getCapacity() const;
+
+    std::span<const float> getPositionsX() const;
+    std::span<const float> getPositionsY() const;
+    std::span<const float> getAges() const;
+
+    // "avx2", "sse2", "neon" or "scalar": the integration kernel update() uses on this CPU
+    static const char *getKernelName();
+
+private:
+    size_t capacity;
+    size_t count{0};
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> age;
+    std::vector<float> lifetime;
+    std::vector<float> halfSize;
+    std::vector<uint32_t> color;
+    uint32_t rngState;
+
+    float random();                 // [0, 1)
+    size_t removeDead();
+};
@@ -1,5 +1,12 @@
 #include "primitive.h"
 #include "../shaders/readShaderFile.h"
+#include "../MeshOptimizer/meshOptimizer.h"
+#include "../Culling/frustum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
 
 /*
 -------------------------------------------------------------------
@@ -10,7 +17,8 @@
     Quad
 -------------------------------------------------------------------
 */
-Primitive::Primitive(MTL::Device *device) : device(device)
+Primitive::Primitive(MTL::Device *device, const VertexLayout &layout)
+    : device(device), vertexLayout(layout), buffers(MetalBufferDevice{device})
 {
     // Transform
     //transform = Transform();
@@ -21,57 +29,159 @@ Primitive::Primitive(MTL::Device *device) : device(device)
 */
 Primitive::~Primitive()
 {
+  // The buffer handles retire themselves; memory they wrap without a copy must wait as long
+  for (std::shared_ptr<void> &memory : adoptedMemory)
+    retireMemory(std::move(memory));
+}
 
-  if (vertexBuffer)
-  {
-    vertexBuffer->release();
-    vertexBuffer = nullptr;
-  }
+/*
+    BUFFER ALLOCATION
+*/
+Handle<MTL::Buffer> Primitive::newFilledBuffer(size_t bytes, const std::function<void(void *contents)> &fill)
+{
+  return buffers.filled(bytes, fill);
+}
 
-  if (pipelineState)
-  {
-    pipelineState->release();
-    pipelineState = nullptr;
-  }
+Handle<MTL::Buffer> Primitive::newCopiedBuffer(const void *source, size_t bytes)
+{
+  return buffers.copied(source, bytes);
+}
+
+// `owner` is kept until the primitive is destroyed
+Handle<MTL::Buffer> Primitive::newAdoptedBuffer(void *memory, size_t bytes, std::shared_ptr<void> owner)
+{
+  Handle<MTL::Buffer> buffer = buffers.adopted(memory, bytes);
+  if (buffer)
+    adoptedMemory.push_back(std::move(owner));
+  return buffer;
 }
 
 /*
     CREATE VERTEX BUFFER
 */
-void Primitive::createVertexBuffer(const std::vector<float4> &vertices)
+void Primitive::createVertexBuffer(std::span<const float4> vertices)
+{
+  createVertexBuffer(std::span<const float>(reinterpret_cast<const float *>(vertices.data()), vertices.size() * 4));
+}
+
+// Raw xyzw stream, shared by the float4 and MeshData (Position) paths
+void Primitive::createVertexBuffer(std::span<const float> xyzw)
+{
+  const size_t count = xyzw.size() / 4;
+  if (count == 0)
+    throw std::runtime_error("No vertices defined");
+
+  vertexBuffer = buffers.positions(vertexLayout.position, xyzw, dequant, localBounds);
+  if (!vertexBuffer)
+    throw std::runtime_error("Failed to create vertex buffer");
+  worldBoundsVersion = UINT64_MAX;
+  vertexCount = count;
+  vertexRing = {};
+}
+
+void Primitive::createVertexBuffer(size_t count, const StreamWriter &write)
 {
-  if (vertices.empty())
+  if (count == 0)
     throw std::runtime_error("No vertices defined");
 
-  vertexBuffer = device->newBuffer(vertices.data(), vertices.size() * sizeof(float4), MTL::ResourceStorageModeManaged);
+  vertexBuffer = buffers.positions(vertexLayout.position, count, write, dequant, localBounds);
+  if (!vertexBuffer)
+    throw std::runtime_error("Failed to create vertex buffer");
+  worldBoundsVersion = UINT64_MAX;
+  vertexCount = count;
+  vertexRing = {};
+}
+
+void Primitive::adoptVertexBuffer(std::span<float> xyzw, std::shared_ptr<void> owner)
+{
+  if (vertexLayout.position != PositionFormat::Float4)
+    throw std::runtime_error("Only float4 positions can be adopted without encoding");
+  const size_t count = xyzw.size() / 4;
+  if (count == 0)
+    throw std::runtime_error("No vertices defined");
 
+  vertexBuffer = newAdoptedBuffer(xyzw.data(), count * 4 * sizeof(float), std::move(owner));
   if (!vertexBuffer)
     throw std::runtime_error("Failed to create vertex buffer");
 
+  localBounds = computeBounds(xyzw.data(), count);
+  worldBoundsVersion = UINT64_MAX;
+  vertexCount = count;
+  vertexOffset = 0;
+  vertexRing = {};
 }
 
 /*
     CREATE COLOR BUFFER
 */
-void Primitive::createColorBuffer(const std::vector<float4> &color)
+void Primitive::createColorBuffer(std::span<const float4> color)
+{
+  createColorBuffer(std::span<const float>(reinterpret_cast<const float *>(color.data()), color.size() * 4));
+}
+
+void Primitive::createColorBuffer(std::span<const float> rgba)
 {
-  if (color.empty())
+  const size_t count = rgba.size() / 4;
+  if (count == 0)
     throw std::runtime_error("No color defined");
 
-  colorBuffer = device->newBuffer(color.data(), color.size() * sizeof(float4), MTL::ResourceStorageModeManaged);
+  colorBuffer = buffers.colors(vertexLayout.color, rgba);
+  if (!colorBuffer)
+    throw std::runtime_error("Failed to create color buffer");
+  colorCount = count;
+  colorRing = {};
+}
+
+void Primitive::createColorBuffer(size_t count, const StreamWriter &write)
+{
+  if (count == 0)
+    throw std::runtime_error("No color defined");
 
+  colorBuffer = buffers.colors(vertexLayout.color, count, write);
   if (!colorBuffer)
-    throw std::runtime_error("Failed to create vertex buffer");
+    throw std::runtime_error("Failed to create color buffer");
+  colorCount = count;
+  colorRing = {};
+}
+
+void Primitive::adoptColorBuffer(std::span<float> rgba, std::shared_ptr<void> owner)
+{
+  if (vertexLayout.color != ColorFormat::Float4)
+    throw std::runtime_error("Only float4 colors can be adopted without encoding");
+  const size_t count = rgba.size() / 4;
+  if (count == 0)
+    throw std::runtime_error("No color defined");
+
+  colorBuffer = newAdoptedBuffer(rgba.data(), count * 4 * sizeof(float), std::move(owner));
+  if (!colorBuffer)
+    throw std::runtime_error("Failed to create color buffer");
+  colorCount = count;
+  colorOffset = 0;
+  colorRing = {};
 }
 
 /*
     CREATE INDEX BUFFER
 */
-void Primitive::createIndexBuffer(const std::vector<uint16_t> &indices)
+void Primitive::createIndexBuffer(std::span<const uint16_t> indices)
+{
+  indexBuffer = newCopiedBuffer(indices.data(), indices.size_bytes());
+  if (!indexBuffer)
+    throw std::runtime_error("Index buffer failed to create");
+}
+
+void Primitive::createIndexBuffer(size_t count, const std::function<void(std::span<uint16_t> indices)> &write)
+{
+  indexBuffer = newFilledBuffer(count * sizeof(uint16_t), [&](void *contents) {
+    write(std::span<uint16_t>(static_cast<uint16_t *>(contents), count));
+  });
+  if (!indexBuffer)
+    throw std::runtime_error("Index buffer failed to create");
+}
+
+const BufferCreationStats &Primitive::getCreationStats() const
 {
-  indexBuffer = device->newBuffer(indices.data(), indices.size() * sizeof(uint16_t), MTL::ResourceStorageModeManaged);
-  if (indexBuffer)
-    std::cout << "Index buffer created" << std::endl;
+  return buffers.stats;
 }
 
 /*
@@ -82,30 +192,47 @@ void Primitive::createRenderPipelineState()
   // Uses helper function to load the shaders - using pre-compiled shaders is another approach
   const std::string fileName = "shaders.metal";
   NS::Error *error{nullptr}; // Used to catch errors when creating the library
-  MTL::Library *library{nullptr};
+  MTL::Library *rawLibrary{nullptr};
 
   try
   {
-    loadShaderFromFile(library, device, fileName);
+    loadShaderFromFile(rawLibrary, device, fileName);
   }
   catch (const std::exception &e)
   {
     std::cerr << "Error loading shader: " << e.what() << std::endl;
   }
+  // Handles release everything below on every return path
+  Handle<MTL::Library> library(rawLibrary);
 
   // Create library
   if (!library)
     throw std::runtime_error("Failed to create triangle shader library");
 
   // Get both vertex and fragment functions
-  MTL::Function *vertexFunction = library->newFunction(NS::String::string("vertex_main", NS::UTF8StringEncoding));
+  Handle<MTL::Function> vertexFunction;
+  if (vertexLayout.isDefault())
+  {
+    vertexFunction = Handle<MTL::Function>(library->newFunction(NS::String::string(vertexFunctionName(), NS::UTF8StringEncoding)));
+  }
+  else
+  {
+    // Specialize the quantized variant for this primitive's formats (function constants 0 and 1)
+    const uint32_t positionFormat = static_cast<uint32_t>(vertexLayout.position);
+    const uint32_t colorFormat = static_cast<uint32_t>(vertexLayout.color);
+    MTL::FunctionConstantValues *constants = MTL::FunctionConstantValues::alloc()->init();
+    constants->setConstantValue(&positionFormat, MTL::DataTypeUInt, NS::UInteger(0));
+    constants->setConstantValue(&colorFormat, MTL::DataTypeUInt, NS::UInteger(1));
+    vertexFunction = Handle<MTL::Function>(library->newFunction(NS::String::string("vertex_main_quantized", NS::UTF8StringEncoding), constants, &error));
+    constants->release();
+  }
   if (!vertexFunction)
   {
     std::cerr << "Vertex function not found" << std::endl;
     return;
   }
 
-  MTL::Function *fragmentFunction = library->newFunction(NS::String::string("fragment_main", NS::UTF8StringEncoding));
+  Handle<MTL::Function> fragmentFunction(library->newFunction(NS::String::string("fragment_main", NS::UTF8StringEncoding)));
   if (!fragmentFunction)
   {
     std::cerr << "Fragment function not found" << std::endl;
@@ -113,15 +240,17 @@ void Primitive::createRenderPipelineState()
   }
 
   // Create render pipeline descriptor
-  MTL::RenderPipelineDescriptor *pipelineDescriptor = MTL::RenderPipelineDescriptor::alloc()->init();
+  Handle<MTL::RenderPipelineDescriptor> pipelineDescriptor(MTL::RenderPipelineDescriptor::alloc()->init());
   // Set the functions
-  pipelineDescriptor->setVertexFunction(vertexFunction);
-  pipelineDescriptor->setFragmentFunction(fragmentFunction);
+  pipelineDescriptor->setVertexFunction(vertexFunction.get());
+  pipelineDescriptor->setFragmentFunction(fragmentFunction.get());
+
+  // Formats of the render pass this draws in (a depth attachment too when one is configured)
+  applyRenderTargetFormat(pipelineDescriptor.get());
 
   // Configure color attachment - NOTE: The color attachment represents the output target for the fragment shader.
   MTL::RenderPipelineColorAttachmentDescriptor *colorAttachment = pipelineDescriptor->colorAttachments()->object(0);
-  colorAttachment->setPixelFormat(MTL::PixelFormat::PixelFormatBGRA8Unorm);
-  colorAttachment->setBlendingEnabled(false); // This overwrites the entire color buffer, keep this in mind when rendering fog etc...
+  applyBlendMode(colorAttachment, blendMode); // Opaque overwrites the entire color buffer, keep this in mind when rendering fog etc...
 
   /*
     OLD - no longer need the vertex descriptor
@@ -145,7 +274,7 @@ void Primitive::createRenderPipelineState()
   */
 
   // Now create the renderPipelineState with the descriptor
-  pipelineState = device->newRenderPipelineState(pipelineDescriptor, &error);
+  pipelineState = Handle<MTL::RenderPipelineState>(device->newRenderPipelineState(pipelineDescriptor.get(), &error));
 
   if (error)
   {
@@ -158,58 +287,292 @@ void Primitive::createRenderPipelineState()
     std::cerr << "Invalid pipelineState" << std::endl;
     return;
   }
+}
 
-  // clean up
-  pipelineDescriptor->release();
-  // vertexDescriptor->release();
-  vertexFunction->release();
-  fragmentFunction->release();
-  library->release();
+const char *Primitive::vertexFunctionName() const
+{
+  return "vertex_main";
 }
 
 /*
-    ENCODE RENDER COMMANDS
+    COMPILE DRAW ITEM
 */
-void Primitive::encodeRenderCommands(MTL::RenderCommandEncoder *encoder) const
+/**
+ * @brief Compiles everything the frame loop needs to draw this primitive into plain data.
+ *
+ * Validation happens here, once, instead of on every frame. The pipeline id and transform
+ * slot are left for the DrawList to assign.
+ *
+ * @throws std::runtime_error If the pipeline state or vertex buffer is missing
+ */
+DrawItem Primitive::compileDrawItem()
 {
-
-  /*
-      To encode, you need:
-      1: A valid encoder
-      2: Complete render pipeline state
-      3: Compete Vertex buffer
-  */
   if (!pipelineState)
     throw std::runtime_error("No Pipeline State");
   if (!vertexBuffer)
     throw std::runtime_error("No Vertex Buffer");
 
-  if (!encoder)
+  DrawItem item;
+  item.vertexBuffer = vertexBuffer.get();   // buffer(0)
+  item.colorBuffer = colorBuffer.get();     // buffer(1)
+  item.vertexOffset = vertexOffset;
+  item.colorOffset = colorOffset;
+  if (!vertexLayout.isDefault())
+    item.flags |= kDrawDequant;
+  if (blendMode != BlendMode::Opaque)
+    item.flags |= kDrawBlended;
+
+  describeDraw(item);
+  describeStreams(item);
+  return item;
+}
+
+/**
+ * @brief Re-describes a kDrawDynamic item for the frame being encoded (DrawList::prepare).
+ */
+void Primitive::prepareDraw(DrawItem &item)
+{
+  describeDraw(item);
+  if (isDynamic())
   {
-    std::cerr << "Invalid encoder" << std::endl;
+    // This frame draws the current slices; they aren't rewritten until it completes
+    streamSlotFrames[streamSlot] = DeferredReleaseQueue::shared().getEncodingFrame();
+    describeStreams(item);
+  }
+}
+
+void Primitive::describeStreams(DrawItem &item) const
+{
+  if (!isDynamic())
     return;
+  item.flags |= kDrawDynamic;
+  if (!vertexRing.empty())
+  {
+    item.vertexBuffer = vertexBuffer.get();
+    item.vertexOffset = vertexRing.getSliceOffset();
+  }
+  if (!colorRing.empty())
+  {
+    item.colorBuffer = colorBuffer.get();
+    item.colorOffset = colorRing.getSliceOffset();
   }
+}
 
-  // encoder->setTriangleFillMode(MTL::TriangleFillMode::TriangleFillModeLines);
-  //  set renderpipeline state using encoder
-  encoder->setRenderPipelineState(pipelineState);
+MTL::RenderPipelineState *Primitive::getPipelineState() const {
+    return pipelineState.get();
+}
 
-  // Set vertex buffer
-  encoder->setVertexBuffer(vertexBuffer, 0, 0); // Set vertexBuffer to buffer(0)
-  encoder->setVertexBuffer(colorBuffer, 0, 1);  // Set colorBuffer to buffer(1)
+void Primitive::setBlendMode(BlendMode mode) {
+    if (mode == blendMode)
+        return;
+    blendMode = mode;
+    createRenderPipelineState();
+}
 
-    /*
-     *  Always send transform matrix to GPU, even if there are not transformations.
-     */
+BlendMode Primitive::getBlendMode() const {
+    return blendMode;
+}
 
-    const Eigen::Matrix4f& transformMatrix = transform.getMatrix();
-    encoder->setVertexBytes(transformMatrix.data(), sizeof(Eigen::Matrix4f), 11);
+const VertexDequant &Primitive::getDequant() const {
+    return dequant;
 }
 
 Transform &Primitive::getTransform() {
     return transform;
 }
 
+const Bounds &Primitive::getLocalBounds() const {
+    return localBounds;
+}
+
+const Bounds &Primitive::getWorldBounds() const {
+    if (worldBoundsVersion != getBoundsVersion())
+    {
+        worldBounds = transformBounds(localBounds, transform.getMatrix());
+        worldBoundsVersion = getBoundsVersion();
+    }
+    return worldBounds;
+}
+
+uint64_t Primitive::getBoundsVersion() const {
+    // Both counters only increase, so their sum changes whenever either does
+    return transform.getVersion() + localBoundsRevision;
+}
+
+float Primitive::intersectRay(const Ray &objectRay) const {
+    return intersectAabb(objectRay, localBounds.box);
+}
+
+/*
+    DYNAMIC UPDATES
+*/
+void Primitive::updateVertices(size_t first, const float *positions, size_t count)
+{
+  if (count == 0)
+    return;
+  if (!vertexBuffer || first > vertexCount || count > vertexCount - first)
+    throw std::out_of_range("Vertex update past the end of the vertex buffer");
+  if (vertexRing.empty())
+    throw std::runtime_error("Vertex update of a static stream; call makeDynamic() first");
+  advanceStreams();
+
+  const size_t stride = positionStride(vertexLayout.position);
+  const size_t begin = first * stride;
+  char *target = vertexRing.getSlice() + begin;
+  if (vertexLayout.position == PositionFormat::Float4)
+    std::memcpy(target, positions, count * stride);
+  else
+    encodePositions(vertexLayout.position, positions, count, dequant, target);
+
+  vertexRing.add(begin, begin + count * stride);
+  ++uploadStats.updates;
+  uploadStats.bytesWritten += count * stride;
+
+  // Grow the local box if the new vertices leave it; the sphere is re-centred on the box
+  const Bounds updated = computeBounds(positions, count);
+  Aabb &box = localBounds.box;
+  bool grew = false;
+  for (int c = 0; c < 3; ++c)
+  {
+    if (updated.box.min[c] < box.min[c]) { box.min[c] = updated.box.min[c]; grew = true; }
+    if (updated.box.max[c] > box.max[c]) { box.max[c] = updated.box.max[c]; grew = true; }
+  }
+  if (grew)
+  {
+    float radiusSq = 0.0f;
+    for (int c = 0; c < 3; ++c)
+    {
+      localBounds.sphere.center[c] = 0.5f * (box.min[c] + box.max[c]);
+      const float half = 0.5f * (box.max[c] - box.min[c]);
+      radiusSq += half * half;
+    }
+    localBounds.sphere.radius = std::sqrt(radiusSq);
+    ++localBoundsRevision;
+  }
+}
+
+void Primitive::updateColors(size_t first, const float *colors, size_t count)
+{
+  if (count == 0)
+    return;
+  if (!colorBuffer || first > colorCount || count > colorCount - first)
+    throw std::out_of_range("Color update past the end of the color buffer");
+  if (colorRing.empty())
+    throw std::runtime_error("Color update of a static stream; call makeDynamic() first");
+  advanceStreams();
+
+  const size_t stride = colorStride(vertexLayout.color);
+  const size_t begin = first * stride;
+  char *target = colorRing.getSlice() + begin;
+  if (vertexLayout.color == ColorFormat::Float4)
+    std::memcpy(target, colors, count * stride);
+  else
+    encodeColors(vertexLayout.color, colors, count, target);
+
+  colorRing.add(begin, begin + count * stride);
+  ++uploadStats.updates;
+  uploadStats.bytesWritten += count * stride;
+}
+
+void Primitive::advanceStreams()
+{
+  DeferredReleaseQueue &releaseQueue = DeferredReleaseQueue::shared();
+  const uint64_t encoding = releaseQueue.getEncodingFrame();
+  if (writableFrame == encoding)
+    return;
+
+  // Only the frame that last drew the next slice has to be done; the others keep overlapping
+  streamSlot = (streamSlot + 1) % kMaxFramesInFlight;
+  releaseQueue.waitForFrame(streamSlotFrames[streamSlot]);
+  streamSlotFrames[streamSlot] = encoding;
+  writableFrame = encoding;
+  ++uploadStats.fenceWaits;
+
+  if (!vertexRing.empty())
+    uploadStats.bytesCaughtUp += vertexRing.advance();
+  if (!colorRing.empty())
+    uploadStats.bytesCaughtUp += colorRing.advance();
+}
+
+/**
+ * @brief Moves the updatable streams into one Managed buffer each, one slice per frame in flight.
+ *
+ * Every slice starts as a copy of the stream. The static buffers are retired; DrawItems
+ * compiled earlier still point at them, so rebuild any DrawList holding the primitive.
+ *
+ * @throws std::runtime_error Without a stream created by createVertexBuffer/createColorBuffer
+ */
+void Primitive::makeDynamic()
+{
+  if (isDynamic())
+    return;
+  if (vertexCount == 0 && colorCount == 0)
+    throw std::runtime_error("No updatable streams to make dynamic");
+
+  const auto ring = [this](Handle<MTL::Buffer> &stream, NS::UInteger &offset, size_t bytes,
+                           StreamRing<kMaxFramesInFlight> &target) {
+    const size_t stride = StreamRing<kMaxFramesInFlight>::sliceStride(bytes);
+    const char *source = static_cast<const char *>(stream->contents()) + offset;
+    Handle<MTL::Buffer> slices = newFilledBuffer(stride * kMaxFramesInFlight, [&](void *contents) {
+      for (size_t slot = 0; slot < kMaxFramesInFlight; ++slot)
+        std::memcpy(static_cast<char *>(contents) + slot * stride, source, bytes);
+    });
+    if (!slices)
+      throw std::runtime_error("Failed to create dynamic stream");
+    target = StreamRing<kMaxFramesInFlight>(slices->contents(), bytes);
+    stream = std::move(slices);
+    offset = 0;
+  };
+  if (vertexCount)
+    ring(vertexBuffer, vertexOffset, vertexCount * positionStride(vertexLayout.position), vertexRing);
+  if (colorCount)
+    ring(colorBuffer, colorOffset, colorCount * colorStride(vertexLayout.color), colorRing);
+  streamSlot = 0;
+}
+
+bool Primitive::isDynamic() const
+{
+  return !vertexRing.empty() || !colorRing.empty();
+}
+
+size_t Primitive::flushUpdates()
+{
+  if (!hasPendingUpdates())
+    return 0;
+
+  size_t flushed = 0;
+  const auto flush = [this, &flushed](const Handle<MTL::Buffer> &buffer, DirtyRanges &dirty) {
+    if (dirty.empty())
+      return;
+    // Shared buffers are coherent already; only Managed ones keep a separate GPU copy
+    const bool managed = buffer->storageMode() == MTL::StorageModeManaged;
+    for (const ByteRange &range : dirty.coalesce())
+    {
+      if (managed)
+        buffer->didModifyRange(NS::Range::Make(range.begin, range.size()));
+      ++uploadStats.ranges;
+      flushed += range.size();
+    }
+    dirty.clear();
+  };
+  flush(vertexBuffer, vertexRing.getDirty());
+  flush(colorBuffer, colorRing.getDirty());
+
+  ++uploadStats.flushes;
+  uploadStats.bytesFlushed += flushed;
+  return flushed;
+}
+
+bool Primitive::hasPendingUpdates() const
+{
+  return !vertexRing.getDirty().empty() || !colorRing.getDirty().empty();
+}
+
+const BufferUploadStats &Primitive::getUploadStats() const
+{
+  return uploadStats;
+}
+
 /*
 -------------------------------------------------------------------
     Triangle  ---------------------------------------------------------
@@ -228,13 +591,14 @@ Triangle::Triangle(MTL::Device *device) : Primitive(device) {
  * and creates all necessary GPU buffers and render pipeline state.
  *
  * @param device The Metal device used to create buffers and pipeline state
- * @param vertices A vector of float4 values representing the triangle's vertex positions
- * @param color A vector of float4 values representing the color of each vertex
+ * @param vertices float4 values representing the triangle's vertex positions
+ * @param color float4 values representing the color of each vertex
+ * @param layout Encoding used for the GPU vertex and color buffers (full float4 by default)
  * @throws std::runtime_error If vertices or color vectors are empty
  * @throws std::runtime_error If buffer creation fails
  */
-Triangle::Triangle(MTL::Device *device, const std::vector<float4> &vertices,
-                   const std::vector<float4> &color): Primitive(device) {
+Triangle::Triangle(MTL::Device *device, std::span<const float4> vertices,
+                   std::span<const float4> color, const VertexLayout &layout): Primitive(device, layout) {
     if (vertices.empty())
         throw std::runtime_error("No vertices defined");
     if (color.empty())
@@ -242,52 +606,39 @@ Triangle::Triangle(MTL::Device *device, const std::vector<float4> &vertices,
     createVertexBuffer(vertices);
     createColorBuffer(color);
     // define indices
-    std::vector<uint16_t> indices = {0, 1, 2};
+    static constexpr uint16_t indices[] = {0, 1, 2};
     Primitive::createIndexBuffer(indices);
 
     createRenderPipelineState();
 }
-Triangle::~Triangle()
-{
-
-    if (indexBuffer)
-    {
-        indexBuffer->release();
-        indexBuffer = nullptr;
-    }
-}
 /*
       Draw ------
 */
-void Triangle::draw(MTL::RenderCommandEncoder *encoder)
+void Triangle::describeDraw(DrawItem &item)
 {
-
-
-  encoder->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle,
-                                 3, // Number of indices
-                                 MTL::IndexType::IndexTypeUInt16,
-                                 indexBuffer,
-                                 0); //
+  item.indexBuffer = indexBuffer.get();
+  item.count = 3; // Number of indices (uint16)
 }
 
 void Triangle::createDefaultBuffers()
 {
+  // Static tables: the buffers copy straight from them, no temporary vectors
   // Positions
-  std::vector<float4> positions = {
-      {0.0, 0.5, 0.0, 1.0},
-      {-0.5, -0.5, 0.0, 1.0},
-      {0.5, -0.5, 0.0, 1.0}};
-  Primitive::createVertexBuffer(positions);
+  static constexpr float positions[] = {
+      0.0, 0.5, 0.0, 1.0,
+      -0.5, -0.5, 0.0, 1.0,
+      0.5, -0.5, 0.0, 1.0};
+  Primitive::createVertexBuffer(std::span<const float>(positions));
 
   // Colors
-  std::vector<float4> color = {
-      {0.5, 0.5, 0.5, 1.0}, // Gray color
-      {0.5, 0.5, 0.5, 1.0}, // Gray color
-      {0.5, 0.5, 0.5, 1.0}}; // Gray color
-  Primitive::createColorBuffer(color);
+  static constexpr float color[] = {
+      0.5, 0.5, 0.5, 1.0, // Gray color
+      0.5, 0.5, 0.5, 1.0, // Gray color
+      0.5, 0.5, 0.5, 1.0}; // Gray color
+  Primitive::createColorBuffer(std::span<const float>(color));
 
   // Indexing
-  std::vector<uint16_t> indices = {0, 1, 2};
+  static constexpr uint16_t indices[] = {0, 1, 2};
   Primitive::createIndexBuffer(indices);
 
 }
@@ -306,7 +657,7 @@ void Triangle::createDefaultBuffers()
  *
  * @param device The Metal device used to create buffers and pipeline state.
  */
-Quad::Quad(MTL::Device *device) : Primitive(device), indexBuffer(nullptr)
+Quad::Quad(MTL::Device *device) : Primitive(device)
 {
     // default
   createDefaultBuffers();
@@ -320,12 +671,14 @@ Quad::Quad(MTL::Device *device) : Primitive(device), indexBuffer(nullptr)
  * It creates the necessary GPU buffers (vertex, color, and index buffers) and sets up the render pipeline state.
  *
  * @param device The Metal device used to create buffers and pipeline state.
- * @param vertices A vector of float4 values representing the positions of the quad's vertices.
- * @param color A vector of float4 values representing the color of each vertex.
+ * @param vertices float4 values representing the positions of the quad's vertices.
+ * @param color float4 values representing the color of each vertex.
+ * @param layout Encoding used for the GPU vertex and color buffers (full float4 by default).
  * @throws std::runtime_error If the vertices or color vectors are empty.
  * @throws std::runtime_error If buffer creation fails.
  */
-Quad::Quad(MTL::Device * device, const std::vector<float4> &vertices, const std::vector<float4> &color): Primitive(device) {
+Quad::Quad(MTL::Device * device, std::span<const float4> vertices, std::span<const float4> color,
+           const VertexLayout &layout): Primitive(device, layout) {
     // custom
     if (vertices.empty())
         throw std::runtime_error("No vertices defined");
@@ -336,79 +689,52 @@ Quad::Quad(MTL::Device * device, const std::vector<float4> &vertices, const std:
 
     createColorBuffer(color);
   // Indexing
-  std::vector<uint16_t> indices = {
+  static constexpr uint16_t indices[] = {
       // First tringle
       0, 2, 3,
       // Second triangle
       0, 1, 2};
-  //Primative::createIndexBuffer(indices);
-    indexBuffer = device->newBuffer(indices.data(), indices.size() * sizeof(float4), MTL::ResourceStorageModeManaged);
-    //Primitive::createIndexBuffer(indices);        // FIXME: I cannot call this method with a quad????
+    Primitive::createIndexBuffer(indices);
 
     createRenderPipelineState();
 }
 
-Quad::~Quad()
-{
-
-  if (indexBuffer)
-  {
-    indexBuffer->release();
-    indexBuffer = nullptr;
-  }
-}
-
 void Quad::createDefaultBuffers()
 {
   // Positions
-  std::vector<float4> vertices = {
-      {-0.5, 0.5, 0.0, 1.0}, // Top Left
-      {0.5, 0.5, 0.0, 1.0},  // Top Right
-      {0.5, -0.5, 0.0, 1.0}, // Bottom Right
-      {-0.5, -0.5, 0.0, 1.0} // Bottom Left
+  static constexpr float vertices[] = {
+      -0.5, 0.5, 0.0, 1.0, // Top Left
+      0.5, 0.5, 0.0, 1.0,  // Top Right
+      0.5, -0.5, 0.0, 1.0, // Bottom Right
+      -0.5, -0.5, 0.0, 1.0 // Bottom Left
   };
-  Primitive::createVertexBuffer(vertices);
-  if (!vertexBuffer)
-    throw std::runtime_error("Vertex buffer failed to create");
+  Primitive::createVertexBuffer(std::span<const float>(vertices));
 
   // Colors
-  std::vector<float4> color = {
-      {0.0, 0.0, 1.0, 1.0},
-      {0.0, 0.0, 1.0, 1.0},
-      {0.0, 0.0, 1.0, 1.0},
-      {0.0, 0.0, 1.0, 1.0}};
-
-  Primitive::createColorBuffer(color);
-  if (!colorBuffer)
-    throw std::runtime_error("Color buffer failed to create");
+  static constexpr float color[] = {
+      0.0, 0.0, 1.0, 1.0,
+      0.0, 0.0, 1.0, 1.0,
+      0.0, 0.0, 1.0, 1.0,
+      0.0, 0.0, 1.0, 1.0};
+  Primitive::createColorBuffer(std::span<const float>(color));
 
   // Indexing
-  std::vector<uint16_t> indices = {
+  static constexpr uint16_t indices[] = {
       // First tringle
       0, 2, 3,
       // Second triangle
       0, 1, 2};
-  //Primative::createIndexBuffer(indices);
-  indexBuffer = device->newBuffer(indices.data(), indices.size() * sizeof(float4), MTL::ResourceStorageModeManaged);
-  if (!indexBuffer)
-    throw std::runtime_error("Index buffer failed to create");
-
-  // test
-  std::cout << "SUCCESS in creating Quad buffers" << std::endl;
+  Primitive::createIndexBuffer(indices);
 }
 
-void Quad::draw(MTL::RenderCommandEncoder *encoder)
+void Quad::describeDraw(DrawItem &item)
 {
-
   if (!indexBuffer)
     throw std::runtime_error("Index buffer failed to create");
 
   // Draw the quad using the index buffer
-  encoder->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle,
-                                 6, // Number of indices
-                                 MTL::IndexType::IndexTypeUInt16,
-                                 indexBuffer,
-                                 0); //
+  item.indexBuffer = indexBuffer.get();
+  item.count = 6; // Number of indices (uint16)
 }
 
 //-------------------------------------------------------------------
@@ -420,93 +746,998 @@ Circle::Circle(MTL::Device *device): Primitive(device) {
     createDefaultBuffers();
     Primitive::createRenderPipelineState();
 }
-/*
-    Destructor
-*/
-Circle::~Circle()
+
+void Circle::createDefaultBuffers() {
+    createOutlineBuffers(kDefaultSegments);
+}
+
+void Circle::createOutlineBuffers(uint32_t count) {
+    // Every stream is written straight into its buffer through the builder overloads
+    segments = count;
+
+    /*
+     * Position: the center, then the outline (the last arc point lands back on angle 0 and is
+     * the ring's first vertex, so it is dropped)
+     */
+    EllipticalArc arc;
+    arc.radius[0] = arc.radius[1] = radius;
+    outline.assign({radius, 0.0f});
+    flattenArcSegments(arc, segments, outline);
+    Primitive::createVertexBuffer(size_t{segments} + 1, [this](std::span<float> xyzw) {
+        float *out = xyzw.data();
+        *out++ = 0.0f; *out++ = 0.0f; *out++ = 0.0f; *out++ = 1.0f;
+        for (uint32_t i = 0; i < segments; ++i) {
+            *out++ = outline[2 * i];
+            *out++ = outline[2 * i + 1];
+            *out++ = 0.0f;
+            *out++ = 1.0f;
+        }
+    });
+
+    /*
+     * Color
+     */
+    Primitive::createColorBuffer(size_t{segments} + 1, [](std::span<float> rgba) {
+        for (size_t i = 0; i < rgba.size(); i += 4) {
+            rgba[i] = 0.4f;
+            rgba[i + 1] = 0.2f;
+            rgba[i + 2] = 0.3f;
+            rgba[i + 3] = 1.0f;
+        }
+    });
+
+    /*
+     * Indices: one fan triangle per segment, the last one connecting back to the first vertex
+     */
+    indexCount = 3 * segments;
+    Primitive::createIndexBuffer(indexCount, [this](std::span<uint16_t> indices) {
+        uint16_t *out = indices.data();
+        for (uint32_t i = 1; i <= segments; ++i) {
+            *out++ = 0;
+            *out++ = static_cast<uint16_t>(i);
+            *out++ = static_cast<uint16_t>(i == segments ? 1 : i + 1);
+        }
+    });
+}
+
+uint32_t Circle::fitToScreen(float viewportSize, float pixelTolerance) {
+    const float tolerance = flatteningTolerance(transform.getMatrix(), viewportSize, pixelTolerance);
+    const uint32_t needed = std::clamp(arcSegmentCount(radius, 2.0f * static_cast<float>(M_PI), tolerance),
+                                       kMinSegments, kMaxSegments);
+
+    // A quarter of headroom when growing, so a steady zoom doesn't rebuild every frame
+    if (needed > segments)
+        createOutlineBuffers(std::min(needed + needed / 4, kMaxSegments));
+    else if (needed * 2 < segments)
+        createOutlineBuffers(needed);
+    return segments;
+}
+
+uint32_t Circle::getSegmentCount() const {
+    return segments;
+}
+
+/**
+ * @brief Describes the fan; a dynamic item since fitToScreen can replace the buffers.
+ */
+void Circle::describeDraw(DrawItem &item) {
+    item.flags |= kDrawDynamic;
+    item.vertexBuffer = vertexBuffer.get();
+    item.colorBuffer = colorBuffer.get();
+    item.vertexOffset = vertexOffset;
+    item.colorOffset = colorOffset;
+    item.indexBuffer = indexBuffer.get();
+    item.count = indexCount;
+}
+
+
+//-------------------------------------------------------------------
+//    Polygon  ------------------------------------------------------
+//-------------------------------------------------------------------
+
+Polygon::Polygon(MTL::Device *device) : Primitive(device) {
+    createDefaultBuffers();
+    createRenderPipelineState();
+}
+
+/**
+ * @brief Triangulates an outline with holes and uploads it.
+ *
+ * @param device The Metal device used to create buffers and pipeline state.
+ * @param xy Flat x, y pairs: the outline, then every hole (either winding).
+ * @param holeStarts First vertex index of each hole, ascending; empty for a simple outline.
+ * @param color Color of every vertex.
+ * @param layout Encoding used for the GPU vertex and color buffers (full float4 by default).
+ * @throws std::runtime_error If the outline has fewer than 3 vertices or triangulates to nothing.
+ * @throws std::invalid_argument If holeStarts is out of order or past the vertex range.
+ */
+Polygon::Polygon(MTL::Device *device, std::span<const float> xy, std::span<const uint32_t> holeStarts,
+                 const float4 &color, const VertexLayout &layout) : Primitive(device, layout) {
+    createPolygonBuffers(xy, holeStarts, color);
+    createRenderPipelineState();
+}
+
+void Polygon::createDefaultBuffers() {
+    static constexpr float frame[] = {
+        -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f,       // Outline
+        -0.25f, -0.25f, 0.25f, -0.25f, 0.25f, 0.25f, -0.25f, 0.25f // Hole
+    };
+    static constexpr uint32_t holes[] = {4};
+    createPolygonBuffers(frame, holes, float4(0.2f, 0.6f, 0.4f, 1.0f));
+}
+
+void Polygon::createPolygonBuffers(std::span<const float> xy, std::span<const uint32_t> holeStarts,
+                                   const float4 &color) {
+    const size_t count = xy.size() / 2;
+    if (count < 3)
+        throw std::runtime_error("Polygon needs at least 3 vertices");
+
+    std::vector<uint32_t> indices;
+    triangulatePolygon(xy, holeStarts, indices, &triangulation);
+    if (indices.empty())
+        throw std::runtime_error("Polygon has no area");
+
+    // Every input vertex is kept so the indices apply as they are; unused ones cost 16 bytes
+    Primitive::createVertexBuffer(count, [xy](std::span<float> xyzw) {
+        float *out = xyzw.data();
+        for (size_t i = 0; i < xy.size() / 2; ++i) {
+            *out++ = xy[2 * i];
+            *out++ = xy[2 * i + 1];
+            *out++ = 0.0f;
+            *out++ = 1.0f;
+        }
+    });
+
+    Primitive::createColorBuffer(count, [&color](std::span<float> rgba) {
+        for (size_t i = 0; i < rgba.size(); i += 4) {
+            rgba[i] = color.x();
+            rgba[i + 1] = color.y();
+            rgba[i + 2] = color.z();
+            rgba[i + 3] = color.w();
+        }
+    });
+
+    // 16-bit indices whenever they fit, like Mesh
+    if (count <= UINT16_MAX) {
+        indexType = MTL::IndexType::IndexTypeUInt16;
+        Primitive::createIndexBuffer(indices.size(), [&indices](std::span<uint16_t> narrow) {
+            std::copy(indices.begin(), indices.end(), narrow.begin());
+        });
+    } else {
+        indexType = MTL::IndexType::IndexTypeUInt32;
+        indexBuffer = newCopiedBuffer(indices.data(), indices.size() * sizeof(uint32_t));
+    }
+    if (!indexBuffer)
+        throw std::runtime_error("Index buffer failed to create");
+    indexCount = static_cast<uint32_t>(indices.size());
+}
+
+void Polygon::describeDraw(DrawItem &item) {
+    item.indexBuffer = indexBuffer.get();
+    item.count = indexCount;
+    if (indexType == MTL::IndexType::IndexTypeUInt32)
+        item.flags |= kDrawIndex32;
+}
+
+const TriangulationStats &Polygon::getTriangulationStats() const {
+    return triangulation;
+}
+
+//-------------------------------------------------------------------
+//    Stroke  -------------------------------------------------------
+//-------------------------------------------------------------------
+
+Stroke::Stroke(MTL::Device *device) : Primitive(device) {
+    createDefaultBuffers();
+    createRenderPipelineState();
+}
+
+/**
+ * @brief Strokes a polyline and uploads the triangles.
+ *
+ * @param device The Metal device used to create buffers and pipeline state.
+ * @param xy Flat x, y pairs along the line; repeated points are dropped.
+ * @param style Width, joins, caps and whether the line is closed.
+ * @param color Color of every vertex.
+ * @param layout Encoding used for the GPU vertex and color buffers (full float4 by default).
+ * @throws std::runtime_error If fewer than 2 distinct points remain.
+ * @throws std::invalid_argument If xy isn't made of pairs or the width isn't positive.
+ */
+Stroke::Stroke(MTL::Device *device, std::span<const float> xy, const StrokeStyle &style, const float4 &color,
+               const VertexLayout &layout) : Primitive(device, layout) {
+    createStrokeBuffers(xy, style, color);
+    createRenderPipelineState();
+}
+
+void Stroke::createDefaultBuffers() {
+    static constexpr float zigzag[] = {-0.6f, -0.3f, -0.3f, 0.3f, 0.0f, -0.3f, 0.3f, 0.3f, 0.6f, -0.3f};
+    StrokeStyle style;
+    style.width = 0.08f;
+    style.join = LineJoin::Round;
+    style.cap = LineCap::Round;
+    createStrokeBuffers(zigzag, style, float4(0.9f, 0.9f, 0.9f, 1.0f));
+}
+
+void Stroke::createStrokeBuffers(std::span<const float> xy, const StrokeStyle &style, const float4 &color) {
+    const Stroker stroker(xy, style);
+    strokeStats = stroker.getStats();
+    const size_t count = stroker.getVertexCount();
+    if (count == 0)
+        throw std::runtime_error("Stroke needs at least 2 distinct points");
+
+    Primitive::createVertexBuffer(count, [&stroker](std::span<float> xyzw) { stroker.writeVertices(xyzw); });
+
+    Primitive::createColorBuffer(count, [&color](std::span<float> rgba) {
+        for (size_t i = 0; i < rgba.size(); i += 4) {
+            rgba[i] = color.x();
+            rgba[i + 1] = color.y();
+            rgba[i + 2] = color.z();
+            rgba[i + 3] = color.w();
+        }
+    });
+
+    // 16-bit indices whenever they fit, like Polygon; either way written in place
+    const size_t indices = stroker.getIndexCount();
+    if (count <= UINT16_MAX) {
+        indexType = MTL::IndexType::IndexTypeUInt16;
+        Primitive::createIndexBuffer(indices, [&stroker](std::span<uint16_t> narrow) { stroker.writeIndices(narrow); });
+    } else {
+        indexType = MTL::IndexType::IndexTypeUInt32;
+        indexBuffer = newFilledBuffer(indices * sizeof(uint32_t), [&stroker, indices](void *contents) {
+            stroker.writeIndices(std::span<uint32_t>(static_cast<uint32_t *>(contents), indices));
+        });
+    }
+    if (!indexBuffer)
+        throw std::runtime_error("Index buffer failed to create");
+    indexCount = static_cast<uint32_t>(indices);
+}
+
+void Stroke::describeDraw(DrawItem &item) {
+    item.indexBuffer = indexBuffer.get();
+    item.count = indexCount;
+    if (indexType == MTL::IndexType::IndexTypeUInt32)
+        item.flags |= kDrawIndex32;
+}
+
+const StrokeStats &Stroke::getStrokeStats() const {
+    return strokeStats;
+}
+
+//-------------------------------------------------------------------
+//    Mesh  ---------------------------------------------------------
+//-------------------------------------------------------------------
+
+/**
+ * @brief Constructs a Mesh from CPU-side indexed geometry.
+ *
+ * When `options.optimize` is set the triangles are reordered for the post-transform vertex
+ * cache and overdraw, and vertices are renumbered in first-use order before upload.
+ * When `options.generateLods` is set, coarser levels are simplified from the optimized mesh
+ * and appended to the same index buffer.
+ *
+ * @param device The Metal device used to create buffers and pipeline state.
+ * @param data Positions, optional per-vertex colors and a triangle list.
+ * @param options Optimization, LOD and vertex layout settings.
+ * @throws std::runtime_error If the mesh has no vertices or no indices.
+ */
+Mesh::Mesh(MTL::Device *device, MeshData data, const MeshOptions &options)
+    : Primitive(device, options.layout), clusterCulling(options.clusterCulling)
+{
+    MeshData &mesh = geometry.mesh;
+    mesh = std::move(data);
+    if (mesh.positions.empty())
+        throw std::runtime_error("No vertices defined");
+    if (mesh.indices.empty())
+        throw std::runtime_error("No indices defined");
+
+    if (options.optimize)
+        optimizeMesh(mesh);
+
+    LodChain &lods = geometry.lods;
+    if (options.generateLods)
+        lods = buildLodChain(mesh);
+    else
+    {
+        lods.indices = mesh.indices;
+        lods.levels.push_back({0, static_cast<uint32_t>(mesh.indices.size()), 0.0f});
+    }
+
+    if (clusterCulling)
+        meshlets = buildMeshlets(mesh);
+
+    createDefaultBuffers();
+    createRenderPipelineState();
+}
+
+/**
+ * @brief Constructs a Mesh from baked geometry, such as a mesh cache hit.
+ *
+ * The vertex/index order and LOD chain are uploaded as they are; `options.optimize` and
+ * `options.generateLods` are ignored. A cache hit (`baked.cache`) in the default layout is not
+ * copied at all: the mapping is wrapped in one no-copy buffer and kept alive with the mesh.
+ *
+ * @throws std::runtime_error If the mesh has no vertices or no LOD 0.
+ */
+Mesh::Mesh(MTL::Device *device, BakedMesh baked, const MeshOptions &options)
+    : Primitive(device, options.layout), geometry(std::move(baked)), clusterCulling(options.clusterCulling)
+{
+    if (geometry.positions().empty())
+        throw std::runtime_error("No vertices defined");
+    if (geometry.lods.levels.empty() || geometry.indices().empty())
+        throw std::runtime_error("No indices defined");
+
+    if (clusterCulling)
+        meshlets = buildMeshlets(geometry.positions(), geometry.indices());
+
+    createDefaultBuffers();
+    createRenderPipelineState();
+}
+
+
+void Mesh::createDefaultBuffers()
 {
+    if (geometry.cache && vertexLayout.isDefault())
+        adoptCacheBuffers();
+    else
+    {
+        const std::span<const Position> positions = geometry.positions();
+        Primitive::createVertexBuffer(std::span<const float>(&positions.data()->x, positions.size() * 4));
+
+        // Default to gray when the source has no vertex colors
+        const std::span<const Color> colors = geometry.colors();
+        if (colors.size() != positions.size())
+        {
+            Primitive::createColorBuffer(positions.size(), [](std::span<float> rgba) {
+                for (size_t i = 0; i < rgba.size(); i += 4)
+                {
+                    rgba[i] = rgba[i + 1] = rgba[i + 2] = 0.5f;
+                    rgba[i + 3] = 1.0f;
+                }
+            });
+        }
+        else
+        {
+            Primitive::createColorBuffer(std::span<const float>(&colors.data()->r, colors.size() * 4));
+        }
+
+        // 16-bit indices whenever they fit, halving index fetch bandwidth
+        const std::span<const uint32_t> lodIndices = geometry.lodIndices();
+        if (positions.size() <= UINT16_MAX)
+        {
+            indexType = MTL::IndexType::IndexTypeUInt16;
+            Primitive::createIndexBuffer(lodIndices.size(), [&lodIndices](std::span<uint16_t> narrow) {
+                std::copy(lodIndices.begin(), lodIndices.end(), narrow.begin());
+            });
+        }
+        else
+        {
+            indexType = MTL::IndexType::IndexTypeUInt32;
+            indexBuffer = newCopiedBuffer(lodIndices.data(), lodIndices.size_bytes());
+        }
+        lodIndexOffset = 0;
+    }
 
+    if (!indexBuffer)
+        throw std::runtime_error("Index buffer failed to create");
 
-    if (vertexBuffer)
+    // One compacted index stream per frame in flight, so the CPU never writes what the GPU reads
+    if (clusterCulling)
     {
-        vertexBuffer->release();
-        vertexBuffer = nullptr;
+        const NS::UInteger indexSize = indexType == MTL::IndexType::IndexTypeUInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        const NS::UInteger bytes = geometry.indices().size() * indexSize;
+        for (Handle<MTL::Buffer> &buffer : clusterIndexBuffers)
+        {
+            buffer = Handle<MTL::Buffer>(device->newBuffer(bytes, MTL::ResourceStorageModeManaged));
+            ++buffers.stats.allocations;
+            buffers.stats.bytesAllocated += bytes;
+            if (!buffer)
+                throw std::runtime_error("Cluster index buffer failed to create");
+        }
     }
+}
+
+/**
+ * @brief Draws a cache hit from its mapping: every section sits 16-byte aligned in the page-aligned
+ * file, so one no-copy buffer serves positions, colors and 32-bit indices at their file offsets.
+ *
+ * The streams are read-only (no vertexCount / colorCount), so CPU updates are rejected.
+ */
+void Mesh::adoptCacheBuffers()
+{
+    const MeshCacheView &cache = *geometry.cache;
+    const MeshCacheHeader &header = *cache.header;
 
-    if (pipelineState)
+    // Metal only reads the wrapped pages; the mapping itself stays PROT_READ
+    vertexBuffer = newAdoptedBuffer(const_cast<char *>(cache.file.data()), cache.file.size(),
+                                    std::const_pointer_cast<MeshCacheView>(geometry.cache));
+    if (!vertexBuffer)
+        throw std::runtime_error("Failed to create mesh cache buffer");
+    vertexOffset = header.positionsOffset;
+
+    if (cache.colors)
+    {
+        colorBuffer = Handle<MTL::Buffer>::retain(vertexBuffer.get());
+        colorOffset = header.colorsOffset;
+    }
+    else
     {
-        pipelineState->release();
-        pipelineState = nullptr;
+        Primitive::createColorBuffer(header.vertexCount, [](std::span<float> rgba) {
+            for (size_t i = 0; i < rgba.size(); i += 4)
+            {
+                rgba[i] = rgba[i + 1] = rgba[i + 2] = 0.5f;
+                rgba[i + 3] = 1.0f;
+            }
+        });
+        colorOffset = 0;
     }
 
+    indexBuffer = Handle<MTL::Buffer>::retain(vertexBuffer.get());
+    indexType = MTL::IndexType::IndexTypeUInt32;
+    lodIndexOffset = header.indicesOffset;
+
+    // Baked with the mesh, nothing to scan
+    localBounds = geometry.bounds;
+    worldBoundsVersion = UINT64_MAX;
 }
 
-void Circle::createDefaultBuffers() {
-   /*
-    * Position
-    */
-   std::vector<float4> positions;
-   unsigned int vertexCount {100};
-   float angle = (2 * M_PI) / vertexCount;
-   positions.emplace_back(0.0, 0.0, 0.0, 1.0);
-   for(int i {1}; i <= vertexCount; ++i){
-       float x = radius * cos(i * angle);
-       float y = radius * sin(i * angle);
-       positions.emplace_back(x, y, 0.0, 1.0);
-   }
-
-   Primitive::createVertexBuffer(positions);
-   if (!vertexBuffer) {
-       throw std::runtime_error("Failed to create circles vertexBuffer");
-   }
-
-   /*
-    * Color
-    */
-   std::vector<float4> color;
-   for (int i {0}; i <= vertexCount; ++i){
-       color.emplace_back(0.4, 0.2, 0.3, 1.0);
-   }
-   Primitive::createColorBuffer(color);
-    if (!colorBuffer)
-        throw std::runtime_error("Color buffer failed to create");
+/**
+ * @brief Culls meshlets against the clip volume and the view direction, in object space.
+ *
+ * Clip space is `transform * position` (no camera yet): x, y in [-1, 1], z in [0, 1],
+ * looking down +z, so the object-space planes come straight from the transform.
+ */
+void Mesh::cullClusters()
+{
+    const Eigen::Matrix4f &m = transform.getMatrix();
 
-    /*
-     * Indices
-     */
-    std::vector<uint16_t> indices;
-    const uint16_t centerIdx = 0;
-    for (uint16_t i = 1; i <= vertexCount; ++i) {
-        // Create two triangles for each segment of the circle
-        indices.push_back(centerIdx); // Center vertex
-        indices.push_back(i);
-        if (i == vertexCount) {
-            indices.push_back(1); // Connect back to the first vertex
-        } else {
-            indices.push_back(i + 1);
+    ClusterCullParams params;
+    const Frustum frustum = extractFrustum(m);
+    std::copy(&frustum.planes[0][0], &frustum.planes[0][0] + 24, &params.planes[0][0]);
+
+    // Facing in object space: sign(det) * M^-1 * view axis (a mirroring transform flips winding)
+    const Eigen::Matrix3f linear = m.block<3, 3>(0, 0);
+    const float det = linear.determinant();
+    params.backfaceCulling = std::abs(det) > 1e-8f;     // flattened meshes show both sides
+    if (params.backfaceCulling)
+    {
+        Eigen::Vector3f view = linear.inverse() * Eigen::Vector3f(0.0f, 0.0f, 1.0f);
+        view = view.normalized() * (det > 0.0f ? 1.0f : -1.0f);
+        for (int k = 0; k < 3; ++k)
+            params.viewDirection[k] = view[k];
+    }
+
+    // The slot was last drawn kMaxFramesInFlight frames ago; the GPU may still be reading it
+    DeferredReleaseQueue &releaseQueue = DeferredReleaseQueue::shared();
+    clusterFrame = (clusterFrame + 1) % kMaxFramesInFlight;
+    releaseQueue.waitForFrame(clusterSlotFrames[clusterFrame]);
+    clusterSlotFrames[clusterFrame] = releaseQueue.getEncodingFrame();
+    MTL::Buffer *buffer = clusterIndexBuffers[clusterFrame].get();
+    size_t written;
+    if (indexType == MTL::IndexType::IndexTypeUInt16)
+        written = cullMeshlets(static_cast<uint16_t *>(buffer->contents()), meshlets, params, &clusterStats);
+    else
+        written = cullMeshlets(static_cast<uint32_t *>(buffer->contents()), meshlets, params, &clusterStats);
+
+    const NS::UInteger indexSize = indexType == MTL::IndexType::IndexTypeUInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    if (written)
+        buffer->didModifyRange(NS::Range::Make(0, written * indexSize));
+    clusterIndexCount = written;
+}
+
+/**
+ * @brief Selects the LOD whose simplification error stays under `pixelThreshold` on screen.
+ *
+ * The projected size only depends on the largest scale in the transform (see pixelsPerUnit).
+ */
+size_t Mesh::selectLod(float viewportSize, float pixelThreshold)
+{
+    currentLod = ::selectLod(geometry.lods, pixelsPerUnit(transform.getMatrix(), viewportSize), pixelThreshold);
+    return currentLod;
+}
+
+/**
+ * @brief Describes the current LOD, or this frame's visible clusters.
+ *
+ * Meshes with a LOD chain or cluster culling are dynamic items. Cluster lists are culled
+ * here, once per drawn frame, into the next per-frame index buffer; compiling only marks
+ * the item so the first cull happens with the frame that draws it.
+ */
+void Mesh::describeDraw(DrawItem &item)
+{
+    const bool compiling = !(item.flags & kDrawDynamic);
+    if (clusterCulling || geometry.lods.levels.size() > 1)
+        item.flags |= kDrawDynamic;
+    if (indexType == MTL::IndexType::IndexTypeUInt32)
+        item.flags |= kDrawIndex32;
+
+    if (clusterCulling)
+    {
+        // Match the CPU cone test: counter-clockwise front faces
+        item.flags |= kDrawCullBack;
+        item.indexOffset = 0;
+        item.count = 0;
+        if (compiling)
+            return;
+
+        cullClusters();
+        item.indexBuffer = clusterIndexBuffers[clusterFrame].get();
+        item.count = static_cast<uint32_t>(clusterIndexCount);
+        return;
+    }
+
+    const LodLevel &level = geometry.lods.levels[currentLod];
+    const NS::UInteger indexSize = indexType == MTL::IndexType::IndexTypeUInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    item.indexBuffer = indexBuffer.get();
+    item.indexOffset = lodIndexOffset + level.indexOffset * indexSize;
+    item.count = level.indexCount;
+}
+
+float Mesh::intersectRay(const Ray &objectRay) const
+{
+    const std::span<const uint32_t> indices = geometry.indices();
+    return intersectTriangles(objectRay, &geometry.positions().data()->x, indices.data(), indices.size());
+}
+
+void Mesh::updateVertices(size_t first, const float *positions, size_t count)
+{
+    if (geometry.cache)
+        throw std::runtime_error("Mesh cache geometry is read-only; build the Mesh from toBakedMesh() to edit it");
+    Primitive::updateVertices(first, positions, count);
+    std::memcpy(geometry.mesh.positions.data() + first, positions, count * sizeof(Position));
+}
+
+std::span<const Position> Mesh::getPositions() const
+{
+    return geometry.positions();
+}
+
+std::span<const uint32_t> Mesh::getIndices() const
+{
+    return geometry.indices();
+}
+
+const LodChain &Mesh::getLodChain() const
+{
+    return geometry.lods;
+}
+
+const ClusterCullStats &Mesh::getClusterStats() const
+{
+    return clusterStats;
+}
+
+//-------------------------------------------------------------------
+//    Procedural Shapes  ---------------------------------------------
+//-------------------------------------------------------------------
+
+ProceduralShapes::ProceduralShapes(MTL::Device *device) : Primitive(device)
+{
+    createDefaultBuffers();
+    createRenderPipelineState();
+}
+
+/**
+ * @brief Constructs a batch of procedural shapes drawn with a single instanced draw.
+ *
+ * @param device The Metal device used to create the instance buffer and pipeline state.
+ * @param instances One record per shape (kind, center, radius, segments, rgba8 color).
+ * @throws std::runtime_error If instances is empty, a kind is unknown or the buffer cannot be created.
+ */
+ProceduralShapes::ProceduralShapes(MTL::Device *device, std::span<const ProceduralInstance> instances)
+    : Primitive(device)
+{
+    createInstanceBuffer(instances);
+    createRenderPipelineState();
+}
+
+void ProceduralShapes::createDefaultBuffers()
+{
+    // Same look as the default Circle
+    ProceduralInstance circle{};
+    circle.radius = 0.5f;
+    circle.kind = static_cast<uint32_t>(ShapeKind::Circle);
+    circle.segments = 100;
+    circle.color = packColor(0.4f, 0.2f, 0.3f, 1.0f);
+    createInstanceBuffer(std::span<const ProceduralInstance>(&circle, 1));
+}
+
+void ProceduralShapes::createInstanceBuffer(std::span<const ProceduralInstance> instances)
+{
+    if (instances.empty())
+        throw std::runtime_error("No instances defined");
+
+    vertexCount = 0;
+    for (const ProceduralInstance &instance : instances)
+    {
+        const uint32_t count = verticesPerInstance(instance);
+        if (count == 0)
+            throw std::runtime_error("Unknown procedural shape kind");
+        vertexCount = std::max<NS::UInteger>(vertexCount, count);
+    }
+    instanceCount = instances.size();
+
+    // Bounds of the shapes' extents (every shape fits in a square of side 2 * radius)
+    std::vector<float> extents;
+    extents.reserve(instances.size() * 8);
+    for (const ProceduralInstance &instance : instances)
+    {
+        extents.insert(extents.end(), {instance.center[0] - instance.radius, instance.center[1] - instance.radius, 0.0f, 1.0f,
+                                       instance.center[0] + instance.radius, instance.center[1] + instance.radius, 0.0f, 1.0f});
+    }
+    localBounds = computeBounds(extents.data(), instances.size() * 2);
+    worldBoundsVersion = UINT64_MAX;
+
+    vertexBuffer = newCopiedBuffer(instances.data(), instances.size_bytes());
+    if (!vertexBuffer)
+        throw std::runtime_error("Failed to create instance buffer");
+}
+
+void ProceduralShapes::describeDraw(DrawItem &item)
+{
+    item.count = static_cast<uint32_t>(vertexCount);
+    item.instanceCount = static_cast<uint32_t>(instanceCount);
+}
+
+const char *ProceduralShapes::vertexFunctionName() const
+{
+    return "vertex_procedural";
+}
+
+NS::UInteger ProceduralShapes::getInstanceCount() const
+{
+    return instanceCount;
+}
+
+NS::UInteger ProceduralShapes::getVertexCountPerInstance() const
+{
+    return vertexCount;
+}
+
+//-------------------------------------------------------------------
+//    Particles  -----------------------------------------------------
+//-------------------------------------------------------------------
+
+Particles::Particles(MTL::Device *device) : Primitive(device), system(20000)
+{
+    createDefaultBuffers();
+    createRenderPipelineState();
+}
+
+/**
+ * @brief Constructs an emitter-fed particle system drawn with a single instanced draw.
+ *
+ * @param device The Metal device used to create the instance buffer and pipeline state.
+ * @param capacity Most particles alive at once; emits past it are dropped.
+ * @param emitter Where and how new particles spawn.
+ * @param rate Particles emitted per second of simulate() time.
+ * @param forces Gravity and drag applied to every particle.
+ * @throws std::runtime_error If capacity is 0 or the buffer cannot be created.
+ */
+Particles::Particles(MTL::Device *device, size_t capacity, const ParticleEmitter &emitter, float rate,
+                     const ParticleForces &forces)
+    : Primitive(device), system(capacity), emitter(emitter), forces(forces), rate(rate)
+{
+    createInstanceBuffer();
+    createRenderPipelineState();
+}
+
+void Particles::createDefaultBuffers()
+{
+    emitter.position[0] = 0.0f;
+    emitter.position[1] = -0.8f;
+    emitter.jitter = 0.02f;
+    emitter.spread = 0.35f;
+    emitter.speedMin = 0.9f;
+    emitter.speedMax = 1.4f;
+    emitter.color = packColor(1.0f, 0.55f, 0.15f, 1.0f);
+    forces.gravity[1] = -1.2f;
+    forces.drag = 0.4f;
+    rate = 8000.0f;
+    createInstanceBuffer();
+}
+
+void Particles::createInstanceBuffer()
+{
+    const size_t capacity = system.getCapacity();
+    if (capacity == 0)
+        throw std::runtime_error("Particles need a capacity of at least 1");
+
+    // One slice per frame in flight, so a slice is never rewritten while the GPU may still read it
+    const size_t bytes = kMaxFramesInFlight * capacity * sizeof(ProceduralInstance);
+    vertexBuffer = newFilledBuffer(bytes, [bytes](void *contents) { std::memset(contents, 0, bytes); });
+    if (!vertexBuffer)
+        throw std::runtime_error("Failed to create instance buffer");
+
+    // Nothing alive yet: bounds start at the emitter and follow the particles in simulate()
+    const float origin[] = {emitter.position[0], emitter.position[1], 0.0f, 1.0f};
+    localBounds = computeBounds(origin, 1);
+    worldBoundsVersion = UINT64_MAX;
+}
+
+/**
+ * @brief Emits `rate * dt` particles, then integrates and kills.
+ *
+ * The local bounds follow the live particles (grown by their size) so culling sees
+ * where they actually are.
+ */
+void Particles::simulate(float dt)
+{
+    if (dt <= 0.0f)
+        return;
+
+    pendingEmits += rate * dt;
+    const size_t emits = static_cast<size_t>(pendingEmits);
+    pendingEmits -= static_cast<float>(emits);
+    system.emit(emitter, emits);
+
+    updateStats = system.update(dt, forces);
+    if (updateStats.updated == 0)
+        return;
+
+    const float extents[] = {updateStats.min[0] - emitter.size, updateStats.min[1] - emitter.size, 0.0f, 1.0f,
+                             updateStats.max[0] + emitter.size, updateStats.max[1] + emitter.size, 0.0f, 1.0f};
+    localBounds = computeBounds(extents, 2);
+    ++localBoundsRevision;
+}
+
+/**
+ * @brief Writes this frame's instances and describes the instanced draw.
+ *
+ * Always a dynamic item; compiling only marks it, so instances are written once per
+ * drawn frame into the next slice of the instance buffer, after the frame that last
+ * drew that slice has completed.
+ */
+void Particles::describeDraw(DrawItem &item)
+{
+    const bool compiling = !(item.flags & kDrawDynamic);
+    item.flags |= kDrawDynamic;
+    item.count = 0;
+    if (compiling)
+        return;
+
+    // The slice was last written kMaxFramesInFlight frames ago; the GPU may still be reading it
+    DeferredReleaseQueue &releaseQueue = DeferredReleaseQueue::shared();
+    frameSlot = (frameSlot + 1) % kMaxFramesInFlight;
+    releaseQueue.waitForFrame(slotFrames[frameSlot]);
+    slotFrames[frameSlot] = releaseQueue.getEncodingFrame();
+    const size_t capacity = system.getCapacity();
+    const NS::UInteger offset = frameSlot * capacity * sizeof(ProceduralInstance);
+    std::span<ProceduralInstance> instances(
+        reinterpret_cast<ProceduralInstance *>(static_cast<char *>(vertexBuffer->contents()) + offset), capacity);
+
+    const size_t written = system.writeInstances(instances);
+    if (written == 0)
+        return;
+    vertexBuffer->didModifyRange(NS::Range::Make(offset, written * sizeof(ProceduralInstance)));
+
+    item.vertexOffset = offset;
+    item.count = static_cast<uint32_t>(verticesPerInstance(instances[0]));
+    item.instanceCount = static_cast<uint32_t>(written);
+}
+
+const char *Particles::vertexFunctionName() const
+{
+    return "vertex_procedural";
+}
+
+ParticleSystem &Particles::getSystem()
+{
+    return system;
+}
+
+const ParticleUpdateStats &Particles::getUpdateStats() const
+{
+    return updateStats;
+}
+
+//-------------------------------------------------------------------
+//    Terrain Patch  -------------------------------------------------
+//-------------------------------------------------------------------
+
+TerrainPatch::TerrainPatch(MTL::Device *device) : Primitive(device)
+{
+    createDefaultBuffers();
+    createRenderPipelineState();
+}
+
+/**
+ * @brief Uploads one built terrain chunk; its indices come from the terrain's shared stitch buffer.
+ *
+ * @param device The Metal device used to create buffers and pipeline state.
+ * @param chunk Positions and colors on the chunk's vertex grid.
+ * @param stitchBuffer newTerrainStitchBuffer(device, stitch), retained by the patch.
+ * @param stitch Offsets and counts of the variants inside stitchBuffer.
+ * @throws std::runtime_error If the chunk's vertex count doesn't match the stitch or a buffer cannot be created.
+ */
+TerrainPatch::TerrainPatch(MTL::Device *device, const TerrainChunk &chunk, MTL::Buffer *stitchBuffer,
+                           const TerrainStitch &stitch)
+    : Primitive(device), node(chunk.node)
+{
+    if (!stitchBuffer)
+        throw std::runtime_error("Terrain patch needs a stitch buffer");
+    indexBuffer = Handle<MTL::Buffer>::retain(stitchBuffer);
+    createPatchBuffers(chunk.mesh, stitch);
+    createRenderPipelineState();
+}
+
+void TerrainPatch::createDefaultBuffers()
+{
+    constexpr uint32_t kCells = 8;
+    const TerrainStitch stitch = buildTerrainStitch(kCells);
+    indexBuffer = newTerrainStitchBuffer(device, stitch);
+
+    MeshData mesh;
+    for (uint32_t j = 0; j <= kCells; ++j)
+    {
+        for (uint32_t i = 0; i <= kCells; ++i)
+        {
+            mesh.positions.push_back({static_cast<float>(i) / kCells - 0.5f, static_cast<float>(j) / kCells - 0.5f, 0.0f, 1.0f});
+            mesh.colors.push_back({0.15f, 0.35f, 0.15f, 1.0f});
         }
     }
+    createPatchBuffers(mesh, stitch);
+    show(0);
+}
+
+void TerrainPatch::createPatchBuffers(const MeshData &mesh, const TerrainStitch &stitch)
+{
+    // Variant 0 is the full grid: cells^2 quads of 2 triangles
+    const size_t cells = static_cast<size_t>(std::lround(std::sqrt(stitch.count[0] / 6.0)));
+    if (mesh.positions.size() != (cells + 1) * (cells + 1) || mesh.colors.size() != mesh.positions.size())
+        throw std::runtime_error("Terrain chunk doesn't match its stitch's vertex grid");
+
+    Primitive::createVertexBuffer(std::span<const float>(&mesh.positions.data()->x, mesh.positions.size() * 4));
+    Primitive::createColorBuffer(std::span<const float>(&mesh.colors.data()->r, mesh.colors.size() * 4));
+    std::copy(std::begin(stitch.offset), std::end(stitch.offset), variantOffsets);
+    std::copy(std::begin(stitch.count), std::end(stitch.count), variantCounts);
+}
+
+void TerrainPatch::show(uint8_t edges)
+{
+    this->edges = static_cast<uint8_t>(edges & 15u);
+    shown = true;
+}
+
+void TerrainPatch::hide()
+{
+    shown = false;
+}
+
+// Dynamic, so show() / hide() take effect on the next drawn frame
+void TerrainPatch::describeDraw(DrawItem &item)
+{
+    item.flags |= kDrawDynamic;
+    item.indexBuffer = indexBuffer.get();
+    item.indexOffset = variantOffsets[edges] * sizeof(uint16_t);
+    item.count = shown ? variantCounts[edges] : 0;
+}
+
+uint64_t TerrainPatch::getNode() const
+{
+    return node;
+}
+
+Handle<MTL::Buffer> newTerrainStitchBuffer(MTL::Device *device, const TerrainStitch &stitch)
+{
+    Handle<MTL::Buffer> buffer(device->newBuffer(stitch.indices.data(), stitch.indices.size() * sizeof(uint16_t),
+                                                 MTL::ResourceStorageModeManaged));
+    if (!buffer)
+        throw std::runtime_error("Failed to create terrain stitch buffer");
+    return buffer;
+}
+
+//-------------------------------------------------------------------
+//    Imported Mesh  -------------------------------------------------
+//-------------------------------------------------------------------
+ImportedMesh::ImportedMesh(MTL::Device *device, std::shared_ptr<const GltfAsset> asset, const GltfPrimitive &primitive,
+                           MTL::Buffer *fileBuffer)
+    : Primitive(device, VertexLayout{PositionFormat::PackedFloat3, primitive.colorFormat}),
+      asset(std::move(asset)), source(primitive), fileBuffer(fileBuffer)
+{
+    createDefaultBuffers();
+    createRenderPipelineState();
+}
+
+ImportedMesh::~ImportedMesh()
+{
+    // In-place streams read the asset's file mapping; keep it until the GPU is done with them
+    retireMemory(std::move(asset));
+}
 
-    // Add the last triangle to close the circle
-    for (uint16_t i = 1; i < vertexCount; ++i) {
-        indices.push_back(0); // Center vertex
-        indices.push_back(i);
-        indices.push_back(i + 1);
+Handle<MTL::Buffer> ImportedMesh::createStreamBuffer(const GltfStream &stream, NS::UInteger &offset)
+{
+    if (stream.zeroCopy && fileBuffer)
+    {
+        offset = stream.fileOffset;
+        return Handle<MTL::Buffer>::retain(fileBuffer);
     }
 
-    indexBuffer = device->newBuffer(indices.data(), indices.size() * sizeof(uint16_t), MTL::ResourceStorageModeManaged );
-    if (!indexBuffer)
-        throw std::runtime_error("Index buffer failed to create");
+    offset = 0;
+    Handle<MTL::Buffer> buffer = newCopiedBuffer(stream.data, stream.byteSize);
+    if (!buffer)
+        throw std::runtime_error("Failed to create imported stream buffer");
+    return buffer;
 }
 
-void Circle::draw(MTL::RenderCommandEncoder *encoder) {
-    // This is the draw call
-    std::cout << "Drawing circle" << std::endl;
+void ImportedMesh::createDefaultBuffers()
+{
+    if (source.vertexCount == 0)
+        throw std::runtime_error("No vertices defined");
+
+    // Bounds come from the accessor's min/max, the vertex data is never touched on the CPU
+    float radiusSq = 0.0f;
+    for (int c = 0; c < 3; ++c)
+    {
+        localBounds.box.min[c] = source.bounds.min[c];
+        localBounds.box.max[c] = source.bounds.max[c];
+        localBounds.sphere.center[c] = 0.5f * (source.bounds.min[c] + source.bounds.max[c]);
+        const float half = 0.5f * (source.bounds.max[c] - source.bounds.min[c]);
+        radiusSq += half * half;
+    }
+    localBounds.sphere.radius = std::sqrt(radiusSq);
+    worldBoundsVersion = UINT64_MAX;
+
+    vertexBuffer = createStreamBuffer(source.positions, vertexOffset);
+
+    if (source.colors.empty())
+    {
+        // No COLOR_0: opaque white, in the Unorm8x4 layout the loader reports for this case
+        colorBuffer = newFilledBuffer(source.vertexCount * sizeof(uint32_t), [this](void *contents) {
+            std::fill_n(static_cast<uint32_t *>(contents), source.vertexCount, 0xFFFFFFFFu);
+        });
+        if (!colorBuffer)
+            throw std::runtime_error("Failed to create imported color buffer");
+        colorOffset = 0;
+    }
+    else
+    {
+        colorBuffer = createStreamBuffer(source.colors, colorOffset);
+    }
 
-    encoder->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle,
-                                   indexBuffer->length() / sizeof(uint16_t), // Number of indices
-                                   MTL::IndexType::IndexTypeUInt16,
-                                   indexBuffer,
-                                   0); //
+    if (!source.indices.empty())
+        indexBuffer = createStreamBuffer(source.indices, indexOffset);
 }
 
+void ImportedMesh::describeDraw(DrawItem &item)
+{
+    if (!indexBuffer)
+    {
+        item.count = static_cast<uint32_t>(source.vertexCount);
+        return;
+    }
+
+    item.indexBuffer = indexBuffer.get();
+    item.indexOffset = indexOffset;
+    item.count = static_cast<uint32_t>(source.indexCount);
+    if (source.indexSize == 4)
+        item.flags |= kDrawIndex32;
+}
+
+std::vector<Primitive *> createGltfPrimitives(MTL::Device *device, const std::shared_ptr<const GltfAsset> &asset)
+{
+    // One shared no-copy view of the whole mapping; page-aligned base, page-rounded length
+    Handle<MTL::Buffer> fileBuffer;
+    if (asset->stats.zeroCopyBytes > 0)
+    {
+        fileBuffer = Handle<MTL::Buffer>(device->newBuffer(asset->file.data(), asset->file.pageAlignedSize(),
+                                                           MTL::ResourceStorageModeShared, nullptr));
+        if (!fileBuffer)
+            std::cerr << "No-copy buffer failed, copying imported streams" << std::endl;
+    }
+
+    std::vector<Primitive *> primitives;
+    for (const GltfNode &node : asset->nodes)
+    {
+        if (node.mesh < 0)
+            continue;
+        for (const GltfPrimitive &primitive : asset->meshes[node.mesh].primitives)
+        {
+            Primitive *mesh = new ImportedMesh(device, asset, primitive, fileBuffer.get());
+            mesh->getTransform().setMatrix(node.world);
+            primitives.push_back(mesh);
+        }
+    }
+
+    return primitives;      // Each ImportedMesh retained its own reference to fileBuffer
+}
@@ -7,36 +7,215 @@
 #include <Metal/Metal.hpp>
 #include "../common/vec4.h"
 #include "../common/Transform.h"
+#include "../VertexFormat/vertexFormat.h"
+#include "../common/meshData.h"
+#include "../common/dirtyRanges.h"
+#include "../common/pageMemory.h"
+#include "../MeshOptimizer/meshSimplifier.h"
+#include "../MeshOptimizer/meshlets.h"
+#include "../Procedural/proceduralShapes.h"
+#include "../Culling/bounds.h"
+#include "../Culling/bvh.h"
+#include "../Loader/gltfLoader.h"
+#include "../Loader/meshCache.h"
+#include "../Resource/handle.h"
+#include "streamBuffers.h"
+#include "streamRing.h"
+#include "../Draw/drawItem.h"
+#include "../Draw/renderTarget.h"
+#include "../Tessellation/triangulator.h"
+#include "../Tessellation/stroker.h"
+#include "../Tessellation/curveFlattener.h"
+#include "../Particles/particleSystem.h"
+#include "../Terrain/terrain.h"
 
+#include <functional>
+#include <memory>
+#include <span>
+
+// Cumulative dynamic-update counters of one Primitive
+struct BufferUploadStats {
+    uint64_t updates{0};            // updateVertices / updateColors calls
+    uint64_t bytesWritten{0};       // Encoded bytes written into buffer memory
+    uint64_t bytesCaughtUp{0};      // Copied into each new slice from the one before (StreamRing)
+    uint64_t flushes{0};            // flushUpdates calls that had something to publish
+    uint64_t ranges{0};             // didModifyRange calls (coalesced ranges)
+    uint64_t bytesFlushed{0};       // Bytes covered by those ranges
+    uint64_t fenceWaits{0};         // Frames that moved to the next slice, fenced on the frame that last drew it
+};
+
+// StreamBuffers' device half: Managed buffers, Shared when wrapping caller memory
+struct MetalBufferDevice {
+    using Buffer = Handle<MTL::Buffer>;
+
+    MTL::Device *device{nullptr};
+
+    Buffer newBuffer(size_t bytes) const
+    {
+        return Buffer(device->newBuffer(bytes, MTL::ResourceStorageModeManaged));
+    }
+    Buffer newBuffer(const void *source, size_t bytes) const
+    {
+        return Buffer(device->newBuffer(source, bytes, MTL::ResourceStorageModeManaged));
+    }
+    Buffer newBufferNoCopy(void *memory, size_t bytes) const
+    {
+        return Buffer(device->newBuffer(memory, bytes, MTL::ResourceStorageModeShared, nullptr));
+    }
+    static void *contents(const Buffer &buffer) { return buffer->contents(); }
+    static void didModify(const Buffer &buffer, size_t bytes) { buffer->didModifyRange(NS::Range::Make(0, bytes)); }
+};
 
 class Primitive {
 public:
-    explicit Primitive(MTL::Device *device);
+    explicit Primitive(MTL::Device *device, const VertexLayout &layout = {});
 
-    virtual ~Primitive() = 0; // Special case for each deallocation
+    // GPU objects are Handles, released once the frames that may use them are done
+    virtual ~Primitive() = 0;
 
-    void encodeRenderCommands(MTL::RenderCommandEncoder *encoder) const;
+    /*
+     *  Drawing
+     *
+     *  A primitive is compiled once into a DrawItem (buffers, offsets, counts) when it joins a
+     *  DrawList; the frame loop then draws from that plain data. compileDrawItem throws
+     *  std::runtime_error without a pipeline or vertex buffer, so nothing is checked per frame.
+     *  describeDraw fills the per-draw part; items flagged kDrawDynamic get it again, through
+     *  prepareDraw, before every frame that draws them.
+     */
+    DrawItem compileDrawItem();
+    void prepareDraw(DrawItem &item);
+    virtual void describeDraw(DrawItem &item) = 0;
 
-    virtual void draw(MTL::RenderCommandEncoder *encoder) = 0;
+    MTL::RenderPipelineState *getPipelineState() const;
+    const VertexDequant &getDequant() const;
+
+    /*
+     *  Blending
+     *
+     *  Opaque primitives overwrite the color buffer. Alpha and Additive ones blend by their colors'
+     *  alpha, so their DrawItems are flagged kDrawBlended and drawn after every opaque one, back to
+     *  front. Changing the mode rebuilds the pipeline: rebuild any DrawList holding the primitive.
+     */
+    void setBlendMode(BlendMode mode);
+    BlendMode getBlendMode() const;
 
     Transform &getTransform();
 
+    // Object-space bounds from the vertex data, and the same bounds under the current Transform
+    const Bounds &getLocalBounds() const;
+    const Bounds &getWorldBounds() const;
+
+    // Changes whenever the world bounds may have (Transform changes or local bounds growing)
+    uint64_t getBoundsVersion() const;
+
+    // Closest hit distance of an object-space ray (>= tMax on a miss); tests the local box by default
+    virtual float intersectRay(const Ray &objectRay) const;
+
+    /*
+     *  Dynamic geometry
+     *
+     *  makeDynamic() moves the vertex and color streams into rings of one slice per frame in
+     *  flight (StreamRing), so updating them never stalls on frames the GPU is still drawing.
+     *  Call it before the primitive joins a DrawList (its items then re-describe themselves every
+     *  frame); otherwise rebuild the list, whose items still borrow the static buffers.
+     *  Recreating a stream (e.g. Circle::fitToScreen) makes it static again.
+     *
+     *  Overwrite `count` vertices (xyzw floats) or colors (rgba floats) starting at vertex
+     *  `first`, in the primitive's own vertex order, encoded into the layout's format. The
+     *  first update of each encoded frame moves to the next slice, waiting
+     *  (DeferredReleaseQueue::waitForFrame) only for the frame that last drew that slice, and
+     *  catches it up with what the other slices were written; writes then go straight into it
+     *  and are recorded as dirty byte ranges, which flushUpdates() publishes once per frame.
+     *  Updates become visible to the next committed frame.
+     *
+     *  Local bounds only ever grow, so culling stays conservative. Normalized position formats
+     *  (Half4, Snorm16x4) clamp to the bounds the buffer was created with.
+     *  Throws std::runtime_error on static streams and std::out_of_range past the end of the
+     *  stream (streams not created through createVertexBuffer/createColorBuffer, e.g. glTF views,
+     *  have no updatable vertices).
+     */
+    void makeDynamic();
+    bool isDynamic() const;
+    virtual void updateVertices(size_t first, const float *positions, size_t count);
+    void updateColors(size_t first, const float *colors, size_t count);
+
+    // One didModifyRange per coalesced dirty range (Managed storage; Shared needs none). Returns bytes flushed.
+    size_t flushUpdates();
+    bool hasPendingUpdates() const;
+    const BufferUploadStats &getUploadStats() const;
+    const BufferCreationStats &getCreationStats() const;
+
 protected:
+    static constexpr size_t kMaxFramesInFlight = 3;     // CAMetalLayer hands out at most 3 drawables
+
     MTL::Device *device{nullptr};
-    MTL::Buffer *vertexBuffer{nullptr};
-    MTL::Buffer *indexBuffer{nullptr};
-    MTL::Buffer *colorBuffer{nullptr};
-    MTL::RenderPipelineState *pipelineState{nullptr};
+    Handle<MTL::Buffer> vertexBuffer;
+    Handle<MTL::Buffer> indexBuffer;
+    Handle<MTL::Buffer> colorBuffer;
+    Handle<MTL::RenderPipelineState> pipelineState;
+    BlendMode blendMode{BlendMode::Opaque};
+    NS::UInteger vertexOffset{0};   // Byte offsets of the streams inside vertexBuffer / colorBuffer
+    NS::UInteger colorOffset{0};
 
     Transform transform;            // Each primitive 'has a' Transform obj
 
+    VertexLayout vertexLayout;      // Encoding of vertexBuffer / colorBuffer
+    VertexDequant dequant;          // Per-mesh position dequantization (buffer 12)
+
+    Bounds localBounds;             // Computed with the vertex buffer
+    mutable Bounds worldBounds;     // Cached, refreshed when transform's version changes
+    mutable uint64_t worldBoundsVersion{UINT64_MAX};
+    uint64_t localBoundsRevision{0};
+
+    // Element counts of the streams created by createVertexBuffer / createColorBuffer
+    size_t vertexCount{0};
+    size_t colorCount{0};
+    StreamRing<kMaxFramesInFlight> vertexRing;         // Empty while the stream is static
+    StreamRing<kMaxFramesInFlight> colorRing;
+    size_t streamSlot{0};                               // Slice the rings are on
+    uint64_t streamSlotFrames[kMaxFramesInFlight]{};    // Frame that last drew each slice
+    BufferUploadStats uploadStats;
+    uint64_t writableFrame{0};      // Encoding frame the rings last advanced for
+    StreamBuffers<MetalBufferDevice> buffers;          // Creation paths and their counts (streamBuffers.h)
+    std::vector<std::shared_ptr<void>> adoptedMemory;   // Backing of no-copy buffers, retired with them
+
     void createRenderPipelineState();
 
-    void createVertexBuffer(const std::vector<float4> &vertices);
+    // Moves the rings to the next slice, once per encoded frame, after the frame that last drew it
+    void advanceStreams();
 
-    void createColorBuffer(const std::vector<float4> &vertices);
+    // Points a dynamic item at the current slices
+    void describeStreams(DrawItem &item) const;
 
-    void createIndexBuffer(const std::vector<uint16_t> &indices);
+    // Vertex function used with the default (float4) layout
+    virtual const char *vertexFunctionName() const;
+
+    /*
+     *  Buffer creation (see StreamBuffers for what each path costs)
+     *
+     *  span        copied once by Metal (or encoded straight into the buffer for compact layouts)
+     *  builder     `write` fills count xyzw / rgba floats directly in buffer memory: no copy
+     *  adopt       page-aligned caller memory (see allocatePageAligned) wrapped without a copy;
+     *              float4 layouts only, `owner` keeps it alive as long as the primitive
+     */
+
+    void createVertexBuffer(std::span<const float4> vertices);
+    void createVertexBuffer(std::span<const float> xyzw);
+    void createVertexBuffer(size_t count, const StreamWriter &write);
+    void adoptVertexBuffer(std::span<float> xyzw, std::shared_ptr<void> owner);
+
+    void createColorBuffer(std::span<const float4> color);
+    void createColorBuffer(std::span<const float> rgba);
+    void createColorBuffer(size_t count, const StreamWriter &write);
+    void adoptColorBuffer(std::span<float> rgba, std::shared_ptr<void> owner);
+
+    void createIndexBuffer(std::span<const uint16_t> indices);
+    void createIndexBuffer(size_t count, const std::function<void(std::span<uint16_t> indices)> &write);
+
+    // Counted allocation helpers behind the functions above (Managed storage; adopted is Shared)
+    Handle<MTL::Buffer> newFilledBuffer(size_t bytes, const std::function<void(void *contents)> &fill);
+    Handle<MTL::Buffer> newCopiedBuffer(const void *source, size_t bytes);
+    Handle<MTL::Buffer> newAdoptedBuffer(void *memory, size_t bytes, std::shared_ptr<void> owner);
 
     virtual void createDefaultBuffers() = 0;
 };
@@ -47,10 +226,11 @@ protected:
 class Triangle final : public Primitive {
 public:
     explicit Triangle(MTL::Device *device);
-    Triangle(MTL::Device *device, const std::vector<float4> & vertices, const std::vector<float4> & color);
-    ~Triangle() override;
+    Triangle(MTL::Device *device, std::span<const float4> vertices, std::span<const float4> color,
+             const VertexLayout &layout = {});
+    ~Triangle() override = default;
 
-    void draw(MTL::RenderCommandEncoder *encoder) override;
+    void describeDraw(DrawItem &item) override;
 
 protected:
     void createDefaultBuffers() override;
@@ -62,16 +242,15 @@ protected:
 class Quad final : public Primitive {
 public:
     explicit Quad(MTL::Device *device);
-    Quad(MTL::Device *device, const std::vector<float4> & vertices, const std::vector<float4> & color);
+    Quad(MTL::Device *device, std::span<const float4> vertices, std::span<const float4> color,
+         const VertexLayout &layout = {});
 
-    ~Quad() override;
+    ~Quad() override = default;
 
-    void draw(MTL::RenderCommandEncoder *encoder) override;
+    void describeDraw(DrawItem &item) override;
 
 private:
     void createDefaultBuffers() override;
-
-    MTL::Buffer *indexBuffer;
 };
 
 /*
@@ -82,14 +261,308 @@ class Circle final : public Primitive {
 public:
     explicit Circle(MTL::Device *device);
 
-    ~Circle() override;
+    ~Circle() override = default;
+
+    void describeDraw(DrawItem &item) override;
+
+    /**
+     * @brief Re-flattens the outline for its size on screen under the current transform.
+     *
+     * Keeps the outline within `pixelTolerance` pixels of the true circle (see flatteningTolerance);
+     * the buffers are only rebuilt when the current count is too coarse, or more than twice what
+     * is needed. Returns the segment count in use. viewportSize is the larger side of the viewport in pixels.
+     */
+    uint32_t fitToScreen(float viewportSize, float pixelTolerance = 0.25f);
 
-    void draw(MTL::RenderCommandEncoder *encoder) override;
+    uint32_t getSegmentCount() const;
 
 private:
+    static constexpr uint32_t kDefaultSegments = 100;  // Until the first fitToScreen
+    static constexpr uint32_t kMinSegments = 8;
+    static constexpr uint32_t kMaxSegments = 4096;
+
     // Members
     float radius{0.5};
+    uint32_t segments{0};
+    uint32_t indexCount{0};
+    std::vector<float> outline;     // Scratch xy, kept between rebuilds
 
     // Methods
     void createDefaultBuffers() override;
+    void createOutlineBuffers(uint32_t segments);
 };
+
+/*
+ *    POLYGON
+ *
+ *    An arbitrary 2D outline with optional holes (flat xy pairs, see triangulatePolygon),
+ *    triangulated once at creation. Positions and the uniform color are written straight
+ *    into their buffers; indices are 16-bit whenever the vertex count allows.
+ */
+class Polygon final : public Primitive {
+public:
+    // A square frame (outline with one square hole)
+    explicit Polygon(MTL::Device *device);
+
+    // Throws std::runtime_error when the outline has fewer than 3 vertices or no area
+    Polygon(MTL::Device *device, std::span<const float> xy, std::span<const uint32_t> holeStarts = {},
+            const float4 &color = float4(0.5f, 0.5f, 0.5f, 1.0f), const VertexLayout &layout = {});
+
+    ~Polygon() override = default;
+
+    void describeDraw(DrawItem &item) override;
+
+    const TriangulationStats &getTriangulationStats() const;
+
+private:
+    uint32_t indexCount{0};
+    MTL::IndexType indexType{MTL::IndexType::IndexTypeUInt16};
+    TriangulationStats triangulation;
+
+    void createDefaultBuffers() override;
+    void createPolygonBuffers(std::span<const float> xy, std::span<const uint32_t> holeStarts, const float4 &color);
+};
+
+/*
+ *    STROKE
+ *
+ *    A polyline drawn `width` wide with miter/round/bevel joins and butt/square/round caps
+ *    (see Stroker): plain triangles, so lines and outlines work with any fill mode. Tessellated
+ *    once at creation straight into the vertex and index buffers.
+ */
+class Stroke final : public Primitive {
+public:
+    // An open zigzag with round joins and caps
+    explicit Stroke(MTL::Device *device);
+
+    // Throws std::runtime_error when the polyline has fewer than 2 distinct points
+    Stroke(MTL::Device *device, std::span<const float> xy, const StrokeStyle &style,
+           const float4 &color = float4(1.0f, 1.0f, 1.0f, 1.0f), const VertexLayout &layout = {});
+
+    ~Stroke() override = default;
+
+    void describeDraw(DrawItem &item) override;
+
+    const StrokeStats &getStrokeStats() const;
+
+private:
+    uint32_t indexCount{0};
+    MTL::IndexType indexType{MTL::IndexType::IndexTypeUInt16};
+    StrokeStats strokeStats;
+
+    void createDefaultBuffers() override;
+    void createStrokeBuffers(std::span<const float> xy, const StrokeStyle &style, const float4 &color);
+};
+
+/*
+ *    MESH
+ *
+ *    Arbitrary indexed geometry built on the CPU (generators, importers).
+ *    The index/vertex order is optimized once at creation time, and an optional
+ *    LOD chain is stored back to back in the same index buffer.
+ *    With cluster culling the mesh is split into meshlets and each frame only the
+ *    visible ones are compacted into a per-frame index buffer (LOD 0 only).
+ *    A mesh cache hit in the default layout is drawn straight from the mapped file:
+ *    positions, colors and the LOD chain share one no-copy buffer and are read-only.
+ */
+struct MeshOptions {
+    bool optimize{true};            // Vertex cache / overdraw / fetch optimization
+    bool generateLods{false};       // Build a quadric-simplified LOD chain
+    bool clusterCulling{false};     // Meshlet frustum + backface cone culling (closed, CCW meshes)
+    VertexLayout layout{};
+};
+
+class Mesh final : public Primitive {
+public:
+    Mesh(MTL::Device *device, MeshData data, const MeshOptions &options = {});
+
+    // Already optimized geometry and LOD chain (e.g. from the mesh cache); no re-baking
+    Mesh(MTL::Device *device, BakedMesh baked, const MeshOptions &options = {});
+
+    ~Mesh() override = default;
+
+    void describeDraw(DrawItem &item) override;
+
+    // Picks the LOD for the current transform; viewportSize is the larger side of the viewport in pixels
+    size_t selectLod(float viewportSize, float pixelThreshold = 1.0f);
+
+    // Exact hit against the full-detail triangles
+    float intersectRay(const Ray &objectRay) const override;
+
+    // Also keeps the CPU copy used for picking in step (meshlet bounds keep their creation-time shape).
+    // Throws std::runtime_error for cache hits, whose geometry is the read-only mapping
+    void updateVertices(size_t first, const float *positions, size_t count) override;
+
+    // The CPU-side geometry: owned, or views into the mesh cache mapping
+    std::span<const Position> getPositions() const;
+    std::span<const uint32_t> getIndices() const;       // LOD 0
+    const LodChain &getLodChain() const;                // Index list empty for cache hits (see BakedMesh::cache)
+    const ClusterCullStats &getClusterStats() const;
+
+private:
+    BakedMesh geometry;
+    size_t currentLod{0};
+    MTL::IndexType indexType{MTL::IndexType::IndexTypeUInt16};
+    NS::UInteger lodIndexOffset{0};     // Byte offset of the LOD chain inside indexBuffer
+
+    // Cluster culling
+    bool clusterCulling{false};
+    MeshletSet meshlets;
+    Handle<MTL::Buffer> clusterIndexBuffers[kMaxFramesInFlight];
+    uint64_t clusterSlotFrames[kMaxFramesInFlight]{};   // Frame that last drew each buffer
+    size_t clusterFrame{0};
+    NS::UInteger clusterIndexCount{0};
+    ClusterCullStats clusterStats;
+
+    void createDefaultBuffers() override;
+    void adoptCacheBuffers();
+    void cullClusters();
+};
+
+/*
+ *    PROCEDURAL SHAPES
+ *
+ *    Many triangles/quads/circles in one instanced draw with no vertex, color or
+ *    index buffers: `vertexBuffer` holds only the 32-byte instance records and
+ *    vertex_procedural rebuilds the geometry from vertex_id / instance_id.
+ */
+class ProceduralShapes final : public Primitive {
+public:
+    explicit ProceduralShapes(MTL::Device *device);
+    ProceduralShapes(MTL::Device *device, std::span<const ProceduralInstance> instances);
+
+    ~ProceduralShapes() override = default;
+
+    void describeDraw(DrawItem &item) override;
+
+    NS::UInteger getInstanceCount() const;
+    NS::UInteger getVertexCountPerInstance() const;
+
+protected:
+    const char *vertexFunctionName() const override;
+
+private:
+    NS::UInteger instanceCount{0};
+    NS::UInteger vertexCount{0};        // Largest vertex count of any instance
+
+    void createDefaultBuffers() override;
+    void createInstanceBuffer(std::span<const ProceduralInstance> instances);
+};
+
+/*
+ *    PARTICLES
+ *
+ *    A ParticleSystem fed by one emitter and drawn like ProceduralShapes: every live
+ *    particle is a Quad instance for vertex_procedural, all in one instanced draw.
+ *    simulate() steps the system on the CPU; describeDraw (a dynamic item) writes this
+ *    frame's instances into its own slice of vertexBuffer, one slice per frame in flight,
+ *    waiting (DeferredReleaseQueue::waitForFrame) if the GPU is still reading that slice.
+ */
+class Particles final : public Primitive {
+public:
+    // A fountain of orange sparks rising from the bottom of the screen
+    explicit Particles(MTL::Device *device);
+
+    // Emits `rate` particles per second; throws std::runtime_error if capacity is 0
+    Particles(MTL::Device *device, size_t capacity, const ParticleEmitter &emitter, float rate,
+              const ParticleForces &forces = {});
+
+    ~Particles() override = default;
+
+    // Emits for `dt` seconds and advances every particle; call once per frame before culling
+    void simulate(float dt);
+
+    void describeDraw(DrawItem &item) override;
+
+    ParticleSystem &getSystem();
+    const ParticleUpdateStats &getUpdateStats() const;
+
+protected:
+    const char *vertexFunctionName() const override;
+
+private:
+    ParticleSystem system;
+    ParticleEmitter emitter;
+    ParticleForces forces;
+    float rate{0.0f};
+    float pendingEmits{0.0f};       // Fraction of a particle carried over to the next frame
+    size_t frameSlot{0};
+    uint64_t slotFrames[kMaxFramesInFlight]{};  // Frame that last drew each slice
+    ParticleUpdateStats updateStats;
+
+    void createDefaultBuffers() override;
+    void createInstanceBuffer();
+};
+
+/*
+ *    TERRAIN PATCH
+ *
+ *    One uploaded Terrain chunk: its own positions and colors, indices from a buffer shared
+ *    by every patch of the terrain that holds all 16 edge-stitching variants back to back
+ *    (see newTerrainStitchBuffer). show() picks the variant for this frame's coarser
+ *    neighbours and hide() skips the draw, so selection changes never touch GPU memory.
+ */
+class TerrainPatch final : public Primitive {
+public:
+    // A flat 8 x 8 cell patch with a stitch buffer of its own
+    explicit TerrainPatch(MTL::Device *device);
+
+    // Retains `stitchBuffer` (the stitch's indices); throws std::runtime_error if the chunk isn't the stitch's vertex grid
+    TerrainPatch(MTL::Device *device, const TerrainChunk &chunk, MTL::Buffer *stitchBuffer, const TerrainStitch &stitch);
+
+    ~TerrainPatch() override = default;
+
+    // Draws with the variant for `edges` (TerrainEdge bits) until hidden; patches start hidden
+    void show(uint8_t edges);
+    void hide();
+
+    void describeDraw(DrawItem &item) override;
+
+    uint64_t getNode() const;
+
+private:
+    uint64_t node{0};
+    uint32_t variantOffsets[16]{};
+    uint32_t variantCounts[16]{};
+    uint8_t edges{0};
+    bool shown{false};
+
+    void createDefaultBuffers() override;
+    void createPatchBuffers(const MeshData &mesh, const TerrainStitch &stitch);
+};
+
+// Every variant of `stitch` in one buffer for the TerrainPatches of a terrain; throws std::runtime_error on failure
+Handle<MTL::Buffer> newTerrainStitchBuffer(MTL::Device *device, const TerrainStitch &stitch);
+
+/*
+ *    IMPORTED MESH
+ *
+ *    One glTF primitive. Streams the loader kept in place are bound straight from a
+ *    no-copy buffer over the mapped file (at their file offsets); converted streams
+ *    get their own buffers. Holds the asset so the mapping outlives the GPU buffers.
+ */
+class ImportedMesh final : public Primitive {
+public:
+    ImportedMesh(MTL::Device *device, std::shared_ptr<const GltfAsset> asset, const GltfPrimitive &primitive,
+                 MTL::Buffer *fileBuffer);
+
+    ~ImportedMesh() override;
+
+    void describeDraw(DrawItem &item) override;
+
+private:
+    std::shared_ptr<const GltfAsset> asset;
+    const GltfPrimitive &source;
+    MTL::Buffer *fileBuffer{nullptr};
+    NS::UInteger indexOffset{0};
+
+    void createDefaultBuffers() override;
+    Handle<MTL::Buffer> createStreamBuffer(const GltfStream &stream, NS::UInteger &offset);
+};
+
+/**
+ * @brief Creates one ImportedMesh per (node, primitive) of the asset's default scene.
+ *
+ * Each mesh's Transform is set to its node's world matrix. The caller owns the primitives.
+ */
+std::vector<Primitive *> createGltfPrimitives(MTL::Device *device, const std::shared_ptr<const GltfAsset> &asset);
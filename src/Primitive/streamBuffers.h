@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "../Culling/bounds.h"
+#include "../VertexFormat/vertexFormat.h"
+#include "../common/pageMemory.h"
+
+/*
+-------------------------------------------------------------------
+  STREAM BUFFERS  --------------------------------------------------
+
+  The ways a Primitive's streams reach buffer memory, and what each
+  one costs, apart from the device that allocates the buffers:
+
+    span     copied once by the device (Float4), or encoded straight
+             into the buffer for compact layouts
+    builder  `write` fills count xyzw / rgba floats directly in buffer
+             memory: no copy (compact layouts stage them once)
+    adopt    page-aligned caller memory wrapped without a copy
+
+  `Device` supplies the buffers (Primitive's allocates Metal ones, the
+  tests plain heap blocks):
+
+    Buffer newBuffer(size_t bytes)                        writable, uninitialized
+    Buffer newBuffer(const void *source, size_t bytes)    one copy, by the device
+    Buffer newBufferNoCopy(void *memory, size_t bytes)    wraps memory, page-rounded length
+    void *contents(const Buffer &)
+    void didModify(const Buffer &, size_t bytes)
+
+  A null Buffer (allocation failure) is returned as is and not counted.
+-------------------------------------------------------------------
+*/
+
+// What creating a Primitive's buffers cost
+struct BufferCreationStats {
+    uint64_t allocations{0};        // Device buffers allocated (adopted ones are not allocations)
+    uint64_t bytesAllocated{0};
+    uint64_t bytesCopied{0};        // Host bytes copied into new buffers
+    uint64_t bytesAdopted{0};       // Caller memory wrapped without a copy
+    uint64_t stagingAllocations{0}; // Temporary CPU arrays (builders with compact layouts)
+};
+
+using StreamWriter = std::function<void(std::span<float> values)>;
+
+template <typename Device>
+class StreamBuffers {
+public:
+    using Buffer = typename Device::Buffer;
+
+    explicit StreamBuffers(Device device) : device(std::move(device)) {}
+
+    // Allocates `bytes` and lets `fill` write the contents in place: no staging copy
+    Buffer filled(size_t bytes, const std::function<void(void *contents)> &fill)
+    {
+        Buffer buffer = device.newBuffer(bytes);
+        if (!buffer)
+            return buffer;
+        fill(device.contents(buffer));
+        device.didModify(buffer, bytes);
+
+        ++stats.allocations;
+        stats.bytesAllocated += bytes;
+        return buffer;
+    }
+
+    // Allocates `bytes` and copies them from `source` (one memcpy inside the device)
+    Buffer copied(const void *source, size_t bytes)
+    {
+        Buffer buffer = device.newBuffer(source, bytes);
+        if (!buffer)
+            return buffer;
+
+        ++stats.allocations;
+        stats.bytesAllocated += bytes;
+        stats.bytesCopied += bytes;
+        return buffer;
+    }
+
+    // Wraps page-aligned caller memory; the caller keeps it alive as long as the buffer
+    Buffer adopted(void *memory, size_t bytes)
+    {
+        if (!isPageAligned(memory))
+            throw std::runtime_error("Adopted buffer memory must be page aligned");
+
+        // The device sees whole pages; the caller's block must cover the rounded length (allocatePageAligned does)
+        Buffer buffer = device.newBufferNoCopy(memory, roundUpToPage(bytes));
+        if (buffer)
+            stats.bytesAdopted += bytes;
+        return buffer;
+    }
+
+    // xyzw floats in `format`; fills `dequant` for compact formats and `bounds` either way
+    Buffer positions(PositionFormat format, std::span<const float> xyzw, VertexDequant &dequant, Bounds &bounds)
+    {
+        const size_t count = xyzw.size() / 4;
+        bounds = computeBounds(xyzw.data(), count);
+        if (format == PositionFormat::Float4)
+            return copied(xyzw.data(), count * 4 * sizeof(float));
+
+        // Encode straight into the buffer, dequant carries the mesh bounds to the shader
+        dequant = computeDequant(xyzw.data(), count);
+        return filled(count * positionStride(format), [&](void *contents) {
+            encodePositions(format, xyzw.data(), count, dequant, contents);
+        });
+    }
+
+    Buffer positions(PositionFormat format, size_t count, const StreamWriter &write, VertexDequant &dequant,
+                     Bounds &bounds)
+    {
+        if (format != PositionFormat::Float4)
+        {
+            // Compact formats need the whole stream for their dequant range, so stage it once
+            std::vector<float> staging(count * 4);
+            ++stats.stagingAllocations;
+            write(staging);
+            return positions(format, staging, dequant, bounds);
+        }
+
+        Buffer buffer = filled(count * 4 * sizeof(float), [&](void *contents) {
+            write(std::span<float>(static_cast<float *>(contents), count * 4));
+        });
+        if (buffer)
+            bounds = computeBounds(static_cast<const float *>(device.contents(buffer)), count);
+        return buffer;
+    }
+
+    // rgba floats in `format`
+    Buffer colors(ColorFormat format, std::span<const float> rgba)
+    {
+        const size_t count = rgba.size() / 4;
+        if (format == ColorFormat::Float4)
+            return copied(rgba.data(), count * 4 * sizeof(float));
+        return filled(count * colorStride(format), [&](void *contents) {
+            encodeColors(format, rgba.data(), count, contents);
+        });
+    }
+
+    Buffer colors(ColorFormat format, size_t count, const StreamWriter &write)
+    {
+        if (format != ColorFormat::Float4)
+        {
+            std::vector<float> staging(count * 4);
+            ++stats.stagingAllocations;
+            write(staging);
+            return colors(format, staging);
+        }
+        return filled(count * 4 * sizeof(float), [&](void *contents) {
+            write(std::span<float>(static_cast<float *>(contents), count * 4));
+        });
+    }
+
+    Device &getDevice() { return device; }
+
+    BufferCreationStats stats;
+
+private:
+    Device device;
+};
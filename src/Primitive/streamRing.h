@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "../common/dirtyRanges.h"
+
+/*
+-------------------------------------------------------------------
+  STREAM RING  -----------------------------------------------------
+
+  A dynamic stream kept as `Slots` slices of one buffer, one per
+  frame in flight, so the CPU writes the next frame's slice while the
+  GPU still reads the others. The caller owns the memory (Slots
+  slices of sliceStride(bytes), each starting as a copy of the
+  stream) and the fencing: before advance() it waits for the frame
+  that last drew the slice coming up. Per frame that writes:
+
+    advance()   moves to the next slice and brings it up to date,
+                copying from the slice before it whatever was
+                written to the other slices since it was current
+    add()       marks bytes written into getSlice()
+    getDirty()  buffer ranges changed since the last flush (catch-up
+                copies and writes), for didModifyRange or, on a CPU
+                backend, the upload memcpy; the caller clears it
+
+  A frame uploads the union of the last Slots frames' writes: no more
+  than it writes when every frame rewrites the same bytes, up to Slots
+  times as much when each frame writes somewhere new.
+-------------------------------------------------------------------
+*/
+template <size_t Slots>
+class StreamRing
+{
+public:
+    static constexpr size_t kSliceAlignment = 256;      // Metal buffer offsets
+
+    static size_t sliceStride(size_t bytes) { return (bytes + kSliceAlignment - 1) / kSliceAlignment * kSliceAlignment; }
+
+    StreamRing() = default;
+    StreamRing(void *memory, size_t bytes) : memory(static_cast<char *>(memory)), stride(sliceStride(bytes)) {}
+
+    // Default constructed: the stream is static
+    bool empty() const { return memory == nullptr; }
+
+    size_t getSlot() const { return slot; }
+    size_t getSliceOffset() const { return slot * stride; }
+    char *getSlice() const { return memory + slot * stride; }
+
+    // Returns the bytes copied to bring the new slice up to date
+    size_t advance()
+    {
+        const size_t previous = slot;
+        slot = (slot + 1) % Slots;
+        written[slot].clear();      // Already in every slice
+
+        missed.clear();
+        for (size_t other = 0; other < Slots; ++other)
+            if (other != slot)
+                for (const ByteRange &range : written[other].coalesce())
+                    missed.add(range.begin, range.end);
+
+        size_t copied = 0;
+        for (const ByteRange &range : missed.coalesce())
+        {
+            std::memcpy(getSlice() + range.begin, memory + previous * stride + range.begin, range.size());
+            dirty.add(getSliceOffset() + range.begin, getSliceOffset() + range.end);
+            copied += range.size();
+        }
+        return copied;
+    }
+
+    // [begin, end) of the current slice was written
+    void add(size_t begin, size_t end)
+    {
+        written[slot].add(begin, end);
+        dirty.add(getSliceOffset() + begin, getSliceOffset() + end);
+    }
+
+    DirtyRanges &getDirty() { return dirty; }
+    const DirtyRanges &getDirty() const { return dirty; }
+
+private:
+    char *memory{nullptr};
+    size_t stride{0};
+    size_t slot{0};
+    std::array<DirtyRanges, Slots> written;     // Writes of each slice's latest frame, slice-relative
+    DirtyRanges missed;                         // Scratch for advance()
+    DirtyRanges dirty;                          // Buffer offsets
+};
@@ -0,0 +1,129 @@
+#include "proceduralShapes.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+    Fixed-point sine, identical in shaders.metal.
+
+    Quarter-wave polynomial s(x) = A x - B x^3 + C x^5 with x in [0, 1] (Q14), chosen
+    so that s(1) = 1 and s'(1) = 0; the largest error is about 5e-4.
+*/
+namespace {
+constexpr int32_t kSinA = 25736;    // pi/2         in Q14
+constexpr int32_t kSinB = 10512;    // pi - 5/2     in Q14
+constexpr int32_t kSinC = 1160;     // pi/2 - 3/2   in Q14
+
+int32_t quarterSinQ15(int32_t x)
+{
+    const int32_t x2 = (x * x) >> 14;
+    int32_t t = kSinB - ((x2 * kSinC) >> 14);
+    t = kSinA - ((x2 * t) >> 14);
+    return (x * t) >> 13;
+}
+
+constexpr float kQ15ToFloat = 1.0f / 32768.0f;      // power of two: exact scaling
+constexpr float kUnorm8ToFloat = 0x1.010102p-8f;    // 1/255 rounded to float, same literal in the shader
+
+float unitCircleCos(uint32_t index, uint32_t segments)
+{
+    const uint32_t phase = (index * 65536u) / segments;
+    return static_cast<float>(sinPhaseQ15((phase + 16384u) & 0xffffu)) * kQ15ToFloat;
+}
+
+float unitCircleSin(uint32_t index, uint32_t segments)
+{
+    const uint32_t phase = (index * 65536u) / segments;
+    return static_cast<float>(sinPhaseQ15(phase & 0xffffu)) * kQ15ToFloat;
+}
+} // namespace
+
+int32_t sinPhaseQ15(uint32_t phase)
+{
+    const uint32_t quadrant = (phase >> 14) & 3u;
+    const int32_t fraction = static_cast<int32_t>(phase & 16383u);
+    const int32_t s = quarterSinQ15((quadrant & 1u) ? 16384 - fraction : fraction);
+    return quadrant >= 2 ? -s : s;
+}
+
+uint32_t packColor(float r, float g, float b, float a)
+{
+    const auto channel = [](float v) {
+        return static_cast<uint32_t>(std::lrintf(std::min(1.0f, std::max(0.0f, v)) * 255.0f));
+    };
+    return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+}
+
+uint32_t verticesPerInstance(const ProceduralInstance &instance)
+{
+    switch (static_cast<ShapeKind>(instance.kind))
+    {
+        case ShapeKind::Triangle: return 3;
+        case ShapeKind::Quad:     return 6;
+        case ShapeKind::Circle:   return 3 * std::clamp<uint32_t>(instance.segments, 3, kMaxCircleSegments);
+    }
+    return 0;
+}
+
+ProceduralVertex generateProceduralVertex(const ProceduralInstance &instance, uint32_t vertexId)
+{
+    // Unit-space corner, scaled by radius around the center
+    float unitX = 0.0f;
+    float unitY = 0.0f;
+
+    if (vertexId < verticesPerInstance(instance))
+    {
+        const uint32_t corner = vertexId % 3;
+        switch (static_cast<ShapeKind>(instance.kind))
+        {
+            case ShapeKind::Triangle:
+            {
+                constexpr float x[3] = {0.0f, -1.0f, 1.0f};
+                constexpr float y[3] = {1.0f, -1.0f, -1.0f};
+                unitX = x[corner];
+                unitY = y[corner];
+                break;
+            }
+            case ShapeKind::Quad:
+            {
+                // Same winding as Quad's index buffer: (0, 2, 3), (0, 1, 2) over TL, TR, BR, BL
+                constexpr uint32_t indices[6] = {0, 2, 3, 0, 1, 2};
+                constexpr float x[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+                constexpr float y[4] = {1.0f, 1.0f, -1.0f, -1.0f};
+                unitX = x[indices[vertexId]];
+                unitY = y[indices[vertexId]];
+                break;
+            }
+            case ShapeKind::Circle:
+            {
+                // Fan triangle t: center, rim t, rim t + 1
+                if (corner != 0)
+                {
+                    const uint32_t segments = std::clamp<uint32_t>(instance.segments, 3, kMaxCircleSegments);
+                    const uint32_t rim = vertexId / 3 + corner - 1;
+                    unitX = unitCircleCos(rim, segments);
+                    unitY = unitCircleSin(rim, segments);
+                }
+                break;
+            }
+        }
+    }
+
+    ProceduralVertex vertex{};
+    vertex.position[0] = std::fma(instance.radius, unitX, instance.center[0]);
+    vertex.position[1] = std::fma(instance.radius, unitY, instance.center[1]);
+    vertex.position[2] = 0.0f;
+    vertex.position[3] = 1.0f;
+    for (int c = 0; c < 4; ++c)
+        vertex.color[c] = static_cast<float>((instance.color >> (8 * c)) & 0xffu) * kUnorm8ToFloat;
+    return vertex;
+}
+
+void generateProceduralGeometry(std::vector<ProceduralVertex> &destination,
+                                const std::vector<ProceduralInstance> &instances, uint32_t vertexCount)
+{
+    destination.resize(instances.size() * vertexCount);
+    for (size_t i = 0; i < instances.size(); ++i)
+        for (uint32_t v = 0; v < vertexCount; ++v)
+            destination[i * vertexCount + v] = generateProceduralVertex(instances[i], v);
+}
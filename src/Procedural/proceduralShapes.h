@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+-------------------------------------------------------------------
+  PROCEDURAL SHAPES  -----------------------------------------------
+
+  Vertex pulling without vertex buffers: the vertex stage rebuilds
+  Triangle / Quad / Circle geometry from vertex_id and a 32-byte
+  per-instance record. This file is the CPU reference of
+  `vertex_procedural` in shaders.metal and must stay bit-identical
+  with it:
+    - angles are integer phases (1/65536 turn) and sin/cos are
+      evaluated in Q15 fixed point, so no libm or GPU transcendental
+      is involved
+    - the only float math is exact int->float conversion, scaling by
+      powers of two, explicit fma and one multiply for colors, all of
+      which are correctly rounded on both sides
+
+  Each instance draws as a non-indexed triangle list. Instances that
+  need fewer vertices than the draw's vertex count collapse the extra
+  vertices onto their center (zero-area triangles). A kind outside
+  ShapeKind needs no vertices, so all of its vertices collapse; the
+  ProceduralShapes primitive rejects such instances up front.
+-------------------------------------------------------------------
+*/
+enum class ShapeKind : uint32_t {
+    Triangle = 0,
+    Quad = 1,
+    Circle = 2
+};
+
+// Layout mirrors `ProceduralInstance` in shaders.metal
+struct ProceduralInstance {
+    float center[2];
+    float radius;           // Circle radius, half-size of Quad/Triangle
+    uint32_t kind;          // ShapeKind
+    uint32_t segments;      // Circle only, clamped to [3, kMaxCircleSegments]
+    uint32_t color;         // rgba8, byte 0 = r
+    uint32_t padding[2];
+};
+static_assert(sizeof(ProceduralInstance) == 32, "ProceduralInstance must match the shader layout");
+
+constexpr uint32_t kMaxCircleSegments = 65535;
+
+struct ProceduralVertex {
+    float position[4];
+    float color[4];
+};
+
+uint32_t packColor(float r, float g, float b, float a);
+
+// 0 for a kind outside ShapeKind
+uint32_t verticesPerInstance(const ProceduralInstance &instance);
+
+/**
+ * @brief Generates one vertex exactly as `vertex_procedural` does (before the transform).
+ */
+ProceduralVertex generateProceduralVertex(const ProceduralInstance &instance, uint32_t vertexId);
+
+/**
+ * @brief Expands every instance into `vertexCount` vertices (the draw's vertex count).
+ */
+void generateProceduralGeometry(std::vector<ProceduralVertex> &destination,
+                                const std::vector<ProceduralInstance> &instances, uint32_t vertexCount);
+
+// Q15 fixed-point sine of a phase in 1/65536 turns, exposed for testing
+int32_t sinPhaseQ15(uint32_t phase);
@@ -0,0 +1,144 @@
+#include "deferredRelease.h"
+
+#include <algorithm>
+#include <utility>
+
+DeferredReleaseQueue &DeferredReleaseQueue::shared()
+{
+    static DeferredReleaseQueue queue;
+    return queue;
+}
+
+void DeferredReleaseQueue::track()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++counters.created;
+}
+
+void DeferredReleaseQueue::retire(NS::Object *object)
+{
+    if (!object)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (submittedFrame > completedFrame)
+        {
+            pending.push_back({submittedFrame, object, nullptr});
+            ++counters.deferred;
+            return;
+        }
+        ++counters.released;
+    }
+    object->release();      // Nothing in flight
+}
+
+void DeferredReleaseQueue::retire(std::shared_ptr<const void> memory)
+{
+    if (!memory)
+        return;
+    std::unique_lock<std::mutex> lock(mutex);
+    if (submittedFrame > completedFrame)
+        pending.push_back({submittedFrame, nullptr, std::move(memory)});
+    lock.unlock();
+    // Otherwise `memory` goes out of scope here, after the lock is dropped
+}
+
+uint64_t DeferredReleaseQueue::submitFrame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return ++submittedFrame;
+}
+
+void DeferredReleaseQueue::frameCompleted(uint64_t frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        completedFrame = std::max(completedFrame, frame);   // One queue: frames complete in order
+    }
+    completed.notify_all();
+}
+
+uint64_t DeferredReleaseQueue::getEncodingFrame() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return submittedFrame + 1;
+}
+
+void DeferredReleaseQueue::waitForFrame(uint64_t frame)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    completed.wait(lock, [this, frame] { return completedFrame >= frame || frame > submittedFrame; });
+}
+
+size_t DeferredReleaseQueue::collect()
+{
+    uint64_t frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty())
+            return 0;
+        frame = completedFrame;
+    }
+    return releaseUpTo(frame);
+}
+
+void DeferredReleaseQueue::drain()
+{
+    uint64_t frame;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        completed.wait(lock, [this] { return completedFrame >= submittedFrame; });
+        frame = completedFrame;
+    }
+    releaseUpTo(frame);
+}
+
+size_t DeferredReleaseQueue::releaseUpTo(uint64_t frame)
+{
+    std::vector<Entry> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Entries are appended in frame order, so the ready ones form a prefix
+        const auto end = std::find_if(pending.begin(), pending.end(), [frame](const Entry &entry) { return entry.frame > frame; });
+        ready.assign(std::make_move_iterator(pending.begin()), std::make_move_iterator(end));
+        pending.erase(pending.begin(), end);
+    }
+
+    size_t objects = 0;
+    for (Entry &entry : ready)
+    {
+        if (entry.object)
+        {
+            entry.object->release();
+            ++objects;
+        }
+    }
+    ready.clear();          // Drops retired memory
+
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.released += objects;
+    return objects;
+}
+
+ResourceCounters DeferredReleaseQueue::getCounters() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ResourceCounters result = counters;
+    result.pending = std::count_if(pending.begin(), pending.end(), [](const Entry &entry) { return entry.object != nullptr; });
+    return result;
+}
+
+void trackResource()
+{
+    DeferredReleaseQueue::shared().track();
+}
+
+void retireResource(NS::Object *object)
+{
+    DeferredReleaseQueue::shared().retire(object);
+}
+
+void retireMemory(std::shared_ptr<const void> memory)
+{
+    DeferredReleaseQueue::shared().retire(std::move(memory));
+}
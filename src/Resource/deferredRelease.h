@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <Foundation/NSObject.hpp>
+
+/*
+-------------------------------------------------------------------
+  DEFERRED RELEASE  ------------------------------------------------
+
+  GPU objects dropped while frames are still in flight are parked here
+  and released only once every frame submitted before the drop has
+  completed, so tearing an object down mid-run never needs a
+  waitUntilCompleted stall.
+
+    submitFrame    render thread, right before commit; returns the id
+                   the command buffer's completed handler reports back
+    frameCompleted any thread (Metal's completion handler)
+    collect        render thread, once per frame: releases what is safe
+    drain          teardown: waits for the last frame, releases all
+    waitForFrame   blocks until one frame completed, for memory that is
+                   rewritten in place frame after frame (ring buffers)
+
+  Objects must be retired between frames (or not be encoded into the
+  command buffer being built): a retire is tagged with the last
+  submitted frame, and released immediately when that frame is done.
+  Memory backing no-copy buffers (e.g. a file mapping) is retired the
+  same way so it outlives the buffers that read it.
+
+  One process-wide queue, since every Handle can end up here.
+-------------------------------------------------------------------
+*/
+struct ResourceCounters
+{
+    uint64_t created{0};        // Objects adopted by a Handle
+    uint64_t released{0};
+    uint64_t deferred{0};       // Releases that had to wait for a frame to complete
+    size_t pending{0};          // Waiting right now
+
+    uint64_t live() const { return created - released; }
+};
+
+class DeferredReleaseQueue
+{
+public:
+    static DeferredReleaseQueue &shared();
+
+    void track();
+
+    void retire(NS::Object *object);
+    void retire(std::shared_ptr<const void> memory);
+
+    uint64_t submitFrame();
+    void frameCompleted(uint64_t frame);
+
+    // Id the next submitFrame returns: the frame being encoded on the render thread
+    uint64_t getEncodingFrame() const;
+
+    // Returns once `frame` completed; frames never submitted (0, the one being encoded) don't wait
+    void waitForFrame(uint64_t frame);
+
+    // Releases everything whose frame has completed; returns the number of objects released
+    size_t collect();
+
+    // Blocks until every submitted frame completed, then releases everything pending
+    void drain();
+
+    ResourceCounters getCounters() const;
+
+private:
+    struct Entry
+    {
+        uint64_t frame;
+        NS::Object *object;                 // One of the two is set
+        std::shared_ptr<const void> memory;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable completed;
+    std::vector<Entry> pending;
+    uint64_t submittedFrame{0};
+    uint64_t completedFrame{0};
+    ResourceCounters counters;
+
+    // Releases pending entries up to `frame`, outside the lock
+    size_t releaseUpTo(uint64_t frame);
+};
+
+// Shorthands for the shared queue
+void trackResource();
+void retireResource(NS::Object *object);
+void retireMemory(std::shared_ptr<const void> memory);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <utility>
+
+#include "deferredRelease.h"
+
+/*
+-------------------------------------------------------------------
+  HANDLE  ----------------------------------------------------------
+
+  Move-only owner of one reference to a metal-cpp object. Dropping
+  the handle hands the reference to the DeferredReleaseQueue, which
+  releases it once no in-flight frame can still use it.
+
+    Handle<MTL::Buffer> buffer(device->newBuffer(...));   // adopts +1
+    Handle<MTL::Buffer> shared = Handle<MTL::Buffer>::retain(raw);
+-------------------------------------------------------------------
+*/
+template <typename T>
+class Handle final
+{
+public:
+    Handle() = default;
+
+    // Takes over a +1 reference (new*, alloc()->init()); null stays empty
+    explicit Handle(T *object) : object(object)
+    {
+        if (object)
+            trackResource();
+    }
+
+    // Adds a reference of its own to an object owned elsewhere
+    static Handle retain(T *object) { return Handle(object ? object->retain() : nullptr); }
+
+    ~Handle() { reset(); }
+
+    Handle(Handle &&other) noexcept : object(std::exchange(other.object, nullptr)) {}
+    Handle &operator=(Handle &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            object = std::exchange(other.object, nullptr);
+        }
+        return *this;
+    }
+    Handle(const Handle &) = delete;
+    Handle &operator=(const Handle &) = delete;
+
+    T *get() const { return object; }
+    T *operator->() const { return object; }
+    explicit operator bool() const { return object != nullptr; }
+
+    void reset()
+    {
+        if (object)
+            retireResource(std::exchange(object, nullptr));
+    }
+
+private:
+    T *object{nullptr};
+};
@@ -0,0 +1,213 @@
+#include "sceneSimulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+constexpr float kTwoPi = 6.2831853f;
+} // namespace
+
+Eigen::Matrix4f poseMatrix(const SimPose &pose)
+{
+    const float c = std::cos(pose.angle), s = std::sin(pose.angle);
+    Eigen::Matrix4f matrix = Eigen::Matrix4f::Identity();
+    matrix(0, 0) = c * pose.scale[0];
+    matrix(0, 1) = -s * pose.scale[1];
+    matrix(1, 0) = s * pose.scale[0];
+    matrix(1, 1) = c * pose.scale[1];
+    matrix(2, 2) = pose.scale[2];
+    matrix(0, 3) = pose.position[0];
+    matrix(1, 3) = pose.position[1];
+    matrix(2, 3) = pose.position[2];
+    return matrix;
+}
+
+SimPose interpolatePose(const SimPose &a, const SimPose &b, float t)
+{
+    SimPose pose;
+    for (int k = 0; k < 3; ++k)
+    {
+        pose.position[k] = a.position[k] + (b.position[k] - a.position[k]) * t;
+        pose.scale[k] = a.scale[k] + (b.scale[k] - a.scale[k]) * t;
+    }
+    pose.angle = a.angle + std::remainder(b.angle - a.angle, kTwoPi) * t;
+    return pose;
+}
+
+void stepBodies(std::span<SimPose> poses, std::span<SimMotion> motions, float dt)
+{
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        SimPose &pose = poses[i];
+        SimMotion &motion = motions[i];
+        for (int k = 0; k < 3; ++k)
+            pose.position[k] += motion.velocity[k] * dt;
+        pose.angle = std::remainder(pose.angle + motion.spin * dt, kTwoPi);
+
+        if (motion.bounds <= 0.0f)
+            continue;
+        for (int k = 0; k < 2; ++k)
+        {
+            // Reflect off the walls, keeping the distance travelled
+            if (pose.position[k] > motion.bounds)
+            {
+                pose.position[k] = 2.0f * motion.bounds - pose.position[k];
+                motion.velocity[k] = -std::abs(motion.velocity[k]);
+            }
+            else if (pose.position[k] < -motion.bounds)
+            {
+                pose.position[k] = -2.0f * motion.bounds - pose.position[k];
+                motion.velocity[k] = std::abs(motion.velocity[k]);
+            }
+        }
+    }
+}
+
+/*
+-------------------------------------------------------------------
+  SIMULATION THREAD  -----------------------------------------------
+-------------------------------------------------------------------
+*/
+SceneSimulation::SceneSimulation(double tickSeconds)
+{
+    if (!(tickSeconds > 0.0))
+        throw std::invalid_argument("Simulation tick must be positive");
+    tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(tickSeconds));
+}
+
+SceneSimulation::~SceneSimulation()
+{
+    stop();
+}
+
+size_t SceneSimulation::addBody(const SimPose &pose, const SimMotion &motion)
+{
+    if (thread.joinable())
+        throw std::runtime_error("Bodies can only be added before the simulation starts");
+    poses.push_back(pose);
+    motions.push_back(motion);
+    return poses.size() - 1;
+}
+
+void SceneSimulation::start()
+{
+    if (thread.joinable())
+        return;
+
+    // The render thread has poses from its first acquire() on
+    const Clock::time_point now = Clock::now();
+    publish(0, now, poses);
+    running = true;
+    thread = std::thread(&SceneSimulation::run, this, now);
+}
+
+void SceneSimulation::stop()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+}
+
+void SceneSimulation::publish(uint64_t tickIndex, Clock::time_point tickTime, const std::vector<SimPose> &previous)
+{
+    // Assigning into the reused slot keeps its capacity: no allocation once warmed up
+    SceneSnapshot &snapshot = snapshots.back();
+    snapshot.tick = tickIndex;
+    snapshot.tickTime = tickTime;
+    snapshot.previous = previous;
+    snapshot.current = poses;
+    snapshot.publishedAt = Clock::now();
+
+    if (snapshots.publish())
+        replaced.fetch_add(1, std::memory_order_relaxed);
+    published.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SceneSimulation::run(Clock::time_point start)
+{
+    const float dt = static_cast<float>(std::chrono::duration<double>(tick).count());
+    std::vector<SimPose> previous;
+    Clock::time_point last = start;     // When the newest state is due
+    uint64_t index = 0;
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_until(last + tick);
+        const Clock::time_point now = Clock::now();
+
+        // Every tick that is due, at most kMaxCatchUpTicks at once
+        int steps = 0;
+        for (; steps < kMaxCatchUpTicks && last + tick <= now; ++steps)
+        {
+            previous = poses;
+            stepBodies(poses, motions, dt);
+            last += tick;
+        }
+        if (steps == 0)
+            continue;
+
+        // Further behind than that (a stall, a breakpoint): the world pauses instead of racing
+        if (last + tick <= now)
+        {
+            const auto behind = static_cast<uint64_t>((now - last) / tick);
+            skippedTicks.fetch_add(behind, std::memory_order_relaxed);
+            last += behind * tick;
+        }
+
+        index += static_cast<uint64_t>(steps);
+        ticks.fetch_add(static_cast<uint64_t>(steps), std::memory_order_relaxed);
+        publish(index, last, previous);
+    }
+}
+
+/*
+ *  Render thread
+ */
+const SceneSnapshot &SceneSimulation::acquire()
+{
+    ++handoff.frames;
+    if (snapshots.acquire())
+    {
+        const double latency =
+            std::chrono::duration<double, std::milli>(Clock::now() - snapshots.front().publishedAt).count();
+        ++handoff.acquired;
+        latencySumMs += latency;
+        handoff.latencyMeanMs = latencySumMs / static_cast<double>(handoff.acquired);
+        handoff.latencyMaxMs = std::max(handoff.latencyMaxMs, latency);
+    }
+    return snapshots.front();
+}
+
+void SceneSimulation::interpolate(Clock::time_point now, std::vector<Eigen::Matrix4f> &matrices) const
+{
+    // Between the two states either side of now - tick; past the newest one it holds still
+    const SceneSnapshot &snapshot = snapshots.front();
+    const double t = std::chrono::duration<double>(now - snapshot.tickTime) / std::chrono::duration<double>(tick);
+    const float alpha = static_cast<float>(std::clamp(t, 0.0, 1.0));
+
+    matrices.resize(snapshot.current.size());
+    for (size_t i = 0; i < snapshot.current.size(); ++i)
+        matrices[i] = poseMatrix(interpolatePose(snapshot.previous[i], snapshot.current[i], alpha));
+}
+
+const HandoffStats &SceneSimulation::getHandoffStats() const
+{
+    return handoff;
+}
+
+SimulationStats SceneSimulation::getStats() const
+{
+    SimulationStats stats;
+    stats.ticks = ticks.load(std::memory_order_relaxed);
+    stats.published = published.load(std::memory_order_relaxed);
+    stats.replaced = replaced.load(std::memory_order_relaxed);
+    stats.skippedTicks = skippedTicks.load(std::memory_order_relaxed);
+    return stats;
+}
+
+double SceneSimulation::getTickSeconds() const
+{
+    return std::chrono::duration<double>(tick).count();
+}
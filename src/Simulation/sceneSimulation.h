@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <eigen/Eigen/Dense>
+
+#include "../common/tripleBuffer.h"
+
+/*
+-------------------------------------------------------------------
+  SCENE SIMULATION  ------------------------------------------------
+
+  Moves bodies on a thread of its own at a fixed timestep, so the
+  simulation rate no longer depends on the frame rate (and a slow
+  frame doesn't slow the world down).
+
+  After every round of ticks the simulation thread publishes an
+  immutable snapshot through a TripleBuffer: the poses at the latest
+  tick and at the tick before. The render thread acquires the newest
+  snapshot once per frame and interpolates between those two poses,
+  running one tick behind real time so it always lands between two
+  simulated states. Neither thread ever waits for the other.
+
+  Poses are position, a rotation about z and a scale, so they can be
+  interpolated without shearing; poseMatrix() composes them in the
+  order Transform applies setScale, setRotation, setTranslation.
+-------------------------------------------------------------------
+*/
+struct SimPose
+{
+    float position[3]{0.0f, 0.0f, 0.0f};
+    float angle{0.0f};                  // About z, radians
+    float scale[3]{1.0f, 1.0f, 1.0f};
+};
+
+struct SimMotion
+{
+    float velocity[3]{0.0f, 0.0f, 0.0f};    // Per second
+    float spin{0.0f};                       // Radians per second
+    float bounds{0.0f};                     // x / y bounce between -bounds and +bounds; 0 = unbounded
+};
+
+// Snapshot handed from the simulation thread to the render thread
+struct SceneSnapshot
+{
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t tick{0};
+    Clock::time_point tickTime;         // When `current` is due; `previous` is one tick earlier
+    Clock::time_point publishedAt;
+    std::vector<SimPose> previous;
+    std::vector<SimPose> current;
+};
+
+struct SimulationStats
+{
+    uint64_t ticks{0};
+    uint64_t published{0};
+    uint64_t replaced{0};               // Published snapshots the render thread never acquired
+    uint64_t skippedTicks{0};           // Dropped after a stall rather than run in a burst
+};
+
+// Render-thread side of the handoff
+struct HandoffStats
+{
+    uint64_t frames{0};                 // acquire() calls
+    uint64_t acquired{0};               // ... that got a new snapshot
+    double latencyMeanMs{0.0};          // Publish to acquire, over the acquired ones
+    double latencyMaxMs{0.0};
+};
+
+Eigen::Matrix4f poseMatrix(const SimPose &pose);
+
+// Component-wise lerp (the angle along the shorter way round)
+SimPose interpolatePose(const SimPose &a, const SimPose &b, float t);
+
+// One fixed step of every body (bounces flip the motion's velocity)
+void stepBodies(std::span<SimPose> poses, std::span<SimMotion> motions, float dt);
+
+class SceneSimulation
+{
+public:
+    using Clock = SceneSnapshot::Clock;
+
+    // Throws std::invalid_argument unless tickSeconds is positive
+    explicit SceneSimulation(double tickSeconds = 1.0 / 120.0);
+    ~SceneSimulation();
+
+    SceneSimulation(const SceneSimulation &) = delete;
+    SceneSimulation &operator=(const SceneSimulation &) = delete;
+
+    // Before start() only (throws std::runtime_error after); returns the body's index in snapshots
+    size_t addBody(const SimPose &pose, const SimMotion &motion);
+
+    // Publishes the initial poses and starts ticking; stop() (or the destructor) joins the thread
+    void start();
+    void stop();
+
+    /*
+     *  Render thread
+     */
+    // Takes the newest snapshot, if one arrived since the last call; returns the one in use
+    const SceneSnapshot &acquire();
+
+    // Poses of the snapshot in use at `now`, one tick behind, as matrices (one per body)
+    void interpolate(Clock::time_point now, std::vector<Eigen::Matrix4f> &matrices) const;
+
+    const HandoffStats &getHandoffStats() const;
+
+    // Any thread
+    SimulationStats getStats() const;
+    double getTickSeconds() const;
+
+private:
+    static constexpr int kMaxCatchUpTicks = 8;
+
+    Clock::duration tick;
+    std::vector<SimPose> poses;         // Simulation thread once started
+    std::vector<SimMotion> motions;
+    TripleBuffer<SceneSnapshot> snapshots;
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> replaced{0};
+    std::atomic<uint64_t> skippedTicks{0};
+
+    HandoffStats handoff;
+    double latencySumMs{0.0};
+
+    void publish(uint64_t tickIndex, Clock::time_point tickTime, const std::vector<SimPose> &previous);
+    void run(Clock::time_point start);
+};
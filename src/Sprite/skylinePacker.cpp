@@ -0,0 +1,105 @@
+#include "skylinePacker.h"
+
+#include <algorithm>
+
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height) : width(width), height(height)
+{
+    clear();
+}
+
+void SkylinePacker::clear()
+{
+    skyline.assign(1, Run{0, 0, width});
+    usedArea = 0;
+}
+
+uint32_t SkylinePacker::getWidth() const
+{
+    return width;
+}
+
+uint32_t SkylinePacker::getHeight() const
+{
+    return height;
+}
+
+float SkylinePacker::getOccupancy() const
+{
+    return static_cast<float>(static_cast<double>(usedArea) / (static_cast<double>(width) * height));
+}
+
+uint32_t SkylinePacker::fitAt(size_t index, uint32_t rectWidth, uint32_t rectHeight) const
+{
+    if (skyline[index].x + rectWidth > width)
+        return UINT32_MAX;
+
+    // The rectangle rests on the highest run it spans
+    uint32_t top = 0;
+    uint32_t covered = 0;
+    for (size_t i = index; covered < rectWidth; ++i)
+    {
+        top = std::max(top, skyline[i].y);
+        if (top + rectHeight > height)
+            return UINT32_MAX;
+        covered += skyline[i].width;
+    }
+    return top;
+}
+
+bool SkylinePacker::insert(uint32_t rectWidth, uint32_t rectHeight, PackedRect &placed)
+{
+    if (rectWidth == 0 || rectHeight == 0 || rectWidth > width || rectHeight > height)
+        return false;
+
+    size_t best = SIZE_MAX;
+    uint32_t bestTop = UINT32_MAX;
+    uint32_t bestWidth = UINT32_MAX;
+    for (size_t i = 0; i < skyline.size(); ++i)
+    {
+        const uint32_t y = fitAt(i, rectWidth, rectHeight);
+        if (y == UINT32_MAX)
+            continue;
+        const uint32_t top = y + rectHeight;
+        if (top < bestTop || (top == bestTop && skyline[i].width < bestWidth))
+        {
+            best = i;
+            bestTop = top;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (best == SIZE_MAX)
+        return false;
+
+    placed = {skyline[best].x, bestTop - rectHeight, rectWidth, rectHeight};
+    usedArea += static_cast<uint64_t>(rectWidth) * rectHeight;
+
+    // The new run covers the rectangle's width; runs underneath shrink or go
+    const uint32_t right = placed.x + rectWidth;
+    skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(best), Run{placed.x, bestTop, rectWidth});
+    size_t next = best + 1;
+    while (next < skyline.size() && skyline[next].x < right)
+    {
+        Run &run = skyline[next];
+        const uint32_t runRight = run.x + run.width;
+        if (runRight <= right)
+        {
+            skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(next));
+            continue;
+        }
+        run.width = runRight - right;
+        run.x = right;
+        break;
+    }
+
+    // Neighbours at the same height merge into one run
+    size_t out = 0;
+    for (size_t i = 1; i < skyline.size(); ++i)
+    {
+        if (skyline[i].y == skyline[out].y)
+            skyline[out].width += skyline[i].width;
+        else
+            skyline[++out] = skyline[i];
+    }
+    skyline.resize(out + 1);
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+-------------------------------------------------------------------
+  SKYLINE PACKER  --------------------------------------------------
+
+  Online rectangle packing for texture atlases. The packed area is
+  described by its top outline only, a skyline of horizontal runs
+  from left to right. A rectangle goes where its top ends up lowest
+  (ties: where it leaves the narrowest run), which keeps the outline
+  flat; the space under overhangs is given up.
+
+  Each insert is linear in the number of runs, which stays small
+  (it only grows with the number of distinct heights on the top
+  edge). Typical sprite sets fill 85-95% of a page.
+-------------------------------------------------------------------
+*/
+struct PackedRect
+{
+    uint32_t x{0};
+    uint32_t y{0};
+    uint32_t width{0};
+    uint32_t height{0};
+};
+
+class SkylinePacker
+{
+public:
+    SkylinePacker(uint32_t width, uint32_t height);
+
+    /**
+     * @brief Places a width x height rectangle.
+     *
+     * @return false, leaving the packer unchanged, when it doesn't fit anywhere.
+     */
+    bool insert(uint32_t width, uint32_t height, PackedRect &placed);
+
+    void clear();
+
+    uint32_t getWidth() const;
+    uint32_t getHeight() const;
+
+    // Area of the inserted rectangles over the page area
+    float getOccupancy() const;
+
+private:
+    struct Run
+    {
+        uint32_t x;
+        uint32_t y;         // Top of the packed area along this run
+        uint32_t width;
+    };
+
+    uint32_t width;
+    uint32_t height;
+    uint64_t usedArea{0};
+    std::vector<Run> skyline;
+
+    // Top a rectangle starting at run `index` would rest on, or UINT32_MAX when it doesn't fit there
+    uint32_t fitAt(size_t index, uint32_t width, uint32_t height) const;
+};
@@ -0,0 +1,76 @@
+#include "spriteBatch.h"
+#include "../common/parallel.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+constexpr size_t kSpritesPerTask = 16384;
+}
+
+SpriteBatchStats buildSpriteBatches(std::span<const Sprite> sprites, std::span<const AtlasRegion> regions,
+                                    std::span<SpriteVertex> vertices, std::vector<SpriteBatch> &batches,
+                                    unsigned threads)
+{
+    if (vertices.size() < 4 * sprites.size())
+        throw std::invalid_argument("Sprite batch: fewer than 4 vertices per sprite");
+
+    // Batches first: a sequential scan, and every region is checked before any worker starts
+    SpriteBatchStats stats;
+    stats.sprites = sprites.size();
+    batches.clear();
+    for (size_t i = 0; i < sprites.size(); ++i)
+    {
+        const Sprite &sprite = sprites[i];
+        if (sprite.region >= regions.size())
+            throw std::out_of_range("Sprite batch: sprite uses an unknown atlas region");
+
+        const uint32_t page = regions[sprite.region].page;
+        if (!batches.empty() && batches.back().page == page && batches.back().blend == sprite.blend)
+        {
+            ++batches.back().count;
+            continue;
+        }
+        if (!batches.empty())
+        {
+            if (batches.back().page != page)
+                ++stats.pageBreaks;
+            else
+                ++stats.blendBreaks;
+        }
+        batches.push_back({page, sprite.blend, static_cast<uint32_t>(i), 1});
+    }
+    stats.batches = batches.size();
+
+    parallelFor(sprites.size(), kSpritesPerTask, threads, [&](size_t begin, size_t end) {
+        SpriteVertex *out = vertices.data() + 4 * begin;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Sprite &sprite = sprites[i];
+            const AtlasRegion &region = regions[sprite.region];
+            const float hw = sprite.width * 0.5f;
+            const float hh = sprite.height * 0.5f;
+
+            // Half extents along the sprite's own axes
+            float ax = hw, ay = 0.0f;   // Right
+            float bx = 0.0f, by = hh;   // Up
+            if (sprite.rotation != 0.0f)
+            {
+                const float c = std::cos(sprite.rotation);
+                const float s = std::sin(sprite.rotation);
+                ax = hw * c;
+                ay = hw * s;
+                bx = -hh * s;
+                by = hh * c;
+            }
+
+            out[0] = {sprite.x - ax - bx, sprite.y - ay - by, region.u0, region.v1, sprite.color};
+            out[1] = {sprite.x + ax - bx, sprite.y + ay - by, region.u1, region.v1, sprite.color};
+            out[2] = {sprite.x + ax + bx, sprite.y + ay + by, region.u1, region.v0, sprite.color};
+            out[3] = {sprite.x - ax + bx, sprite.y - ay + by, region.u0, region.v0, sprite.color};
+            out += 4;
+        }
+    });
+    return stats;
+}
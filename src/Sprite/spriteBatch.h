@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+/*
+-------------------------------------------------------------------
+  SPRITE BATCHES  --------------------------------------------------
+
+  The CPU half of the SpriteBatcher, free of Metal so it runs (and
+  can be measured) anywhere. Sprites are turned into 4 vertices each,
+  in submission order, and grouped into batches that only break when
+  the atlas page or the blend mode changes: draw order is kept, so
+  interleaving pages or blend modes costs batches.
+-------------------------------------------------------------------
+*/
+enum class SpriteBlend : uint8_t
+{
+    Opaque,
+    Alpha,      // src * a + dst * (1 - a)
+    Additive,   // src * a + dst
+};
+
+// Where one image sits in an atlas (see TextureAtlas); v grows downwards
+struct AtlasRegion
+{
+    uint32_t page{0};
+    float u0{0.0f}, v0{0.0f};
+    float u1{0.0f}, v1{0.0f};
+    uint32_t width{0};          // Texels
+    uint32_t height{0};
+};
+
+struct Sprite
+{
+    float x{0.0f}, y{0.0f};     // Center
+    float width{0.0f};
+    float height{0.0f};
+    float rotation{0.0f};       // Radians, counter-clockwise
+    uint32_t color{0xffffffffu};    // rgba8 tint, r in the low byte
+    uint32_t region{0};         // Index into the atlas' regions
+    SpriteBlend blend{SpriteBlend::Alpha};
+};
+
+// Matches SpriteVertex in shaders.metal
+struct SpriteVertex
+{
+    float x, y;
+    float u, v;
+    uint32_t color;
+};
+
+static_assert(sizeof(SpriteVertex) == 20 && std::is_trivially_copyable_v<SpriteVertex>,
+              "SpriteVertex is read by the GPU as packed_float2, packed_float2, uint");
+
+// Sprites [first, first + count) share a page and a blend mode; their vertices start at 4 * first
+struct SpriteBatch
+{
+    uint32_t page;
+    SpriteBlend blend;
+    uint32_t first;
+    uint32_t count;
+};
+
+struct SpriteBatchStats
+{
+    size_t sprites{0};
+    size_t batches{0};
+    size_t pageBreaks{0};       // Batches started by a page change
+    size_t blendBreaks{0};      // ... by a blend change (a change of both counts as a page break)
+};
+
+/**
+ * @brief Writes 4 vertices per sprite into `vertices` and replaces `batches` with the sprites' batches.
+ *
+ * Corners go bottom-left, bottom-right, top-right, top-left (counter-clockwise, y up), so every
+ * sprite is the triangles (0, 1, 2), (2, 3, 0). Vertices are written by up to `threads` workers
+ * (0 uses the hardware concurrency) once the sprites are long enough to split.
+ *
+ * @throws std::out_of_range For a sprite whose region isn't in `regions`.
+ * @throws std::invalid_argument When `vertices` holds fewer than 4 per sprite.
+ */
+SpriteBatchStats buildSpriteBatches(std::span<const Sprite> sprites, std::span<const AtlasRegion> regions,
+                                    std::span<SpriteVertex> vertices, std::vector<SpriteBatch> &batches,
+                                    unsigned threads = 0);
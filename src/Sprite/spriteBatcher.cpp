@@ -0,0 +1,202 @@
+#include "spriteBatcher.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../shaders/readShaderFile.h"
+#include "../Draw/renderTarget.h"
+
+SpriteBatcher::SpriteBatcher(MTL::Device *device) : device(device), atlas(device)
+{
+    createPipelines();
+    createIndexBuffer();
+    createSampler();
+}
+
+TextureAtlas &SpriteBatcher::getAtlas()
+{
+    return atlas;
+}
+
+void SpriteBatcher::setViewMatrix(const Eigen::Matrix4f &matrix)
+{
+    view = matrix;
+}
+
+void SpriteBatcher::clear()
+{
+    sprites.clear();
+}
+
+void SpriteBatcher::draw(const Sprite &sprite)
+{
+    sprites.push_back(sprite);
+}
+
+void SpriteBatcher::draw(std::span<const Sprite> more)
+{
+    sprites.insert(sprites.end(), more.begin(), more.end());
+}
+
+size_t SpriteBatcher::size() const
+{
+    return sprites.size();
+}
+
+/*
+-------------------------------------------------------------------
+  SETUP  -----------------------------------------------------------
+-------------------------------------------------------------------
+*/
+void SpriteBatcher::createPipelines()
+{
+    MTL::Library *rawLibrary{nullptr};
+    try
+    {
+        loadShaderFromFile(rawLibrary, device, "shaders.metal");
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error loading shader: " << e.what() << std::endl;
+    }
+    Handle<MTL::Library> library(rawLibrary);
+    if (!library)
+        throw std::runtime_error("Failed to create sprite shader library");
+
+    Handle<MTL::Function> vertexFunction(library->newFunction(NS::String::string("vertex_sprite", NS::UTF8StringEncoding)));
+    Handle<MTL::Function> fragmentFunction(library->newFunction(NS::String::string("fragment_sprite", NS::UTF8StringEncoding)));
+    if (!vertexFunction || !fragmentFunction)
+        throw std::runtime_error("Sprite shader functions not found");
+
+    for (SpriteBlend blend : {SpriteBlend::Opaque, SpriteBlend::Alpha, SpriteBlend::Additive})
+    {
+        Handle<MTL::RenderPipelineDescriptor> descriptor(MTL::RenderPipelineDescriptor::alloc()->init());
+        descriptor->setVertexFunction(vertexFunction.get());
+        descriptor->setFragmentFunction(fragmentFunction.get());
+
+        applyRenderTargetFormat(descriptor.get());
+        MTL::RenderPipelineColorAttachmentDescriptor *colorAttachment = descriptor->colorAttachments()->object(0);
+        colorAttachment->setBlendingEnabled(blend != SpriteBlend::Opaque);
+        colorAttachment->setRgbBlendOperation(MTL::BlendOperationAdd);
+        colorAttachment->setAlphaBlendOperation(MTL::BlendOperationAdd);
+        colorAttachment->setSourceRGBBlendFactor(MTL::BlendFactorSourceAlpha);
+        colorAttachment->setSourceAlphaBlendFactor(MTL::BlendFactorOne);
+        const MTL::BlendFactor destination =
+            blend == SpriteBlend::Additive ? MTL::BlendFactorOne : MTL::BlendFactorOneMinusSourceAlpha;
+        colorAttachment->setDestinationRGBBlendFactor(destination);
+        colorAttachment->setDestinationAlphaBlendFactor(destination);
+
+        NS::Error *error{nullptr};
+        pipelines[static_cast<size_t>(blend)] =
+            Handle<MTL::RenderPipelineState>(device->newRenderPipelineState(descriptor.get(), &error));
+        if (error)
+            std::cerr << "ERROR: " << error->localizedDescription()->utf8String() << std::endl;
+        if (!pipelines[static_cast<size_t>(blend)])
+            throw std::runtime_error("Failed to create sprite pipeline state");
+    }
+}
+
+void SpriteBatcher::createIndexBuffer()
+{
+    // (0, 1, 2), (2, 3, 0) for every sprite of the longest draw
+    std::vector<uint16_t> indices(static_cast<size_t>(kSpritesPerDraw) * 6);
+    for (uint32_t sprite = 0; sprite < kSpritesPerDraw; ++sprite)
+    {
+        const uint16_t base = static_cast<uint16_t>(sprite * 4);
+        uint16_t *out = indices.data() + static_cast<size_t>(sprite) * 6;
+        out[0] = base;
+        out[1] = base + 1;
+        out[2] = base + 2;
+        out[3] = base + 2;
+        out[4] = base + 3;
+        out[5] = base;
+    }
+    indexBuffer = Handle<MTL::Buffer>(device->newBuffer(indices.data(), indices.size() * sizeof(uint16_t),
+                                                        MTL::ResourceStorageModeShared));
+    if (!indexBuffer)
+        throw std::runtime_error("Failed to create sprite index buffer");
+}
+
+void SpriteBatcher::createSampler()
+{
+    Handle<MTL::SamplerDescriptor> descriptor(MTL::SamplerDescriptor::alloc()->init());
+    descriptor->setMinFilter(MTL::SamplerMinMagFilterLinear);
+    descriptor->setMagFilter(MTL::SamplerMinMagFilterLinear);
+    descriptor->setSAddressMode(MTL::SamplerAddressModeClampToEdge);
+    descriptor->setTAddressMode(MTL::SamplerAddressModeClampToEdge);
+    sampler = Handle<MTL::SamplerState>(device->newSamplerState(descriptor.get()));
+    if (!sampler)
+        throw std::runtime_error("Failed to create sprite sampler");
+}
+
+/*
+-------------------------------------------------------------------
+  PER FRAME  -------------------------------------------------------
+-------------------------------------------------------------------
+*/
+SpriteStats SpriteBatcher::encode(MTL::RenderCommandEncoder *encoder)
+{
+    SpriteStats stats;
+    if (sprites.empty())
+        return stats;
+
+    DeferredReleaseQueue &releaseQueue = DeferredReleaseQueue::shared();
+    StreamSlot &slot = stream[nextSlot];
+    nextSlot = (nextSlot + 1) % kStreamSlots;
+
+    const size_t bytes = sprites.size() * 4 * sizeof(SpriteVertex);
+    if (slot.capacity < bytes)
+    {
+        // Grow by half again so a slowly growing sprite count doesn't reallocate every frame
+        const size_t capacity = std::max(bytes, slot.capacity + slot.capacity / 2);
+        slot.buffer = Handle<MTL::Buffer>(device->newBuffer(capacity, MTL::ResourceStorageModeShared));
+        if (!slot.buffer)
+            throw std::runtime_error("Failed to create sprite vertex stream");
+        slot.capacity = capacity;
+    }
+    else
+    {
+        releaseQueue.waitForFrame(slot.frame);
+    }
+    slot.frame = releaseQueue.getEncodingFrame();
+
+    std::span<SpriteVertex> vertices(static_cast<SpriteVertex *>(slot.buffer->contents()), sprites.size() * 4);
+    stats.batching = buildSpriteBatches(sprites, atlas.getRegions(), vertices, batches);
+    stats.bytesWritten = bytes;
+
+    encoder->setVertexBuffer(slot.buffer.get(), 0, 0);
+    encoder->setVertexBytes(view.data(), sizeof(Eigen::Matrix4f), 11);
+    encoder->setFragmentSamplerState(sampler.get(), 0);
+
+    uint32_t boundPage = UINT32_MAX;
+    int boundBlend = -1;
+    for (const SpriteBatch &batch : batches)
+    {
+        if (static_cast<int>(batch.blend) != boundBlend)
+        {
+            encoder->setRenderPipelineState(pipelines[static_cast<size_t>(batch.blend)].get());
+            boundBlend = static_cast<int>(batch.blend);
+        }
+        if (batch.page != boundPage)
+        {
+            encoder->setFragmentTexture(atlas.getPage(batch.page), 0);
+            boundPage = batch.page;
+        }
+
+        // The index buffer counts from 0, so each draw moves the stream to its first sprite
+        for (uint32_t first = batch.first; first < batch.first + batch.count; first += kSpritesPerDraw)
+        {
+            const uint32_t count = std::min(kSpritesPerDraw, batch.first + batch.count - first);
+            encoder->setVertexBufferOffset(static_cast<NS::UInteger>(first) * 4 * sizeof(SpriteVertex), 0);
+            encoder->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle,
+                                           static_cast<NS::UInteger>(count) * 6,
+                                           MTL::IndexType::IndexTypeUInt16,
+                                           indexBuffer.get(),
+                                           NS::UInteger(0));
+            ++stats.draws;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <Metal/Metal.hpp>
+#include <eigen/Eigen/Dense>
+
+#include "spriteBatch.h"
+#include "textureAtlas.h"
+#include "../Resource/handle.h"
+
+// What one encode() did
+struct SpriteStats
+{
+    SpriteBatchStats batching;
+    size_t draws{0};            // Batches longer than kSpritesPerDraw take several
+    size_t bytesWritten{0};     // Vertex stream bytes written this frame
+};
+
+/*
+-------------------------------------------------------------------
+  SPRITE BATCHER  --------------------------------------------------
+
+  Draws any number of textured quads from one vertex stream instead
+  of a Primitive (three buffers and a pipeline) each. Per frame:
+
+    clear()          forget last frame's sprites
+    draw(sprite)     append, in draw order
+    encode(encoder)  build the batches straight into this frame's
+                     stream buffer, one draw per batch
+
+  The stream is a ring of kStreamSlots shared buffers, one per frame
+  in flight: a slot is only rewritten once the frame that last read
+  it completed, and is reallocated (the old buffer retired through
+  its Handle) when the sprites outgrow it. Every draw reuses one
+  static 16-bit index buffer, so a draw covers at most
+  kSpritesPerDraw sprites.
+-------------------------------------------------------------------
+*/
+class SpriteBatcher
+{
+public:
+    static constexpr size_t kStreamSlots = 3;
+    static constexpr uint32_t kSpritesPerDraw = 16384;  // 4 vertices each, addressable with uint16 indices
+
+    explicit SpriteBatcher(MTL::Device *device);
+
+    TextureAtlas &getAtlas();
+
+    // Maps sprite coordinates to clip space (identity by default)
+    void setViewMatrix(const Eigen::Matrix4f &matrix);
+
+    void clear();
+    void draw(const Sprite &sprite);
+    void draw(std::span<const Sprite> sprites);
+    size_t size() const;
+
+    /**
+     * @brief Writes this frame's vertices and encodes its batches; call once per frame.
+     *
+     * Leaves the encoder with the sprite pipeline bound. Throws std::out_of_range for a sprite
+     * whose region isn't in the atlas.
+     */
+    SpriteStats encode(MTL::RenderCommandEncoder *encoder);
+
+private:
+    struct StreamSlot
+    {
+        Handle<MTL::Buffer> buffer;
+        size_t capacity{0};     // Bytes
+        uint64_t frame{0};      // Last frame that read it
+    };
+
+    MTL::Device *device;
+    TextureAtlas atlas;
+    std::vector<Sprite> sprites;
+    std::vector<SpriteBatch> batches;
+    std::array<StreamSlot, kStreamSlots> stream;
+    size_t nextSlot{0};
+    Handle<MTL::Buffer> indexBuffer;
+    std::array<Handle<MTL::RenderPipelineState>, 3> pipelines;     // By SpriteBlend
+    Handle<MTL::SamplerState> sampler;
+    Eigen::Matrix4f view{Eigen::Matrix4f::Identity()};
+
+    void createPipelines();
+    void createIndexBuffer();
+    void createSampler();
+};
@@ -0,0 +1,90 @@
+#include "textureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+TextureAtlas::TextureAtlas(MTL::Device *device, uint32_t pageSize) : device(device), pageSize(pageSize)
+{
+}
+
+TextureAtlas::Page &TextureAtlas::newPage()
+{
+    MTL::TextureDescriptor *descriptor =
+        MTL::TextureDescriptor::texture2DDescriptor(MTL::PixelFormatRGBA8Unorm, pageSize, pageSize, false);
+    descriptor->setUsage(MTL::TextureUsageShaderRead);
+    Handle<MTL::Texture> texture(device->newTexture(descriptor));
+    if (!texture)
+        throw std::runtime_error("Failed to create atlas page");
+
+    pages.push_back({SkylinePacker(pageSize, pageSize), std::move(texture)});
+    return pages.back();
+}
+
+uint32_t TextureAtlas::add(uint32_t width, uint32_t height, std::span<const uint8_t> rgba)
+{
+    if (width == 0 || height == 0)
+        throw std::invalid_argument("Atlas: empty image");
+    if (rgba.size() < static_cast<size_t>(width) * height * 4)
+        throw std::invalid_argument("Atlas: image data is smaller than width * height * 4");
+    const uint32_t paddedWidth = width + 2 * kPadding;
+    const uint32_t paddedHeight = height + 2 * kPadding;
+    if (paddedWidth > pageSize || paddedHeight > pageSize)
+        throw std::invalid_argument("Atlas: image is larger than a page");
+
+    PackedRect rect;
+    uint32_t page = 0;
+    while (page < pages.size() && !pages[page].packer.insert(paddedWidth, paddedHeight, rect))
+        ++page;
+    if (page == pages.size())
+        newPage().packer.insert(paddedWidth, paddedHeight, rect);     // Always fits an empty page
+
+    // Image plus its border, edge texels repeated outwards
+    std::vector<uint8_t> padded(static_cast<size_t>(paddedWidth) * paddedHeight * 4);
+    for (uint32_t y = 0; y < paddedHeight; ++y)
+    {
+        const uint32_t sourceY = std::clamp(y, kPadding, height + kPadding - 1) - kPadding;
+        const uint8_t *sourceRow = rgba.data() + static_cast<size_t>(sourceY) * width * 4;
+        uint8_t *row = padded.data() + static_cast<size_t>(y) * paddedWidth * 4;
+        for (uint32_t x = 0; x < kPadding; ++x)
+        {
+            std::memcpy(row + x * 4, sourceRow, 4);
+            std::memcpy(row + (kPadding + width + x) * 4, sourceRow + (width - 1) * 4, 4);
+        }
+        std::memcpy(row + kPadding * 4, sourceRow, static_cast<size_t>(width) * 4);
+    }
+    pages[page].texture->replaceRegion(MTL::Region(rect.x, rect.y, paddedWidth, paddedHeight), 0,
+                                       padded.data(), static_cast<NS::UInteger>(paddedWidth) * 4);
+
+    const float scale = 1.0f / static_cast<float>(pageSize);
+    AtlasRegion region;
+    region.page = page;
+    region.u0 = static_cast<float>(rect.x + kPadding) * scale;
+    region.v0 = static_cast<float>(rect.y + kPadding) * scale;
+    region.u1 = static_cast<float>(rect.x + kPadding + width) * scale;
+    region.v1 = static_cast<float>(rect.y + kPadding + height) * scale;
+    region.width = width;
+    region.height = height;
+    regions.push_back(region);
+    return static_cast<uint32_t>(regions.size() - 1);
+}
+
+std::span<const AtlasRegion> TextureAtlas::getRegions() const
+{
+    return regions;
+}
+
+MTL::Texture *TextureAtlas::getPage(uint32_t page) const
+{
+    return pages[page].texture.get();
+}
+
+size_t TextureAtlas::getPageCount() const
+{
+    return pages.size();
+}
+
+float TextureAtlas::getOccupancy(uint32_t page) const
+{
+    return pages[page].packer.getOccupancy();
+}
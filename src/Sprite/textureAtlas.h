@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <Metal/Metal.hpp>
+
+#include "skylinePacker.h"
+#include "spriteBatch.h"
+#include "../Resource/handle.h"
+
+/*
+-------------------------------------------------------------------
+  TEXTURE ATLAS  ---------------------------------------------------
+
+  RGBA8 images packed into square pages with a SkylinePacker. An
+  image goes into the first page with room, or a new page when none
+  has. Each image is uploaded with a 1 texel border copied from its
+  edges, so linear filtering never reads a neighbour.
+
+  Adding an image only writes texels no region used before, so it is
+  safe between frames while earlier regions are being drawn.
+-------------------------------------------------------------------
+*/
+class TextureAtlas
+{
+public:
+    static constexpr uint32_t kPageSize = 2048;
+    static constexpr uint32_t kPadding = 1;
+
+    explicit TextureAtlas(MTL::Device *device, uint32_t pageSize = kPageSize);
+
+    /**
+     * @brief Packs a tightly packed RGBA8 image and uploads it.
+     *
+     * @return Index of the image's region (what Sprite::region refers to).
+     * @throws std::invalid_argument For an empty image or one larger than a page.
+     * @throws std::runtime_error When a page texture can't be created.
+     */
+    uint32_t add(uint32_t width, uint32_t height, std::span<const uint8_t> rgba);
+
+    std::span<const AtlasRegion> getRegions() const;
+    MTL::Texture *getPage(uint32_t page) const;
+    size_t getPageCount() const;
+
+    // Packed area over page area, per page
+    float getOccupancy(uint32_t page) const;
+
+private:
+    struct Page
+    {
+        SkylinePacker packer;
+        Handle<MTL::Texture> texture;
+    };
+
+    MTL::Device *device;
+    uint32_t pageSize;
+    std::vector<Page> pages;
+    std::vector<AtlasRegion> regions;
+
+    Page &newPage();
+};
@@ -0,0 +1,285 @@
+#include "assetStreamer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+size_t bakedBytes(const BakedMesh &baked)
+{
+    // A cache hit holds its mapping instead of owned sections
+    if (baked.cache)
+        return baked.cache->file.size() + baked.lods.levels.size() * sizeof(LodLevel);
+    return baked.mesh.positions.size() * sizeof(Position) + baked.mesh.colors.size() * sizeof(Color) +
+           baked.mesh.indices.size() * sizeof(uint32_t) + baked.lods.indices.size() * sizeof(uint32_t) +
+           baked.lods.levels.size() * sizeof(LodLevel);
+}
+} // namespace
+
+float streamingPriority(float distance, float radius)
+{
+    return radius / std::max(distance, 1e-3f);
+}
+
+AssetStreamer::AssetStreamer(MeshImporter importer, const StreamingOptions &options)
+    : importer(std::move(importer)), options(options)
+{
+    counters.budgetBytes = options.memoryBudgetBytes;
+
+    const unsigned hardware = std::max(2u, std::thread::hardware_concurrency());
+    const unsigned decoders = options.decodeThreads ? options.decodeThreads : hardware - 1;
+
+    threads.emplace_back(&AssetStreamer::ioLoop, this);
+    for (unsigned i = 0; i < decoders; ++i)
+        threads.emplace_back(&AssetStreamer::decodeLoop, this);
+}
+
+AssetStreamer::~AssetStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ioWake.notify_all();
+    decodeWake.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+/*
+-------------------------------------------------------------------
+  RENDER THREAD  ---------------------------------------------------
+-------------------------------------------------------------------
+*/
+AssetId AssetStreamer::add(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    assets.push_back({});
+    assets.back().path = path;
+    return static_cast<AssetId>(assets.size() - 1);
+}
+
+void AssetStreamer::beginFrame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Anything still queued but not asked for last frame has scrolled out of interest
+    const auto stale = [this](AssetId id) { return assets[id].lastRequested < frame; };
+    for (AssetId id : queued)
+    {
+        if (stale(id))
+        {
+            assets[id].state = AssetState::Unloaded;
+            ++counters.cancellations;
+        }
+    }
+    queued.erase(std::remove_if(queued.begin(), queued.end(), stale), queued.end());
+    ++frame;
+}
+
+void AssetStreamer::request(AssetId id, float priority)
+{
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Asset &asset = assets.at(id);
+        asset.priority = priority;
+        asset.lastRequested = frame;
+        if (asset.state == AssetState::Unloaded)
+        {
+            asset.state = AssetState::Queued;
+            queued.push_back(id);
+            wake = true;
+        }
+    }
+    if (wake)
+        ioWake.notify_one();
+}
+
+std::vector<StreamedMesh> AssetStreamer::takeStaged()
+{
+    std::vector<StreamedMesh> uploads;
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!stagedQueue.empty() && uploads.size() < options.maxUploadsPerFrame)
+    {
+        const AssetId id = popHighest(stagedQueue);
+        Asset &asset = assets[id];
+        asset.state = AssetState::Resident;
+        asset.lastRequested = std::max(asset.lastRequested, frame);
+        uploads.push_back({id, std::move(asset.staged), asset.charged});
+        asset.staged = {};
+    }
+    return uploads;
+}
+
+std::vector<AssetId> AssetStreamer::evict()
+{
+    std::vector<AssetId> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (charged < options.memoryBudgetBytes)
+            return evicted;
+
+        std::vector<AssetId> candidates;
+        for (AssetId id = 0; id < assets.size(); ++id)
+            if (assets[id].state == AssetState::Resident && assets[id].lastRequested < frame)
+                candidates.push_back(id);
+        std::sort(candidates.begin(), candidates.end(),
+                  [this](AssetId a, AssetId b) { return assets[a].lastRequested < assets[b].lastRequested; });
+
+        for (AssetId id : candidates)
+        {
+            if (charged < options.memoryBudgetBytes)
+                break;
+            Asset &asset = assets[id];
+            charged -= asset.charged;
+            asset.charged = 0;
+            asset.state = AssetState::Unloaded;
+            evicted.push_back(id);
+            ++counters.evictions;
+        }
+    }
+    if (!evicted.empty())
+        ioWake.notify_one();
+    return evicted;
+}
+
+AssetState AssetStreamer::getState(AssetId id) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return assets.at(id).state;
+}
+
+StreamingStats AssetStreamer::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    StreamingStats stats = counters;
+    stats.assets = assets.size();
+    stats.chargedBytes = charged;
+    for (const Asset &asset : assets)
+    {
+        switch (asset.state)
+        {
+        case AssetState::Queued: ++stats.queued; break;
+        case AssetState::Reading:
+        case AssetState::Decoding: ++stats.inFlight; break;
+        case AssetState::Staged: ++stats.staged; break;
+        case AssetState::Resident: ++stats.resident; break;
+        default: break;
+        }
+    }
+    return stats;
+}
+
+/*
+-------------------------------------------------------------------
+  WORKERS  ---------------------------------------------------------
+-------------------------------------------------------------------
+*/
+AssetId AssetStreamer::popHighest(std::vector<AssetId> &queue) const
+{
+    auto best = std::max_element(queue.begin(), queue.end(),
+                                 [this](AssetId a, AssetId b) { return assets[a].priority < assets[b].priority; });
+    const AssetId id = *best;
+    *best = queue.back();
+    queue.pop_back();
+    return id;
+}
+
+void AssetStreamer::ioLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        ioWake.wait(lock, [this] { return stopping || (!queued.empty() && charged < options.memoryBudgetBytes); });
+        if (stopping)
+            return;
+
+        const AssetId id = popHighest(queued);
+        assets[id].state = AssetState::Reading;
+        const std::string path = assets[id].path;
+        lock.unlock();
+
+        MappedFile source;
+        bool ok = true;
+        try
+        {
+            source = MappedFile(path);
+            source.adviseSequential();
+            source.prefetch();
+        }
+        catch (const std::runtime_error &error)
+        {
+            std::cerr << "Streaming: " << error.what() << std::endl;
+            ok = false;
+        }
+
+        lock.lock();
+        Asset &asset = assets[id];
+        if (!ok)
+        {
+            asset.state = AssetState::Failed;
+            ++counters.failures;
+            continue;
+        }
+        asset.charged = source.size();
+        asset.source = std::move(source);
+        asset.state = AssetState::Decoding;
+        charged += asset.charged;
+        counters.bytesRead += asset.charged;
+        decodeQueue.push_back(id);
+        decodeWake.notify_one();
+    }
+}
+
+void AssetStreamer::decodeLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        decodeWake.wait(lock, [this] { return stopping || !decodeQueue.empty(); });
+        if (stopping)
+            return;
+
+        const AssetId id = popHighest(decodeQueue);
+        const std::string path = assets[id].path;
+        MappedFile source = std::move(assets[id].source);
+        lock.unlock();
+
+        BakedMesh baked;
+        MeshCacheStats cacheStats;
+        bool ok = true;
+        try
+        {
+            baked = loadMeshCached(path, source.data(), source.size(), importer, options.generateLods, &cacheStats);
+        }
+        catch (const std::exception &error)
+        {
+            std::cerr << "Streaming: " << path << ": " << error.what() << std::endl;
+            ok = false;
+        }
+        source = MappedFile();      // Unmap before taking the lock; the source bytes are no longer charged
+        const size_t bytes = ok ? bakedBytes(baked) : 0;
+
+        lock.lock();
+        Asset &asset = assets[id];
+        charged = charged - asset.charged + bytes;
+        asset.charged = bytes;
+        if (!ok)
+        {
+            asset.state = AssetState::Failed;
+            ++counters.failures;
+        }
+        else
+        {
+            asset.staged = std::move(baked);
+            asset.state = AssetState::Staged;
+            stagedQueue.push_back(id);
+            ++counters.loads;
+            counters.cacheHits += cacheStats.hit;
+        }
+        ioWake.notify_one();        // Budget may have freed up
+    }
+}
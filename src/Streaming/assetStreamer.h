@@ -0,0 +1,160 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Loader/mappedFile.h"
+#include "../Loader/meshCache.h"
+
+/*
+-------------------------------------------------------------------
+  ASSET STREAMING  -------------------------------------------------
+
+  Loads meshes in the background so the render loop never waits on
+  the disk:
+
+    request()   main thread, every frame, for each asset it wants
+    I/O thread  maps the highest-priority queued source and faults its
+                pages in (the only place that touches the disk)
+    decoders    run loadMeshCached on the prefetched bytes (cache hit
+                or import + bake), leaving a staged BakedMesh
+    takeStaged  main thread hands staged meshes to the GPU, a few per
+                frame
+    evict       main thread drops least-recently-requested resident
+                meshes while the budget is exceeded
+
+  Every byte an asset holds (mapped source while decoding, staged or
+  uploaded geometry) is charged against memoryBudgetBytes. The I/O
+  thread only starts a load while the charge is under budget, so the
+  budget can be overshot by at most the loads already in flight.
+  Queued assets that stop being requested are dropped before loading.
+
+  All public methods are meant for the render thread and only take
+  the streamer lock briefly; none of them wait for I/O or decoding.
+-------------------------------------------------------------------
+*/
+using AssetId = uint32_t;
+
+enum class AssetState : uint8_t
+{
+    Unloaded,
+    Queued,
+    Reading,        // I/O thread
+    Decoding,       // decode pool
+    Staged,         // decoded, waiting for takeStaged
+    Resident,       // handed to the renderer
+    Failed,
+};
+
+struct StreamingOptions
+{
+    size_t memoryBudgetBytes{size_t{512} << 20};
+    unsigned decodeThreads{0};          // 0 = hardware concurrency - 1 (at least 1)
+    size_t maxUploadsPerFrame{2};       // Staged meshes returned per takeStaged call
+    bool generateLods{true};
+};
+
+// A decoded mesh ready for upload
+struct StreamedMesh
+{
+    AssetId id{0};
+    BakedMesh baked;
+    size_t bytes{0};                    // Charged against the budget until evicted
+};
+
+struct StreamingStats
+{
+    size_t assets{0};
+    size_t queued{0};
+    size_t inFlight{0};                 // Reading or decoding
+    size_t staged{0};
+    size_t resident{0};
+    size_t chargedBytes{0};
+    size_t budgetBytes{0};
+    uint64_t bytesRead{0};
+    uint64_t loads{0};
+    uint64_t cacheHits{0};
+    uint64_t evictions{0};
+    uint64_t cancellations{0};
+    uint64_t failures{0};
+};
+
+/**
+ * @brief Load priority from how large an asset appears: bounding radius over distance to the eye.
+ */
+float streamingPriority(float distance, float radius);
+
+class AssetStreamer
+{
+public:
+    /**
+     * @brief Starts the I/O thread and decode pool. `importer` parses source bytes (e.g. parseObj)
+     * and is called from several decode threads at once.
+     */
+    explicit AssetStreamer(MeshImporter importer, const StreamingOptions &options = {});
+    ~AssetStreamer();
+
+    AssetStreamer(const AssetStreamer &) = delete;
+    AssetStreamer &operator=(const AssetStreamer &) = delete;
+
+    // Registers a source file; nothing is loaded until it is requested
+    AssetId add(const std::string &path);
+
+    // Starts a new frame of requests; queued assets not requested last frame are dropped
+    void beginFrame();
+
+    // Marks `id` as wanted this frame, queueing it if unloaded. Higher priorities load first.
+    void request(AssetId id, float priority);
+
+    // Up to maxUploadsPerFrame staged meshes, highest priority first; they become Resident
+    std::vector<StreamedMesh> takeStaged();
+
+    // Resident assets not requested this frame, least recently used first, until under budget.
+    // The caller releases their GPU resources; they can be requested again later.
+    std::vector<AssetId> evict();
+
+    AssetState getState(AssetId id) const;
+    StreamingStats getStats() const;
+
+private:
+    struct Asset
+    {
+        std::string path;
+        AssetState state{AssetState::Unloaded};
+        float priority{0.0f};
+        uint64_t lastRequested{0};
+        size_t charged{0};
+        MappedFile source;              // Reading -> Decoding
+        BakedMesh staged;               // Staged
+    };
+
+    void ioLoop();
+    void decodeLoop();
+
+    // Removes and returns the highest-priority id in `queue`
+    AssetId popHighest(std::vector<AssetId> &queue) const;
+
+    MeshImporter importer;
+    StreamingOptions options;
+
+    mutable std::mutex mutex;
+    std::condition_variable ioWake;
+    std::condition_variable decodeWake;
+    bool stopping{false};
+
+    std::deque<Asset> assets;           // Indexed by AssetId; deque keeps elements in place on add
+    std::vector<AssetId> queued;
+    std::vector<AssetId> decodeQueue;
+    std::vector<AssetId> stagedQueue;
+    uint64_t frame{1};
+    size_t charged{0};
+    StreamingStats counters;
+
+    std::vector<std::thread> threads;
+};
@@ -0,0 +1,46 @@
+#include "frameStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+void FrameTimeRecorder::record(double seconds)
+{
+    times.push_back(seconds * 1000.0);
+}
+
+void FrameTimeRecorder::clear()
+{
+    times.clear();
+}
+
+FrameTimeSummary FrameTimeRecorder::summarize() const
+{
+    FrameTimeSummary summary;
+    summary.frames = times.size();
+    if (times.empty())
+        return summary;
+
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    const auto percentile = [&sorted](double p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    };
+
+    double sum = 0.0;
+    for (double ms : sorted)
+        sum += ms;
+    summary.meanMs = sum / static_cast<double>(sorted.size());
+
+    double variance = 0.0;
+    for (double ms : sorted)
+        variance += (ms - summary.meanMs) * (ms - summary.meanMs);
+    summary.stdDevMs = std::sqrt(variance / static_cast<double>(sorted.size()));
+
+    summary.p50Ms = percentile(0.50);
+    summary.p95Ms = percentile(0.95);
+    summary.p99Ms = percentile(0.99);
+    summary.maxMs = sorted.back();
+    summary.hitches = static_cast<size_t>(sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), 2.0 * summary.p50Ms));
+    return summary;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/*
+-------------------------------------------------------------------
+  FRAME TIME STATS  ------------------------------------------------
+
+  Collects per-frame times and summarizes how steady they were:
+  percentiles, spread, and hitches (frames taking more than twice
+  the median). Streaming work should move the mean very little and
+  the tail not at all.
+-------------------------------------------------------------------
+*/
+struct FrameTimeSummary
+{
+    size_t frames{0};
+    double meanMs{0.0};
+    double p50Ms{0.0};
+    double p95Ms{0.0};
+    double p99Ms{0.0};
+    double maxMs{0.0};
+    double stdDevMs{0.0};
+    size_t hitches{0};
+};
+
+class FrameTimeRecorder
+{
+public:
+    void record(double seconds);
+    void clear();
+
+    size_t size() const { return times.size(); }
+
+    FrameTimeSummary summarize() const;
+
+private:
+    std::vector<double> times;      // Milliseconds
+};
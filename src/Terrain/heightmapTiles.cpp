@@ -0,0 +1,197 @@
+#include "heightmapTiles.h"
+#include "../Loader/mappedFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+constexpr size_t kTileBytes = size_t{HeightmapTiles::kTileSize} * HeightmapTiles::kTileSize * sizeof(float);
+
+uint64_t tileKey(uint32_t level, int64_t tileX, int64_t tileY)
+{
+    return (uint64_t{level} << 58) | (static_cast<uint64_t>(tileX) << 29) | static_cast<uint64_t>(tileY);
+}
+
+// Lattice value in [0, 1] (integer hash, no tables)
+float latticeValue(int64_t x, int64_t y, uint32_t seed)
+{
+    uint32_t h = static_cast<uint32_t>(x) * 0x8da6b343u ^ static_cast<uint32_t>(y) * 0xd8163841u ^ seed * 0xcb1ab31fu;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    h *= 0x297a2d39u;
+    h ^= h >> 15;
+    return static_cast<float>(h >> 8) * 0x1.0p-24f;
+}
+
+float valueNoise(double x, double y, uint32_t seed)
+{
+    const double fx = std::floor(x), fy = std::floor(y);
+    const int64_t ix = static_cast<int64_t>(fx), iy = static_cast<int64_t>(fy);
+    float tx = static_cast<float>(x - fx), ty = static_cast<float>(y - fy);
+    tx = tx * tx * (3.0f - 2.0f * tx);
+    ty = ty * ty * (3.0f - 2.0f * ty);
+    const float a = latticeValue(ix, iy, seed), b = latticeValue(ix + 1, iy, seed);
+    const float c = latticeValue(ix, iy + 1, seed), d = latticeValue(ix + 1, iy + 1, seed);
+    return (a + (b - a) * tx) + ((c + (d - c) * tx) - (a + (b - a) * tx)) * ty;
+}
+} // namespace
+
+HeightSampler rawHeightmapSampler(const std::string &path, uint32_t width, uint32_t height)
+{
+    auto file = std::make_shared<MappedFile>(path);
+    if (file->size() < size_t{width} * height * 2)
+        throw std::runtime_error("Heightmap " + path + " is smaller than width * height * 2 bytes");
+
+    return [file, width, height](int64_t x0, int64_t y0, uint32_t stride, uint32_t columns, uint32_t rows, float *out) {
+        const auto *bytes = reinterpret_cast<const uint8_t *>(file->data());
+        for (uint32_t j = 0; j < rows; ++j)
+        {
+            const int64_t y = std::min<int64_t>(y0 + int64_t{j} * stride, height - 1);
+            const uint8_t *row = bytes + static_cast<size_t>(y) * width * 2;
+            for (uint32_t i = 0; i < columns; ++i)
+            {
+                const int64_t x = std::min<int64_t>(x0 + int64_t{i} * stride, width - 1);
+                const uint8_t *sample = row + static_cast<size_t>(x) * 2;
+                *out++ = static_cast<float>(sample[0] | (sample[1] << 8)) * (1.0f / 65535.0f);
+            }
+        }
+    };
+}
+
+HeightSampler noiseHeightmapSampler(uint32_t width, uint32_t height, uint32_t seed, float featureSize, int octaves)
+{
+    if (!(featureSize > 0.0f) || octaves < 1)
+        throw std::invalid_argument("Noise heightmap needs a positive feature size and at least one octave");
+
+    // Octave o has amplitude 2^-o; dividing by their sum keeps heights in [0, 1]
+    const float amplitudeSum = 2.0f - std::ldexp(1.0f, 1 - octaves);
+
+    return [=](int64_t x0, int64_t y0, uint32_t stride, uint32_t columns, uint32_t rows, float *out) {
+        for (uint32_t j = 0; j < rows; ++j)
+        {
+            const double y = static_cast<double>(std::min<int64_t>(y0 + int64_t{j} * stride, height - 1));
+            for (uint32_t i = 0; i < columns; ++i)
+            {
+                const double x = static_cast<double>(std::min<int64_t>(x0 + int64_t{i} * stride, width - 1));
+                float sum = 0.0f;
+                double frequency = 1.0 / featureSize;
+                for (int o = 0; o < octaves; ++o, frequency *= 2.0)
+                    sum += std::ldexp(valueNoise(x * frequency, y * frequency, seed + static_cast<uint32_t>(o)), -o);
+                *out++ = sum / amplitudeSum;
+            }
+        }
+    };
+}
+
+/*
+-------------------------------------------------------------------
+  TILE CACHE  ------------------------------------------------------
+-------------------------------------------------------------------
+*/
+HeightmapTiles::HeightmapTiles(uint32_t width, uint32_t height, HeightSampler sampler, size_t budgetBytes)
+    : width(width), height(height), sampler(std::move(sampler)), budgetBytes(budgetBytes)
+{
+    if (width < 2 || height < 2)
+        throw std::invalid_argument("Heightmap needs at least 2 x 2 samples");
+    counters.budgetBytes = budgetBytes;
+}
+
+uint32_t HeightmapTiles::getWidth() const
+{
+    return width;
+}
+
+uint32_t HeightmapTiles::getHeight() const
+{
+    return height;
+}
+
+std::shared_ptr<HeightmapTiles::Tile> HeightmapTiles::acquire(uint32_t level, int64_t tileX, int64_t tileY)
+{
+    std::shared_ptr<Tile> tile;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<Tile> &slot = tiles[tileKey(level, tileX, tileY)];
+        if (slot)
+        {
+            ++counters.hits;
+        }
+        else
+        {
+            slot = std::make_shared<Tile>();
+            ++counters.loads;
+            counters.bytes += kTileBytes;
+        }
+        slot->lastUsed = ++clock;
+        tile = slot;
+        evictOverBudget();
+    }
+
+    // Loaded outside the lock; a second thread asking meanwhile waits here for this load
+    std::call_once(tile->loaded, [&] {
+        tile->heights.resize(size_t{kTileSize} * kTileSize);
+        const int64_t step = int64_t{1} << level;
+        sampler(tileX * kTileSize * step, tileY * kTileSize * step, static_cast<uint32_t>(step), kTileSize, kTileSize,
+                tile->heights.data());
+    });
+    return tile;
+}
+
+void HeightmapTiles::evictOverBudget()
+{
+    while (counters.bytes > budgetBytes && tiles.size() > 1)
+    {
+        auto oldest = tiles.begin();
+        for (auto it = tiles.begin(); it != tiles.end(); ++it)
+            if (it->second->lastUsed < oldest->second->lastUsed)
+                oldest = it;
+        tiles.erase(oldest);            // Readers still holding it keep it alive
+        counters.bytes -= kTileBytes;
+        ++counters.evictions;
+    }
+}
+
+void HeightmapTiles::sampleGrid(uint32_t level, int64_t x0, int64_t y0, uint32_t count, float *out)
+{
+    // Level samples past these repeat the map's last column / row, so no tile is ever loaded past them
+    const int64_t step = int64_t{1} << level;
+    const int64_t lastX = (int64_t{width} - 1 + step - 1) / step;
+    const int64_t lastY = (int64_t{height} - 1 + step - 1) / step;
+
+    std::shared_ptr<Tile> tile;
+    int64_t tileX = -1, tileY = -1;
+    for (uint32_t j = 0; j < count; ++j)
+    {
+        const int64_t y = std::clamp<int64_t>(y0 + j, 0, lastY);
+        const int64_t rowInTile = y % kTileSize;
+        int64_t i = 0;
+        while (i < count)
+        {
+            const int64_t x = std::clamp<int64_t>(x0 + i, 0, lastX);
+            if (!tile || x / kTileSize != tileX || y / kTileSize != tileY)
+            {
+                tileX = x / kTileSize;
+                tileY = y / kTileSize;
+                tile = acquire(level, tileX, tileY);
+            }
+
+            // Copy the run up to the tile's right edge (clamped samples one at a time)
+            const float *row = tile->heights.data() + rowInTile * kTileSize;
+            const int64_t run = x0 + i == x ? std::min<int64_t>({count - i, kTileSize - x % kTileSize, lastX - x + 1}) : 1;
+            std::memcpy(out + size_t{j} * count + i, row + x % kTileSize, static_cast<size_t>(run) * sizeof(float));
+            i += run;
+        }
+    }
+}
+
+HeightTileStats HeightmapTiles::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    HeightTileStats stats = counters;
+    stats.tiles = tiles.size();
+    return stats;
+}
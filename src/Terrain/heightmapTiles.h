@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+-------------------------------------------------------------------
+  HEIGHTMAP TILES  -------------------------------------------------
+
+  A heightmap too large to hold (16K x 16K samples is 1 GB as floats)
+  read on demand in square tiles, per level of detail:
+
+    level 0   every sample
+    level l   every 2^l-th sample in x and y (point sampled, not
+              filtered, so a coarse sample is exactly the fine sample
+              at the same spot and LOD seams line up)
+
+  A tile holds kTileSize^2 samples of one level, so a coarse tile
+  covers 2^l times the area of a level 0 one and a distant chunk of
+  terrain never pulls in the full-resolution data beneath it.
+
+  Tiles load through a HeightSampler (a raw 16-bit file, procedural
+  noise, ...) the first time any thread asks for them, outside the
+  cache lock; threads asking for the same tile meanwhile wait for
+  that one load. The least recently used tiles are dropped while the
+  cache is over its budget (tiles in use stay alive until released).
+-------------------------------------------------------------------
+*/
+
+/**
+ * Fills out[j * columns + i] with the height in [0, 1] at
+ * (min(x0 + i * stride, width - 1), min(y0 + j * stride, height - 1)).
+ * Called from several threads at once.
+ */
+using HeightSampler = std::function<void(int64_t x0, int64_t y0, uint32_t stride, uint32_t columns, uint32_t rows,
+                                         float *out)>;
+
+/**
+ * @brief Samples a raw 16-bit little-endian, row-major heightmap (.r16 / .raw) through a memory map.
+ *
+ * Only the pages under sampled rows are read. Throws std::runtime_error if the file is smaller
+ * than width * height * 2 bytes.
+ */
+HeightSampler rawHeightmapSampler(const std::string &path, uint32_t width, uint32_t height);
+
+// Fractal value noise: deterministic per sample, so any tile can be generated on its own
+HeightSampler noiseHeightmapSampler(uint32_t width, uint32_t height, uint32_t seed = 1, float featureSize = 1024.0f,
+                                    int octaves = 8);
+
+struct HeightTileStats
+{
+    size_t tiles{0};                // Resident
+    size_t bytes{0};
+    size_t budgetBytes{0};
+    uint64_t loads{0};
+    uint64_t hits{0};
+    uint64_t evictions{0};
+};
+
+class HeightmapTiles
+{
+public:
+    static constexpr uint32_t kTileSize = 256;
+
+    // Throws std::invalid_argument for a map smaller than 2 x 2 samples
+    HeightmapTiles(uint32_t width, uint32_t height, HeightSampler sampler, size_t budgetBytes = size_t{64} << 20);
+
+    uint32_t getWidth() const;
+    uint32_t getHeight() const;
+
+    /**
+     * @brief Copies a count x count block of level `level` samples starting at (x0, y0) into `out`.
+     *
+     * Coordinates are in level samples (level 0 sample x0 << level); past the edge of the map
+     * they repeat the last row / column. Thread safe.
+     */
+    void sampleGrid(uint32_t level, int64_t x0, int64_t y0, uint32_t count, float *out);
+
+    HeightTileStats getStats() const;
+
+private:
+    struct Tile
+    {
+        std::once_flag loaded;
+        std::vector<float> heights;     // kTileSize^2
+        uint64_t lastUsed{0};
+    };
+
+    uint32_t width;
+    uint32_t height;
+    HeightSampler sampler;
+    size_t budgetBytes;
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<Tile>> tiles;
+    uint64_t clock{0};
+    HeightTileStats counters;
+
+    std::shared_ptr<Tile> acquire(uint32_t level, int64_t tileX, int64_t tileY);
+    void evictOverBudget();
+};
@@ -0,0 +1,589 @@
+#include "terrain.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+constexpr uint64_t kCoordinateMask = (uint64_t{1} << 29) - 1;
+
+struct Neighbour
+{
+    int dx, dy;
+    uint8_t edge;
+};
+
+constexpr Neighbour kNeighbours[4] = {
+    {-1, 0, kEdgeLeft},
+    {1, 0, kEdgeRight},
+    {0, -1, kEdgeBottom},
+    {0, 1, kEdgeTop},
+};
+
+void decodeNode(uint64_t node, uint32_t &level, int64_t &x, int64_t &y)
+{
+    level = static_cast<uint32_t>(node >> 58);
+    x = static_cast<int64_t>((node >> 29) & kCoordinateMask);
+    y = static_cast<int64_t>(node & kCoordinateMask);
+}
+
+// Green valleys, brown slopes, white peaks
+Color heightColor(float h)
+{
+    static constexpr Color kLow{0.15f, 0.35f, 0.15f, 1.0f};
+    static constexpr Color kMid{0.45f, 0.35f, 0.2f, 1.0f};
+    static constexpr Color kHigh{0.95f, 0.95f, 0.95f, 1.0f};
+    const Color &a = h < 0.5f ? kLow : kMid;
+    const Color &b = h < 0.5f ? kMid : kHigh;
+    const float t = std::clamp(h < 0.5f ? h * 2.0f : h * 2.0f - 1.0f, 0.0f, 1.0f);
+    return Color{a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t, 1.0f};
+}
+} // namespace
+
+/**
+ * @brief Builds the 16 triangle lists of a chunk, one per combination of stitched edges.
+ *
+ * A stitched edge drops its odd vertices by folding each onto the even vertex before it: the
+ * triangles touching the dropped vertex stretch to the even one, the ones between the two collapse
+ * and are skipped. Moving a vertex along its own (straight) edge keeps every remaining triangle's
+ * winding, and the edge is left with exactly the coarser neighbour's vertices.
+ */
+TerrainStitch buildTerrainStitch(uint32_t cells)
+{
+    if (cells < 2 || cells > 128 || (cells & (cells - 1)) != 0)
+        throw std::invalid_argument("Terrain chunks need a power of two in [2, 128] cells per side");
+
+    TerrainStitch stitch;
+    const uint32_t side = cells + 1;
+    stitch.indices.reserve(size_t{16} * (cells * cells * 6 + 1));
+
+    for (uint32_t mask = 0; mask < 16; ++mask)
+    {
+        auto vertex = [&](uint32_t i, uint32_t j) -> uint16_t {
+            if ((mask & kEdgeLeft) && i == 0 && (j & 1))
+                --j;
+            else if ((mask & kEdgeRight) && i == cells && (j & 1))
+                --j;
+            else if ((mask & kEdgeBottom) && j == 0 && (i & 1))
+                --i;
+            else if ((mask & kEdgeTop) && j == cells && (i & 1))
+                --i;
+            return static_cast<uint16_t>(j * side + i);
+        };
+        auto triangle = [&](uint16_t a, uint16_t b, uint16_t c) {
+            if (a == b || b == c || c == a)
+                return;
+            stitch.indices.insert(stitch.indices.end(), {a, b, c});
+        };
+
+        // Variants start 4-byte aligned, as Metal wants index buffer offsets; the pad index is never drawn
+        if (stitch.indices.size() & 1)
+            stitch.indices.push_back(0);
+        stitch.offset[mask] = static_cast<uint32_t>(stitch.indices.size());
+        for (uint32_t j = 0; j < cells; ++j)
+        {
+            for (uint32_t i = 0; i < cells; ++i)
+            {
+                const uint16_t v00 = vertex(i, j), v10 = vertex(i + 1, j);
+                const uint16_t v01 = vertex(i, j + 1), v11 = vertex(i + 1, j + 1);
+
+                // Alternating diagonals, counter-clockwise seen from +z
+                if (((i + j) & 1) == 0)
+                {
+                    triangle(v00, v10, v11);
+                    triangle(v00, v11, v01);
+                }
+                else
+                {
+                    triangle(v00, v10, v01);
+                    triangle(v10, v11, v01);
+                }
+            }
+        }
+        stitch.count[mask] = static_cast<uint32_t>(stitch.indices.size()) - stitch.offset[mask];
+    }
+    return stitch;
+}
+
+bool terrainEye(const Eigen::Matrix4f &transform, float eye[3])
+{
+    Eigen::Matrix4f inverse;
+    bool invertible = false;
+    // Any non-zero determinant: a terrain thousands of cells wide scales by far less than Eigen's default threshold
+    transform.computeInverseWithCheck(inverse, invertible, 0.0f);
+    if (!invertible || !inverse.allFinite())
+        return false;
+
+    const Eigen::Vector4f local = inverse * Eigen::Vector4f(0.0f, 0.0f, -1.0f, 1.0f);
+    for (int k = 0; k < 3; ++k)
+        eye[k] = local[k] / local[3];
+    return true;
+}
+
+/*
+-------------------------------------------------------------------
+  TERRAIN  ---------------------------------------------------------
+-------------------------------------------------------------------
+*/
+Terrain::Terrain(std::shared_ptr<HeightmapTiles> heights, const TerrainOptions &options)
+    : heights(std::move(heights)), options(options), stitch(buildTerrainStitch(options.chunkCells))
+{
+    if (!this->heights)
+        throw std::invalid_argument("Terrain needs a heightmap");
+    if (!(options.cellSize > 0.0f) || !(options.lodDistance >= 1.0f))
+        throw std::invalid_argument("Terrain needs a positive cell size and a LOD distance of at least 1");
+
+    cellsX = int64_t{this->heights->getWidth()} - 1;
+    cellsY = int64_t{this->heights->getHeight()} - 1;
+    while ((int64_t{options.chunkCells} << (levels - 1)) < std::max(cellsX, cellsY))
+        ++levels;
+
+    unsigned count = options.buildThreads;
+    if (count == 0)
+        count = std::max(1u, std::thread::hardware_concurrency() - 1);
+    for (unsigned i = 0; i < count; ++i)
+        threads.emplace_back(&Terrain::buildLoop, this);
+}
+
+Terrain::~Terrain()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+uint64_t Terrain::nodeKey(uint32_t level, uint32_t x, uint32_t y)
+{
+    return (uint64_t{level} << 58) | (uint64_t{x} << 29) | uint64_t{y};
+}
+
+uint32_t Terrain::nodeLevel(uint64_t node)
+{
+    return static_cast<uint32_t>(node >> 58);
+}
+
+/*
+ *  Selection
+ */
+bool Terrain::isInside(uint32_t level, int64_t x, int64_t y) const
+{
+    const int64_t width = int64_t{options.chunkCells} << level;
+    return x >= 0 && y >= 0 && x * width < cellsX && y * width < cellsY;
+}
+
+float Terrain::distanceTo(const float eye[3], uint32_t level, int64_t x, int64_t y) const
+{
+    const int64_t width = int64_t{options.chunkCells} << level;
+    const float min[3] = {static_cast<float>(x * width) * options.cellSize,
+                          static_cast<float>(y * width) * options.cellSize, 0.0f};
+    const float max[3] = {static_cast<float>(std::min((x + 1) * width, cellsX)) * options.cellSize,
+                          static_cast<float>(std::min((y + 1) * width, cellsY)) * options.cellSize,
+                          options.heightScale};
+    float squared = 0.0f;
+    for (int k = 0; k < 3; ++k)
+    {
+        const float d = std::max({min[k] - eye[k], 0.0f, eye[k] - max[k]});
+        squared += d * d;
+    }
+    return std::sqrt(squared);
+}
+
+void Terrain::selectNode(const float eye[3], uint32_t level, uint32_t x, uint32_t y)
+{
+    if (!isInside(level, x, y))
+        return;
+
+    const float width = static_cast<float>(options.chunkCells << level) * options.cellSize;
+    if (level > 0 && distanceTo(eye, level, x, y) < options.lodDistance * width)
+    {
+        for (uint32_t child = 0; child < 4; ++child)
+            selectNode(eye, level - 1, 2 * x + (child & 1), 2 * y + (child >> 1));
+        return;
+    }
+    leaves.insert(nodeKey(level, x, y));
+}
+
+// Level of the chunk in `set` covering level `level` node (x, y); -1 when that area is split finer
+int Terrain::coveringLevel(const std::unordered_set<uint64_t> &set, uint32_t level, int64_t x, int64_t y) const
+{
+    for (uint32_t l = level; l < levels; ++l)
+    {
+        const uint32_t shift = l - level;
+        if (set.count(nodeKey(l, static_cast<uint32_t>(x >> shift), static_cast<uint32_t>(y >> shift))))
+            return static_cast<int>(l);
+    }
+    return -1;
+}
+
+void Terrain::split(uint64_t node, std::vector<uint64_t> &worklist)
+{
+    uint32_t level;
+    int64_t x, y;
+    decodeNode(node, level, x, y);
+    leaves.erase(node);
+    for (uint32_t child = 0; child < 4; ++child)
+    {
+        const int64_t cx = 2 * x + (child & 1), cy = 2 * y + (child >> 1);
+        if (!isInside(level - 1, cx, cy))
+            continue;
+        const uint64_t key = nodeKey(level - 1, static_cast<uint32_t>(cx), static_cast<uint32_t>(cy));
+        leaves.insert(key);
+        worklist.push_back(key);
+    }
+    ++balanceSplits;
+}
+
+// Splits coarse chunks until no two neighbours are more than one level apart
+void Terrain::balance()
+{
+    std::vector<uint64_t> worklist(leaves.begin(), leaves.end());
+    while (!worklist.empty())
+    {
+        const uint64_t node = worklist.back();
+        worklist.pop_back();
+        if (!leaves.count(node))
+            continue;
+
+        uint32_t level;
+        int64_t x, y;
+        decodeNode(node, level, x, y);
+        for (const Neighbour &n : kNeighbours)
+        {
+            const int64_t nx = x + n.dx, ny = y + n.dy;
+            if (!isInside(level, nx, ny))
+                continue;
+            for (int covering = coveringLevel(leaves, level, nx, ny); covering > static_cast<int>(level) + 1;
+                 covering = coveringLevel(leaves, level, nx, ny))
+            {
+                const uint32_t shift = static_cast<uint32_t>(covering) - level;
+                split(nodeKey(covering, static_cast<uint32_t>(nx >> shift), static_cast<uint32_t>(ny >> shift)), worklist);
+            }
+        }
+    }
+}
+
+// Walks the selection's tree, descending only where every child is uploaded (caller holds the lock)
+void Terrain::selectResident(uint32_t level, uint32_t x, uint32_t y)
+{
+    if (level > 0 && coveringLevel(leaves, level, x, y) < 0)
+    {
+        bool uploaded = true;
+        for (uint32_t child = 0; child < 4 && uploaded; ++child)
+        {
+            const uint32_t cx = 2 * x + (child & 1), cy = 2 * y + (child >> 1);
+            if (!isInside(level - 1, cx, cy))
+                continue;
+            auto it = chunks.find(nodeKey(level - 1, cx, cy));
+            uploaded = it != chunks.end() && it->second.state == ChunkState::Resident;
+        }
+        if (uploaded)
+        {
+            for (uint32_t child = 0; child < 4; ++child)
+            {
+                const uint32_t cx = 2 * x + (child & 1), cy = 2 * y + (child >> 1);
+                if (isInside(level - 1, cx, cy))
+                    selectResident(level - 1, cx, cy);
+            }
+            return;
+        }
+    }
+    drawLeaves.insert(nodeKey(level, x, y));
+}
+
+// Replaces the parent's whole subtree with the parent (uploaded: selectResident came through it)
+void Terrain::merge(uint64_t node)
+{
+    uint32_t level;
+    int64_t x, y;
+    decodeNode(node, level, x, y);
+    for (auto it = drawLeaves.begin(); it != drawLeaves.end();)
+    {
+        uint32_t l;
+        int64_t lx, ly;
+        decodeNode(*it, l, lx, ly);
+        if (l < level && (lx >> (level - l)) == x && (ly >> (level - l)) == y)
+            it = drawLeaves.erase(it);
+        else
+            ++it;
+    }
+    drawLeaves.insert(node);
+}
+
+// Merges fine chunks up until no two neighbours are more than one level apart; every merge only coarsens
+void Terrain::balanceResident()
+{
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (uint64_t node : std::vector<uint64_t>(drawLeaves.begin(), drawLeaves.end()))
+        {
+            if (!drawLeaves.count(node))
+                continue;
+
+            uint32_t level;
+            int64_t x, y;
+            decodeNode(node, level, x, y);
+            for (const Neighbour &n : kNeighbours)
+            {
+                if (isInside(level, x + n.dx, y + n.dy) &&
+                    coveringLevel(drawLeaves, level, x + n.dx, y + n.dy) > static_cast<int>(level) + 1)
+                {
+                    merge(nodeKey(level + 1, static_cast<uint32_t>(x >> 1), static_cast<uint32_t>(y >> 1)));
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+uint8_t Terrain::findEdges(const std::unordered_set<uint64_t> &set, uint32_t level, int64_t x, int64_t y) const
+{
+    uint8_t edges = 0;
+    for (const Neighbour &n : kNeighbours)
+        if (isInside(level, x + n.dx, y + n.dy) && coveringLevel(set, level, x + n.dx, y + n.dy) == static_cast<int>(level) + 1)
+            edges |= n.edge;
+    return edges;
+}
+
+void Terrain::update(const float eye[3])
+{
+    const auto start = std::chrono::steady_clock::now();
+    leaves.clear();
+    balanceSplits = 0;
+    selectNode(eye, levels - 1, 0, 0);
+    balance();
+    target.assign(leaves.begin(), leaves.end());
+    std::sort(target.begin(), target.end());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++frame;
+
+        // The selection and its ancestors (the stand-ins while it builds), each once
+        for (uint64_t leaf : target)
+        {
+            uint32_t level;
+            int64_t x, y;
+            decodeNode(leaf, level, x, y);
+            for (; level < levels; ++level, x >>= 1, y >>= 1)
+            {
+                const uint64_t node = nodeKey(level, static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+                auto [it, inserted] = chunks.try_emplace(node);
+                if (inserted)
+                    queue.push_back(node);
+                else if (it->second.lastUsed == frame)
+                    break;
+
+                const float width = static_cast<float>(options.chunkCells << level) * options.cellSize;
+                it->second.lastUsed = frame;
+                it->second.priority = static_cast<float>(level) + 1.0f / (1.0f + distanceTo(eye, level, x, y) / width);
+            }
+        }
+
+        // Queued chunks this selection no longer wants are dropped before they are built
+        queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                   [this](uint64_t node) {
+                                       auto it = chunks.find(node);
+                                       if (it->second.lastUsed == frame)
+                                           return false;
+                                       chunks.erase(it);
+                                       ++cancelled;
+                                       return true;
+                                   }),
+                    queue.end());
+
+        // Nothing is drawn until the root is up
+        drawLeaves.clear();
+        if (chunks.at(nodeKey(levels - 1, 0, 0)).state == ChunkState::Resident)
+        {
+            selectResident(levels - 1, 0, 0);
+            balanceResident();
+        }
+    }
+    wake.notify_all();
+
+    draws.clear();
+    for (uint64_t node : drawLeaves)
+    {
+        uint32_t level;
+        int64_t x, y;
+        decodeNode(node, level, x, y);
+        draws.push_back({node, findEdges(drawLeaves, level, x, y)});
+    }
+    std::sort(draws.begin(), draws.end(), [](const TerrainDraw &a, const TerrainDraw &b) { return a.node < b.node; });
+    selectMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ *  Building
+ */
+MeshData Terrain::buildChunk(uint64_t node) const
+{
+    uint32_t level;
+    int64_t x, y;
+    decodeNode(node, level, x, y);
+
+    const uint32_t side = options.chunkCells + 1;
+    std::vector<float> samples(size_t{side} * side);
+    heights->sampleGrid(level, x * options.chunkCells, y * options.chunkCells, side, samples.data());
+
+    MeshData mesh;
+    mesh.positions.resize(samples.size());
+    mesh.colors.resize(samples.size());
+    for (uint32_t j = 0; j < side; ++j)
+    {
+        // Same clamping as the tiles: samples past the map's edge sit on it
+        const int64_t gy = std::min((y * options.chunkCells + j) << level, cellsY);
+        for (uint32_t i = 0; i < side; ++i)
+        {
+            const int64_t gx = std::min((x * options.chunkCells + i) << level, cellsX);
+            const size_t v = size_t{j} * side + i;
+            mesh.positions[v] = Position{static_cast<float>(gx) * options.cellSize, static_cast<float>(gy) * options.cellSize,
+                                         samples[v] * options.heightScale, 1.0f};
+            mesh.colors[v] = heightColor(samples[v]);
+        }
+    }
+    return mesh;
+}
+
+void Terrain::buildLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping)
+            return;
+
+        auto best = std::max_element(queue.begin(), queue.end(), [this](uint64_t a, uint64_t b) {
+            return chunks.at(a).priority < chunks.at(b).priority;
+        });
+        const uint64_t node = *best;
+        *best = queue.back();
+        queue.pop_back();
+        chunks.at(node).state = ChunkState::Building;
+
+        lock.unlock();
+        MeshData mesh = buildChunk(node);
+        lock.lock();
+
+        Chunk &chunk = chunks.at(node);     // Building chunks are never dropped
+        chunk.staged = std::move(mesh);
+        chunk.state = ChunkState::Staged;
+        ++built;
+    }
+}
+
+std::vector<TerrainChunk> Terrain::takeBuilt()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<uint64_t> ready;
+    for (auto it = chunks.begin(); it != chunks.end();)
+    {
+        if (it->second.state == ChunkState::Staged && it->second.lastUsed != frame)
+        {
+            // Finished after the selection moved on
+            it = chunks.erase(it);
+            ++cancelled;
+            continue;
+        }
+        if (it->second.state == ChunkState::Staged)
+            ready.push_back(it->first);
+        ++it;
+    }
+
+    const size_t count = std::min(ready.size(), options.maxUploadsPerFrame);
+    std::partial_sort(ready.begin(), ready.begin() + count, ready.end(),
+                      [this](uint64_t a, uint64_t b) { return chunks.at(a).priority > chunks.at(b).priority; });
+
+    std::vector<TerrainChunk> uploads;
+    uploads.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Chunk &chunk = chunks.at(ready[i]);
+        chunk.state = ChunkState::Resident;
+        uploads.push_back({ready[i], std::move(chunk.staged)});
+        chunk.staged = {};
+    }
+    return uploads;
+}
+
+std::vector<uint64_t> Terrain::evict()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t resident = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> unused;     // (lastUsed, node)
+    for (const auto &[node, chunk] : chunks)
+    {
+        if (chunk.state != ChunkState::Resident)
+            continue;
+        ++resident;
+        if (chunk.lastUsed != frame)
+            unused.emplace_back(chunk.lastUsed, node);
+    }
+    if (resident <= options.maxResidentChunks)
+        return {};
+
+    const size_t count = std::min(unused.size(), resident - options.maxResidentChunks);
+    std::partial_sort(unused.begin(), unused.begin() + count, unused.end());
+
+    std::vector<uint64_t> released;
+    released.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        chunks.erase(unused[i].second);
+        released.push_back(unused[i].second);
+    }
+    evicted += count;
+    return released;
+}
+
+std::span<const TerrainDraw> Terrain::getDraws() const
+{
+    return draws;
+}
+
+const TerrainStitch &Terrain::getStitch() const
+{
+    return stitch;
+}
+
+uint32_t Terrain::getLevelCount() const
+{
+    return levels;
+}
+
+TerrainStats Terrain::getStats() const
+{
+    TerrainStats stats;
+    stats.selected = target.size();
+    stats.drawn = draws.size();
+    for (const TerrainDraw &draw : draws)
+        stats.triangles += stitch.count[draw.edges] / 3;
+    stats.balanceSplits = balanceSplits;
+    stats.selectMilliseconds = selectMilliseconds;
+    stats.tiles = heights->getStats();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &[node, chunk] : chunks)
+    {
+        stats.resident += chunk.state == ChunkState::Resident;
+        stats.queued += chunk.state == ChunkState::Queued;
+        stats.building += chunk.state == ChunkState::Building;
+        stats.staged += chunk.state == ChunkState::Staged;
+    }
+    stats.built = built;
+    stats.evicted = evicted;
+    stats.cancelled = cancelled;
+    return stats;
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <eigen/Eigen/Dense>
+
+#include "heightmapTiles.h"
+#include "../common/meshData.h"
+
+/*
+-------------------------------------------------------------------
+  TERRAIN  ---------------------------------------------------------
+
+  A heightmap drawn as a quadtree of chunks. Every chunk is the same
+  (cells + 1)^2 vertex grid; a chunk at level l samples every 2^l-th
+  height, so it covers 2^l times the area of a level 0 chunk. The
+  root (level levels - 1) covers the whole map.
+
+  Per frame, on the render thread:
+
+    update(eye)  splits chunks while the eye (terrain space) is closer
+                 than lodDistance chunk widths, then splits further
+                 until neighbours differ by at most one level. Chunks
+                 next to a coarser neighbour skip every other vertex
+                 along that edge (one of 16 shared index variants, see
+                 buildTerrainStitch), so their edges match exactly and
+                 no cracks open. Missing chunks of the selection and
+                 of its ancestors are queued, coarse and near first;
+                 queued ones no longer wanted are dropped.
+    takeBuilt    chunk meshes finished by the build threads, a few per
+                 frame, for the caller to upload
+    getDraws     what to draw: the latest selection with chunks not
+                 uploaded yet replaced by their closest uploaded
+                 ancestor, merged further up where that would put
+                 neighbours more than one level apart. Every drawn
+                 frame is balanced and crack free, and a moving eye
+                 sees coarse terrain rather than holes while the fine
+                 chunks build.
+    evict        uploaded chunks not wanted this frame,
+                 least recently used first, beyond maxResidentChunks
+
+  Build threads sample heights through HeightmapTiles (tiles of the
+  chunk's level only) and write positions (x, y on the ground, z =
+  height * heightScale) and colors graded by height.
+-------------------------------------------------------------------
+*/
+enum TerrainEdge : uint8_t
+{
+    kEdgeLeft = 1u << 0,        // -x neighbour is one level coarser
+    kEdgeRight = 1u << 1,
+    kEdgeBottom = 1u << 2,      // -y
+    kEdgeTop = 1u << 3,
+};
+
+struct TerrainOptions
+{
+    uint32_t chunkCells{32};            // Cells per chunk side; a power of two in [2, 128]
+    float cellSize{1.0f};               // Spacing of level 0 samples
+    float heightScale{1.0f};            // z of the highest sample
+    float lodDistance{2.5f};            // In chunk widths; at least 1
+    unsigned buildThreads{0};           // 0 = hardware concurrency - 1 (at least 1)
+    size_t maxUploadsPerFrame{16};
+    size_t maxResidentChunks{1024};
+};
+
+// One chunk to draw and which of its edges are stitched to a coarser neighbour
+struct TerrainDraw
+{
+    uint64_t node{0};
+    uint8_t edges{0};
+};
+
+// A built chunk: positions and colors on the chunk's vertex grid (row-major, x fastest)
+struct TerrainChunk
+{
+    uint64_t node{0};
+    MeshData mesh;
+};
+
+// Triangle lists for every edge mask, back to back over the shared (cells + 1)^2 vertex grid
+struct TerrainStitch
+{
+    std::vector<uint16_t> indices;
+    uint32_t offset[16]{};              // First index of each variant (even)
+    uint32_t count[16]{};
+};
+
+struct TerrainStats
+{
+    size_t selected{0};                 // Chunks in the latest selection
+    size_t drawn{0};                    // Chunks in getDraws(); differs while chunks build
+    size_t triangles{0};                // Drawn
+    size_t balanceSplits{0};            // Extra splits keeping neighbours within one level
+    size_t resident{0};
+    size_t queued{0};
+    size_t building{0};
+    size_t staged{0};
+    uint64_t built{0};
+    uint64_t evicted{0};
+    uint64_t cancelled{0};
+    double selectMilliseconds{0.0};     // The last update(), selection to draws
+    HeightTileStats tiles;
+};
+
+// Throws std::invalid_argument unless cells is a power of two in [2, 128]
+TerrainStitch buildTerrainStitch(uint32_t cells);
+
+/**
+ * @brief The view origin in terrain space: the eye at (0, 0, -1) the streamer also uses, through the
+ * inverse of the terrain's transform. Returns false (eye untouched) for a transform that can't be inverted.
+ */
+bool terrainEye(const Eigen::Matrix4f &transform, float eye[3]);
+
+class Terrain
+{
+public:
+    // Starts the build threads; throws std::invalid_argument for bad options
+    explicit Terrain(std::shared_ptr<HeightmapTiles> heights, const TerrainOptions &options = {});
+    ~Terrain();
+
+    Terrain(const Terrain &) = delete;
+    Terrain &operator=(const Terrain &) = delete;
+
+    // Selects this frame's chunks for an eye in terrain space; never waits for a build
+    void update(const float eye[3]);
+
+    // Up to maxUploadsPerFrame finished chunks, coarsest and nearest first; they count as uploaded
+    std::vector<TerrainChunk> takeBuilt();
+
+    // Uploaded chunks to release (see the banner); they can be selected and built again later
+    std::vector<uint64_t> evict();
+
+    std::span<const TerrainDraw> getDraws() const;
+    const TerrainStitch &getStitch() const;
+    uint32_t getLevelCount() const;
+    TerrainStats getStats() const;
+
+    static uint64_t nodeKey(uint32_t level, uint32_t x, uint32_t y);
+    static uint32_t nodeLevel(uint64_t node);
+
+private:
+    enum class ChunkState : uint8_t
+    {
+        Queued,
+        Building,
+        Staged,
+        Resident,
+    };
+
+    struct Chunk
+    {
+        ChunkState state{ChunkState::Queued};
+        float priority{0.0f};
+        uint64_t lastUsed{0};
+        MeshData staged;
+    };
+
+    std::shared_ptr<HeightmapTiles> heights;
+    TerrainOptions options;
+    TerrainStitch stitch;
+    uint32_t levels{1};
+    int64_t cellsX{0};                  // Level 0 cells: samples - 1
+    int64_t cellsY{0};
+
+    // Render thread only
+    std::unordered_set<uint64_t> leaves;        // Latest selection
+    std::unordered_set<uint64_t> drawLeaves;    // Its uploaded stand-in
+    std::vector<uint64_t> target;
+    std::vector<TerrainDraw> draws;
+    size_t balanceSplits{0};
+    double selectMilliseconds{0.0};
+
+    // Shared with the build threads
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping{false};
+    std::unordered_map<uint64_t, Chunk> chunks;
+    std::vector<uint64_t> queue;
+    uint64_t frame{0};
+    uint64_t built{0};
+    uint64_t evicted{0};
+    uint64_t cancelled{0};
+    std::vector<std::thread> threads;
+
+    bool isInside(uint32_t level, int64_t x, int64_t y) const;
+    float distanceTo(const float eye[3], uint32_t level, int64_t x, int64_t y) const;
+    void selectNode(const float eye[3], uint32_t level, uint32_t x, uint32_t y);
+    void selectResident(uint32_t level, uint32_t x, uint32_t y);
+    void balance();
+    void balanceResident();
+    void split(uint64_t node, std::vector<uint64_t> &worklist);
+    void merge(uint64_t node);
+    int coveringLevel(const std::unordered_set<uint64_t> &set, uint32_t level, int64_t x, int64_t y) const;
+    uint8_t findEdges(const std::unordered_set<uint64_t> &set, uint32_t level, int64_t x, int64_t y) const;
+
+    MeshData buildChunk(uint64_t node) const;
+    void buildLoop();
+};
@@ -0,0 +1,371 @@
+#include "curveFlattener.h"
+#include "../common/Transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+constexpr int kMaxCubicDepth = 16;          // At most 65536 pieces per cubic
+constexpr uint32_t kMaxArcSegments = 65536;
+constexpr double kQuarterTurn = 1.5707963267948966;
+
+void requirePositive(float tolerance)
+{
+    if (!(tolerance > 0.0f))
+        throw std::invalid_argument("Flattening tolerance must be positive");
+}
+
+struct Cubic
+{
+    float x[4];
+    float y[4];
+    int depth;
+};
+
+/**
+ * @brief True when the cubic stays within `toleranceSq` (squared) of its chord.
+ *
+ * The curve minus the chord (parametrized by the same t) is 3t(1-t)((1-t)u + tv), so per axis
+ * it never exceeds max(|3u|, |3v|) / 4 (Roger Willcocks' bound).
+ */
+bool isFlat(const Cubic &c, float toleranceSq)
+{
+    const float ux = 3.0f * c.x[1] - 2.0f * c.x[0] - c.x[3];
+    const float uy = 3.0f * c.y[1] - 2.0f * c.y[0] - c.y[3];
+    const float vx = 3.0f * c.x[2] - c.x[0] - 2.0f * c.x[3];
+    const float vy = 3.0f * c.y[2] - c.y[0] - 2.0f * c.y[3];
+    return std::max(ux * ux, vx * vx) + std::max(uy * uy, vy * vy) <= 16.0f * toleranceSq;
+}
+
+// de Casteljau at t = 1/2
+void split(const Cubic &c, Cubic &left, Cubic &right)
+{
+    auto half = [](const float *p, float *l, float *r) {
+        const float p01 = 0.5f * (p[0] + p[1]);
+        const float p12 = 0.5f * (p[1] + p[2]);
+        const float p23 = 0.5f * (p[2] + p[3]);
+        const float p012 = 0.5f * (p01 + p12);
+        const float p123 = 0.5f * (p12 + p23);
+        const float mid = 0.5f * (p012 + p123);
+        l[0] = p[0];
+        l[1] = p01;
+        l[2] = p012;
+        l[3] = mid;
+        r[0] = mid;
+        r[1] = p123;
+        r[2] = p23;
+        r[3] = p[3];
+    };
+    half(c.x, left.x, right.x);
+    half(c.y, left.y, right.y);
+    left.depth = right.depth = c.depth + 1;
+}
+} // namespace
+
+float flatteningTolerance(const Eigen::Matrix4f &transform, float viewportSize, float pixelTolerance)
+{
+    const float pixels = pixelsPerUnit(transform, viewportSize);
+    if (!(pixels > 0.0f) || !(pixelTolerance > 0.0f))
+        return std::numeric_limits<float>::max();      // Nothing visible: coarsest flattening
+    return pixelTolerance / pixels;
+}
+
+uint32_t arcSegmentCount(float radius, float sweep, float tolerance)
+{
+    requirePositive(tolerance);
+    // A chord spanning angle a sits r * (1 - cos(a / 2)) inside the arc at its middle
+    const double ratio = 1.0 - static_cast<double>(tolerance) / std::max(static_cast<double>(radius), 1e-30);
+    const double maxStep = ratio <= 0.0 ? kQuarterTurn : std::min(kQuarterTurn, 2.0 * std::acos(ratio));
+    const double segments = std::ceil(std::fabs(static_cast<double>(sweep)) / maxStep);
+    return static_cast<uint32_t>(std::clamp(segments, 1.0, static_cast<double>(kMaxArcSegments)));
+}
+
+size_t flattenQuadratic(const float p0[2], const float p1[2], const float p2[2], float tolerance,
+                        std::vector<float> &xy, FlattenStats *stats)
+{
+    requirePositive(tolerance);
+
+    // Wang's formula: a chord over a parameter step h is off by at most |p0 - 2 p1 + p2| h^2 / 4
+    const float dx = p0[0] - 2.0f * p1[0] + p2[0];
+    const float dy = p0[1] - 2.0f * p1[1] + p2[1];
+    const double steps = std::ceil(std::sqrt(std::sqrt(static_cast<double>(dx) * dx + static_cast<double>(dy) * dy) /
+                                             (4.0 * tolerance)));
+    const size_t count = static_cast<size_t>(std::clamp(steps, 1.0, static_cast<double>(kMaxArcSegments)));
+
+    xy.reserve(xy.size() + 2 * count);
+    const float step = 1.0f / static_cast<float>(count);
+    for (size_t i = 1; i < count; ++i)
+    {
+        const float t = static_cast<float>(i) * step;
+        const float s = 1.0f - t;
+        xy.push_back(s * s * p0[0] + 2.0f * s * t * p1[0] + t * t * p2[0]);
+        xy.push_back(s * s * p0[1] + 2.0f * s * t * p1[1] + t * t * p2[1]);
+    }
+    xy.push_back(p2[0]);
+    xy.push_back(p2[1]);
+
+    if (stats)
+    {
+        ++stats->curves;
+        stats->points += count;
+    }
+    return count;
+}
+
+size_t flattenCubic(const float p0[2], const float p1[2], const float p2[2], const float p3[2], float tolerance,
+                    std::vector<float> &xy, FlattenStats *stats)
+{
+    requirePositive(tolerance);
+    const float toleranceSq = tolerance * tolerance;
+
+    // Depth first, left half on top, so pieces come off the stack in curve order
+    Cubic stack[kMaxCubicDepth + 2];
+    size_t top = 0;
+    stack[top++] = Cubic{{p0[0], p1[0], p2[0], p3[0]}, {p0[1], p1[1], p2[1], p3[1]}, 0};
+
+    const size_t first = xy.size();
+    size_t subdivisions = 0;
+    while (top > 0)
+    {
+        const Cubic curve = stack[--top];
+        if (curve.depth >= kMaxCubicDepth || isFlat(curve, toleranceSq))
+        {
+            xy.push_back(curve.x[3]);
+            xy.push_back(curve.y[3]);
+            continue;
+        }
+        split(curve, stack[top + 1], stack[top]);
+        top += 2;
+        ++subdivisions;
+    }
+
+    const size_t count = (xy.size() - first) / 2;
+    if (stats)
+    {
+        ++stats->curves;
+        stats->points += count;
+        stats->subdivisions += subdivisions;
+    }
+    return count;
+}
+
+size_t flattenArc(const EllipticalArc &arc, float tolerance, std::vector<float> &xy, FlattenStats *stats)
+{
+    const float radius = std::max(std::fabs(arc.radius[0]), std::fabs(arc.radius[1]));
+    return flattenArcSegments(arc, arcSegmentCount(radius, arc.sweep, tolerance), xy, stats);
+}
+
+size_t flattenArcSegments(const EllipticalArc &arc, uint32_t segments, std::vector<float> &xy, FlattenStats *stats)
+{
+    const uint32_t count = std::max<uint32_t>(segments, 1);
+
+    // Rotate (cos, sin) of the parametric angle by one step per point; double keeps the drift
+    // far below any useful tolerance even for the longest arcs
+    const double step = static_cast<double>(arc.sweep) / count;
+    const double stepCos = std::cos(step), stepSin = std::sin(step);
+    const double axisCos = std::cos(static_cast<double>(arc.rotation));
+    const double axisSin = std::sin(static_cast<double>(arc.rotation));
+    double c = std::cos(static_cast<double>(arc.start));
+    double s = std::sin(static_cast<double>(arc.start));
+
+    xy.reserve(xy.size() + 2 * static_cast<size_t>(count));
+    for (uint32_t i = 1; i <= count; ++i)
+    {
+        if (i == count)
+        {
+            // Land exactly on the end angle
+            c = std::cos(static_cast<double>(arc.start) + static_cast<double>(arc.sweep));
+            s = std::sin(static_cast<double>(arc.start) + static_cast<double>(arc.sweep));
+        }
+        else
+        {
+            const double rotated = c * stepCos - s * stepSin;
+            s = s * stepCos + c * stepSin;
+            c = rotated;
+        }
+        const double ex = arc.radius[0] * c;
+        const double ey = arc.radius[1] * s;
+        xy.push_back(static_cast<float>(arc.center[0] + ex * axisCos - ey * axisSin));
+        xy.push_back(static_cast<float>(arc.center[1] + ex * axisSin + ey * axisCos));
+    }
+
+    if (stats)
+    {
+        ++stats->curves;
+        stats->points += count;
+    }
+    return count;
+}
+
+/*
+-------------------------------------------------------------------
+  PATH BUILDER  ----------------------------------------------------
+-------------------------------------------------------------------
+*/
+PathBuilder::PathBuilder(float tolerance) : tolerance(tolerance)
+{
+    requirePositive(tolerance);
+}
+
+void PathBuilder::setTolerance(float value)
+{
+    requirePositive(value);
+    tolerance = value;
+}
+
+float PathBuilder::getTolerance() const
+{
+    return tolerance;
+}
+
+PathBuilder &PathBuilder::moveTo(float x, float y)
+{
+    contourStarts.push_back(static_cast<uint32_t>(points.size() / 2));
+    closed.push_back(0);
+    points.push_back(x);
+    points.push_back(y);
+    open = true;
+    return *this;
+}
+
+void PathBuilder::beginSegment()
+{
+    if (contourStarts.empty())
+        throw std::runtime_error("Path: segment before the first moveTo");
+    if (!open)
+    {
+        // After close() the next segment starts a new contour where the closed one did
+        const uint32_t start = contourStarts.back();
+        moveTo(points[2 * start], points[2 * start + 1]);
+    }
+}
+
+PathBuilder &PathBuilder::lineTo(float x, float y)
+{
+    beginSegment();
+    points.push_back(x);
+    points.push_back(y);
+    return *this;
+}
+
+PathBuilder &PathBuilder::quadTo(float cx, float cy, float x, float y)
+{
+    beginSegment();
+
+    const float p0[2] = {points[points.size() - 2], points[points.size() - 1]};
+    const float p1[2] = {cx, cy};
+    const float p2[2] = {x, y};
+    flattenQuadratic(p0, p1, p2, tolerance, points, &stats);
+    return *this;
+}
+
+PathBuilder &PathBuilder::cubicTo(float c1x, float c1y, float c2x, float c2y, float x, float y)
+{
+    beginSegment();
+
+    const float p0[2] = {points[points.size() - 2], points[points.size() - 1]};
+    const float p1[2] = {c1x, c1y};
+    const float p2[2] = {c2x, c2y};
+    const float p3[2] = {x, y};
+    flattenCubic(p0, p1, p2, p3, tolerance, points, &stats);
+    return *this;
+}
+
+PathBuilder &PathBuilder::arcTo(const EllipticalArc &arc)
+{
+    const double axisCos = std::cos(static_cast<double>(arc.rotation));
+    const double axisSin = std::sin(static_cast<double>(arc.rotation));
+    const double ex = arc.radius[0] * std::cos(static_cast<double>(arc.start));
+    const double ey = arc.radius[1] * std::sin(static_cast<double>(arc.start));
+    const float x = static_cast<float>(arc.center[0] + ex * axisCos - ey * axisSin);
+    const float y = static_cast<float>(arc.center[1] + ex * axisSin + ey * axisCos);
+
+    if (!open)
+        moveTo(x, y);
+    else if (points[points.size() - 2] != x || points[points.size() - 1] != y)
+        lineTo(x, y);
+    flattenArc(arc, tolerance, points, &stats);
+    return *this;
+}
+
+PathBuilder &PathBuilder::close()
+{
+    if (!open)
+        return *this;
+
+    // The closing edge is implied; a repeated first point would only be dropped downstream
+    const size_t start = contourStarts.back();
+    const size_t count = points.size() / 2 - start;
+    if (count > 1 && points[2 * start] == points[points.size() - 2] && points[2 * start + 1] == points[points.size() - 1])
+        points.resize(points.size() - 2);
+    closed.back() = 1;
+    open = false;
+    return *this;
+}
+
+PathBuilder &PathBuilder::addEllipse(float cx, float cy, float rx, float ry)
+{
+    open = false;
+    EllipticalArc arc;
+    arc.center[0] = cx;
+    arc.center[1] = cy;
+    arc.radius[0] = rx;
+    arc.radius[1] = ry;
+    arcTo(arc);
+    return close();
+}
+
+void PathBuilder::clear()
+{
+    points.clear();
+    contourStarts.clear();
+    closed.clear();
+    open = false;
+    stats = {};
+}
+
+std::span<const float> PathBuilder::getPoints() const
+{
+    return points;
+}
+
+std::span<const uint32_t> PathBuilder::getContourStarts() const
+{
+    return contourStarts;
+}
+
+std::span<const uint32_t> PathBuilder::getHoleStarts() const
+{
+    if (contourStarts.size() < 2)
+        return {};
+    return std::span<const uint32_t>(contourStarts).subspan(1);
+}
+
+size_t PathBuilder::getContourCount() const
+{
+    return contourStarts.size();
+}
+
+std::span<const float> PathBuilder::getContour(size_t contour) const
+{
+    if (contour >= contourStarts.size())
+        throw std::out_of_range("Path: no such contour");
+    const size_t begin = contourStarts[contour];
+    const size_t end = contour + 1 < contourStarts.size() ? contourStarts[contour + 1] : points.size() / 2;
+    return std::span<const float>(points).subspan(2 * begin, 2 * (end - begin));
+}
+
+bool PathBuilder::isClosed(size_t contour) const
+{
+    if (contour >= closed.size())
+        throw std::out_of_range("Path: no such contour");
+    return closed[contour] != 0;
+}
+
+const FlattenStats &PathBuilder::getStats() const
+{
+    return stats;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <eigen/Eigen/Dense>
+
+/*
+-------------------------------------------------------------------
+  CURVE FLATTENING  ------------------------------------------------
+
+  Turns quadratic / cubic Beziers and elliptical arcs into polylines
+  whose distance from the true curve stays under a tolerance, with as
+  few points as that allows:
+
+    quadratic  uniform steps, count from Wang's formula (the second
+               derivative is constant, so uniform is already optimal)
+    cubic      recursive de Casteljau halving until each piece passes
+               a flatness bound; flat stretches stop early, tight
+               bends keep splitting. Halving overshoots about as much
+               as it saves: random cubics end up within a few percent
+               of (slightly above) uniform steps from Wang's formula
+    arc        equal angle steps from the sagitta of the largest
+               radius, points from an incremental rotation (one
+               cos/sin per arc, not per point)
+
+  The tolerance is in the curve's own units; flatteningTolerance()
+  derives it from a transform and a pixel error, so a shape that is
+  small on screen gets few points and a large one stays smooth.
+
+  PathBuilder strings curves into contours as flat xy pairs, laid out
+  the way triangulatePolygon (outline, then holes) and Stroker (one
+  polyline per contour) take them.
+-------------------------------------------------------------------
+*/
+struct FlattenStats
+{
+    size_t curves{0};           // Curves and arcs flattened (straight lines not counted)
+    size_t points{0};           // Points they produced
+    size_t subdivisions{0};     // Cubic halvings
+};
+
+struct EllipticalArc
+{
+    float center[2]{0.0f, 0.0f};
+    float radius[2]{1.0f, 1.0f};
+    float rotation{0.0f};       // Of the ellipse's x axis, radians
+    float start{0.0f};          // Parametric start angle, radians
+    float sweep{6.2831853f};    // Signed; counter-clockwise when positive
+};
+
+/**
+ * @brief Object-space distance that projects to `pixelTolerance` pixels under `transform`.
+ *
+ * Same convention as Mesh::selectLod: clip space spans 2 units across `viewportSize` pixels
+ * and only the largest scale of the transform counts. Pass the larger of the viewport's width
+ * and height, so the axis with more pixels per unit isn't under-tessellated.
+ */
+float flatteningTolerance(const Eigen::Matrix4f &transform, float viewportSize, float pixelTolerance = 0.25f);
+
+// Segments an arc of `radius` sweeping `sweep` radians needs to stay within `tolerance` (at least 1)
+uint32_t arcSegmentCount(float radius, float sweep, float tolerance);
+
+/*
+ *  Each function appends the curve's points after p0 (the end point included) as xy pairs
+ *  and returns how many it appended; p0 is expected to be the last point already in `xy`.
+ *  Throws std::invalid_argument for a tolerance that isn't positive.
+ */
+size_t flattenQuadratic(const float p0[2], const float p1[2], const float p2[2], float tolerance,
+                        std::vector<float> &xy, FlattenStats *stats = nullptr);
+size_t flattenCubic(const float p0[2], const float p1[2], const float p2[2], const float p3[2], float tolerance,
+                    std::vector<float> &xy, FlattenStats *stats = nullptr);
+
+// Appends the points after the arc's start point
+size_t flattenArc(const EllipticalArc &arc, float tolerance, std::vector<float> &xy, FlattenStats *stats = nullptr);
+
+// Same with a given segment count (e.g. one picked with arcSegmentCount and some headroom)
+size_t flattenArcSegments(const EllipticalArc &arc, uint32_t segments, std::vector<float> &xy,
+                          FlattenStats *stats = nullptr);
+
+/*
+-------------------------------------------------------------------
+  PATH BUILDER  ----------------------------------------------------
+-------------------------------------------------------------------
+*/
+class PathBuilder
+{
+public:
+    explicit PathBuilder(float tolerance);
+
+    // Applies to curves added after the call
+    void setTolerance(float tolerance);
+    float getTolerance() const;
+
+    // Starts a new contour
+    PathBuilder &moveTo(float x, float y);
+    PathBuilder &lineTo(float x, float y);
+    PathBuilder &quadTo(float cx, float cy, float x, float y);
+    PathBuilder &cubicTo(float c1x, float c1y, float c2x, float c2y, float x, float y);
+
+    // Joins the arc's start with a line, or starts a contour there if none is open
+    PathBuilder &arcTo(const EllipticalArc &arc);
+
+    // Marks the open contour closed; the next segment starts a new one
+    PathBuilder &close();
+
+    // A closed ellipse as its own contour
+    PathBuilder &addEllipse(float cx, float cy, float rx, float ry);
+
+    void clear();
+
+    // Every contour back to back
+    std::span<const float> getPoints() const;
+
+    // First point of each contour; from the second on these are triangulatePolygon's holeStarts
+    std::span<const uint32_t> getContourStarts() const;
+    std::span<const uint32_t> getHoleStarts() const;
+
+    size_t getContourCount() const;
+    std::span<const float> getContour(size_t contour) const;
+    bool isClosed(size_t contour) const;
+
+    const FlattenStats &getStats() const;
+
+private:
+    float tolerance;
+    std::vector<float> points;
+    std::vector<uint32_t> contourStarts;
+    std::vector<uint8_t> closed;        // Per contour
+    bool open{false};                   // A contour takes segments
+    FlattenStats stats;
+
+    void beginSegment();
+};
@@ -0,0 +1,591 @@
+#include "stroker.h"
+#include "../common/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+constexpr size_t kPointsPerChunk = size_t{1} << 14;     // Join/cap counting and writing granularity
+constexpr size_t kSegmentsPerTask = size_t{1} << 15;
+constexpr float kStraight = 1e-6f;                      // |sin| of a turn too small to leave a visible gap
+constexpr float kMinSegment = 1e-18f;                   // Shorter offsets count as repeated points (squares stay normal)
+constexpr int kMaxRoundSteps = 1024;                    // Per full turn
+constexpr float kPi = 3.14159265358979323846f;
+
+enum FillKind : uint8_t
+{
+    kFillNone,
+    kFillBevel,
+    kFillMiter,
+    kFillRound,
+    kFillStartSquare,
+    kFillEndSquare,
+    kFillStartRound,
+    kFillEndRound,
+};
+
+// Segment quad corners: 4 vertices per segment, left/right of its start, then of its end
+enum Corner : uint32_t
+{
+    kStartLeft,
+    kStartRight,
+    kEndLeft,
+    kEndRight,
+};
+
+inline void writeVertex(float *out, float x, float y)
+{
+    out[0] = x;
+    out[1] = y;
+    out[2] = 0.0f;
+    out[3] = 1.0f;
+}
+
+#if defined(__SSE2__)
+// One corner of four consecutive segments (x, y per lane) into each segment's 16 floats
+inline void storeCorner(float *out, __m128 x, __m128 y, Corner corner)
+{
+    __m128 z = _mm_setzero_ps();
+    __m128 w = _mm_set1_ps(1.0f);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(out + corner * 4, x);
+    _mm_storeu_ps(out + 16 + corner * 4, y);
+    _mm_storeu_ps(out + 32 + corner * 4, z);
+    _mm_storeu_ps(out + 48 + corner * 4, w);
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+inline void storeCorner(float *out, float32x4_t x, float32x4_t y, Corner corner)
+{
+    const float32x4x2_t xy = vtrnq_f32(x, y);                                   // x0 y0 x2 y2 | x1 y1 x3 y3
+    const float32x4x2_t zw = vtrnq_f32(vdupq_n_f32(0.0f), vdupq_n_f32(1.0f));   // 0 1 0 1 | 0 1 0 1
+    vst1q_f32(out + corner * 4, vcombine_f32(vget_low_f32(xy.val[0]), vget_low_f32(zw.val[0])));
+    vst1q_f32(out + 16 + corner * 4, vcombine_f32(vget_low_f32(xy.val[1]), vget_low_f32(zw.val[1])));
+    vst1q_f32(out + 32 + corner * 4, vcombine_f32(vget_high_f32(xy.val[0]), vget_high_f32(zw.val[0])));
+    vst1q_f32(out + 48 + corner * 4, vcombine_f32(vget_high_f32(xy.val[1]), vget_high_f32(zw.val[1])));
+}
+#endif
+} // namespace
+
+// What fills the gap at one point: a join between segments `in` and `out`, or a cap of segment `in`
+struct Stroker::Fill
+{
+    FillKind kind{kFillNone};
+    bool turnLeft{false};       // Joins: the outer side is the right one
+    uint32_t steps{0};          // Round joins/caps: triangles in the fan
+    float angle{0.0f};          // Round joins: turn angle
+    size_t in{0};
+    size_t out{0};
+
+    // Vertices added, which is also the number of triangles
+    uint32_t count() const
+    {
+        switch (kind)
+        {
+        case kFillNone:
+            return 0;
+        case kFillBevel:
+            return 1;
+        case kFillMiter:
+        case kFillStartSquare:
+        case kFillEndSquare:
+            return 2;
+        default:
+            return steps;
+        }
+    }
+};
+
+/*
+-------------------------------------------------------------------
+  ANALYSIS  --------------------------------------------------------
+-------------------------------------------------------------------
+*/
+Stroker::Stroker(std::span<const float> xy, const StrokeStyle &style) : style(style)
+{
+    if (xy.size() % 2 != 0)
+        throw std::invalid_argument("Stroke: xy must hold x, y pairs");
+    if (!(style.width > 0.0f) || !std::isfinite(style.width))
+        throw std::invalid_argument("Stroke: width must be positive and finite");
+
+    halfWidth = style.width * 0.5f;
+    // A chord of angle a sits halfWidth * (1 - cos(a / 2)) inside its arc
+    roundStep = style.tolerance < halfWidth ? 2.0f * std::acos(1.0f - std::max(style.tolerance, 0.0f) / halfWidth) : kPi;
+    roundStep = std::max(roundStep, 2.0f * kPi / kMaxRoundSteps);
+
+    cleanPoints(xy);
+    segmentCount = pointCount < 2 ? 0 : style.closed ? pointCount : pointCount - 1;
+    stats.points = pointCount;
+    stats.segments = segmentCount;
+    if (segmentCount == 0)
+        return;
+
+    computeDirections();
+    countFills();
+}
+
+void Stroker::cleanPoints(std::span<const float> xy)
+{
+    const size_t count = xy.size() / 2;
+    auto distinct = [](const float *a, const float *b) {
+        return std::max(std::fabs(b[0] - a[0]), std::fabs(b[1] - a[1])) > kMinSegment;
+    };
+
+    // Borrow the input unless something has to go
+    size_t first = 1;
+    while (first < count && distinct(&xy[2 * first - 2], &xy[2 * first]))
+        ++first;
+    if (first >= count)
+    {
+        points = xy;
+        pointCount = count;
+    }
+    else
+    {
+        cleaned.resize(xy.size());
+        std::copy(xy.begin(), xy.begin() + 2 * first, cleaned.begin());
+        size_t kept = first;
+        for (size_t i = first; i < count; ++i)
+        {
+            if (distinct(&cleaned[2 * kept - 2], &xy[2 * i]))
+            {
+                cleaned[2 * kept] = xy[2 * i];
+                cleaned[2 * kept + 1] = xy[2 * i + 1];
+                ++kept;
+            }
+        }
+        cleaned.resize(2 * kept);
+        points = cleaned;
+        pointCount = kept;
+    }
+
+    // A closed line that repeats its first point already has its closing segment
+    if (style.closed)
+        while (pointCount > 1 && !distinct(&points[2 * pointCount - 2], &points[0]))
+            --pointCount;
+    points = points.first(2 * pointCount);
+}
+
+void Stroker::computeDirections()
+{
+    directionX.resize(segmentCount);
+    directionY.resize(segmentCount);
+
+    parallelFor(segmentCount, kSegmentsPerTask, style.threads, [this](size_t begin, size_t end) {
+        const float *p = points.data();
+        float *ux = directionX.data();
+        float *uy = directionY.data();
+        size_t s = begin;
+
+        // Four segments at a time while their end points are contiguous (the closing segment isn't)
+#if defined(__SSE2__)
+        for (; s + 4 <= end && s + 4 < pointCount; s += 4)
+        {
+            const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(p + 2 * s + 2), _mm_loadu_ps(p + 2 * s));   // dx0 dy0 dx1 dy1
+            const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(p + 2 * s + 6), _mm_loadu_ps(p + 2 * s + 4));
+            const __m128 dx = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 dy = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(3, 1, 3, 1));
+            const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+            _mm_storeu_ps(ux + s, _mm_div_ps(dx, length));
+            _mm_storeu_ps(uy + s, _mm_div_ps(dy, length));
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        for (; s + 4 <= end && s + 4 < pointCount; s += 4)
+        {
+            const float32x4x2_t a = vld2q_f32(p + 2 * s);          // Deinterleaved x, y of points s..s+3
+            const float32x4x2_t b = vld2q_f32(p + 2 * s + 2);      // Points s+1..s+4
+            const float32x4_t dx = vsubq_f32(b.val[0], a.val[0]);
+            const float32x4_t dy = vsubq_f32(b.val[1], a.val[1]);
+            const float32x4_t length = vsqrtq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)));
+            vst1q_f32(ux + s, vdivq_f32(dx, length));
+            vst1q_f32(uy + s, vdivq_f32(dy, length));
+        }
+#endif
+        for (; s < end; ++s)
+        {
+            const size_t next = s + 1 == pointCount ? 0 : s + 1;
+            const float dx = p[2 * next] - p[2 * s];
+            const float dy = p[2 * next + 1] - p[2 * s + 1];
+            const float length = std::sqrt(dx * dx + dy * dy);
+            ux[s] = dx / length;
+            uy[s] = dy / length;
+        }
+    });
+}
+
+Stroker::Fill Stroker::classify(size_t point) const
+{
+    Fill fill;
+    if (!style.closed && (point == 0 || point == pointCount - 1))
+    {
+        const bool start = point == 0;
+        fill.in = fill.out = start ? 0 : segmentCount - 1;
+        if (style.cap == LineCap::Square)
+            fill.kind = start ? kFillStartSquare : kFillEndSquare;
+        else if (style.cap == LineCap::Round)
+        {
+            fill.kind = start ? kFillStartRound : kFillEndRound;
+            fill.steps = std::max(2u, static_cast<uint32_t>(std::ceil(kPi / roundStep)));
+        }
+        return fill;
+    }
+
+    fill.in = point == 0 ? segmentCount - 1 : point - 1;
+    fill.out = point;
+    const float x0 = directionX[fill.in], y0 = directionY[fill.in];
+    const float x1 = directionX[fill.out], y1 = directionY[fill.out];
+    const float cross = x0 * y1 - y0 * x1;
+    const float dot = x0 * x1 + y0 * y1;
+    if (dot > 0.0f && std::fabs(cross) <= kStraight)
+        return fill;
+
+    fill.turnLeft = cross > 0.0f;
+    switch (style.join)
+    {
+    case LineJoin::Bevel:
+        fill.kind = kFillBevel;
+        break;
+    case LineJoin::Miter:
+    {
+        // The miter is 1 / cos(turn / 2) widths long, and cos^2(turn / 2) = (1 + dot) / 2
+        const float limit = std::max(style.miterLimit, 1.0f);
+        fill.kind = (1.0f + dot) * limit * limit >= 2.0f ? kFillMiter : kFillBevel;
+        break;
+    }
+    case LineJoin::Round:
+        fill.kind = kFillRound;
+        fill.angle = std::atan2(std::fabs(cross), dot);
+        fill.steps = std::clamp(static_cast<uint32_t>(std::ceil(fill.angle / roundStep)), 1u,
+                                static_cast<uint32_t>(kMaxRoundSteps / 2));
+        break;
+    }
+    return fill;
+}
+
+void Stroker::countFills()
+{
+    const size_t chunks = (pointCount + kPointsPerChunk - 1) / kPointsPerChunk;
+    std::vector<StrokeStats> chunkStats(chunks);
+
+    parallelFor(chunks, 1, style.threads, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            StrokeStats &local = chunkStats[chunk];
+            const size_t last = std::min(pointCount, (chunk + 1) * kPointsPerChunk);
+            for (size_t point = chunk * kPointsPerChunk; point < last; ++point)
+            {
+                const Fill fill = classify(point);
+                local.vertices += fill.count();
+                local.miters += fill.kind == kFillMiter;
+                local.bevels += fill.kind == kFillBevel;
+                local.roundJoins += fill.kind == kFillRound;
+                local.caps += fill.kind >= kFillStartSquare;
+            }
+        }
+    });
+
+    // Fill vertices follow the segment quads, chunk by chunk
+    chunkOffsets.resize(chunks + 1);
+    size_t offset = 4 * segmentCount;
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        chunkOffsets[chunk] = offset;
+        offset += chunkStats[chunk].vertices;
+        stats.miters += chunkStats[chunk].miters;
+        stats.bevels += chunkStats[chunk].bevels;
+        stats.roundJoins += chunkStats[chunk].roundJoins;
+        stats.caps += chunkStats[chunk].caps;
+    }
+    chunkOffsets[chunks] = offset;
+
+    // Every fill vertex also adds one triangle
+    stats.vertices = offset;
+    stats.indices = 6 * segmentCount + 3 * (offset - 4 * segmentCount);
+}
+
+size_t Stroker::getVertexCount() const
+{
+    return stats.vertices;
+}
+
+size_t Stroker::getIndexCount() const
+{
+    return stats.indices;
+}
+
+const StrokeStats &Stroker::getStats() const
+{
+    return stats;
+}
+
+/*
+-------------------------------------------------------------------
+  VERTICES  --------------------------------------------------------
+-------------------------------------------------------------------
+*/
+void Stroker::writeVertices(std::span<float> xyzw) const
+{
+    if (xyzw.size() < 4 * stats.vertices)
+        throw std::invalid_argument("Stroke: vertex span is too small");
+    if (segmentCount == 0)
+        return;
+
+    const float *p = points.data();
+    const float *ux = directionX.data();
+    const float *uy = directionY.data();
+    const float hw = halfWidth;
+
+    // Segment quads: the points offset along each segment's left normal (-uy, ux)
+    parallelFor(segmentCount, kSegmentsPerTask, style.threads, [&](size_t begin, size_t end) {
+        size_t s = begin;
+#if defined(__SSE2__)
+        const __m128 half = _mm_set1_ps(hw);
+        for (; s + 4 <= end && s + 4 < pointCount; s += 4)
+        {
+            const __m128 a0 = _mm_loadu_ps(p + 2 * s), a1 = _mm_loadu_ps(p + 2 * s + 4);
+            const __m128 b0 = _mm_loadu_ps(p + 2 * s + 2), b1 = _mm_loadu_ps(p + 2 * s + 6);
+            const __m128 x0 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 y0 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1));
+            const __m128 x1 = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 y1 = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1));
+            const __m128 nx = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(uy + s)), half);
+            const __m128 ny = _mm_mul_ps(_mm_loadu_ps(ux + s), half);
+
+            float *out = xyzw.data() + 16 * s;
+            storeCorner(out, _mm_add_ps(x0, nx), _mm_add_ps(y0, ny), kStartLeft);
+            storeCorner(out, _mm_sub_ps(x0, nx), _mm_sub_ps(y0, ny), kStartRight);
+            storeCorner(out, _mm_add_ps(x1, nx), _mm_add_ps(y1, ny), kEndLeft);
+            storeCorner(out, _mm_sub_ps(x1, nx), _mm_sub_ps(y1, ny), kEndRight);
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        const float32x4_t half = vdupq_n_f32(hw);
+        for (; s + 4 <= end && s + 4 < pointCount; s += 4)
+        {
+            const float32x4x2_t a = vld2q_f32(p + 2 * s);
+            const float32x4x2_t b = vld2q_f32(p + 2 * s + 2);
+            const float32x4_t nx = vmulq_f32(vnegq_f32(vld1q_f32(uy + s)), half);
+            const float32x4_t ny = vmulq_f32(vld1q_f32(ux + s), half);
+
+            float *out = xyzw.data() + 16 * s;
+            storeCorner(out, vaddq_f32(a.val[0], nx), vaddq_f32(a.val[1], ny), kStartLeft);
+            storeCorner(out, vsubq_f32(a.val[0], nx), vsubq_f32(a.val[1], ny), kStartRight);
+            storeCorner(out, vaddq_f32(b.val[0], nx), vaddq_f32(b.val[1], ny), kEndLeft);
+            storeCorner(out, vsubq_f32(b.val[0], nx), vsubq_f32(b.val[1], ny), kEndRight);
+        }
+#endif
+        for (; s < end; ++s)
+        {
+            const size_t next = s + 1 == pointCount ? 0 : s + 1;
+            const float nx = -uy[s] * hw, ny = ux[s] * hw;
+            float *out = xyzw.data() + 16 * s;
+            writeVertex(out + 4 * kStartLeft, p[2 * s] + nx, p[2 * s + 1] + ny);
+            writeVertex(out + 4 * kStartRight, p[2 * s] - nx, p[2 * s + 1] - ny);
+            writeVertex(out + 4 * kEndLeft, p[2 * next] + nx, p[2 * next + 1] + ny);
+            writeVertex(out + 4 * kEndRight, p[2 * next] - nx, p[2 * next + 1] - ny);
+        }
+    });
+
+    // Joins and caps, each chunk at its counted offset
+    const size_t chunks = chunkOffsets.size() - 1;
+    parallelFor(chunks, 1, style.threads, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            float *out = xyzw.data() + 4 * chunkOffsets[chunk];
+            const size_t last = std::min(pointCount, (chunk + 1) * kPointsPerChunk);
+            for (size_t point = chunk * kPointsPerChunk; point < last; ++point)
+            {
+                const Fill fill = classify(point);
+                if (fill.kind == kFillNone)
+                    continue;
+
+                const float x = p[2 * point], y = p[2 * point + 1];
+                const float dx = ux[fill.in], dy = uy[fill.in];
+                float *next = out;
+                auto emit = [&next](float vx, float vy) {
+                    writeVertex(next, vx, vy);
+                    next += 4;
+                };
+
+                switch (fill.kind)
+                {
+                case kFillStartSquare:
+                    emit(x + (-dx - dy) * hw, y + (-dy + dx) * hw);     // Behind the start, left then right
+                    emit(x + (-dx + dy) * hw, y + (-dy - dx) * hw);
+                    break;
+                case kFillEndSquare:
+                    emit(x + (dx + dy) * hw, y + (dy - dx) * hw);       // Past the end, right then left
+                    emit(x + (dx - dy) * hw, y + (dy + dx) * hw);
+                    break;
+                case kFillMiter:
+                {
+                    // Tip along the sum of the outer normals; |n0 + n1| / (1 + dot) = 1 / cos(turn / 2)
+                    const float side = fill.turnLeft ? -1.0f : 1.0f;
+                    const float scale = side * hw / (1.0f + dx * ux[fill.out] + dy * uy[fill.out]);
+                    emit(x, y);
+                    emit(x - (dy + uy[fill.out]) * scale, y + (dx + ux[fill.out]) * scale);
+                    break;
+                }
+                default:
+                {
+                    emit(x, y);
+                    if (fill.kind == kFillBevel)
+                        break;
+
+                    // Fan interior: the first outer offset rotated towards the last in equal steps
+                    float vx, vy, step;
+                    if (fill.kind == kFillRound)
+                    {
+                        vx = fill.turnLeft ? dy * hw : -dy * hw;
+                        vy = fill.turnLeft ? -dx * hw : dx * hw;
+                        step = (fill.turnLeft ? fill.angle : -fill.angle) / static_cast<float>(fill.steps);
+                    }
+                    else
+                    {
+                        const bool start = fill.kind == kFillStartRound;
+                        vx = start ? -dy * hw : dy * hw;        // Left side at the start, right side at the end
+                        vy = start ? dx * hw : -dx * hw;
+                        step = kPi / static_cast<float>(fill.steps);
+                    }
+                    const float c = std::cos(step), s = std::sin(step);
+                    for (uint32_t i = 1; i < fill.steps; ++i)
+                    {
+                        const float rx = vx * c - vy * s;
+                        vy = vx * s + vy * c;
+                        vx = rx;
+                        emit(x + vx, y + vy);
+                    }
+                    break;
+                }
+                }
+                out = next;
+            }
+        }
+    });
+}
+
+/*
+-------------------------------------------------------------------
+  INDICES  ---------------------------------------------------------
+-------------------------------------------------------------------
+*/
+void Stroker::writeIndices(std::span<uint16_t> indices) const
+{
+    if (stats.vertices > UINT16_MAX)
+        throw std::invalid_argument("Stroke: too many vertices for 16-bit indices");
+    writeIndicesAs(indices);
+}
+
+void Stroker::writeIndices(std::span<uint32_t> indices) const
+{
+    if (stats.vertices > UINT32_MAX)
+        throw std::invalid_argument("Stroke: too many vertices for 32-bit indices");
+    writeIndicesAs(indices);
+}
+
+template <typename Index>
+void Stroker::writeIndicesAs(std::span<Index> indices) const
+{
+    if (indices.size() < stats.indices)
+        throw std::invalid_argument("Stroke: index span is too small");
+    if (segmentCount == 0)
+        return;
+
+    parallelFor(segmentCount, kSegmentsPerTask, style.threads, [&](size_t begin, size_t end) {
+        Index *out = indices.data() + 6 * begin;
+        for (size_t s = begin; s < end; ++s)
+        {
+            const Index base = static_cast<Index>(4 * s);
+            *out++ = base + kStartRight;
+            *out++ = base + kEndRight;
+            *out++ = base + kEndLeft;
+            *out++ = base + kStartRight;
+            *out++ = base + kEndLeft;
+            *out++ = base + kStartLeft;
+        }
+    });
+
+    auto corner = [](size_t segment, Corner c) { return static_cast<Index>(4 * segment + c); };
+
+    const size_t chunks = chunkOffsets.size() - 1;
+    parallelFor(chunks, 1, style.threads, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            // Fill triangles are laid out like their vertices: 3 indices per fill vertex
+            size_t vertex = chunkOffsets[chunk];
+            Index *out = indices.data() + 6 * segmentCount + 3 * (vertex - 4 * segmentCount);
+            auto emit = [&out](Index a, Index b, Index c) {
+                *out++ = a;
+                *out++ = b;
+                *out++ = c;
+            };
+
+            const size_t last = std::min(pointCount, (chunk + 1) * kPointsPerChunk);
+            for (size_t point = chunk * kPointsPerChunk; point < last; ++point)
+            {
+                const Fill fill = classify(point);
+                const Index center = static_cast<Index>(vertex);
+                switch (fill.kind)
+                {
+                case kFillNone:
+                    continue;
+                case kFillStartSquare:
+                    emit(corner(fill.in, kStartLeft), center, center + 1);
+                    emit(corner(fill.in, kStartLeft), center + 1, corner(fill.in, kStartRight));
+                    break;
+                case kFillEndSquare:
+                    emit(corner(fill.in, kEndRight), center, center + 1);
+                    emit(corner(fill.in, kEndRight), center + 1, corner(fill.in, kEndLeft));
+                    break;
+                default:
+                {
+                    // A fan around `center` from one outer corner, through the added vertices, to the other
+                    Index first, lastCorner;
+                    bool counterClockwise = true;
+                    if (fill.kind == kFillStartRound)
+                    {
+                        first = corner(fill.in, kStartLeft);
+                        lastCorner = corner(fill.in, kStartRight);
+                    }
+                    else if (fill.kind == kFillEndRound)
+                    {
+                        first = corner(fill.in, kEndRight);
+                        lastCorner = corner(fill.in, kEndLeft);
+                    }
+                    else if (fill.turnLeft)
+                    {
+                        first = corner(fill.in, kEndRight);
+                        lastCorner = corner(fill.out, kStartRight);
+                    }
+                    else
+                    {
+                        first = corner(fill.in, kEndLeft);
+                        lastCorner = corner(fill.out, kStartLeft);
+                        counterClockwise = false;
+                    }
+
+                    const uint32_t interior = fill.count() - 1;
+                    Index previous = first;
+                    for (uint32_t i = 0; i <= interior; ++i)
+                    {
+                        const Index next = i < interior ? static_cast<Index>(center + 1 + i) : lastCorner;
+                        if (counterClockwise)
+                            emit(center, previous, next);
+                        else
+                            emit(center, next, previous);
+                        previous = next;
+                    }
+                    break;
+                }
+                }
+                vertex += fill.count();
+            }
+        }
+    });
+}
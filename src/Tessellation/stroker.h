@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+-------------------------------------------------------------------
+  POLYLINE STROKING  -----------------------------------------------
+
+  Turns a polyline into triangles `width` wide, portable and
+  independent of the fill mode:
+
+    - every segment is a quad of its own (4 vertices, 2 triangles)
+    - every interior point fills the gap on the outer side of the
+      turn with a miter, bevel or round fan; straight continuations
+      need nothing
+    - open lines get butt, square or round caps; closed ones a join
+      at every point
+
+  The inner side of a turn overlaps instead of being clipped, so a
+  translucent stroke darkens there; opaque strokes look exact.
+
+  Two passes over the points. Construction cleans repeated points,
+  computes every segment's direction four at a time (SSE2 / NEON)
+  and counts the join geometry in fixed chunks, so the exact vertex
+  and index counts are known before any buffer exists. The write
+  pass then fills caller (buffer) memory directly, chunks in
+  parallel, each at an offset fixed by the counts.
+
+  Input is flat xy pairs; output vertices are xyzw (z = 0, w = 1)
+  and triangles are counter-clockwise (y up), like Polygon.
+-------------------------------------------------------------------
+*/
+enum class LineJoin : uint8_t
+{
+    Miter,
+    Round,
+    Bevel,
+};
+
+enum class LineCap : uint8_t
+{
+    Butt,
+    Square,     // Extends each end by half the width
+    Round,
+};
+
+struct StrokeStyle
+{
+    float width{0.02f};
+    LineJoin join{LineJoin::Miter};
+    LineCap cap{LineCap::Butt};
+    float miterLimit{4.0f};     // Longest miter in widths before the join is beveled (as in SVG; below 1 acts as 1)
+    float tolerance{0.001f};    // Furthest a round join/cap chord may sit inside its arc
+    bool closed{false};         // Joins the last point back to the first instead of capping both ends
+    unsigned threads{0};        // Workers for long polylines, 0 uses the hardware concurrency
+};
+
+struct StrokeStats
+{
+    size_t points{0};           // After dropping repeated points
+    size_t segments{0};
+    size_t miters{0};
+    size_t bevels{0};           // Including miters past the limit
+    size_t roundJoins{0};
+    size_t caps{0};
+    size_t vertices{0};
+    size_t indices{0};
+};
+
+/**
+ * @brief Strokes one polyline: counts at construction, writes on demand.
+ *
+ * Borrows `xy` unless repeated points had to be dropped, so it must outlive the Stroker.
+ * Fewer than two distinct points stroke to nothing.
+ */
+class Stroker
+{
+public:
+    /**
+     * @throws std::invalid_argument For an odd number of floats or a width that isn't positive and finite.
+     */
+    Stroker(std::span<const float> xy, const StrokeStyle &style);
+
+    size_t getVertexCount() const;
+    size_t getIndexCount() const;
+    const StrokeStats &getStats() const;
+
+    // getVertexCount() xyzw vertices; throws std::invalid_argument when `xyzw` is smaller
+    void writeVertices(std::span<float> xyzw) const;
+
+    // getIndexCount() indices; throws std::invalid_argument when `indices` is smaller, or the
+    // vertices don't fit 16 bits for the uint16_t overload
+    void writeIndices(std::span<uint16_t> indices) const;
+    void writeIndices(std::span<uint32_t> indices) const;
+
+private:
+    struct Fill;
+
+    StrokeStyle style;
+    std::vector<float> cleaned;         // Only used when the input repeats points
+    std::span<const float> points;
+    size_t pointCount{0};
+    size_t segmentCount{0};
+    std::vector<float> directionX;      // Unit direction of every segment
+    std::vector<float> directionY;
+    std::vector<size_t> chunkOffsets;   // First fill vertex of every chunk of points, past the segment quads
+    float halfWidth{0.0f};
+    float roundStep{0.0f};              // Largest angle one round join/cap triangle may span
+    StrokeStats stats;
+
+    void cleanPoints(std::span<const float> xy);
+    void computeDirections();
+    void countFills();
+    Fill classify(size_t point) const;
+
+    template <typename Index>
+    void writeIndicesAs(std::span<Index> indices) const;
+};
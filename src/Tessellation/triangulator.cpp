@@ -0,0 +1,760 @@
+#include "triangulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+// Rings with more vertices than this get the reflex grid
+constexpr size_t kIndexThreshold = 80;
+
+struct Node
+{
+    double x, y;
+    uint32_t i;                     // Input vertex index
+    Node *prev{nullptr};
+    Node *next{nullptr};
+    uint32_t slot{UINT32_MAX};      // Position in the reflex grid, UINT32_MAX when not in it
+    bool steiner{false};            // Single-vertex hole: never filtered away
+
+    Node(uint32_t i, double x, double y) : x(x), y(y), i(i) {}
+};
+
+// Twice the signed area of (p, q, r), negated: negative when counter-clockwise (a convex corner of the outline)
+inline double area(const Node *p, const Node *q, const Node *r)
+{
+    return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+inline bool equals(const Node *a, const Node *b)
+{
+    return a->x == b->x && a->y == b->y;
+}
+
+inline int sign(double value)
+{
+    return (value > 0.0) - (value < 0.0);
+}
+
+inline bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+{
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) && (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+           (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+// q lies on segment pr, given the three are collinear
+inline bool onSegment(const Node *p, const Node *q, const Node *r)
+{
+    return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) && q->y <= std::max(p->y, r->y) &&
+           q->y >= std::min(p->y, r->y);
+}
+
+bool intersects(const Node *p1, const Node *q1, const Node *p2, const Node *q2)
+{
+    const int o1 = sign(area(p1, q1, p2));
+    const int o2 = sign(area(p1, q1, q2));
+    const int o3 = sign(area(p2, q2, p1));
+    const int o4 = sign(area(p2, q2, q1));
+
+    if (o1 != o2 && o3 != o4)
+        return true;
+    // Collinear touching counts as intersecting
+    return (o1 == 0 && onSegment(p1, p2, q1)) || (o2 == 0 && onSegment(p1, q2, q1)) ||
+           (o3 == 0 && onSegment(p2, p1, q2)) || (o4 == 0 && onSegment(p2, q1, q2));
+}
+
+// Diagonal ab stays inside the polygon around a
+bool locallyInside(const Node *a, const Node *b)
+{
+    return area(a->prev, a, a->next) < 0.0 ? area(a, b, a->next) >= 0.0 && area(a, a->prev, b) >= 0.0
+                                           : area(a, b, a->prev) < 0.0 || area(a, a->next, b) < 0.0;
+}
+
+// Midpoint of ab is inside the polygon (even-odd)
+bool middleInside(const Node *a, const Node *b)
+{
+    const double px = (a->x + b->x) * 0.5;
+    const double py = (a->y + b->y) * 0.5;
+    bool inside = false;
+    const Node *p = a;
+    do
+    {
+        if ((p->y > py) != (p->next->y > py) && p->next->y != p->y &&
+            px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x)
+            inside = !inside;
+        p = p->next;
+    } while (p != a);
+    return inside;
+}
+
+bool intersectsPolygon(const Node *a, const Node *b)
+{
+    const Node *p = a;
+    do
+    {
+        if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i && intersects(p, p->next, a, b))
+            return true;
+        p = p->next;
+    } while (p != a);
+    return false;
+}
+
+bool isValidDiagonal(const Node *a, const Node *b)
+{
+    if (a->next->i == b->i || a->prev->i == b->i || intersectsPolygon(a, b))
+        return false;
+    if (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+        (area(a->prev, a, b->prev) != 0.0 || area(a, b->prev, b) != 0.0))
+        return true;
+    // Zero-length diagonal between two touching vertices
+    return equals(a, b) && area(a->prev, a, a->next) > 0.0 && area(b->prev, b, b->next) > 0.0;
+}
+
+// Sector of m contains the sector of p (both around the same point)
+bool sectorContainsSector(const Node *m, const Node *p)
+{
+    return area(m->prev, m, p->prev) < 0.0 && area(p->next, m, m->next) < 0.0;
+}
+
+void unlinkNode(Node *p)
+{
+    p->next->prev = p->prev;
+    p->prev->next = p->next;
+}
+
+/*
+ *  Uniform grid over the ring's reflex (and collinear) vertices, the only ones that can block
+ *  an ear. Clipping never turns a convex vertex reflex, so the set is built once per ring and
+ *  only shrinks: clipped vertices and vertices that turn convex are erased in O(1), keeping
+ *  every cell down to the vertices that can still block.
+ */
+class ReflexGrid
+{
+public:
+    bool active() const
+    {
+        return !offsets.empty();
+    }
+
+    void clear()
+    {
+        for (size_t c = 0; c + 1 < offsets.size(); ++c)
+            for (uint32_t k = offsets[c]; k < ends[c]; ++k)
+                cells[k].node->slot = UINT32_MAX;
+        offsets.clear();
+        ends.clear();
+        cells.clear();
+    }
+
+    // Swap-removes `p` from its cell; no-op for vertices not in the grid
+    void erase(Node *p)
+    {
+        if (p->slot == UINT32_MAX)
+            return;
+        const size_t cell = cellOf(p->x, p->y);
+        const uint32_t last = --ends[cell];
+        cells[p->slot] = cells[last];
+        cells[p->slot].node->slot = p->slot;
+        p->slot = UINT32_MAX;
+    }
+
+    // Returns false (and stays inactive) when the ring has no extent. A convex ring gets an empty
+    // grid: nothing can block an ear, and the plain test would still walk the whole ring for each
+    bool build(Node *ring)
+    {
+        clear();
+        double maxX = ring->x, maxY = ring->y;
+        minX = ring->x;
+        minY = ring->y;
+        std::vector<Node *> reflex;
+        Node *p = ring;
+        do
+        {
+            minX = std::min(minX, p->x);
+            minY = std::min(minY, p->y);
+            maxX = std::max(maxX, p->x);
+            maxY = std::max(maxY, p->y);
+            if (area(p->prev, p, p->next) >= 0.0)
+                reflex.push_back(p);
+            p = p->next;
+        } while (p != ring);
+
+        const double width = maxX - minX;
+        const double height = maxY - minY;
+        if (width <= 0.0 || height <= 0.0)
+            return false;
+
+        // About one reflex vertex per cell
+        const double cellSize = std::sqrt(width * height / static_cast<double>(std::max<size_t>(reflex.size(), 1)));
+        invCell = 1.0 / cellSize;
+        columns = static_cast<uint32_t>(std::clamp(width * invCell, 1.0, 65536.0)) + 1;
+        rows = static_cast<uint32_t>(std::clamp(height * invCell, 1.0, 65536.0)) + 1;
+
+        // Counting sort into one flat array (CSR)
+        offsets.assign(size_t{columns} * rows + 1, 0);
+        for (const Node *r : reflex)
+            ++offsets[cellOf(r->x, r->y) + 1];
+        for (size_t c = 1; c < offsets.size(); ++c)
+            offsets[c] += offsets[c - 1];
+        cells.resize(reflex.size());
+        ends.assign(offsets.begin(), offsets.end() - 1);
+        for (Node *r : reflex)
+        {
+            const uint32_t slot = ends[cellOf(r->x, r->y)]++;
+            cells[slot] = {r->x, r->y, r};
+            r->slot = slot;
+        }
+        return true;
+    }
+
+    /*
+     *  Calls `blocks` for every vertex inside triangle abc, visiting only the cells it touches,
+     *  row by row: each row only spans the triangle's x extent inside that row's slab.
+     *  Stops at the first blocker.
+     */
+    template <typename Blocks>
+    bool anyInside(const Node *a, const Node *b, const Node *c, const Blocks &blocks) const
+    {
+        const double y0 = std::min({a->y, b->y, c->y});
+        const double y1 = std::max({a->y, b->y, c->y});
+        const uint32_t row0 = row(y0);
+        const uint32_t row1 = row(y1);
+        const Node *corners[3] = {a, b, c};
+        const double pad = 1e-9 / invCell;
+
+        for (uint32_t r = row0; r <= row1; ++r)
+        {
+            const double slab0 = std::max(y0, minY + r / invCell);
+            const double slab1 = std::min(y1, minY + (r + 1) / invCell);
+
+            double x0 = std::numeric_limits<double>::infinity();
+            double x1 = -x0;
+            for (int e = 0; e < 3; ++e)
+            {
+                const Node *p = corners[e];
+                const Node *q = corners[(e + 1) % 3];
+                const double lo = std::max(slab0, std::min(p->y, q->y));
+                const double hi = std::min(slab1, std::max(p->y, q->y));
+                if (lo > hi)
+                    continue;       // Edge misses the slab
+                if (p->y == q->y)
+                {
+                    x0 = std::min({x0, p->x, q->x});
+                    x1 = std::max({x1, p->x, q->x});
+                    continue;
+                }
+                const double slope = (q->x - p->x) / (q->y - p->y);
+                const double xa = p->x + (lo - p->y) * slope;
+                const double xb = p->x + (hi - p->y) * slope;
+                x0 = std::min({x0, xa, xb});
+                x1 = std::max({x1, xa, xb});
+            }
+            if (x0 > x1)
+                continue;
+
+            const size_t rowStart = size_t{r} * columns;
+            const uint32_t first = column(x0 - pad);
+            const uint32_t last = column(x1 + pad);
+            for (size_t cell = rowStart + first; cell <= rowStart + last; ++cell)
+                for (uint32_t k = offsets[cell]; k < ends[cell]; ++k)
+                {
+                    // Positions live in the cell so the common miss never touches the node
+                    const Entry &entry = cells[k];
+                    if (pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, entry.x, entry.y) && blocks(entry.node))
+                        return true;
+                }
+        }
+        return false;
+    }
+
+private:
+    double minX{0.0}, minY{0.0}, invCell{0.0};
+    uint32_t columns{0}, rows{0};
+    std::vector<uint32_t> offsets;  // Cell c owns cells[offsets[c], offsets[c + 1]), row-major
+    std::vector<uint32_t> ends;     // ... of which [offsets[c], ends[c]) are still reflex
+    struct Entry
+    {
+        double x, y;
+        Node *node;
+    };
+    std::vector<Entry> cells;
+
+    uint32_t column(double x) const
+    {
+        return static_cast<uint32_t>(std::clamp((x - minX) * invCell, 0.0, double(columns - 1)));
+    }
+
+    uint32_t row(double y) const
+    {
+        return static_cast<uint32_t>(std::clamp((y - minY) * invCell, 0.0, double(rows - 1)));
+    }
+
+    size_t cellOf(double x, double y) const
+    {
+        return size_t{row(y)} * columns + column(x);
+    }
+};
+
+// Twice the signed area of a flat xy ring; positive when counter-clockwise (y up)
+double signedArea(std::span<const float> xy, size_t first, size_t last)
+{
+    double sum = 0.0;
+    for (size_t i = first, j = last - 1; i < last; j = i++)
+        sum += (double(xy[2 * j]) - xy[2 * i]) * (double(xy[2 * i + 1]) + xy[2 * j + 1]);
+    return sum;
+}
+
+class Triangulator
+{
+public:
+    Triangulator(std::span<const float> xy, std::vector<uint32_t> &indices, TriangulationStats &stats)
+        : xy(xy), indices(indices), stats(stats)
+    {
+    }
+
+    void run(std::span<const uint32_t> holeStarts)
+    {
+        const size_t vertexCount = xy.size() / 2;
+        const size_t outerEnd = holeStarts.empty() ? vertexCount : holeStarts[0];
+
+        Node *outer = linkedList(0, outerEnd, true);
+        if (!outer || outer->next == outer->prev)
+            return;
+        if (!holeStarts.empty())
+            outer = eliminateHoles(holeStarts, outer);
+
+        earcutLinked(outer, 0);
+    }
+
+private:
+    std::span<const float> xy;
+    std::vector<uint32_t> &indices;
+    TriangulationStats &stats;
+    std::deque<Node> nodes;         // Stable addresses while the ring is spliced
+    ReflexGrid grid;                // Of the ring being clipped; rebuilt for each split-off ring
+
+    void removeNode(Node *p)
+    {
+        unlinkNode(p);
+        grid.erase(p);
+    }
+
+    // Clipping an ear only shrinks its neighbours' angles; drop them from the grid once convex
+    void updateReflex(Node *p)
+    {
+        if (p->slot != UINT32_MAX && area(p->prev, p, p->next) < 0.0)
+            grid.erase(p);
+    }
+
+    Node *insertNode(uint32_t i, Node *last)
+    {
+        Node *p = &nodes.emplace_back(i, xy[2 * i], xy[2 * i + 1]);
+        if (!last)
+        {
+            p->prev = p;
+            p->next = p;
+        }
+        else
+        {
+            p->next = last->next;
+            p->prev = last;
+            last->next->prev = p;
+            last->next = p;
+        }
+        return p;
+    }
+
+    // Ring over vertices [first, last): counter-clockwise for the outline, clockwise for holes
+    Node *linkedList(size_t first, size_t last, bool counterClockwise)
+    {
+        if (last <= first)
+            return nullptr;
+
+        Node *tail = nullptr;
+        if (counterClockwise == (signedArea(xy, first, last) > 0.0))
+            for (size_t v = first; v < last; ++v)
+                tail = insertNode(static_cast<uint32_t>(v), tail);
+        else
+            for (size_t v = last; v-- > first;)
+                tail = insertNode(static_cast<uint32_t>(v), tail);
+
+        if (tail && equals(tail, tail->next))
+        {
+            removeNode(tail);
+            tail = tail->next;
+        }
+        return tail;
+    }
+
+    // Drops duplicate and collinear vertices between start and end
+    Node *filterPoints(Node *start, Node *end = nullptr)
+    {
+        if (!start)
+            return start;
+        if (!end)
+            end = start;
+
+        Node *p = start;
+        bool again;
+        do
+        {
+            again = false;
+            if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0.0))
+            {
+                removeNode(p);
+                p = end = p->prev;
+                if (p == p->next)
+                    break;
+                again = true;
+            }
+            else
+            {
+                p = p->next;
+            }
+        } while (again || p != end);
+        return end;
+    }
+
+    // The outline ring runs counter-clockwise, so (prev, ear, next) already is
+    void emit(const Node *a, const Node *b, const Node *c)
+    {
+        indices.push_back(a->i);
+        indices.push_back(b->i);
+        indices.push_back(c->i);
+    }
+
+    void earcutLinked(Node *ear, int pass)
+    {
+        if (!ear)
+            return;
+        if (pass == 0)
+            indexRing(ear);
+
+        Node *stop = ear;
+        while (ear->prev != ear->next)
+        {
+            Node *prev = ear->prev;
+            Node *next = ear->next;
+
+            if (grid.active() ? isEarIndexed(ear) : isEar(ear))
+            {
+                emit(prev, ear, next);
+                ++stats.earsClipped;
+                removeNode(ear);
+                updateReflex(prev);
+                updateReflex(next);
+
+                // Skipping the next vertex leaves fewer sliver triangles
+                ear = next->next;
+                stop = next->next;
+                continue;
+            }
+
+            ear = next;
+            if (ear == stop)
+            {
+                // A full lap without an ear: clean up, then progressively harder fixes
+                if (pass == 0)
+                {
+                    earcutLinked(filterPoints(ear), 1);
+                }
+                else if (pass == 1)
+                {
+                    ear = cureLocalIntersections(filterPoints(ear));
+                    earcutLinked(ear, 2);
+                }
+                else
+                {
+                    splitEarcut(ear);
+                }
+                break;
+            }
+        }
+    }
+
+    bool isEar(const Node *ear) const
+    {
+        const Node *a = ear->prev;
+        const Node *b = ear;
+        const Node *c = ear->next;
+        if (area(a, b, c) >= 0.0)
+            return false;           // Reflex
+
+        const double x0 = std::min({a->x, b->x, c->x}), y0 = std::min({a->y, b->y, c->y});
+        const double x1 = std::max({a->x, b->x, c->x}), y1 = std::max({a->y, b->y, c->y});
+
+        for (const Node *p = c->next; p != a; p = p->next)
+        {
+            if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+                pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && area(p->prev, p, p->next) >= 0.0)
+                return false;
+        }
+        return true;
+    }
+
+    // Same test, visiting only the reflex vertices in the grid cells the triangle covers
+    bool isEarIndexed(const Node *ear) const
+    {
+        const Node *a = ear->prev;
+        const Node *b = ear;
+        const Node *c = ear->next;
+        if (area(a, b, c) >= 0.0)
+            return false;
+
+        return !grid.anyInside(a, b, c, [&](const Node *p) {
+            return p != a && p != c && area(p->prev, p, p->next) >= 0.0;
+        });
+    }
+
+    // Cuts off the triangle around each local self-intersection (a, p, p->next, b)
+    Node *cureLocalIntersections(Node *start)
+    {
+        Node *p = start;
+        do
+        {
+            Node *a = p->prev;
+            Node *b = p->next->next;
+            if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a))
+            {
+                emit(a, p, b);
+                ++stats.intersectionsCured;
+                removeNode(p);
+                removeNode(p->next);
+                p = start = b;
+            }
+            p = p->next;
+        } while (p != start);
+        return filterPoints(p);
+    }
+
+    // Last resort: split the ring along any valid diagonal and triangulate both halves
+    void splitEarcut(Node *start)
+    {
+        Node *a = start;
+        do
+        {
+            for (Node *b = a->next->next; b != a->prev; b = b->next)
+            {
+                if (a->i != b->i && isValidDiagonal(a, b))
+                {
+                    Node *c = splitPolygon(a, b);
+                    ++stats.splits;
+                    a = filterPoints(a, a->next);
+                    c = filterPoints(c, c->next);
+                    earcutLinked(a, 0);
+                    earcutLinked(c, 0);
+                    return;
+                }
+            }
+            a = a->next;
+        } while (a != start);
+    }
+
+    // Links a and b with a two-way bridge; returns the copy of b on the second ring
+    Node *splitPolygon(Node *a, Node *b)
+    {
+        Node *a2 = &nodes.emplace_back(a->i, a->x, a->y);
+        Node *b2 = &nodes.emplace_back(b->i, b->x, b->y);
+        Node *an = a->next;
+        Node *bp = b->prev;
+
+        a->next = b;
+        b->prev = a;
+        a2->next = an;
+        an->prev = a2;
+        b2->next = a2;
+        a2->prev = b2;
+        bp->next = b2;
+        b2->prev = bp;
+        return b2;
+    }
+
+    /*
+     *  Holes
+     */
+    Node *eliminateHoles(std::span<const uint32_t> holeStarts, Node *outer)
+    {
+        const size_t vertexCount = xy.size() / 2;
+        std::vector<Node *> queue;
+        queue.reserve(holeStarts.size());
+        for (size_t h = 0; h < holeStarts.size(); ++h)
+        {
+            const size_t first = holeStarts[h];
+            const size_t last = h + 1 < holeStarts.size() ? holeStarts[h + 1] : vertexCount;
+            Node *list = linkedList(first, last, false);
+            if (!list)
+                continue;
+            if (list == list->next)
+                list->steiner = true;
+            queue.push_back(leftmost(list));
+        }
+
+        std::sort(queue.begin(), queue.end(), [](const Node *a, const Node *b) {
+            return a->x != b->x ? a->x < b->x : a->y < b->y;
+        });
+        for (Node *hole : queue)
+            outer = eliminateHole(hole, outer);
+        return outer;
+    }
+
+    Node *eliminateHole(Node *hole, Node *outer)
+    {
+        Node *bridge = findHoleBridge(hole, outer);
+        if (!bridge)
+            return outer;
+
+        Node *bridgeReverse = splitPolygon(bridge, hole);
+        filterPoints(bridgeReverse, bridgeReverse->next);
+        return filterPoints(bridge, bridge->next);
+    }
+
+    // David Eberly's visible-vertex search: cast a ray left from the hole's leftmost vertex
+    static Node *findHoleBridge(Node *hole, Node *outer)
+    {
+        const double hx = hole->x;
+        const double hy = hole->y;
+        double qx = -std::numeric_limits<double>::infinity();
+        Node *m = nullptr;
+
+        Node *p = outer;
+        do
+        {
+            if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+            {
+                const double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+                if (x <= hx && x > qx)
+                {
+                    qx = x;
+                    m = p->x < p->next->x ? p : p->next;
+                    if (x == hx)
+                        return m;   // Hole touches the outline
+                }
+            }
+            p = p->next;
+        } while (p != outer);
+
+        if (!m)
+            return nullptr;
+
+        // Vertices inside the triangle (hole, hit, m) may block m; take the one at the smallest angle
+        const Node *stop = m;
+        const double mx = m->x;
+        const double my = m->y;
+        double tanMin = std::numeric_limits<double>::infinity();
+        p = m;
+        do
+        {
+            if (hx >= p->x && p->x >= mx && hx != p->x &&
+                pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+            {
+                const double tan = std::abs(hy - p->y) / (hx - p->x);
+                if (locallyInside(p, hole) &&
+                    (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p))))))
+                {
+                    m = p;
+                    tanMin = tan;
+                }
+            }
+            p = p->next;
+        } while (p != stop);
+        return m;
+    }
+
+    static Node *leftmost(Node *start)
+    {
+        Node *p = start;
+        Node *best = start;
+        do
+        {
+            if (p->x < best->x || (p->x == best->x && p->y < best->y))
+                best = p;
+            p = p->next;
+        } while (p != start);
+        return best;
+    }
+
+    /*
+     *  Reflex grid
+     */
+    void indexRing(Node *start)
+    {
+        grid.clear();
+        size_t count = 0;
+        const Node *p = start;
+        do
+        {
+            ++count;
+            p = p->next;
+        } while (p != start && count <= kIndexThreshold);
+
+        if (count > kIndexThreshold && grid.build(start))
+            stats.indexed = true;
+    }
+};
+
+void checkHoleStarts(std::span<const float> xy, std::span<const uint32_t> holeStarts)
+{
+    uint32_t previous = 0;
+    for (uint32_t start : holeStarts)
+    {
+        if (start < previous || start > xy.size() / 2)
+            throw std::invalid_argument("Triangulation: hole starts must be ascending and inside the vertex range");
+        previous = start;
+    }
+}
+} // namespace
+
+/*
+-------------------------------------------------------------------
+  TRIANGULATE  -----------------------------------------------------
+-------------------------------------------------------------------
+*/
+size_t triangulatePolygon(std::span<const float> xy, std::span<const uint32_t> holeStarts,
+                          std::vector<uint32_t> &indices, TriangulationStats *stats)
+{
+    checkHoleStarts(xy, holeStarts);
+    if (xy.size() / 2 > UINT32_MAX)
+        throw std::invalid_argument("Triangulation: too many vertices");
+
+    TriangulationStats local;
+    TriangulationStats &s = stats ? *stats : local;
+    s = {};
+    s.vertices = xy.size() / 2;
+    s.holes = holeStarts.size();
+
+    indices.clear();
+    indices.reserve((s.vertices + 2 * s.holes) * 3);
+
+    Triangulator(xy, indices, s).run(holeStarts);
+    s.triangles = indices.size() / 3;
+    return s.triangles;
+}
+
+double triangulationAreaError(std::span<const float> xy, std::span<const uint32_t> holeStarts,
+                              std::span<const uint32_t> indices)
+{
+    const size_t vertexCount = xy.size() / 2;
+    double polygonArea = 0.0;
+    for (size_t h = 0; h <= holeStarts.size(); ++h)
+    {
+        const size_t first = h == 0 ? 0 : holeStarts[h - 1];
+        const size_t last = h < holeStarts.size() ? holeStarts[h] : vertexCount;
+        if (last > first)
+            polygonArea += (h == 0 ? 1.0 : -1.0) * std::abs(signedArea(xy, first, last));
+    }
+
+    double trianglesArea = 0.0;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        const uint32_t a = indices[t], b = indices[t + 1], c = indices[t + 2];
+        trianglesArea += std::abs((double(xy[2 * c]) - xy[2 * a]) * (double(xy[2 * b + 1]) - xy[2 * a + 1]) -
+                                  (double(xy[2 * b]) - xy[2 * a]) * (double(xy[2 * c + 1]) - xy[2 * a + 1]));
+    }
+
+    if (polygonArea == 0.0 && trianglesArea == 0.0)
+        return 0.0;
+    return std::abs(trianglesArea - polygonArea) / std::abs(polygonArea);
+}
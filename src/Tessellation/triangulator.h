@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+-------------------------------------------------------------------
+  POLYGON TRIANGULATION  -------------------------------------------
+
+  Ear clipping over a doubly linked vertex ring, with holes bridged
+  into the outline first (each hole joined to a mutually visible
+  outer vertex, leftmost hole first).
+
+  Only reflex vertices can block an ear, and clipping never makes a
+  convex vertex reflex. Large rings bucket their reflex vertices in a
+  uniform grid, dropping each one as it is clipped or turns convex;
+  an ear test then visits only the cells the candidate triangle
+  covers instead of the whole ring. Typical outlines (smooth curves,
+  coastlines, glyphs) run in about O(n log n). Bridging walks the
+  outline once per hole, so h holes add O(h * n): a few thousand
+  holes cost little, 100K holes take minutes. Long thin
+  bands whose edges are longer than the band is wide stay quadratic,
+  as with any ear clipper: most candidate ears there are blocked.
+  Dense jittered rings sit in between: the clipped ears fan out into
+  slivers that grow with the ring, so each test covers more cells
+  (a 1M-vertex noisy star takes ~25x its 100K time). The cell size
+  is not what limits it; 4x larger or smaller cells are no faster.
+
+  Degenerate input is handled rather than rejected:
+    - duplicate and collinear vertices are dropped as they appear
+    - when no ear is left, local self-intersections are cut off, and
+      as a last resort the ring is split along a valid diagonal and
+      each half is triangulated on its own
+  So outlines touching themselves at a vertex, holes touching the
+  outline or each other, and zero-width spikes triangulate exactly.
+  Self-intersecting input (a bowtie, a spike crossing or running
+  through another vertex) cannot: triangles only use input vertices,
+  so the crossing points are missing and the result is a best effort
+  that can miss a lobe or cover area outside the outline.
+
+  Input is flat xy pairs: the outline, then each hole, with
+  `holeStarts` giving the first vertex index of every hole. Either
+  winding is accepted for both. Output triangles index the input
+  vertices and are counter-clockwise (y up).
+-------------------------------------------------------------------
+*/
+struct TriangulationStats
+{
+    size_t vertices{0};
+    size_t holes{0};
+    size_t triangles{0};
+    size_t earsClipped{0};
+    size_t intersectionsCured{0};   // Triangles cut off around local self-intersections
+    size_t splits{0};               // Diagonal splits (last-resort pass)
+    bool indexed{false};            // Reflex grid used for ear tests
+};
+
+/**
+ * @brief Triangulates a polygon with holes into `indices` (cleared first).
+ *
+ * Vertices beyond the outline are only holes; pass an empty `holeStarts` for a simple outline.
+ * Throws std::invalid_argument when a hole start is out of order or past the end.
+ *
+ * @return Number of triangles written.
+ */
+size_t triangulatePolygon(std::span<const float> xy, std::span<const uint32_t> holeStarts,
+                          std::vector<uint32_t> &indices, TriangulationStats *stats = nullptr);
+
+/**
+ * @brief Sum of |area| of the triangles minus |area| of the polygon, relative to the polygon's area.
+ *
+ * 0 for an exact triangulation; a quick check for tests and benchmarks. Only meaningful for
+ * outlines that don't cross themselves: a bowtie's signed area cancels out.
+ */
+double triangulationAreaError(std::span<const float> xy, std::span<const uint32_t> holeStarts,
+                              std::span<const uint32_t> indices);
@@ -0,0 +1,378 @@
+#include "vertexFormat.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// VERTEX_FORMAT_SCALAR leaves only the scalar kernels, so tests can check them on SIMD hosts too
+#if defined(__SSE2__) && !defined(VERTEX_FORMAT_SCALAR)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__) && !defined(VERTEX_FORMAT_SCALAR)
+#include <arm_neon.h>
+#endif
+
+/*
+-------------------------------------------------------------------
+  HELPERS  ---------------------------------------------------------
+-------------------------------------------------------------------
+*/
+namespace {
+
+constexpr float snorm16Max = 32767.0f;
+constexpr float unorm8Max = 255.0f;
+
+inline float clampUnit(float v) {
+    return std::min(1.0f, std::max(-1.0f, v));
+}
+
+inline int16_t toSnorm16(float v) {
+    return static_cast<int16_t>(std::lrintf(clampUnit(v) * snorm16Max));
+}
+
+inline uint8_t toUnorm8(float v) {
+    return static_cast<uint8_t>(std::lrintf(std::min(1.0f, std::max(0.0f, v)) * unorm8Max));
+}
+
+// Normalized encoding shared by Half4 and Snorm16x4: (v - offset) / scale, clamped to [-1, 1].
+struct Normalizer {
+    float invScale[4];
+    float offset[4];
+
+    explicit Normalizer(const VertexDequant &dequant) {
+        for (int i = 0; i < 4; ++i) {
+            invScale[i] = dequant.scale[i] != 0.0f ? 1.0f / dequant.scale[i] : 0.0f;
+            offset[i] = dequant.offset[i];
+        }
+    }
+};
+
+/*
+    POSITION KERNELS
+*/
+void encodePackedFloat3(const float *src, size_t count, float *dst) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i * 3 + 0] = src[i * 4 + 0];
+        dst[i * 3 + 1] = src[i * 4 + 1];
+        dst[i * 3 + 2] = src[i * 4 + 2];
+    }
+}
+
+void decodePackedFloat3(const float *src, size_t count, float *dst) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i * 4 + 0] = src[i * 3 + 0];
+        dst[i * 4 + 1] = src[i * 3 + 1];
+        dst[i * 4 + 2] = src[i * 3 + 2];
+        dst[i * 4 + 3] = 1.0f;
+    }
+}
+
+void encodeSnorm16(const float *src, size_t count, const Normalizer &n, int16_t *dst) {
+    size_t i = 0;
+#if defined(__SSE2__) && !defined(VERTEX_FORMAT_SCALAR)
+    const __m128 invScale = _mm_loadu_ps(n.invScale);
+    const __m128 offset = _mm_loadu_ps(n.offset);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 range = _mm_set_ps(0.0f, snorm16Max, snorm16Max, snorm16Max);   // w lane encodes to 0
+    for (; i + 2 <= count; i += 2) {
+        __m128 a = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + i * 4), offset), invScale);
+        __m128 b = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + i * 4 + 4), offset), invScale);
+        a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(a, lo), hi), range);
+        b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(b, lo), hi), range);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), packed);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__) && !defined(VERTEX_FORMAT_SCALAR)
+    const float32x4_t invScale = vld1q_f32(n.invScale);
+    const float32x4_t offset = vld1q_f32(n.offset);
+    const float32x4_t lo = vdupq_n_f32(-1.0f);
+    const float32x4_t hi = vdupq_n_f32(1.0f);
+    const float rangeLanes[4] = {snorm16Max, snorm16Max, snorm16Max, 0.0f};
+    const float32x4_t range = vld1q_f32(rangeLanes);
+    for (; i < count; ++i) {
+        float32x4_t v = vmulq_f32(vsubq_f32(vld1q_f32(src + i * 4), offset), invScale);
+        v = vmulq_f32(vminq_f32(vmaxq_f32(v, lo), hi), range);
+        vst1_s16(dst + i * 4, vqmovn_s32(vcvtnq_s32_f32(v)));
+    }
+#endif
+    for (; i < count; ++i) {
+        for (int c = 0; c < 3; ++c)
+            dst[i * 4 + c] = toSnorm16((src[i * 4 + c] - n.offset[c]) * n.invScale[c]);
+        dst[i * 4 + 3] = 0;
+    }
+}
+
+void decodeSnorm16(const int16_t *src, size_t count, const VertexDequant &d, float *dst) {
+    for (size_t i = 0; i < count; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            const float unit = std::max(static_cast<float>(src[i * 4 + c]) / snorm16Max, -1.0f);
+            dst[i * 4 + c] = unit * d.scale[c] + d.offset[c];
+        }
+        dst[i * 4 + 3] = 1.0f;
+    }
+}
+
+void encodeHalf(const float *src, size_t count, const Normalizer &n, uint16_t *dst) {
+    size_t i = 0;
+#if defined(__F16C__) && !defined(VERTEX_FORMAT_SCALAR)
+    const __m128 invScale = _mm_loadu_ps(n.invScale);
+    const __m128 offset = _mm_loadu_ps(n.offset);
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    for (; i + 2 <= count; i += 2) {
+        __m128 a = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + i * 4), offset), invScale);
+        __m128 b = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + i * 4 + 4), offset), invScale);
+        a = _mm_and_ps(_mm_min_ps(_mm_max_ps(a, lo), hi), xyzMask);
+        b = _mm_and_ps(_mm_min_ps(_mm_max_ps(b, lo), hi), xyzMask);
+        const __m256 ab = _mm256_insertf128_ps(_mm256_castps128_ps256(a), b, 1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm256_cvtps_ph(ab, _MM_FROUND_TO_NEAREST_INT));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__) && !defined(VERTEX_FORMAT_SCALAR)
+    const float32x4_t invScale = vld1q_f32(n.invScale);
+    const float32x4_t offset = vld1q_f32(n.offset);
+    const uint32_t maskLanes[4] = {~0u, ~0u, ~0u, 0u};
+    const uint32x4_t xyzMask = vld1q_u32(maskLanes);
+    const float32x4_t lo = vdupq_n_f32(-1.0f);
+    const float32x4_t hi = vdupq_n_f32(1.0f);
+    for (; i < count; ++i) {
+        float32x4_t v = vmulq_f32(vsubq_f32(vld1q_f32(src + i * 4), offset), invScale);
+        v = vminq_f32(vmaxq_f32(v, lo), hi);
+        v = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), xyzMask));
+        vst1_u16(dst + i * 4, vreinterpret_u16_f16(vcvt_f16_f32(v)));
+    }
+#endif
+    for (; i < count; ++i) {
+        for (int c = 0; c < 3; ++c)
+            dst[i * 4 + c] = floatToHalf(clampUnit((src[i * 4 + c] - n.offset[c]) * n.invScale[c]));
+        dst[i * 4 + 3] = 0;
+    }
+}
+
+void decodeHalf(const uint16_t *src, size_t count, const VertexDequant &d, float *dst) {
+    for (size_t i = 0; i < count; ++i) {
+        for (int c = 0; c < 3; ++c)
+            dst[i * 4 + c] = halfToFloat(src[i * 4 + c]) * d.scale[c] + d.offset[c];
+        dst[i * 4 + 3] = 1.0f;
+    }
+}
+
+/*
+    COLOR KERNELS
+*/
+void encodeUnorm8(const float *src, size_t count, uint8_t *dst) {
+    size_t i = 0;
+#if defined(__SSE2__) && !defined(VERTEX_FORMAT_SCALAR)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 range = _mm_set1_ps(unorm8Max);
+    for (; i + 4 <= count; i += 4) {
+        __m128i q[4];
+        for (int k = 0; k < 4; ++k) {
+            const __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + (i + k) * 4), zero), one);
+            q[k] = _mm_cvtps_epi32(_mm_mul_ps(v, range));
+        }
+        const __m128i lo = _mm_packs_epi32(q[0], q[1]);
+        const __m128i hi = _mm_packs_epi32(q[2], q[3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__) && !defined(VERTEX_FORMAT_SCALAR)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t range = vdupq_n_f32(unorm8Max);
+    for (; i + 2 <= count; i += 2) {
+        const float32x4_t a = vmulq_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i * 4), zero), one), range);
+        const float32x4_t b = vmulq_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i * 4 + 4), zero), one), range);
+        const uint16x8_t wide = vcombine_u16(vqmovn_u32(vcvtnq_u32_f32(a)), vqmovn_u32(vcvtnq_u32_f32(b)));
+        vst1_u8(dst + i * 4, vqmovn_u16(wide));
+    }
+#endif
+    for (size_t k = i * 4; k < count * 4; ++k)     // i counts vertices, the tail components
+        dst[k] = toUnorm8(src[k]);
+}
+
+void decodeUnorm8(const uint8_t *src, size_t count, float *dst) {
+    for (size_t i = 0; i < count * 4; ++i)
+        dst[i] = static_cast<float>(src[i]) / unorm8Max;
+}
+
+} // namespace
+
+/*
+-------------------------------------------------------------------
+  PUBLIC API  ------------------------------------------------------
+-------------------------------------------------------------------
+*/
+size_t positionStride(PositionFormat format) {
+    switch (format) {
+        case PositionFormat::Float4:       return 4 * sizeof(float);
+        case PositionFormat::PackedFloat3: return 3 * sizeof(float);
+        case PositionFormat::Half4:        return 4 * sizeof(uint16_t);
+        case PositionFormat::Snorm16x4:    return 4 * sizeof(int16_t);
+    }
+    throw std::runtime_error("Unknown position format");
+}
+
+size_t colorStride(ColorFormat format) {
+    switch (format) {
+        case ColorFormat::Float4:   return 4 * sizeof(float);
+        case ColorFormat::Unorm8x4: return 4 * sizeof(uint8_t);
+    }
+    throw std::runtime_error("Unknown color format");
+}
+
+VertexDequant computeDequant(const float *positions, size_t count) {
+    VertexDequant dequant;
+    if (count == 0)
+        return dequant;
+
+    float lo[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (size_t i = 0; i < count; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            lo[c] = std::min(lo[c], positions[i * 4 + c]);
+            hi[c] = std::max(hi[c], positions[i * 4 + c]);
+        }
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        dequant.offset[c] = 0.5f * (lo[c] + hi[c]);
+        const float halfExtent = 0.5f * (hi[c] - lo[c]);
+        dequant.scale[c] = halfExtent > 0.0f ? halfExtent : 1.0f;   // flat axis: any scale works
+    }
+    dequant.scale[3] = 1.0f;
+    dequant.offset[3] = 0.0f;
+    return dequant;
+}
+
+float positionErrorBound(PositionFormat format, const VertexDequant &dequant) {
+    const float maxScale = std::max({dequant.scale[0], dequant.scale[1], dequant.scale[2]});
+    switch (format) {
+        case PositionFormat::Float4:
+        case PositionFormat::PackedFloat3:
+            return 0.0f;
+        case PositionFormat::Half4:
+            // 11 significant bits on [-1, 1]: half an ulp at 1.0 is 2^-11, plus float rounding slack.
+            return maxScale * (std::ldexp(1.0f, -11) + 4.0f * FLT_EPSILON);
+        case PositionFormat::Snorm16x4:
+            return maxScale * (0.5f / snorm16Max + 4.0f * FLT_EPSILON);
+    }
+    throw std::runtime_error("Unknown position format");
+}
+
+void encodePositions(PositionFormat format, const float *src, size_t count, const VertexDequant &dequant, void *dst) {
+    switch (format) {
+        case PositionFormat::Float4:
+            std::memcpy(dst, src, count * 4 * sizeof(float));
+            return;
+        case PositionFormat::PackedFloat3:
+            encodePackedFloat3(src, count, static_cast<float *>(dst));
+            return;
+        case PositionFormat::Half4:
+            encodeHalf(src, count, Normalizer(dequant), static_cast<uint16_t *>(dst));
+            return;
+        case PositionFormat::Snorm16x4:
+            encodeSnorm16(src, count, Normalizer(dequant), static_cast<int16_t *>(dst));
+            return;
+    }
+    throw std::runtime_error("Unknown position format");
+}
+
+void decodePositions(PositionFormat format, const void *src, size_t count, const VertexDequant &dequant, float *dst) {
+    switch (format) {
+        case PositionFormat::Float4:
+            std::memcpy(dst, src, count * 4 * sizeof(float));
+            return;
+        case PositionFormat::PackedFloat3:
+            decodePackedFloat3(static_cast<const float *>(src), count, dst);
+            return;
+        case PositionFormat::Half4:
+            decodeHalf(static_cast<const uint16_t *>(src), count, dequant, dst);
+            return;
+        case PositionFormat::Snorm16x4:
+            decodeSnorm16(static_cast<const int16_t *>(src), count, dequant, dst);
+            return;
+    }
+    throw std::runtime_error("Unknown position format");
+}
+
+void encodeColors(ColorFormat format, const float *src, size_t count, void *dst) {
+    switch (format) {
+        case ColorFormat::Float4:
+            std::memcpy(dst, src, count * 4 * sizeof(float));
+            return;
+        case ColorFormat::Unorm8x4:
+            encodeUnorm8(src, count, static_cast<uint8_t *>(dst));
+            return;
+    }
+    throw std::runtime_error("Unknown color format");
+}
+
+void decodeColors(ColorFormat format, const void *src, size_t count, float *dst) {
+    switch (format) {
+        case ColorFormat::Float4:
+            std::memcpy(dst, src, count * 4 * sizeof(float));
+            return;
+        case ColorFormat::Unorm8x4:
+            decodeUnorm8(static_cast<const uint8_t *>(src), count, dst);
+            return;
+    }
+    throw std::runtime_error("Unknown color format");
+}
+
+/*
+    HALF CONVERSION
+*/
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half;
+    if (bits >= (143u << 23)) {                 // overflow, inf or NaN
+        half = bits > (255u << 23) ? 0x7e00u : 0x7c00u;
+    } else if (bits < (113u << 23)) {           // half subnormal or zero: let the FPU round
+        constexpr uint32_t magicBits = 126u << 23;
+        float magic;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        f += magic;
+        std::memcpy(&bits, &f, sizeof(bits));
+        half = bits - magicBits;
+    } else {                                    // normal: rebias exponent, round to nearest even
+        const uint32_t mantissaOdd = (bits >> 13) & 1u;
+        bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu + mantissaOdd;
+        half = bits >> 13;
+    }
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+float halfToFloat(uint16_t value) {
+    constexpr uint32_t shiftedExponent = 0x7c00u << 13;
+    uint32_t bits = (value & 0x7fffu) << 13;
+    const uint32_t exponent = bits & shiftedExponent;
+    bits += (127u - 15u) << 23;
+
+    if (exponent == shiftedExponent) {          // inf or NaN
+        bits += (128u - 16u) << 23;
+    } else if (exponent == 0) {                 // zero or subnormal: renormalize
+        constexpr uint32_t magicBits = 113u << 23;
+        float magic;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        bits += 1u << 23;
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        f -= magic;
+        std::memcpy(&bits, &f, sizeof(bits));
+    }
+
+    bits |= static_cast<uint32_t>(value & 0x8000u) << 16;
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+-------------------------------------------------------------------
+  VERTEX FORMATS  ---------------------------------------------------
+
+  Compact encodings for the two per-vertex streams a Primitive owns.
+  The numeric values of the enums are passed to shaders.metal as
+  function constants, so they must stay in sync with vertex_main_quantized.
+
+  Position formats (bytes per vertex):
+    Float4        16   float4, w = 1 (the original layout)
+    PackedFloat3  12   packed_float3, w is implied
+    Half4          8   half4 (w unused), dequantized with scale/offset
+    Snorm16x4      8   short4 (w unused), dequantized with scale/offset
+
+  Color formats (bytes per vertex):
+    Float4        16
+    Unorm8x4       4   rgba8, byte 0 = r
+-------------------------------------------------------------------
+*/
+enum class PositionFormat : uint32_t {
+    Float4 = 0,
+    PackedFloat3 = 1,
+    Half4 = 2,
+    Snorm16x4 = 3
+};
+
+enum class ColorFormat : uint32_t {
+    Float4 = 0,
+    Unorm8x4 = 1
+};
+
+struct VertexLayout {
+    PositionFormat position{PositionFormat::Float4};
+    ColorFormat color{ColorFormat::Float4};
+
+    bool isDefault() const {
+        return position == PositionFormat::Float4 && color == ColorFormat::Float4;
+    }
+};
+
+/**
+ * @brief Per-mesh dequantization parameters, bound to the vertex stage at buffer(12).
+ *
+ * Layout matches `VertexDequant` in shaders.metal: decoded = encoded * scale + offset,
+ * where `encoded` is in [-1, 1] for the normalized formats.
+ */
+struct VertexDequant {
+    float scale[4]{1.0f, 1.0f, 1.0f, 1.0f};
+    float offset[4]{0.0f, 0.0f, 0.0f, 0.0f};
+};
+
+size_t positionStride(PositionFormat format);
+size_t colorStride(ColorFormat format);
+
+/**
+ * @brief Computes the scale/offset that maps the mesh bounding box onto [-1, 1]^3.
+ *
+ * @param positions Tightly packed xyzw floats.
+ * @param count Number of vertices.
+ */
+VertexDequant computeDequant(const float *positions, size_t count);
+
+/**
+ * @brief Largest per-component absolute error a round trip through `format` can introduce.
+ */
+float positionErrorBound(PositionFormat format, const VertexDequant &dequant);
+
+// Encode/decode kernels. `src`/`dst` float streams are tightly packed xyzw / rgba.
+// The normalized formats (Half4, Snorm16x4) clamp positions outside the dequant box onto it.
+void encodePositions(PositionFormat format, const float *src, size_t count, const VertexDequant &dequant, void *dst);
+void decodePositions(PositionFormat format, const void *src, size_t count, const VertexDequant &dequant, float *dst);
+void encodeColors(ColorFormat format, const float *src, size_t count, void *dst);
+void decodeColors(ColorFormat format, const void *src, size_t count, float *dst);
+
+// Scalar IEEE half conversion (round to nearest even), used by the fallback kernels.
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
@@ -33,6 +33,7 @@ void Transform::setTranslation(float x, float y, float z) {
     translationMatrix(2, 3) = z;
 
     transformMatrix = translationMatrix * transformMatrix;
+    ++version;
 
 }
 /**
@@ -52,6 +53,7 @@ void Transform::setRotation(float angleRadians, float x, float y, float z) {
     rotationMatrix.block<3,3>(0,0) = rotMatrix;
 
     transformMatrix = rotationMatrix * transformMatrix;
+    ++version;
 }
 /**
  * @brief Applies a scaling transformation to the current transformation matrix.
@@ -67,6 +69,7 @@ void Transform::setScale(float x, float y, float z) {
     scaleMatrix(2, 2) = z;
 
     transformMatrix = scaleMatrix * transformMatrix;
+    ++version;
 
 }
 /**
@@ -74,6 +77,16 @@ void Transform::setScale(float x, float y, float z) {
  */
 void Transform::reset() {
     transformMatrix = Eigen::Matrix4f::Identity();
+    ++version;
+}
+/**
+ * @brief Replaces the transformation matrix.
+ *
+ * @param matrix The new model matrix.
+ */
+void Transform::setMatrix(const Matrix4f &matrix) {
+    transformMatrix = matrix;
+    ++version;
 }
 /**
  * @brief Retrieves the current transformation matrix.
@@ -83,6 +96,19 @@ void Transform::reset() {
 const Eigen::Matrix4f& Transform::getMatrix() const {
     return transformMatrix;
 }
+/**
+ * @brief Retrieves the change counter of the transformation matrix.
+ *
+ * @return A value that changes every time the matrix is modified.
+ */
+uint64_t Transform::getVersion() const {
+    return version;
+}
+
+float pixelsPerUnit(const Matrix4f &matrix, float viewportSize) {
+    const float maxScale = matrix.block<3, 3>(0, 0).colwise().norm().maxCoeff();
+    return maxScale * viewportSize * 0.5f;
+}
 
 /*
  *      Operator overloads  ---------------------
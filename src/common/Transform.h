@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <eigen/Eigen/Dense>        // TODO try and fix include path
 
 /**
@@ -33,17 +34,33 @@ public:
     // Reset to identity Matrix
     void reset();
 
+    // Replace the whole matrix (e.g. a world matrix flattened from an imported node hierarchy)
+    void setMatrix(const Matrix4f &matrix);
+
     // Opertor overload
     friend std::ostream& operator<<(std::ostream& os, const Transform& transform);
     //friend void operator*(float scale);         // Scale entire matrix by single value
 
     const Matrix4f &getMatrix() const;
 
+    // Bumped on every change so dependents (e.g. world bounds) know when to recompute
+    uint64_t getVersion() const;
+
 private:
     // Hide implementation
     //Matrix4f translation;
     Matrix4f transformMatrix;
+    uint64_t version{0};
 };
 
+/**
+ * @brief Screen pixels one object-space unit covers under `matrix`.
+ *
+ * There is no projection matrix yet: clip space spans 2 units across `viewportSize` pixels
+ * and only the largest scale in the matrix counts. Clip x and y stretch over the width and
+ * the height, so the larger of the two bounds the pixels per unit along either axis.
+ */
+float pixelsPerUnit(const Matrix4f &matrix, float viewportSize);
+
 
 
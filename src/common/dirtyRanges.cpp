@@ -0,0 +1,40 @@
+#include "dirtyRanges.h"
+
+#include <algorithm>
+
+void DirtyRanges::add(size_t begin, size_t end)
+{
+    if (begin >= end)
+        return;
+
+    // Sequential writes (the common morphing pattern) grow the last range in place
+    if (!ranges.empty())
+    {
+        ByteRange &last = ranges.back();
+        if (begin <= last.end + mergeGap && end + mergeGap >= last.begin)
+        {
+            last.begin = std::min(last.begin, begin);
+            last.end = std::max(last.end, end);
+            return;
+        }
+    }
+    ranges.push_back({begin, end});
+}
+
+const std::vector<ByteRange> &DirtyRanges::coalesce()
+{
+    if (ranges.size() < 2)
+        return ranges;
+
+    std::sort(ranges.begin(), ranges.end(), [](const ByteRange &a, const ByteRange &b) { return a.begin < b.begin; });
+    size_t merged = 0;
+    for (size_t i = 1; i < ranges.size(); ++i)
+    {
+        if (ranges[i].begin <= ranges[merged].end + mergeGap)
+            ranges[merged].end = std::max(ranges[merged].end, ranges[i].end);
+        else
+            ranges[++merged] = ranges[i];
+    }
+    ranges.resize(merged + 1);
+    return ranges;
+}
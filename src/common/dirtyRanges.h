@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/*
+-------------------------------------------------------------------
+  DIRTY RANGES  ----------------------------------------------------
+
+  Byte ranges of a buffer written since the last flush. Writes are
+  appended as they come (extending the previous range when they touch
+  it); coalesce() sorts and merges once per flush, joining ranges
+  separated by at most `mergeGap` bytes, since one slightly larger
+  upload is cheaper than two calls.
+-------------------------------------------------------------------
+*/
+struct ByteRange
+{
+    size_t begin{0};
+    size_t end{0};
+
+    size_t size() const { return end - begin; }
+};
+
+class DirtyRanges
+{
+public:
+    static constexpr size_t kDefaultMergeGap = 256;
+
+    explicit DirtyRanges(size_t mergeGap = kDefaultMergeGap) : mergeGap(mergeGap) {}
+
+    // Marks [begin, end) as modified; empty ranges are ignored
+    void add(size_t begin, size_t end);
+
+    bool empty() const { return ranges.empty(); }
+
+    // Sorted, disjoint ranges covering every add() since the last clear()
+    const std::vector<ByteRange> &coalesce();
+
+    void clear() { ranges.clear(); }
+
+private:
+    std::vector<ByteRange> ranges;
+    size_t mergeGap;
+};
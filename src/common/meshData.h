@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common.h"
+
+/*
+  CPU-side indexed triangle mesh.
+
+  Portable (no Metal types) so geometry can be generated, imported and
+  optimized before a Primitive uploads it. Positions use w = 1.
+*/
+struct MeshData
+{
+    std::vector<Position> positions;
+    std::vector<Color> colors;          // Empty or one per position
+    std::vector<uint32_t> indices;      // Triangle list
+
+    size_t vertexCount() const { return positions.size(); }
+    size_t triangleCount() const { return indices.size() / 3; }
+};
@@ -0,0 +1,35 @@
+#include "pageMemory.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <unistd.h>
+
+size_t pageSize()
+{
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t roundUpToPage(size_t bytes)
+{
+    const size_t page = pageSize();
+    return (bytes + page - 1) / page * page;
+}
+
+std::shared_ptr<void> allocatePageAligned(size_t bytes)
+{
+    const size_t length = roundUpToPage(bytes == 0 ? 1 : bytes);
+    void *block = std::aligned_alloc(pageSize(), length);
+    if (!block)
+        throw std::bad_alloc();
+    std::memset(block, 0, length);
+    return std::shared_ptr<void>(block, [](void *pointer) { std::free(pointer); });
+}
+
+bool isPageAligned(const void *pointer)
+{
+    return reinterpret_cast<uintptr_t>(pointer) % pageSize() == 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+/*
+  Page-aligned heap blocks, the memory Metal can wrap without a copy
+  (newBufferWithBytesNoCopy needs a page-aligned base and a length in
+  whole pages). The returned block is zero-filled and its length is
+  rounded up to a page multiple.
+*/
+size_t pageSize();
+
+size_t roundUpToPage(size_t bytes);
+
+// Shared so GPU buffers that adopt the block can keep it alive
+std::shared_ptr<void> allocatePageAligned(size_t bytes);
+
+bool isPageAligned(const void *pointer);
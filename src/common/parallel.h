@@ -0,0 +1,36 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/*
+  Splits [0, count) into contiguous ranges and runs fn(begin, end) on each, one
+  std::thread per range (the calling thread takes the first). Ranges are at least
+  `minPerTask` long, so small inputs stay on the calling thread.
+  threads == 0 uses the hardware concurrency.
+*/
+template <typename Fn>
+void parallelFor(size_t count, size_t minPerTask, unsigned threads, Fn &&fn)
+{
+    if (count == 0)
+        return;
+
+    // hardware_concurrency() can take microseconds, so it's only asked when the caller didn't say
+    const size_t bySize = std::max<size_t>(1, count / std::max<size_t>(1, minPerTask));
+    const size_t tasks = std::min<size_t>(threads ? threads : std::max(1u, std::thread::hardware_concurrency()), bySize);
+    if (tasks <= 1)
+    {
+        fn(size_t{0}, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(tasks - 1);
+    for (size_t task = 1; task < tasks; ++task)
+        workers.emplace_back([&fn, task, tasks, count] { fn(count * task / tasks, count * (task + 1) / tasks); });
+    fn(size_t{0}, count / tasks);
+    for (std::thread &worker : workers)
+        worker.join();
+}
@@ -0,0 +1,121 @@
+#include "radixSort.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+// Flips every bit of negatives and only the sign of positives: unsigned order becomes float order
+uint32_t toOrdered(float key)
+{
+    uint32_t value;
+    std::memcpy(&value, &key, sizeof(value));
+    return value & 0x80000000u ? ~value : value | 0x80000000u;
+}
+
+float fromOrdered(uint32_t value)
+{
+    value = value & 0x80000000u ? value & 0x7fffffffu : ~value;
+    float key;
+    std::memcpy(&key, &value, sizeof(key));
+    return key;
+}
+} // namespace
+
+void FloatRadixSort::sort(std::span<float> keys, std::span<uint32_t> values)
+{
+    if (keys.size() != values.size())
+        throw std::invalid_argument("Radix sort: keys and values differ in size");
+    if (keys.size() >= std::numeric_limits<uint32_t>::max())
+        throw std::invalid_argument("Radix sort: too many keys");
+
+    const size_t count = keys.size();
+    // One chunk per worker, each at least kMinKeysPerTask keys
+    size_t tasks = 1;
+    if (count >= 2 * kMinKeysPerTask)
+        tasks = std::min<size_t>(count / kMinKeysPerTask,
+                                 threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+    stats = {};
+    stats.keys = count;
+    stats.tasks = static_cast<uint32_t>(tasks);
+    if (count < 2)
+        return;
+
+    for (std::vector<uint32_t> &buffer : bits)
+        buffer.resize(count);
+    for (std::vector<uint32_t> &buffer : payload)
+        buffer.resize(count);
+    offsets.resize(kDigits * tasks);
+
+    // Keys remapped into bits[0] and values copied into payload[0] on the way in
+    parallelFor(tasks, 1, static_cast<unsigned>(tasks), [&](size_t begin, size_t end) {
+        const size_t first = count * begin / tasks, last = count * end / tasks;
+        for (size_t i = first; i < last; ++i)
+            bits[0][i] = toOrdered(keys[i]);
+        std::memcpy(payload[0].data() + first, values.data() + first, (last - first) * sizeof(uint32_t));
+    });
+
+    int source = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 8)
+    {
+        // Digit counts per chunk, then the offsets each chunk writes its digits from
+        parallelFor(tasks, 1, static_cast<unsigned>(tasks), [&, shift](size_t begin, size_t end) {
+            for (size_t task = begin; task < end; ++task)
+            {
+                uint32_t *counts = offsets.data() + kDigits * task;
+                std::fill(counts, counts + kDigits, 0u);
+                const uint32_t *in = bits[source].data();
+                for (size_t i = count * task / tasks, last = count * (task + 1) / tasks; i < last; ++i)
+                    ++counts[(in[i] >> shift) & (kDigits - 1)];
+            }
+        });
+
+        uint32_t offset = 0;
+        bool oneBucket = false;
+        for (uint32_t digit = 0; digit < kDigits; ++digit)
+        {
+            const uint32_t digitStart = offset;
+            for (size_t task = 0; task < tasks; ++task)
+            {
+                uint32_t &slot = offsets[kDigits * task + digit];
+                const uint32_t digitCount = slot;
+                slot = offset;
+                offset += digitCount;
+            }
+            oneBucket |= offset - digitStart == count;
+        }
+        if (oneBucket)
+        {
+            ++stats.skippedPasses;
+            continue;
+        }
+
+        const int target = source ^ 1;
+        parallelFor(tasks, 1, static_cast<unsigned>(tasks), [&, shift](size_t begin, size_t end) {
+            for (size_t task = begin; task < end; ++task)
+            {
+                uint32_t *next = offsets.data() + kDigits * task;
+                const uint32_t *inBits = bits[source].data(), *inValues = payload[source].data();
+                uint32_t *outBits = bits[target].data(), *outValues = payload[target].data();
+                for (size_t i = count * task / tasks, last = count * (task + 1) / tasks; i < last; ++i)
+                {
+                    const uint32_t slot = next[(inBits[i] >> shift) & (kDigits - 1)]++;
+                    outBits[slot] = inBits[i];
+                    outValues[slot] = inValues[i];
+                }
+            }
+        });
+        source = target;
+        ++stats.passes;
+    }
+
+    parallelFor(tasks, 1, static_cast<unsigned>(tasks), [&](size_t begin, size_t end) {
+        const size_t first = count * begin / tasks, last = count * end / tasks;
+        for (size_t i = first; i < last; ++i)
+            keys[i] = fromOrdered(bits[source][i]);
+        std::memcpy(values.data() + first, payload[source].data() + first, (last - first) * sizeof(uint32_t));
+    });
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+-------------------------------------------------------------------
+  RADIX SORT  ------------------------------------------------------
+
+  Stable LSD radix sort of 32-bit float keys carrying a uint32 value
+  (a draw index, typically): four passes of 8 bits over the keys'
+  bits, remapped so unsigned order is float order (negatives below
+  positives, -0 just below +0, NaNs at the ends by sign).
+
+  Each pass splits the keys into contiguous chunks, one per worker:
+  every worker counts its chunk's digits, the counts are turned into
+  exclusive offsets per (digit, chunk) on the calling thread, and
+  every worker then scatters its chunk to its own offsets, so the
+  result is stable whatever the thread count. Passes where all keys
+  share the digit (common for the exponent byte of nearby depths) are
+  skipped.
+
+  Scratch buffers are kept between calls; sorting the same number of
+  keys every frame allocates nothing.
+-------------------------------------------------------------------
+*/
+struct RadixSortStats
+{
+    size_t keys{0};
+    uint32_t passes{0};             // Digit passes that moved keys
+    uint32_t skippedPasses{0};      // ... and that found every key in one bucket
+    uint32_t tasks{0};              // Chunks per pass
+};
+
+class FloatRadixSort
+{
+public:
+    static constexpr size_t kMinKeysPerTask = 65536;    // Below this, threads cost more than they save
+
+    // threads == 0 uses the hardware concurrency
+    explicit FloatRadixSort(unsigned threads = 0) : threads(threads) {}
+
+    /**
+     * @brief Sorts `keys` ascending, moving `values` along with them; equal keys keep their order.
+     *
+     * Throws std::invalid_argument when the spans differ in size or hold more than 2^32 - 1 keys.
+     * Sort descending by negating the keys.
+     */
+    void sort(std::span<float> keys, std::span<uint32_t> values);
+
+    const RadixSortStats &getStats() const { return stats; }
+
+private:
+    static constexpr uint32_t kDigits = 256;
+
+    unsigned threads;
+    std::vector<uint32_t> bits[2];      // Remapped keys, ping-ponged between passes
+    std::vector<uint32_t> payload[2];
+    std::vector<uint32_t> offsets;      // kDigits per task
+    RadixSortStats stats;
+};
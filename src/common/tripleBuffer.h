@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/*
+  Lock-free handoff of the latest value from one writer thread to one reader thread.
+
+  Three slots: the writer owns one (back), the reader owns one (front) and the third
+  (middle) changes hands through a single atomic byte that also carries a "fresh" bit.
+  publish() swaps the filled back slot into the middle; acquire() swaps a fresh middle
+  into the front. Neither side ever waits or retries: a value published again before
+  the reader acquired it is simply replaced, and the reader keeps its front slot until
+  something newer arrives.
+
+  Each slot is only touched by its current owner, so slots can be reused without
+  allocating (e.g. vectors keep their capacity); the exchange orders the writer's
+  writes before the reader's reads.
+*/
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T &initial) : slots{initial, initial, initial} {}
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // Writer: the slot to fill; it holds the value published two publishes ago
+    T &back() { return slots[backIndex]; }
+
+    // Writer: hands back() over; returns true if that replaced a value the reader never acquired
+    bool publish()
+    {
+        const uint8_t previous = middle.exchange(static_cast<uint8_t>(backIndex | kFresh), std::memory_order_acq_rel);
+        backIndex = previous & kIndexMask;
+        return (previous & kFresh) != 0;
+    }
+
+    // Reader: moves to the newest published value; returns false (front unchanged) if there is none
+    bool acquire()
+    {
+        // Only the reader clears the bit, so a fresh middle stays fresh until the exchange below
+        if (!(middle.load(std::memory_order_relaxed) & kFresh))
+            return false;
+        const uint8_t previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & kIndexMask;
+        return true;
+    }
+
+    // Reader: the last acquired value (the initial one before the first acquire)
+    const T &front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr uint8_t kIndexMask = 3;
+    static constexpr uint8_t kFresh = 4;
+
+    T slots[3]{};
+    uint8_t backIndex{0};                       // Writer only
+    alignas(64) std::atomic<uint8_t> middle{1};
+    alignas(64) uint8_t frontIndex{2};          // Reader only
+};
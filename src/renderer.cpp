@@ -1,9 +1,30 @@
 #include "common/common.h"
 #include "renderer.h"
+#include "Loader/objLoader.h"
+#include "MeshGenerator/meshGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <random>
 
 //#define TRIANGLE
 #define QUAD
-//#define CIRCLE
+//#define CIRCLE      // Outline re-flattened every frame for its size on screen
+//#define MODEL "assets/model.obj"
+//#define STREAM_DIR "assets/stream"     // Every .obj in here, laid out on a grid and streamed in
+//#define GLB_MODEL "assets/model.glb"
+//#define SPHERE
+//#define POLYGON     // A five-pointed star with a pentagon hole, through the triangulator
+//#define STROKE      // A star outline (miter joins) and a sine wave (round joins and caps), through the stroker
+//#define CURVES      // A rounded badge with an elliptical hole and an S curve, flattened to a quarter pixel
+//#define SPRITES 100000  // Bouncing sprites from a packed atlas, drawn by the SpriteBatcher
+//#define PARTICLES 100000  // A fountain of up to this many particles, one instanced draw
+//#define SIMULATE    // The hand-built primitives drift and spin, stepped at 120 Hz on a thread of their own
+//#define TERRAIN 4097  // A noise heightmap this many samples across, as LOD chunks built in the background
+//#define DEPTH       // Depth attachment; the opaque pass draws front to back so hidden fragments are rejected unshaded
+//#define TRANSLUCENT // quad2 at half alpha and the fountain additive, drawn back to front after the opaque pass
+//#define MORPH       // Wobbles quad1's corners every frame through the dynamic vertex API (needs QUAD)
 //#define LOG
 
 /**
@@ -13,8 +34,16 @@
  *
  * @param window Reference to the Window object.
  */
-Renderer::Renderer(Window &window) : device(nullptr), commandQueue(nullptr), window(window),
-                                     triangle1(nullptr),triangle2(nullptr),quad1(nullptr),quad2(nullptr), previousTime(std::chrono::high_resolution_clock::now()), totalTime(0.0),
+Renderer::Renderer(Window &window) : device(nullptr), window(window),
+                                     triangle1(nullptr),triangle2(nullptr),quad1(nullptr),quad2(nullptr),sphere(nullptr),polygon(nullptr),outline(nullptr),wave(nullptr),fountain(nullptr),
+                                     circle(nullptr),curveFill(nullptr),curveStroke(nullptr),
+                                     streamer([](const char *data, size_t size) {
+                                       // The decode pool already runs one asset per thread
+                                       ObjLoadOptions options;
+                                       options.threads = 1;
+                                       return parseObj(data, size, options);
+                                     }),
+                                     previousTime(std::chrono::high_resolution_clock::now()), simulatedTime(previousTime), totalTime(0.0),
                                      lastPrintedSecond(-1), frames(0)
 {
   // Get device from the windows metal layer
@@ -22,6 +51,12 @@ Renderer::Renderer(Window &window) : device(nullptr), commandQueue(nullptr), win
   if (!device)
     throw std::runtime_error("Failed to get Metal Device");
 
+#ifdef DEPTH
+  // Before any pipeline is built: they are all compiled against these formats
+  setRenderTargetFormat({MTL::PixelFormat::PixelFormatBGRA8Unorm, MTL::PixelFormat::PixelFormatDepth32Float});
+  depthStates = std::make_unique<DepthStates>(device);
+#endif /* DEPTH */
+
   /*
    *    Quad
    */
@@ -42,16 +77,27 @@ Renderer::Renderer(Window &window) : device(nullptr), commandQueue(nullptr), win
   };
 
   quad1 = new Quad(device, positions, color );
+#ifdef MORPH
+  quad1->makeDynamic();     // Before the DrawList compiles it
+#endif /* MORPH */
 
   // Quad 2
+#ifdef TRANSLUCENT
+  const float quad2Alpha = 0.5f;    // Blended over quad1
+#else
+  const float quad2Alpha = 1.0f;
+#endif /* TRANSLUCENT */
   color = {
-      {1.0, 0.0, 0.0, 1.0}, // Red color
-      {1.0, 0.0, 0.0, 1.0}, // Red color
-      {1.0, 0.0, 0.0, 1.0}, // Red color
-      {1.0, 0.0, 0.0, 1.0}
+      {1.0, 0.0, 0.0, quad2Alpha}, // Red color
+      {1.0, 0.0, 0.0, quad2Alpha}, // Red color
+      {1.0, 0.0, 0.0, quad2Alpha}, // Red color
+      {1.0, 0.0, 0.0, quad2Alpha}
   };
 
   quad2 = new Quad(device, positions, color );
+#ifdef TRANSLUCENT
+  quad2->setBlendMode(BlendMode::Alpha);
+#endif /* TRANSLUCENT */
   Transform &matrix = quad2->getTransform();
   matrix.setRotation(-pi, 0, 0, 1);
   matrix.setScale(.5, .5, 0);
@@ -97,11 +143,212 @@ Renderer::Renderer(Window &window) : device(nullptr), commandQueue(nullptr), win
   matrix.setTranslation(0, -0.3, 0);
   std::cout << "After: \n" << matrix << std::endl;
 #endif /* TRIANGLE */
+  /*
+   *      Model
+   */
+#ifdef MODEL
+  {
+    // Streamed in the background; parsed and optimized once, later launches map MODEL.meshcache instead.
+    // Close up and closed, so it draws only its clusters inside the view and facing it.
+    MeshOptions options;
+    options.clusterCulling = true;
+    addStreamed(MODEL, 0.0f, 0.0f, 0.0f, 1.0f, options);
+  }
+#endif /* MODEL */
+#ifdef STREAM_DIR
+  {
+    std::vector<std::string> paths;
+    for (const auto &entry : std::filesystem::directory_iterator(STREAM_DIR))
+      if (entry.path().extension() == ".obj")
+        paths.push_back(entry.path().string());
+    std::sort(paths.begin(), paths.end());
+
+    const size_t columns = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(paths.size()))));
+    const float cell = 2.0f / static_cast<float>(columns);
+    for (size_t i = 0; i < paths.size(); ++i)
+      addStreamed(paths[i], -1.0f + cell * (static_cast<float>(i % columns) + 0.5f),
+                  1.0f - cell * (static_cast<float>(i / columns) + 0.5f), 0.5f, 0.45f * cell);
+  }
+#endif /* STREAM_DIR */
+#ifdef GLB_MODEL
+  const std::shared_ptr<const GltfAsset> asset = loadGlb(GLB_MODEL);
+  imported = createGltfPrimitives(device, asset);
+  std::cout << "Loaded " GLB_MODEL ": " << imported.size() << " primitives in " << asset->stats.seconds << " s, "
+            << asset->stats.zeroCopyBytes << " bytes in place, " << asset->stats.convertedBytes << " converted, peak RSS "
+            << asset->stats.peakResidentBytes / (1 << 20) << " MB" << std::endl;
+#endif /* GLB_MODEL */
+  /*
+   *      Sphere
+   */
+#ifdef SPHERE
+  {
+    // Closed and counter-clockwise: the back half's clusters are culled before they reach the GPU
+    MeshOptions options;
+    options.clusterCulling = true;
+    sphere = new Mesh(device, getSphere(SphereType::Icosphere, 16)->toMeshData(), options);
+  }
+  sphere->getTransform().setScale(0.5, 0.5, 0.5);
+#endif /* SPHERE */
+#ifdef POLYGON
+  {
+    // Outline: 10 alternating outer/inner points; hole: a small pentagon wound the other way
+    std::vector<float> xy;
+    for (int i = 0; i < 10; ++i) {
+      const float angle = static_cast<float>(M_PI / 2 + i * M_PI / 5);
+      const float r = i % 2 ? 0.25f : 0.6f;
+      xy.push_back(r * std::cos(angle));
+      xy.push_back(r * std::sin(angle));
+    }
+    const uint32_t holeStarts[] = {10};
+    for (int i = 0; i < 5; ++i) {
+      const float angle = static_cast<float>(M_PI / 2 - i * 2 * M_PI / 5);
+      xy.push_back(0.1f * std::cos(angle));
+      xy.push_back(0.1f * std::sin(angle));
+    }
+    polygon = new Polygon(device, xy, holeStarts, float4(0.9f, 0.7f, 0.1f, 1.0f));
+  }
+#endif /* POLYGON */
+#ifdef STROKE
+  {
+    std::vector<float> star;
+    for (int i = 0; i < 10; ++i) {
+      const float angle = static_cast<float>(M_PI / 2 + i * M_PI / 5);
+      const float r = i % 2 ? 0.3f : 0.7f;
+      star.push_back(r * std::cos(angle));
+      star.push_back(r * std::sin(angle));
+    }
+    StrokeStyle style;
+    style.width = 0.03f;
+    style.closed = true;
+    outline = new Stroke(device, star, style, float4(0.1f, 0.4f, 0.9f, 1.0f));
+
+    std::vector<float> sine;
+    for (int i = 0; i <= 200; ++i) {
+      const float x = -0.9f + 1.8f * static_cast<float>(i) / 200.0f;
+      sine.push_back(x);
+      sine.push_back(-0.75f + 0.1f * std::sin(x * 12.0f));
+    }
+    style.width = 0.02f;
+    style.closed = false;
+    style.join = LineJoin::Round;
+    style.cap = LineCap::Round;
+    wave = new Stroke(device, sine, style, float4(0.9f, 0.3f, 0.2f, 1.0f));
+  }
+#endif /* STROKE */
+#ifdef CIRCLE
+  circle = new Circle(device);
+#endif /* CIRCLE */
+#ifdef CURVES
+  {
+    // Flattened once for the initial framebuffer at identity scale
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window.getGLFWWindow(), &width, &height);
+    PathBuilder path(flatteningTolerance(Eigen::Matrix4f::Identity(), static_cast<float>(std::max({width, height, 1}))));
+
+    // Rounded rectangle outline, then the hole
+    const float r = 0.15f;
+    EllipticalArc corner;
+    corner.radius[0] = corner.radius[1] = r;
+    corner.sweep = static_cast<float>(M_PI / 2);
+    const float centers[4][2] = {{0.45f, -0.05f}, {0.45f, 0.45f}, {-0.45f, 0.45f}, {-0.45f, -0.05f}};
+    for (int i = 0; i < 4; ++i) {
+      corner.center[0] = centers[i][0];
+      corner.center[1] = centers[i][1];
+      corner.start = static_cast<float>(-M_PI / 2 + i * M_PI / 2);
+      path.arcTo(corner);
+    }
+    path.close();
+    path.addEllipse(0.0f, 0.2f, 0.3f, 0.12f);
+    curveFill = new Polygon(device, path.getPoints(), path.getHoleStarts(), float4(0.2f, 0.6f, 0.4f, 1.0f));
+
+    PathBuilder line(path.getTolerance());
+    line.moveTo(-0.7f, -0.6f).cubicTo(-0.3f, -0.1f, 0.3f, -1.0f, 0.7f, -0.45f);
+    StrokeStyle style;
+    style.width = 0.025f;
+    style.join = LineJoin::Round;
+    style.cap = LineCap::Round;
+    curveStroke = new Stroke(device, line.getContour(0), style, float4(0.9f, 0.5f, 0.1f, 1.0f));
+
+    const FlattenStats &fill = path.getStats();
+    std::cout << "Curves: badge " << fill.points << " points from " << fill.curves << " arcs, S curve "
+              << line.getStats().points << " points (" << line.getStats().subdivisions << " subdivisions)" << std::endl;
+  }
+#endif /* CURVES */
+#ifdef SPRITES
+  createSprites(SPRITES);
+#endif /* SPRITES */
+#ifdef TERRAIN
+  {
+    // A quarter of the map across the view, centered, heights up to half the clip depth
+    auto heights = std::make_shared<HeightmapTiles>(TERRAIN, TERRAIN,
+                                                    noiseHeightmapSampler(TERRAIN, TERRAIN, 7, TERRAIN / 8.0f));
+    TerrainOptions options;
+    options.heightScale = TERRAIN / 16.0f;
+    terrain = std::make_unique<Terrain>(heights, options);
+    terrainStitch = newTerrainStitchBuffer(device, terrain->getStitch());
+
+    const float scale = 8.0f / (TERRAIN - 1);
+    terrainMatrix.diagonal() << scale, scale, scale, 1.0f;
+    terrainMatrix.col(3).head<2>().setConstant(-4.0f);
+    std::cout << "Terrain: " << terrain->getLevelCount() << " levels" << std::endl;
+  }
+#endif /* TERRAIN */
+#ifdef PARTICLES
+  {
+    // About as many spawn per second as live for the average lifetime (1.5 s) fit the capacity
+    ParticleEmitter emitter;
+    emitter.position[1] = -0.8f;
+    emitter.jitter = 0.02f;
+    emitter.spread = 0.35f;
+    emitter.speedMin = 0.9f;
+    emitter.speedMax = 1.4f;
+    emitter.color = packColor(1.0f, 0.55f, 0.15f, 1.0f);
+    ParticleForces forces;
+    forces.gravity[1] = -1.2f;
+    forces.drag = 0.4f;
+    fountain = new Particles(device, PARTICLES, emitter, PARTICLES / 1.5f, forces);
+#ifdef TRANSLUCENT
+    fountain->setBlendMode(BlendMode::Additive);    // Fades out with its alpha
+#endif /* TRANSLUCENT */
+  }
+#endif /* PARTICLES */
+  for (Primitive *primitive : {quad1, quad2, triangle1, triangle2, static_cast<Primitive *>(sphere), polygon, outline,
+                               wave, static_cast<Primitive *>(fountain), static_cast<Primitive *>(circle), curveFill, curveStroke})
+    if (primitive)
+      scene.push_back(primitive);
+  scene.insert(scene.end(), imported.begin(), imported.end());
+#ifdef SIMULATE
+  {
+    // Each moves around where it was placed, bouncing within half a clip unit of it
+    simulation = std::make_unique<SceneSimulation>(1.0 / 120.0);
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> speed(-0.3f, 0.3f);
+    for (Primitive *primitive : {quad1, quad2, triangle1, triangle2, static_cast<Primitive *>(sphere), polygon,
+                                 outline, wave, static_cast<Primitive *>(circle), curveFill, curveStroke})
+    {
+      if (!primitive)
+        continue;
+      SimMotion motion;
+      motion.velocity[0] = speed(random);
+      motion.velocity[1] = speed(random);
+      motion.spin = 3.0f * speed(random);
+      motion.bounds = 0.5f;
+      simulation->addBody(SimPose{}, motion);
+      simulated.push_back(primitive);
+      simulatedBase.push_back(primitive->getTransform().getMatrix());
+    }
+    simulation->start();
+  }
+#endif /* SIMULATE */
+
+  glfwSetWindowUserPointer(window.getGLFWWindow(), this);
+  glfwSetMouseButtonCallback(window.getGLFWWindow(), mouseButtonCallback);
+
   /*
    *Command Queue
    */
   // Create the command queue (created from the device)
-  commandQueue = device->newCommandQueue()->retain();
+  commandQueue = Handle<MTL::CommandQueue>(device->newCommandQueue());
 
   // Render
   render();
@@ -109,20 +356,41 @@ Renderer::Renderer(Window &window) : device(nullptr), commandQueue(nullptr), win
 /**
  * @brief Destructor for the Renderer class.
  *
- * Cleans up allocated resources. Currently commented out due to segfault issues.
+ * Deletes every primitive it created (the scene holds all of them that are still alive),
+ * then waits for the last frame and releases everything that was deferred. Anything still
+ * live after that was never handed back and is reported as a leak.
  */
 Renderer::~Renderer()
 {
-    // FIXME: There is a segfault here when deallocating?
-  if (triangle1)
-  {
-    delete triangle1;
-    triangle1 = nullptr;
-  }
+  drawList.clear();
+  spriteBatcher.reset();
+  for (Primitive *primitive : scene)
+    delete primitive;
+  simulation.reset();       // Joins the simulation thread
+  simulated.clear();
+  scene.clear();
+  terrainPatches.clear();
+  terrain.reset();          // Joins the chunk build threads
+  terrainStitch.reset();
+  imported.clear();
+  streamed.clear();
+  triangle1 = triangle2 = quad1 = quad2 = polygon = outline = wave = nullptr;
+  sphere = nullptr;
+  fountain = nullptr;
+  circle = nullptr;
+  curveFill = curveStroke = nullptr;
 
-  if (commandQueue)
-    commandQueue->release();
+  depthTexture.reset();
+  depthStates.reset();
+  commandQueue.reset();
 
+  DeferredReleaseQueue &releaseQueue = DeferredReleaseQueue::shared();
+  releaseQueue.drain();
+  const ResourceCounters counters = releaseQueue.getCounters();
+  std::cout << "GPU objects: " << counters.created << " created, " << counters.released << " released, "
+            << counters.deferred << " deferred" << std::endl;
+  if (counters.live() > 0)
+    std::cerr << "Leaked GPU objects: " << counters.live() << std::endl;
 }
 /**
  * @brief Main render loop.
@@ -151,6 +419,7 @@ void Renderer::render()
 
       // Create command buffer per frame
       MTL::CommandBuffer *commandBuffer = commandQueue->commandBuffer();
+      DeferredReleaseQueue &releaseQueue = DeferredReleaseQueue::shared();
 
       // Create render pass descriptor
       MTL::RenderPassDescriptor *renderPass = MTL::RenderPassDescriptor::alloc()->init();
@@ -160,6 +429,18 @@ void Renderer::render()
       colorAttachment->setClearColor(MTL::ClearColor(4.0, 2.0, 5.0, 1.0));
       colorAttachment->setStoreAction(MTL::StoreActionStore);
 
+      if (depthStates)
+      {
+        // Only needed while the pass runs, so it is never stored
+        MTL::Texture *target = drawable->texture();
+        updateDepthTexture(target->width(), target->height());
+        MTL::RenderPassDepthAttachmentDescriptor *depthAttachment = renderPass->depthAttachment();
+        depthAttachment->setTexture(depthTexture.get());
+        depthAttachment->setLoadAction(MTL::LoadActionClear);
+        depthAttachment->setClearDepth(1.0);
+        depthAttachment->setStoreAction(MTL::StoreActionDontCare);
+      }
+
 
       /*
        *      Encoding
@@ -172,37 +453,520 @@ void Renderer::render()
       //encoder->setVertexBytes(&currTime, sizeof(float), 11);
       }
 
-      if (quad1) {
-        quad1->encodeRenderCommands(encoder); // Needs a RenderCommandEncoder, NOT CommandEncoder
-        quad1->draw(encoder);
-      }
-      if (quad2) {
-        quad2->encodeRenderCommands(encoder); // Needs a RenderCommandEncoder, NOT CommandEncoder
-        quad2->draw(encoder);
-      }
+#if defined(MORPH) && defined(QUAD)
+      morphQuad();
+#endif /* MORPH */
+      // Publish this frame's dynamic vertex/color writes, one didModifyRange per coalesced range
+      for (Primitive *primitive : scene)
+        uploadedBytes += primitive->flushUpdates();
 
-      if (triangle1) {
-        triangle1->encodeRenderCommands(encoder); // Needs a RenderCommandEncoder, NOT CommandEncoder
-        triangle1->draw(encoder);
-      }
-      if (triangle2) {
-        triangle2->encodeRenderCommands(encoder); // Needs a RenderCommandEncoder, NOT CommandEncoder
-        triangle2->draw(encoder);
+#ifdef SIMULATE
+      applySimulation();
+#endif /* SIMULATE */
+#ifdef PARTICLES
+      {
+        // Wall-clock step, clamped so a stall (window drag, breakpoint) doesn't launch everything at once
+        const auto now = std::chrono::high_resolution_clock::now();
+        const float dt = std::min(std::chrono::duration<float>(now - simulatedTime).count(), 0.1f);
+        simulatedTime = now;
+        fountain->simulate(dt);
+#ifdef LOG
+        const ParticleUpdateStats &particleStats = fountain->getUpdateStats();
+        std::cout << "Particles: " << particleStats.updated << " updated, " << particleStats.killed << " killed" << std::endl;
+#endif /*LOG*/
       }
+#endif /* PARTICLES */
+      // Clip space stretches over the larger side most, so that side sets the pixels per unit
+      const float viewportSize =
+          static_cast<float>(std::max(drawable->texture()->width(), drawable->texture()->height()));
+#ifdef CIRCLE
+      circle->fitToScreen(viewportSize);
+#endif /* CIRCLE */
+      selectLods(viewportSize);
+#ifdef TERRAIN
+      updateTerrain();
+#endif /* TERRAIN */
+      cullScene();
+      if (drawList.size() != scene.size())
+        drawList.build(scene);
+      drawList.prepare(visible);
+      orderPasses();
+      if (depthStates)
+        encoder->setDepthStencilState(depthStates->get(DepthMode::Opaque));
+      drawStats = drawList.encode(encoder, opaqueDraws); // Needs a RenderCommandEncoder, NOT CommandEncoder
+      if (depthStates)
+        encoder->setDepthStencilState(depthStates->get(DepthMode::ReadOnly));
+      transparentStats = drawList.encode(encoder, transparentDraws);
+#ifdef LOG
+      std::cout << "Draws: " << drawStats.draws << " opaque, " << transparentStats.draws << " transparent, pipeline changes "
+                << drawStats.pipelineChanges + transparentStats.pipelineChanges << ", dynamic " << drawStats.dynamicUpdates
+                << std::endl;
+#endif /*LOG*/
+#ifdef SPRITES
+      animateSprites();
+      if (depthStates)
+        encoder->setDepthStencilState(depthStates->get(DepthMode::Off));    // Overlay on top of the scene
+      spriteStats = spriteBatcher->encode(encoder);
+#ifdef LOG
+      std::cout << "Sprites: " << spriteStats.batching.sprites << " in " << spriteStats.batching.batches << " batches, "
+                << spriteStats.draws << " draws" << std::endl;
+#endif /*LOG*/
+#endif /* SPRITES */
 
       encoder->endEncoding();
 
       // Present
       commandBuffer->presentDrawable(drawable);
+      const uint64_t frame = releaseQueue.submitFrame();
+      commandBuffer->addCompletedHandler([frame](MTL::CommandBuffer *) {
+        DeferredReleaseQueue::shared().frameCompleted(frame);
+      });
       commandBuffer->commit();
 
       renderPass->release();
 
+      // Scene changes from streaming land between frames, after this frame's visibility was used
+      updateStreaming();
+
+      // Release GPU objects whose last frame has completed
+      releaseQueue.collect();
+
       pool->release();
     }
   }
 }
 
+/**
+ * @brief Fills `visible` with the scene objects whose world bounds touch the view.
+ *
+ * Transforms map straight into clip space for now, so the view frustum is the
+ * clip volume itself (identity matrix).
+ */
+void Renderer::cullScene()
+{
+  sceneSpheres.clear();
+  if (scene.size() < kBvhCullThreshold)
+  {
+    for (const Primitive *primitive : scene) {
+      const BoundingSphere &sphere = primitive->getWorldBounds().sphere;
+      sceneSpheres.push(sphere.center, sphere.radius);
+    }
+  }
+
+  static const Frustum view = extractFrustum(Eigen::Matrix4f::Identity());
+  visible.clear();
+  if (scene.size() >= kBvhCullThreshold)
+  {
+    updateSceneBvh();
+    sceneBvh.queryFrustum(view, visible);
+  }
+  else
+  {
+    cullSpheres(view, sceneSpheres, visible);
+  }
+
+#ifdef LOG
+  std::cout << "Visible: " << visible.size() << "/" << scene.size() << std::endl;
+#endif /*LOG*/
+}
+
+/**
+ * @brief Splits this frame's visible draws into the opaque and the transparent (blended) pass.
+ *
+ * Transparent draws go back to front by the clip z of their world box's center, so each blends
+ * over what lies behind it. With a depth attachment the opaque ones go front to back by their
+ * box's nearest z, so the depth test rejects what's hidden before it's shaded; without one they
+ * keep scene order, later entries painting over earlier ones. (Boxes rather than spheres: a flat
+ * primitive's sphere reaches in front of it by its width, so coplanar ones wouldn't tie.)
+ *
+ * Both sorts are stable, so ties keep the order the lists are filled in: transparent ones in
+ * scene order, opaque ones reversed. With a less test the first draw wins a tie, so coplanar
+ * opaque primitives (the quads at z = 0) still show the later one, as they did unsorted.
+ */
+void Renderer::orderPasses()
+{
+  visibleMask.assign(scene.size(), 0);
+  for (uint32_t index : visible)
+    visibleMask[index] = 1;
+
+  opaqueDraws.clear();
+  opaqueDepths.clear();
+  transparentDraws.clear();
+  transparentDepths.clear();
+  for (uint32_t index = 0; index < scene.size(); ++index) {
+    if (!visibleMask[index])
+      continue;
+    const Aabb &box = scene[index]->getWorldBounds().box;
+    if (drawList[index].flags & kDrawBlended) {
+      transparentDraws.push_back(index);
+      transparentDepths.push_back(-0.5f * (box.min[2] + box.max[2]));   // Farthest first
+    } else {
+      opaqueDraws.push_back(index);
+      opaqueDepths.push_back(box.min[2]);
+    }
+  }
+
+  if (depthStates) {
+    std::reverse(opaqueDraws.begin(), opaqueDraws.end());
+    std::reverse(opaqueDepths.begin(), opaqueDepths.end());
+    passSort.sort(opaqueDepths, opaqueDraws);
+  }
+  passSort.sort(transparentDepths, transparentDraws);
+}
+
+/**
+ * @brief (Re)creates the depth texture when the drawable size changes.
+ *
+ * GPU-only memory; the old texture is released once the frames still using it complete.
+ */
+void Renderer::updateDepthTexture(NS::UInteger width, NS::UInteger height)
+{
+  if (depthTexture && depthTexture->width() == width && depthTexture->height() == height)
+    return;
+
+  MTL::TextureDescriptor *descriptor = MTL::TextureDescriptor::texture2DDescriptor(
+      getRenderTargetFormat().depth, width, height, false);
+  descriptor->setStorageMode(MTL::StorageModePrivate);
+  descriptor->setUsage(MTL::TextureUsageRenderTarget);
+  depthTexture = Handle<MTL::Texture>(device->newTexture(descriptor));
+  if (!depthTexture)
+    throw std::runtime_error("Failed to create depth texture");
+}
+
+/**
+ * @brief Keeps sceneBvh in step with the scene.
+ *
+ * A changed primitive count rebuilds the tree; otherwise only primitives whose
+ * bounds version (Transform or dynamic vertex updates) moved since the last frame are refit.
+ */
+void Renderer::updateSceneBvh()
+{
+  if (sceneBoxes.size() != scene.size())
+  {
+    sceneBoxes.resize(scene.size());
+    sceneVersions.resize(scene.size());
+    for (size_t i = 0; i < scene.size(); ++i) {
+      sceneBoxes[i] = scene[i]->getWorldBounds().box;
+      sceneVersions[i] = scene[i]->getBoundsVersion();
+    }
+    sceneBvh.build(sceneBoxes);
+    return;
+  }
+
+  for (size_t i = 0; i < scene.size(); ++i) {
+    const uint64_t version = scene[i]->getBoundsVersion();
+    if (version == sceneVersions[i])
+      continue;
+    sceneVersions[i] = version;
+    sceneBoxes[i] = scene[i]->getWorldBounds().box;
+    sceneBvh.refitPrimitive(static_cast<uint32_t>(i), sceneBoxes[i]);
+  }
+}
+
+/**
+ * @brief Casts a ray through the cursor and returns the closest scene index hit.
+ *
+ * Transforms map straight into clip space, so the ray runs along +z from in front of
+ * the near plane. Each candidate is tested in object space against its real geometry;
+ * primitives flattened by a zero scale fall back to their world box.
+ */
+int Renderer::pick(double cursorX, double cursorY)
+{
+  int width = 0, height = 0;
+  glfwGetWindowSize(window.getGLFWWindow(), &width, &height);
+  if (width <= 0 || height <= 0 || scene.empty())
+    return -1;
+
+  Ray ray{};
+  ray.origin[0] = static_cast<float>(2.0 * cursorX / width - 1.0);
+  ray.origin[1] = static_cast<float>(1.0 - 2.0 * cursorY / height);
+  ray.origin[2] = -1.0f;
+  ray.direction[2] = 1.0f;
+
+  updateSceneBvh();
+  const RayHit hit = sceneBvh.raycast(ray, [this](uint32_t index, const Ray &worldRay) {
+    Eigen::Matrix4f inverse;
+    bool invertible = false;
+    scene[index]->getTransform().getMatrix().computeInverseWithCheck(inverse, invertible);
+    if (!invertible)
+      return intersectAabb(worldRay, sceneBoxes[index]);
+
+    // Affine map keeps t, so the direction is left unnormalized
+    const Eigen::Vector4f origin = inverse * Eigen::Vector4f(worldRay.origin[0], worldRay.origin[1], worldRay.origin[2], 1.0f);
+    const Eigen::Vector4f direction = inverse * Eigen::Vector4f(worldRay.direction[0], worldRay.direction[1], worldRay.direction[2], 0.0f);
+    Ray objectRay{{origin[0], origin[1], origin[2]}, {direction[0], direction[1], direction[2]}, worldRay.tMax};
+    return scene[index]->intersectRay(objectRay);
+  });
+  return hit.valid() ? static_cast<int>(hit.primitive) : -1;
+}
+
+void Renderer::mouseButtonCallback(GLFWwindow *glfwWindow, int button, int action, int /*mods*/)
+{
+  if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS)
+    return;
+
+  auto *renderer = static_cast<Renderer *>(glfwGetWindowUserPointer(glfwWindow));
+  double x = 0.0, y = 0.0;
+  glfwGetCursorPos(glfwWindow, &x, &y);
+  std::cout << "Picked: " << renderer->pick(x, y) << std::endl;
+}
+
+/**
+ * @brief Morphing workload for the dynamic vertex path: rewrites quad1's corners each frame.
+ */
+void Renderer::morphQuad()
+{
+  if (!quad1)
+    return;
+
+  const float phase = 0.05f * static_cast<float>(morphFrame++);
+  const float wobble = 0.1f * std::sin(phase);
+  const float corners[4][4] = {
+    {-0.75f - wobble, 0.75f + wobble, 0.0f, 1.0f},
+    {0.0f + wobble, 0.75f, 0.0f, 1.0f},
+    {0.0f, 0.0f - wobble, 0.0f, 1.0f},
+    {-0.75f, 0.0f, 0.0f, 1.0f},
+  };
+  quad1->updateVertices(0, corners[0], 3);    // The last corner stays put
+}
+
+/**
+ * @brief Sprite workload for the batcher: `count` sprites over 16 packed disc images.
+ */
+void Renderer::createSprites(size_t count)
+{
+  spriteBatcher = std::make_unique<SpriteBatcher>(device);
+  TextureAtlas &atlas = spriteBatcher->getAtlas();
+
+  // Soft discs of a few sizes and hues, white in the middle
+  std::vector<uint32_t> regions;
+  std::vector<uint8_t> pixels;
+  for (uint32_t image = 0; image < 16; ++image) {
+    const uint32_t size = 16 + 8 * (image % 8);
+    pixels.assign(static_cast<size_t>(size) * size * 4, 0);
+    const float hue = static_cast<float>(image) / 16.0f;
+    for (uint32_t y = 0; y < size; ++y) {
+      for (uint32_t x = 0; x < size; ++x) {
+        const float dx = (static_cast<float>(x) + 0.5f) / static_cast<float>(size) * 2.0f - 1.0f;
+        const float dy = (static_cast<float>(y) + 0.5f) / static_cast<float>(size) * 2.0f - 1.0f;
+        const float d = std::sqrt(dx * dx + dy * dy);
+        const float alpha = std::clamp((1.0f - d) * 4.0f, 0.0f, 1.0f);
+        uint8_t *texel = &pixels[(static_cast<size_t>(y) * size + x) * 4];
+        for (int c = 0; c < 3; ++c) {
+          const float channel = 0.5f + 0.5f * std::cos(static_cast<float>(2.0 * M_PI) * (hue + static_cast<float>(c) / 3.0f));
+          texel[c] = static_cast<uint8_t>(255.0f * std::min(1.0f, channel + (1.0f - d) * 0.5f));
+        }
+        texel[3] = static_cast<uint8_t>(255.0f * alpha);
+      }
+    }
+    regions.push_back(atlas.add(size, size, pixels));
+  }
+  std::cout << "Sprite atlas: " << atlas.getPageCount() << " page(s), " << 100.0f * atlas.getOccupancy(0)
+            << "% of page 0 used" << std::endl;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  spriteField.resize(count);
+  spriteVelocities.resize(count * 2);
+  for (size_t i = 0; i < count; ++i) {
+    Sprite &sprite = spriteField[i];
+    sprite.x = unit(rng);
+    sprite.y = unit(rng);
+    sprite.width = sprite.height = 0.02f + 0.015f * unit(rng);
+    sprite.rotation = static_cast<float>(M_PI) * unit(rng);
+    sprite.region = regions[i % regions.size()];
+    sprite.blend = i % 4 ? SpriteBlend::Alpha : SpriteBlend::Additive;
+    spriteVelocities[2 * i] = 0.004f * unit(rng);
+    spriteVelocities[2 * i + 1] = 0.004f * unit(rng);
+  }
+  // Grouped by blend mode so the whole field is two batches (plus 16K-sprite draw splits)
+  std::stable_partition(spriteField.begin(), spriteField.end(),
+                        [](const Sprite &sprite) { return sprite.blend == SpriteBlend::Alpha; });
+}
+
+/**
+ * @brief Moves every sprite, bouncing off the edges of the view, and queues them for this frame.
+ */
+void Renderer::animateSprites()
+{
+  for (size_t i = 0; i < spriteField.size(); ++i) {
+    Sprite &sprite = spriteField[i];
+    float &vx = spriteVelocities[2 * i];
+    float &vy = spriteVelocities[2 * i + 1];
+    sprite.x += vx;
+    sprite.y += vy;
+    if (std::fabs(sprite.x) > 1.0f)
+      vx = -vx;
+    if (std::fabs(sprite.y) > 1.0f)
+      vy = -vy;
+    sprite.rotation += 0.01f;
+  }
+  spriteBatcher->clear();
+  spriteBatcher->draw(spriteField);
+}
+
+/**
+ * @brief Registers a mesh file with the streamer and reserves its scene slot.
+ */
+void Renderer::addStreamed(const std::string &path, float x, float y, float z, float scale, const MeshOptions &options)
+{
+  StreamedSlot slot{};
+  slot.asset = streamer.add(path);
+  slot.anchor[0] = x;
+  slot.anchor[1] = y;
+  slot.anchor[2] = z;
+  slot.scale = scale;
+  slot.options = options;
+  streamed.push_back(slot);
+}
+
+/**
+ * @brief Once per frame: requests wanted assets, evicts over budget, uploads a few staged meshes.
+ *
+ * Unloaded slots are always requested; resident ones only while they were visible this
+ * frame, so off-screen meshes age out of the LRU first. Priority is the projected size
+ * seen from the clip-space eye at z = -1. Nothing here waits on the streamer's threads.
+ */
+void Renderer::updateStreaming()
+{
+  if (streamed.empty())
+    return;
+
+  std::vector<uint8_t> shown(scene.size(), 0);
+  for (uint32_t index : visible)
+    shown[index] = 1;
+
+  streamer.beginFrame();
+  for (const StreamedSlot &slot : streamed)
+  {
+    const float *center = slot.anchor;
+    float radius = slot.scale;
+    if (slot.primitive)
+    {
+      if (!shown[slot.sceneIndex])
+        continue;
+      const BoundingSphere &sphere = slot.primitive->getWorldBounds().sphere;
+      center = sphere.center;
+      radius = sphere.radius;
+    }
+    const float dz = center[2] + 1.0f;
+    const float distance = std::sqrt(center[0] * center[0] + center[1] * center[1] + dz * dz);
+    streamer.request(slot.asset, streamingPriority(distance, radius));
+  }
+
+  for (AssetId id : streamer.evict())
+  {
+    StreamedSlot &slot = streamed[id];
+    if (!slot.primitive)
+      continue;
+
+    // Swap-remove from the scene and fix up whichever slot owned the moved entry
+    Primitive *moved = scene.back();
+    scene[slot.sceneIndex] = moved;
+    scene.pop_back();
+    for (StreamedSlot &other : streamed)
+      if (other.primitive == moved)
+        other.sceneIndex = slot.sceneIndex;
+
+    delete slot.primitive;
+    slot.primitive = nullptr;
+    sceneBoxes.clear();     // Forces a BVH rebuild
+    drawList.clear();       // Its items borrowed the deleted mesh's buffers
+  }
+
+  for (StreamedMesh &upload : streamer.takeStaged())
+  {
+    StreamedSlot &slot = streamed[upload.id];
+    slot.primitive = new Mesh(device, std::move(upload.baked), slot.options);
+    Transform &transform = slot.primitive->getTransform();
+    transform.setScale(slot.scale, slot.scale, slot.scale);
+    transform.setTranslation(slot.anchor[0], slot.anchor[1], slot.anchor[2]);
+    slot.sceneIndex = scene.size();
+    scene.push_back(slot.primitive);
+    sceneBoxes.clear();
+    drawList.clear();
+  }
+}
+
+/**
+ * @brief Once per frame, after the transforms are final and before the draw list is prepared.
+ *
+ * viewportSize is the larger of the drawable's width and height, in pixels.
+ */
+void Renderer::selectLods(float viewportSize)
+{
+  if (sphere)
+    sphere->selectLod(viewportSize);
+  for (StreamedSlot &slot : streamed)
+    if (slot.primitive)
+      slot.primitive->selectLod(viewportSize);
+}
+
+/**
+ * @brief Poses the simulated primitives from the newest simulation snapshot.
+ *
+ * Never waits: without a new snapshot the previous one is interpolated further (up to its
+ * latest state), so the frame rate and the 120 Hz tick stay independent.
+ */
+void Renderer::applySimulation()
+{
+  simulation->acquire();
+  simulation->interpolate(std::chrono::steady_clock::now(), simulatedMatrices);
+  for (size_t i = 0; i < simulatedMatrices.size(); ++i)
+    simulated[i]->getTransform().setMatrix(simulatedMatrices[i] * simulatedBase[i]);
+}
+
+/**
+ * @brief Once per frame before culling: selects terrain chunks, then evicts, uploads and shows patches.
+ *
+ * Patches join and leave the scene like streamed meshes (BVH and draw list rebuilt); which
+ * ones draw, and with which edge variant, only changes their dynamic index range. Chunks
+ * drawn this frame were all uploaded in earlier ones, so nothing here waits on a build.
+ */
+void Renderer::updateTerrain()
+{
+  float eye[3];
+  if (!terrainEye(terrainMatrix, eye))
+    return;
+  terrain->update(eye);
+
+  for (uint64_t node : terrain->evict())
+  {
+    auto it = terrainPatches.find(node);
+    if (it == terrainPatches.end())
+      continue;
+
+    // Swap-remove from the scene and fix up a streamed slot that owned the moved entry
+    const size_t index = static_cast<size_t>(std::find(scene.begin(), scene.end(), it->second) - scene.begin());
+    Primitive *moved = scene.back();
+    scene[index] = moved;
+    scene.pop_back();
+    for (StreamedSlot &other : streamed)
+      if (other.primitive == moved)
+        other.sceneIndex = index;
+
+    delete it->second;
+    terrainPatches.erase(it);
+    sceneBoxes.clear();
+    drawList.clear();
+  }
+
+  for (const TerrainChunk &chunk : terrain->takeBuilt())
+  {
+    TerrainPatch *patch = new TerrainPatch(device, chunk, terrainStitch.get(), terrain->getStitch());
+    patch->getTransform().setMatrix(terrainMatrix);
+    terrainPatches.emplace(chunk.node, patch);
+    scene.push_back(patch);
+    sceneBoxes.clear();
+    drawList.clear();
+  }
+
+  for (auto &[node, patch] : terrainPatches)
+    patch->hide();
+  for (const TerrainDraw &draw : terrain->getDraws())
+    terrainPatches.at(draw.node)->show(draw.edges);
+}
+
 void Renderer::logFPS()
 {
   using Clock = std::chrono::high_resolution_clock;
@@ -211,6 +975,7 @@ void Renderer::logFPS()
   auto currentTime = Clock::now();
   std::chrono::duration<double> deltaTime = currentTime - previousTime;
   previousTime = currentTime;
+  frameTimes.record(deltaTime.count());
 
   std::cout << "Delta Time: " << deltaTime.count() << " seconds" << std::endl;
 
@@ -227,6 +992,45 @@ void Renderer::logFPS()
     std::cout << "Total Time: " << currentSecond << " seconds" << std::endl;
     std::cout << "FPS: " << frames << std::endl;
 
+    const FrameTimeSummary summary = frameTimes.summarize();
+    std::cout << "Frame ms: mean " << summary.meanMs << ", p50 " << summary.p50Ms << ", p99 " << summary.p99Ms
+              << ", max " << summary.maxMs << ", stddev " << summary.stdDevMs << ", hitches " << summary.hitches
+              << std::endl;
+    frameTimes.clear();
+
+    std::cout << "Dynamic uploads: " << uploadedBytes << " bytes" << std::endl;
+
+    const ResourceCounters resources = DeferredReleaseQueue::shared().getCounters();
+    std::cout << "GPU objects: " << resources.live() << " live, " << resources.pending << " awaiting release" << std::endl;
+    uploadedBytes = 0;
+
+    if (!streamed.empty())
+    {
+      const StreamingStats stats = streamer.getStats();
+      std::cout << "Streaming: " << stats.resident << "/" << stats.assets << " resident, " << stats.inFlight
+                << " loading, " << stats.queued << " queued, " << stats.chargedBytes / (1 << 20) << "/"
+                << stats.budgetBytes / (1 << 20) << " MB, " << stats.evictions << " evicted" << std::endl;
+    }
+
+    if (simulation)
+    {
+      const SimulationStats stats = simulation->getStats();
+      const HandoffStats &handoff = simulation->getHandoffStats();
+      std::cout << "Simulation: " << stats.ticks << " ticks, " << handoff.acquired << "/" << handoff.frames
+                << " frames got a new snapshot, handoff mean " << handoff.latencyMeanMs << " ms, max "
+                << handoff.latencyMaxMs << " ms, " << stats.replaced << " replaced, " << stats.skippedTicks
+                << " ticks skipped" << std::endl;
+    }
+
+    if (terrain)
+    {
+      const TerrainStats stats = terrain->getStats();
+      std::cout << "Terrain: " << stats.drawn << "/" << stats.selected << " chunks drawn, " << stats.triangles
+                << " triangles, " << stats.resident << " resident, " << stats.queued + stats.building
+                << " building, select " << stats.selectMilliseconds << " ms, tiles "
+                << stats.tiles.bytes / (1 << 20) << "/" << stats.tiles.budgetBytes / (1 << 20) << " MB" << std::endl;
+    }
+
     // Update the last printed second and reset frame counter
     lastPrintedSecond = currentSecond;
     frames = 0;
@@ -5,9 +5,20 @@
 
 #include "window.h"
 #include "./Primitive/primitive.h"
+#include "./Culling/frustum.h"
+#include "./Culling/bvh.h"
+#include "./Draw/drawList.h"
+#include "./Streaming/assetStreamer.h"
+#include "./Streaming/frameStats.h"
+#include "./Sprite/spriteBatcher.h"
+#include "./Terrain/terrain.h"
+#include "./Simulation/sceneSimulation.h"
+#include "./common/radixSort.h"
 
 
 #include <iostream>
+#include <memory>
+#include <unordered_map>
 
 class Renderer
 {
@@ -24,7 +35,7 @@ public:
 private:
   void logFPS();
   MTL::Device *device;
-  MTL::CommandQueue *commandQueue;
+  Handle<MTL::CommandQueue> commandQueue;
   Window &window;
 
   // Scene objects
@@ -36,9 +47,105 @@ private:
   Primitive* triangle2;    // Base ptr
   Primitive* quad1;
   Primitive* quad2;
+  Mesh* sphere;             // SPHERE; picks its LOD every frame
+  Primitive* polygon;
+  Primitive* outline;
+  Primitive* wave;
+  Particles* fountain;      // PARTICLES; stepped every frame, so kept as its own type
+  Circle* circle;           // CIRCLE; re-flattened every frame
+  Primitive* curveFill;
+  Primitive* curveStroke;
+  std::vector<Primitive*> imported;   // One per glTF node primitive (GLB_MODEL), owned
+
+  // Background-loaded meshes (MODEL, STREAM_DIR); slot i streams asset i.
+  // A slot's Mesh is created when its data arrives and deleted when it is evicted.
+  struct StreamedSlot
+  {
+    AssetId asset;
+    float anchor[3];          // Placement, also the priority estimate before the bounds are known
+    float scale;
+    MeshOptions options;
+    Mesh *primitive{nullptr};
+    size_t sceneIndex{0};
+  };
+  AssetStreamer streamer;
+  std::vector<StreamedSlot> streamed;
+
+  void addStreamed(const std::string &path, float x, float y, float z, float scale, const MeshOptions &options = {});
+  void updateStreaming();
+
+  // Every Mesh (SPHERE and the streamed ones) picks its LOD for its size on screen
+  void selectLods(float viewportSize);
+
+  // Dynamic vertex updates flushed since the last FPS log
+  size_t uploadedBytes{0};
+  uint64_t morphFrame{0};
+  void morphQuad();
+
+  // Everything drawable, culled against the view before encoding
+  std::vector<Primitive*> scene;
+  SphereSoA sceneSpheres;
+  std::vector<uint32_t> visible;
+
+  // Scene BVH over world boxes; rebuilt when the scene changes, refit per moved primitive
+  static constexpr size_t kBvhCullThreshold = 64;   // Below this the flat sphere test is faster
+  Bvh sceneBvh;
+  std::vector<Aabb> sceneBoxes;
+  std::vector<uint64_t> sceneVersions;
+
+  void cullScene();
+  void updateSceneBvh();
+
+  // The scene compiled into DrawItems (item i draws scene[i]); cleared whenever the scene changes
+  DrawList drawList;
+  DrawStats drawStats;
+
+  // Depth attachment (DEPTH): sized to the drawable, with the opaque pass sorted front to back
+  std::unique_ptr<DepthStates> depthStates;
+  Handle<MTL::Texture> depthTexture;
+  void updateDepthTexture(NS::UInteger width, NS::UInteger height);
+
+  // This frame's visible draws split by pass (opaque, then blended back to front), with their sort keys
+  FloatRadixSort passSort;
+  std::vector<uint8_t> visibleMask;
+  std::vector<uint32_t> opaqueDraws;
+  std::vector<float> opaqueDepths;
+  std::vector<uint32_t> transparentDraws;
+  std::vector<float> transparentDepths;
+  DrawStats transparentStats;
+  void orderPasses();
+
+  // Transforms moved by the fixed-step simulation thread (SIMULATE): each frame simulated[i] gets
+  // the interpolated pose of body i applied on top of its original matrix, simulatedBase[i]
+  std::unique_ptr<SceneSimulation> simulation;
+  std::vector<Primitive*> simulated;
+  std::vector<Eigen::Matrix4f> simulatedBase;
+  std::vector<Eigen::Matrix4f> simulatedMatrices;
+  void applySimulation();
+
+  // Heightmap terrain (TERRAIN): a TerrainPatch in the scene per uploaded chunk, shown or hidden per frame
+  std::unique_ptr<Terrain> terrain;
+  Handle<MTL::Buffer> terrainStitch;        // Shared index variants of every patch
+  Eigen::Matrix4f terrainMatrix{Eigen::Matrix4f::Identity()};
+  std::unordered_map<uint64_t, TerrainPatch*> terrainPatches;
+  void updateTerrain();
+
+  // Batched sprites (SPRITES), bouncing around the view; two velocity floats per sprite
+  std::unique_ptr<SpriteBatcher> spriteBatcher;
+  std::vector<Sprite> spriteField;
+  std::vector<float> spriteVelocities;
+  SpriteStats spriteStats;
+  void createSprites(size_t count);
+  void animateSprites();
+
+  // Mouse picking: closest primitive under the cursor, or -1
+  int pick(double cursorX, double cursorY);
+  static void mouseButtonCallback(GLFWwindow *glfwWindow, int button, int action, int mods);
 
   std::chrono::high_resolution_clock::time_point previousTime;
+  std::chrono::high_resolution_clock::time_point simulatedTime;     // Last particle step
   double totalTime;
   int lastPrintedSecond;
   int frames;
+  FrameTimeRecorder frameTimes;
 };
@@ -24,6 +24,151 @@ vertex VertexOut vertex_main(
     return out;
 }
 
+/*
+ *  Quantized vertex streams. Specialized per Primitive through function constants;
+ *  the values mirror PositionFormat / ColorFormat in VertexFormat/vertexFormat.h.
+ *  The streams live in the device address space so imported buffers can be bound
+ *  at their (4-byte aligned) offsets inside a mapped file.
+ */
+constant uint positionFormat [[function_constant(0)]];
+constant uint colorFormat [[function_constant(1)]];
+
+struct VertexDequant {
+    float4 scale;
+    float4 offset;
+};
+
+vertex VertexOut vertex_main_quantized(
+    device const uchar *positionData [[buffer(0)]],
+    device const uchar *colorData [[buffer(1)]],
+    constant float4x4 &matrix [[buffer(11)]],
+    constant VertexDequant &dequant [[buffer(12)]],
+    uint vertexID [[vertex_id]]
+    ) {
+    float4 position;
+    if (positionFormat == 1) {          // PackedFloat3
+        position = float4(float3(((device const packed_float3 *)positionData)[vertexID]), 1.0);
+    } else if (positionFormat == 2) {   // Half4
+        float3 unit = float3(((device const half4 *)positionData)[vertexID].xyz);
+        position = float4(unit * dequant.scale.xyz + dequant.offset.xyz, 1.0);
+    } else if (positionFormat == 3) {   // Snorm16x4
+        float3 unit = max(float3(((device const short4 *)positionData)[vertexID].xyz) / 32767.0, -1.0);
+        position = float4(unit * dequant.scale.xyz + dequant.offset.xyz, 1.0);
+    } else {                            // Float4
+        position = ((device const float4 *)positionData)[vertexID];
+    }
+
+    VertexOut out;
+    out.position = matrix * position;
+    if (colorFormat == 1) {             // Unorm8x4
+        out.color = unpack_unorm4x8_to_float(((device const uint *)colorData)[vertexID]);
+    } else {                            // Float4
+        out.color = ((device const float4 *)colorData)[vertexID];
+    }
+    return out;
+}
+
+/*
+ *  Procedural shapes: geometry from vertex_id / instance_id only.
+ *  CPU reference: Procedural/proceduralShapes.cpp - keep the math identical.
+ */
+struct ProceduralInstance {
+    packed_float2 center;
+    float radius;
+    uint kind;          // 0 triangle, 1 quad, 2 circle
+    uint segments;
+    uint color;         // rgba8
+    uint2 padding;
+};
+
+static int quarterSinQ15(int x) {
+    int x2 = (x * x) >> 14;
+    int t = 10512 - ((x2 * 1160) >> 14);
+    t = 25736 - ((x2 * t) >> 14);
+    return (x * t) >> 13;
+}
+
+static int sinPhaseQ15(uint phase) {
+    uint quadrant = (phase >> 14) & 3u;
+    int fraction = int(phase & 16383u);
+    int s = quarterSinQ15((quadrant & 1u) ? 16384 - fraction : fraction);
+    return quadrant >= 2 ? -s : s;
+}
+
+vertex VertexOut vertex_procedural(
+    constant ProceduralInstance *instances [[buffer(0)]],
+    constant float4x4 &matrix [[buffer(11)]],
+    uint vertexID [[vertex_id]],
+    uint instanceID [[instance_id]]
+    ) {
+    constant ProceduralInstance &instance = instances[instanceID];
+    uint segments = clamp(instance.segments, 3u, 65535u);
+    // Unknown kinds get no vertices, so they collapse onto their center like verticesPerInstance == 0
+    uint vertexCount = instance.kind == 0 ? 3u : (instance.kind == 1 ? 6u : (instance.kind == 2 ? 3u * segments : 0u));
+
+    float2 unit = float2(0.0);
+    if (vertexID < vertexCount) {
+        uint corner = vertexID % 3;
+        if (instance.kind == 0) {
+            const float2 corners[3] = {float2(0.0, 1.0), float2(-1.0, -1.0), float2(1.0, -1.0)};
+            unit = corners[corner];
+        } else if (instance.kind == 1) {
+            const uint indices[6] = {0, 2, 3, 0, 1, 2};
+            const float2 corners[4] = {float2(-1.0, 1.0), float2(1.0, 1.0), float2(1.0, -1.0), float2(-1.0, -1.0)};
+            unit = corners[indices[vertexID]];
+        } else if (corner != 0) {
+            uint rim = vertexID / 3 + corner - 1;
+            uint phase = (rim * 65536u) / segments;
+            unit = float2(float(sinPhaseQ15((phase + 16384u) & 0xffffu)),
+                          float(sinPhaseQ15(phase & 0xffffu))) * (1.0f / 32768.0f);
+        }
+    }
+
+    VertexOut out;
+    out.position = matrix * float4(fma(instance.radius, unit.x, instance.center.x),
+                                   fma(instance.radius, unit.y, instance.center.y), 0.0, 1.0);
+    // 0.00392156886 is 1/255 rounded to float, the same constant as the CPU reference
+    out.color = float4(float((instance.color >> 0) & 0xffu), float((instance.color >> 8) & 0xffu),
+                       float((instance.color >> 16) & 0xffu), float((instance.color >> 24) & 0xffu)) * 0.00392156886f;
+    return out;
+}
+
+/*
+ *  Sprites: four SpriteVertex per sprite (Sprite/spriteBatch.h), tinted texels of an atlas page.
+ */
+struct SpriteVertex {
+    packed_float2 position;
+    packed_float2 uv;
+    uint color;         // rgba8
+};
+
+struct SpriteOut {
+    float4 position [[position]];
+    float2 uv;
+    float4 color;
+};
+
+vertex SpriteOut vertex_sprite(
+    device const SpriteVertex *vertices [[buffer(0)]],
+    constant float4x4 &matrix [[buffer(11)]],
+    uint vertexID [[vertex_id]]
+    ) {
+    SpriteVertex in = vertices[vertexID];
+    SpriteOut out;
+    out.position = matrix * float4(float2(in.position), 0.0, 1.0);
+    out.uv = float2(in.uv);
+    out.color = unpack_unorm4x8_to_float(in.color);
+    return out;
+}
+
+fragment float4 fragment_sprite(
+    SpriteOut in [[stage_in]],
+    texture2d<float> atlas [[texture(0)]],
+    sampler atlasSampler [[sampler(0)]]
+    ) {
+    return atlas.sample(atlasSampler, in.uv) * in.color;
+}
+
 fragment float4 fragment_main(VertexOut in [[stage_in]]) {
     return in.color; // Use the interpolated color
 }
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+/*
+-------------------------------------------------------------------
+  CHECK  -----------------------------------------------------------
+
+  The tests are plain executables run by ctest: a failed CHECK prints
+  where and what, and the test keeps going so one run reports every
+  failure; finish() turns the count into the exit code.
+-------------------------------------------------------------------
+*/
+namespace check
+{
+inline int failures = 0;
+
+inline void fail(const char *file, int line, const char *what)
+{
+    std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, what);
+    ++failures;
+}
+
+inline int finish()
+{
+    if (failures)
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+} // namespace check
+
+#define CHECK(condition)                                    \
+    do                                                      \
+    {                                                       \
+        if (!(condition))                                   \
+            check::fail(__FILE__, __LINE__, #condition);    \
+    } while (false)
@@ -0,0 +1,196 @@
+#include "check.h"
+#include "../src/Tessellation/curveFlattener.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+/*
+  Flattened quadratics, cubics (loops and cusps included) and elliptical arcs against the curves
+  themselves, at several tolerances: the polyline and the curve never get further apart than the
+  tolerance, either way round (each measured against the other densely sampled). The polylines
+  start and end on the curve's end points, a looser tolerance never costs more points, and
+  flatteningTolerance turns pixels into object units the way selectLod does.
+*/
+namespace
+{
+constexpr size_t kCurveSamples = 2048;     // Dense polyline standing in for the exact curve
+constexpr size_t kSegmentSamples = 8;      // Points checked along each flattened segment
+
+using Curve = std::function<void(double t, double &x, double &y)>;
+
+double segmentDistance(double px, double py, const double *a, const double *b)
+{
+    const double dx = b[0] - a[0], dy = b[1] - a[1];
+    const double lengthSq = dx * dx + dy * dy;
+    const double t = lengthSq > 0.0 ? std::clamp(((px - a[0]) * dx + (py - a[1]) * dy) / lengthSq, 0.0, 1.0) : 0.0;
+    const double ex = a[0] + t * dx - px, ey = a[1] + t * dy - py;
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+double polylineDistance(double px, double py, const std::vector<double> &line)
+{
+    double best = INFINITY;
+    for (size_t i = 0; i + 3 < line.size(); i += 2)
+        best = std::min(best, segmentDistance(px, py, &line[i], &line[i + 2]));
+    return best;
+}
+
+// Largest gap between the curve and the flattened points (p0 followed by what the flattener appended)
+double deviation(const Curve &curve, const std::vector<float> &xy)
+{
+    std::vector<double> flat(xy.begin(), xy.end());
+    std::vector<double> dense;
+    for (size_t i = 0; i <= kCurveSamples; ++i)
+    {
+        double x, y;
+        curve(double(i) / kCurveSamples, x, y);
+        dense.push_back(x);
+        dense.push_back(y);
+    }
+
+    double worst = 0.0;
+    for (size_t i = 0; i < dense.size(); i += 2)
+        worst = std::max(worst, polylineDistance(dense[i], dense[i + 1], flat));
+    for (size_t i = 0; i + 3 < flat.size(); i += 2)
+        for (size_t k = 0; k <= kSegmentSamples; ++k)
+        {
+            const double t = double(k) / kSegmentSamples;
+            worst = std::max(worst, polylineDistance(flat[i] + t * (flat[i + 2] - flat[i]),
+                                                     flat[i + 1] + t * (flat[i + 3] - flat[i + 1]), dense));
+        }
+    return worst;
+}
+
+bool endsOn(const std::vector<float> &xy, const float *first, const float *last)
+{
+    return xy.size() >= 4 && xy[0] == first[0] && xy[1] == first[1] && xy[xy.size() - 2] == last[0] &&
+           xy[xy.size() - 1] == last[1];
+}
+
+Curve quadratic(const float *p0, const float *p1, const float *p2)
+{
+    return [=](double t, double &x, double &y) {
+        const double s = 1.0 - t;
+        x = s * s * p0[0] + 2.0 * s * t * p1[0] + t * t * p2[0];
+        y = s * s * p0[1] + 2.0 * s * t * p1[1] + t * t * p2[1];
+    };
+}
+
+Curve cubic(const float *p0, const float *p1, const float *p2, const float *p3)
+{
+    return [=](double t, double &x, double &y) {
+        const double s = 1.0 - t;
+        x = s * s * s * p0[0] + 3.0 * s * s * t * p1[0] + 3.0 * s * t * t * p2[0] + t * t * t * p3[0];
+        y = s * s * s * p0[1] + 3.0 * s * s * t * p1[1] + 3.0 * s * t * t * p2[1] + t * t * t * p3[1];
+    };
+}
+
+Curve ellipse(const EllipticalArc &arc)
+{
+    return [=](double t, double &x, double &y) {
+        const double angle = arc.start + t * arc.sweep;
+        const double ex = arc.radius[0] * std::cos(angle), ey = arc.radius[1] * std::sin(angle);
+        x = arc.center[0] + ex * std::cos(arc.rotation) - ey * std::sin(arc.rotation);
+        y = arc.center[1] + ex * std::sin(arc.rotation) + ey * std::cos(arc.rotation);
+    };
+}
+
+// Rounding in float coordinates around 100 units, on top of the tolerance
+constexpr double kSlack = 1e-4;
+} // namespace
+
+int main()
+{
+    const float tolerances[] = {1.0f, 0.25f, 0.05f};
+    std::mt19937 random(46);
+    std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+
+    // Random quadratics and cubics, plus a cubic that loops and one with a cusp
+    std::vector<std::array<float, 8>> cubics(12);
+    for (auto &c : cubics)
+        for (float &v : c)
+            v = coordinate(random);
+    cubics.push_back({0.0f, 0.0f, 150.0f, 100.0f, -50.0f, 100.0f, 100.0f, 0.0f});      // Loop
+    cubics.push_back({0.0f, 0.0f, 100.0f, 100.0f, 0.0f, 100.0f, 100.0f, 0.0f});        // Cusp
+
+    for (float tolerance : tolerances)
+    {
+        bool quadraticsWithin = true, cubicsWithin = true, endsExact = true;
+        double quadraticWorst = 0.0, cubicWorst = 0.0;
+        for (const auto &c : cubics)
+        {
+            std::vector<float> xy = {c[0], c[1]};
+            flattenQuadratic(&c[0], &c[2], &c[4], tolerance, xy);
+            const double q = deviation(quadratic(&c[0], &c[2], &c[4]), xy);
+            quadraticsWithin = quadraticsWithin && q <= tolerance + kSlack;
+            quadraticWorst = std::max(quadraticWorst, q / tolerance);
+            endsExact = endsExact && endsOn(xy, &c[0], &c[4]);
+
+            xy = {c[0], c[1]};
+            flattenCubic(&c[0], &c[2], &c[4], &c[6], tolerance, xy);
+            const double d = deviation(cubic(&c[0], &c[2], &c[4], &c[6]), xy);
+            cubicsWithin = cubicsWithin && d <= tolerance + kSlack;
+            cubicWorst = std::max(cubicWorst, d / tolerance);
+            endsExact = endsExact && endsOn(xy, &c[0], &c[6]);
+        }
+        CHECK(quadraticsWithin);
+        CHECK(cubicsWithin);
+        CHECK(endsExact);
+        std::printf("tolerance %.2f: quadratics within %.2f of it, cubics within %.2f\n", tolerance, quadraticWorst,
+                    cubicWorst);
+    }
+
+    // Ellipses and circles, either direction, rotated, past a full turn
+    {
+        const EllipticalArc arcs[] = {{{0.0f, 0.0f}, {100.0f, 100.0f}, 0.0f, 0.0f, 6.2831853f},
+                                      {{10.0f, -5.0f}, {120.0f, 30.0f}, 0.6f, 1.0f, 5.0f},
+                                      {{0.0f, 0.0f}, {20.0f, 90.0f}, -1.2f, 0.5f, -4.0f},
+                                      {{3.0f, 4.0f}, {50.0f, 50.0f}, 0.0f, 0.0f, 9.0f}};
+        bool arcsWithin = true;
+        for (float tolerance : tolerances)
+            for (const EllipticalArc &arc : arcs)
+            {
+                double x, y;
+                ellipse(arc)(0.0, x, y);
+                std::vector<float> xy = {static_cast<float>(x), static_cast<float>(y)};
+                flattenArc(arc, tolerance, xy);
+                arcsWithin = arcsWithin && deviation(ellipse(arc), xy) <= tolerance + kSlack;
+            }
+        CHECK(arcsWithin);
+        // r (1 - cos(pi / n)) <= tolerance: a circle of radius 100 at 0.25 takes 45 segments
+        CHECK(arcSegmentCount(100.0f, 6.2831853f, 0.25f) == 45);
+    }
+
+    // A looser tolerance never adds points
+    {
+        bool fewer = true;
+        for (const auto &c : cubics)
+        {
+            size_t previous = SIZE_MAX;
+            for (float tolerance : {0.01f, 0.1f, 1.0f, 10.0f})
+            {
+                std::vector<float> xy;
+                const size_t points = flattenCubic(&c[0], &c[2], &c[4], &c[6], tolerance, xy);
+                fewer = fewer && points <= previous;
+                previous = points;
+            }
+        }
+        CHECK(fewer);
+    }
+
+    // Pixels to object units: a scale of 2 on a 1000 pixel viewport puts 1000 pixels on a unit
+    {
+        Eigen::Matrix4f transform = Eigen::Matrix4f::Identity();
+        transform(0, 0) = transform(1, 1) = transform(2, 2) = 2.0f;
+        CHECK(std::abs(flatteningTolerance(transform, 1000.0f, 0.25f) - 0.25e-3f) < 1e-9f);
+        CHECK(flatteningTolerance(Eigen::Matrix4f::Zero(), 1000.0f) > 1e30f);
+    }
+
+    std::printf("flattened curves within their tolerance\n");
+    return check::finish();
+}
@@ -0,0 +1,154 @@
+#include "check.h"
+#include "../src/common/dirtyRanges.h"
+#include "../src/Primitive/streamRing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/*
+  DirtyRanges: writes touching or near the last range extend it in place, coalesce() sorts and
+  merges across gaps of up to mergeGap bytes (never wider), and clear() empties. Then StreamRing
+  over plain memory as a CPU backend: after random partial writes, each new slice is a byte-exact
+  copy of the stream, and the dirty ranges cover every byte that changed in it.
+*/
+namespace
+{
+std::vector<ByteRange> coalesced(DirtyRanges &dirty)
+{
+    return dirty.coalesce();
+}
+
+bool equal(const std::vector<ByteRange> &ranges, std::initializer_list<ByteRange> expected)
+{
+    if (ranges.size() != expected.size())
+        return false;
+    size_t i = 0;
+    for (const ByteRange &range : expected)
+    {
+        if (ranges[i].begin != range.begin || ranges[i].end != range.end)
+            return false;
+        ++i;
+    }
+    return true;
+}
+} // namespace
+
+int main()
+{
+    // Merging as writes come: sequential and overlapping writes grow the last range
+    {
+        DirtyRanges dirty(16);
+        CHECK(dirty.empty());
+        dirty.add(10, 10);                      // Empty ranges are ignored
+        dirty.add(20, 10);
+        CHECK(dirty.empty());
+        dirty.add(0, 64);
+        dirty.add(64, 128);                     // Touching
+        dirty.add(100, 140);                    // Overlapping
+        dirty.add(150, 160);                    // 10 bytes away, under the gap
+        dirty.add(0, 8);                        // Inside
+        CHECK(equal(coalesced(dirty), {{0, 160}}));
+    }
+
+    // Coalescing: out of order, nested and duplicate ranges, merged only across gaps up to mergeGap
+    {
+        DirtyRanges dirty(16);
+        dirty.add(1000, 1100);
+        dirty.add(0, 100);
+        dirty.add(500, 600);
+        dirty.add(1116, 1200);                  // 16 bytes after 1100: joins
+        dirty.add(117, 200);                    // 17 bytes after 100: stays apart
+        dirty.add(520, 540);                    // Nested
+        dirty.add(500, 600);                    // Duplicate
+        CHECK(equal(coalesced(dirty), {{0, 100}, {117, 200}, {500, 600}, {1000, 1200}}));
+        CHECK(equal(coalesced(dirty), {{0, 100}, {117, 200}, {500, 600}, {1000, 1200}}));   // Idempotent
+
+        DirtyRanges exact(0);
+        exact.add(0, 10);
+        exact.add(20, 30);
+        exact.add(10, 20);                      // Fills the hole exactly
+        CHECK(equal(coalesced(exact), {{0, 30}}));
+    }
+
+    // Clearing
+    {
+        DirtyRanges dirty;
+        dirty.add(0, 4);
+        dirty.add(10000, 10004);
+        dirty.clear();
+        CHECK(dirty.empty() && dirty.coalesce().empty());
+        dirty.add(8, 12);
+        CHECK(equal(coalesced(dirty), {{8, 12}}));
+    }
+
+    // StreamRing: every slice catches up with the writes made to the others
+    {
+        constexpr size_t kSlots = 3;
+        constexpr size_t kBytes = 10000;
+        const size_t stride = StreamRing<kSlots>::sliceStride(kBytes);
+        CHECK(stride % StreamRing<kSlots>::kSliceAlignment == 0 && stride >= kBytes);
+
+        std::vector<char> reference(kBytes);
+        for (size_t i = 0; i < kBytes; ++i)
+            reference[i] = static_cast<char>(i * 7);
+        std::vector<char> memory(stride * kSlots);
+        for (size_t slot = 0; slot < kSlots; ++slot)
+            std::memcpy(memory.data() + slot * stride, reference.data(), kBytes);
+
+        StreamRing<kSlots> ring(memory.data(), kBytes);
+        CHECK(!ring.empty() && StreamRing<kSlots>().empty());
+
+        std::mt19937 random(38);
+        std::uniform_int_distribution<size_t> start(0, kBytes - 1);
+        std::uniform_int_distribution<size_t> length(1, 300);
+        bool slicesMatch = true, dirtyCovers = true, slotsCycle = true;
+        for (size_t frame = 1; frame <= 50; ++frame)
+        {
+            const std::vector<char> before(memory.begin() + ((frame % kSlots) * stride),
+                                           memory.begin() + ((frame % kSlots) * stride) + kBytes);
+            ring.advance();
+            slotsCycle = slotsCycle && ring.getSlot() == frame % kSlots && ring.getSliceOffset() == ring.getSlot() * stride;
+            slicesMatch = slicesMatch && std::memcmp(ring.getSlice(), reference.data(), kBytes) == 0;
+
+            // A few scattered writes, the last frame's none
+            const size_t writes = frame == 50 ? 0 : frame % 4;
+            for (size_t w = 0; w < writes; ++w)
+            {
+                const size_t begin = start(random);
+                const size_t end = std::min(kBytes, begin + length(random));
+                for (size_t i = begin; i < end; ++i)
+                    ring.getSlice()[i] = reference[i] = static_cast<char>(frame + i);
+                ring.add(begin, end);
+            }
+
+            // Every byte that differs from what the slice held before is in a dirty range of this slice
+            std::vector<bool> covered(kBytes, false);
+            for (const ByteRange &range : ring.getDirty().coalesce())
+            {
+                dirtyCovers = dirtyCovers && range.begin >= ring.getSliceOffset() &&
+                              range.end <= ring.getSliceOffset() + kBytes;
+                for (size_t i = range.begin; i < range.end && i - ring.getSliceOffset() < kBytes; ++i)
+                    covered[i - ring.getSliceOffset()] = true;
+            }
+            for (size_t i = 0; i < kBytes; ++i)
+                dirtyCovers = dirtyCovers && (covered[i] || before[i] == ring.getSlice()[i]);
+            ring.getDirty().clear();
+        }
+        CHECK(slotsCycle);
+        CHECK(slicesMatch);
+        CHECK(dirtyCovers);
+
+        // With no writes for Slots frames in a row, a new slice has nothing to catch up
+        for (size_t frame = 0; frame < kSlots; ++frame)
+            ring.advance();
+        ring.getDirty().clear();
+        CHECK(ring.advance() == 0 && ring.getDirty().empty());
+        CHECK(std::memcmp(ring.getSlice(), reference.data(), kBytes) == 0);
+    }
+
+    std::printf("dirty ranges merge, coalesce and clear; stream ring slices stay in step\n");
+    return check::finish();
+}
@@ -0,0 +1,129 @@
+#include "check.h"
+#include "../src/Loader/gltfLoader.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+  loadGlb on a one-triangle .glb, then on copies with one JSON field broken at a time: every
+  malformed size, offset or index must be a std::runtime_error, never a read or a GPU fetch
+  outside the file.
+*/
+namespace
+{
+const std::string kJson =
+    R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":44}],)"
+    R"("bufferViews":[{"buffer":0,"byteOffset":0,"byteLength":36},{"buffer":0,"byteOffset":36,"byteLength":6}],)"
+    R"("accessors":[{"bufferView":0,"componentType":5126,"count":3,"type":"VEC3","min":[0,0,0],"max":[1,1,0]},)"
+    R"({"bufferView":1,"byteOffset":0,"componentType":5123,"count":3,"type":"SCALAR"}],)"
+    R"("meshes":[{"primitives":[{"attributes":{"POSITION":0},"indices":1}]}],)"
+    R"("nodes":[{"mesh":0,"children":[1]},{}],"scenes":[{"nodes":[0]}],"scene":0})";
+
+void append32(std::vector<uint8_t> &out, uint32_t value)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+std::filesystem::path writeGlb(const std::string &json, const uint16_t indices[3])
+{
+    std::string text = json;
+    text.resize((text.size() + 3) & ~size_t{3}, ' ');
+
+    std::vector<uint8_t> bin(44, 0);
+    const float positions[9] = {0, 0, 0, 1, 0, 0, 0, 1, 0};
+    std::memcpy(bin.data(), positions, sizeof(positions));
+    std::memcpy(bin.data() + 36, indices, 6);
+
+    std::vector<uint8_t> glb;
+    append32(glb, 0x46546C67u);
+    append32(glb, 2);
+    append32(glb, static_cast<uint32_t>(12 + 8 + text.size() + 8 + bin.size()));
+    append32(glb, static_cast<uint32_t>(text.size()));
+    append32(glb, 0x4E4F534Au);
+    glb.insert(glb.end(), text.begin(), text.end());
+    append32(glb, static_cast<uint32_t>(bin.size()));
+    append32(glb, 0x004E4942u);
+    glb.insert(glb.end(), bin.begin(), bin.end());
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "gltfLoaderTest.glb";
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char *>(glb.data()),
+                                                 static_cast<std::streamsize>(glb.size()));
+    return path;
+}
+
+// kJson with the first `from` replaced by `to`
+std::string broken(const char *from, const char *to)
+{
+    std::string json = kJson;
+    const size_t at = json.find(from);
+    CHECK(at != std::string::npos);
+    if (at != std::string::npos)
+        json.replace(at, std::strlen(from), to);
+    return json;
+}
+
+bool rejects(const std::string &json, const uint16_t indices[3])
+{
+    const std::filesystem::path path = writeGlb(json, indices);
+    try
+    {
+        loadGlb(path.string());
+    }
+    catch (const std::runtime_error &)
+    {
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+int main()
+{
+    const uint16_t triangle[3] = {0, 1, 2};
+    {
+        const std::shared_ptr<const GltfAsset> asset = loadGlb(writeGlb(kJson, triangle).string());
+        CHECK(asset->meshes.size() == 1 && asset->meshes[0].primitives.size() == 1);
+        const GltfPrimitive &primitive = asset->meshes[0].primitives[0];
+        CHECK(primitive.vertexCount == 3);
+        CHECK(primitive.indexCount == 3 && primitive.indexSize == 2);
+        CHECK(primitive.positions.zeroCopy && primitive.indices.zeroCopy);
+    }
+
+    // Indices past the POSITION count, in place (ushort) and converted (ubyte)
+    const uint16_t pastEnd[3] = {0, 1, 3};
+    CHECK(rejects(kJson, pastEnd));
+    const uint16_t bytesPastEnd[3] = {0x0100, 0x0003, 0};     // ubyte 0, 1, 3
+    CHECK(rejects(broken(R"("componentType":5123)", R"("componentType":5121)"), bytesPastEnd));
+    CHECK(!rejects(broken(R"("componentType":5123)", R"("componentType":5121)"), triangle));
+    CHECK(rejects(broken(R"("componentType":5123)", R"("componentType":5126)"), triangle));
+
+    // Sizes and offsets that are negative, fractional, huge or past the data
+    CHECK(rejects(broken(R"("byteOffset":36)", R"("byteOffset":-4)"), triangle));
+    CHECK(rejects(broken(R"("byteOffset":36)", R"("byteOffset":36.5)"), triangle));
+    CHECK(rejects(broken(R"("byteOffset":36)", R"("byteOffset":18446744073709551612)"), triangle));
+    CHECK(rejects(broken(R"("byteOffset":36)", R"("byteOffset":40)"), triangle));
+    CHECK(rejects(broken(R"("byteLength":36)", R"("byteLength":1e300)"), triangle));
+    CHECK(rejects(broken(R"("byteLength":36)", R"("byteLength":4000)"), triangle));
+    CHECK(rejects(broken(R"("count":3,"type":"VEC3")", R"("count":2.5,"type":"VEC3")"), triangle));
+    CHECK(rejects(broken(R"("count":3,"type":"VEC3")", R"("count":4,"type":"VEC3")"), triangle));
+    CHECK(rejects(broken(R"("count":3,"type":"VEC3")", R"("count":9007199254740991,"type":"VEC3")"), triangle));
+    CHECK(rejects(broken(R"("count":3,"type":"VEC3")", R"("count":-1,"type":"VEC3")"), triangle));
+    CHECK(rejects(broken(R"("byteLength":36})", R"("byteLength":36,"byteStride":4})"), triangle));
+    CHECK(rejects(broken(R"("byteLength":36})", R"("byteLength":36,"byteStride":-12})"), triangle));
+    CHECK(rejects(broken(R"("byteOffset":0,"componentType")", R"("byteOffset":2,"componentType")"), triangle));
+
+    // Indices into the JSON arrays
+    CHECK(rejects(broken(R"("POSITION":0)", R"("POSITION":0.5)"), triangle));
+    CHECK(rejects(broken(R"("POSITION":0)", R"("POSITION":1e10)"), triangle));
+    CHECK(rejects(broken(R"("children":[1])", R"("children":[1.5])"), triangle));
+    CHECK(rejects(broken(R"("scenes":[{"nodes":[0]}])", R"("scenes":[{"nodes":[-1]}])"), triangle));
+
+    std::filesystem::remove(std::filesystem::temp_directory_path() / "gltfLoaderTest.glb");
+    return check::finish();
+}
@@ -0,0 +1,42 @@
+#include "check.h"
+#include "../src/common/Transform.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+#include "../src/MeshOptimizer/meshSimplifier.h"
+
+#include <cstdio>
+
+/*
+  What Mesh::selectLod does every frame, without a device: a sphere's LOD chain picked for a
+  shrinking transform. The level only gets coarser as the scale shrinks, the chosen level's
+  error stays under a pixel, and a far enough sphere ends on the coarsest level.
+*/
+int main()
+{
+    const LodChain chain = buildLodChain(getSphere(SphereType::Icosphere, 16)->toMeshData());
+    CHECK(chain.levels.size() > 2);
+
+    constexpr float kViewportSize = 1920.0f;     // The larger side of 1920 x 1080
+    Transform transform;
+    size_t previous = 0;
+    for (float scale = 1.0f; scale > 1e-3f; scale *= 0.8f)
+    {
+        transform.reset();
+        transform.setScale(scale, scale, scale);
+        const float pixels = pixelsPerUnit(transform.getMatrix(), kViewportSize);
+        CHECK(pixels == scale * kViewportSize * 0.5f);
+
+        const size_t lod = selectLod(chain, pixels);
+        CHECK(lod >= previous);
+        CHECK(chain.levels[lod].error * pixels <= 1.0f);
+        if (lod != previous)
+            std::printf("scale %.4f: LOD %zu (%u indices)\n", scale, lod, chain.levels[lod].indexCount);
+        previous = lod;
+    }
+    CHECK(previous == chain.levels.size() - 1);
+
+    // Full size on a large viewport keeps full detail
+    transform.reset();
+    transform.setScale(4.0f, 4.0f, 4.0f);
+    CHECK(selectLod(chain, pixelsPerUnit(transform.getMatrix(), kViewportSize)) == 0);
+    return check::finish();
+}
@@ -0,0 +1,107 @@
+#include "check.h"
+#include "../src/Loader/meshCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+  loadMeshCached through a miss and a hit: the hit must hand out the mapping itself (nothing
+  copied) with the same geometry. A cache with an index past its vertices is corrupt and re-bakes,
+  and writing never goes through a fixed temporary name nor leaves one behind.
+*/
+namespace
+{
+// Two triangles over four vertices, colored
+MeshData quad()
+{
+    MeshData mesh;
+    mesh.positions = {{0, 0, 0, 1}, {1, 0, 0, 1}, {1, 1, 0, 1}, {0, 1, 0, 1}};
+    mesh.colors = {{1, 0, 0, 1}, {0, 1, 0, 1}, {0, 0, 1, 1}, {1, 1, 1, 1}};
+    mesh.indices = {0, 1, 2, 0, 2, 3};
+    return mesh;
+}
+
+size_t leftovers(const std::filesystem::path &directory, const std::string &cacheName)
+{
+    size_t count = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(directory))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name != cacheName && name.rfind(cacheName, 0) == 0)
+            ++count;
+    }
+    return count;
+}
+} // namespace
+
+int main()
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "meshCacheTest";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    const std::string source = (directory / "quad.src").string();
+    const std::string cachePath = source + ".meshcache";
+    std::ofstream(source) << "quad";
+
+    // A stale fixed-name temporary must not get in the way
+    std::filesystem::create_directory(cachePath + ".tmp");
+
+    size_t imports = 0;
+    const MeshImporter importer = [&imports](const char *, size_t) {
+        ++imports;
+        return quad();
+    };
+
+    MeshCacheStats stats;
+    const BakedMesh baked = loadMeshCached(source, importer, false, &stats);
+    CHECK(!stats.hit && imports == 1);
+    CHECK(!baked.cache && stats.cacheBytes > 0);
+    CHECK(std::filesystem::exists(cachePath));
+    CHECK(leftovers(directory, "quad.src.meshcache") == 1);     // only the stale .tmp directory
+
+    // Hit: the geometry stays in the mapping
+    const BakedMesh hit = loadMeshCached(source, importer, false, &stats);
+    CHECK(stats.hit && imports == 1);
+    CHECK(hit.cache != nullptr);
+    CHECK(hit.mesh.positions.empty() && hit.mesh.indices.empty() && hit.lods.indices.empty());
+    CHECK(hit.positions().size() == baked.positions().size() && hit.indices().size() == baked.indices().size());
+    CHECK(hit.colors().size() == hit.positions().size());
+    CHECK(reinterpret_cast<const char *>(hit.positions().data()) == hit.cache->file.data() + hit.cache->header->positionsOffset);
+    for (size_t i = 0; i < hit.indices().size(); ++i)
+        CHECK(hit.indices()[i] == baked.indices()[i]);
+    for (size_t i = 0; i < hit.positions().size(); ++i)
+        CHECK(hit.positions()[i].x == baked.positions()[i].x && hit.positions()[i].y == baked.positions()[i].y);
+    CHECK(hit.lods.levels.size() == 1 && hit.lods.levels[0].indexCount == 6);
+
+    // The owned copy matches too
+    const BakedMesh copy = hit.cache->toBakedMesh();
+    CHECK(copy.mesh.indices == baked.mesh.indices && copy.lods.indices == baked.lods.indices);
+
+    // An index naming no vertex is corrupt, whatever the header says
+    BakedMesh broken = baked;
+    broken.lods.indices[4] = 4;
+    const uint64_t sourceHash = hashBytes("quad", 4);
+    const uint32_t flags = kMeshCacheColors;
+    writeMeshCache(cachePath, sourceHash, 4, flags, broken);
+    CHECK(!openMeshCache(cachePath, sourceHash, 4, flags));
+
+    // A level that isn't whole triangles is too
+    BakedMesh ragged = baked;
+    ragged.lods.levels[0].indexCount = 5;
+    writeMeshCache(cachePath, sourceHash, 4, flags, ragged);
+    CHECK(!openMeshCache(cachePath, sourceHash, 4, flags));
+
+    // ... and re-bakes
+    loadMeshCached(source, importer, false, &stats);
+    CHECK(!stats.hit && imports == 2);
+    CHECK(openMeshCache(cachePath, sourceHash, 4, flags).has_value());
+    CHECK(leftovers(directory, "quad.src.meshcache") == 1);
+
+    std::filesystem::remove_all(directory);
+    std::printf("mesh cache hits map in place and reject corrupt indices\n");
+    return check::finish();
+}
@@ -0,0 +1,152 @@
+#include "check.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+#include "../src/MeshOptimizer/meshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*
+  optimizeMesh on generated spheres, in generation order and with their triangles shuffled: the
+  output draws the same triangles with the same winding (vertices are tagged with their original
+  index in the color red, which the fetch pass carries along), the fetch remap is a permutation of
+  the referenced vertices, and ACMR never gets worse.
+*/
+namespace
+{
+using Triangle = std::array<uint32_t, 3>;
+
+// Rotated so the smallest index leads, keeping the winding; sorted, so two lists compare as sets
+std::vector<Triangle> canonical(const std::vector<uint32_t> &indices)
+{
+    std::vector<Triangle> triangles(indices.size() / 3);
+    for (size_t t = 0; t < triangles.size(); ++t)
+    {
+        Triangle triangle = {indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles[t] = triangle;
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+MeshData taggedSphere(SphereType type, uint32_t segments, bool shuffled)
+{
+    MeshData mesh = getSphere(type, segments)->toMeshData();
+    mesh.colors.resize(mesh.vertexCount());
+    for (size_t v = 0; v < mesh.vertexCount(); ++v)
+        mesh.colors[v] = {static_cast<float>(v), 0.0f, 0.0f, 1.0f};
+    if (shuffled)
+    {
+        std::vector<Triangle> triangles(mesh.triangleCount());
+        for (size_t t = 0; t < triangles.size(); ++t)
+            triangles[t] = {mesh.indices[t * 3], mesh.indices[t * 3 + 1], mesh.indices[t * 3 + 2]};
+        std::mt19937 random(27);
+        std::shuffle(triangles.begin(), triangles.end(), random);
+        for (size_t t = 0; t < triangles.size(); ++t)
+            std::copy(triangles[t].begin(), triangles[t].end(), mesh.indices.begin() + t * 3);
+    }
+    return mesh;
+}
+
+// Output triangles in original vertex numbers, through the tags; false if a position didn't travel with its tag
+bool originalIndices(const MeshData &optimized, const MeshData &original, std::vector<uint32_t> &indices)
+{
+    indices.resize(optimized.indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        const uint32_t v = optimized.indices[i];
+        const uint32_t source = static_cast<uint32_t>(optimized.colors[v].r);
+        const Position &a = optimized.positions[v];
+        const Position &b = original.positions[source];
+        if (a.x != b.x || a.y != b.y || a.z != b.z || a.w != b.w)
+            return false;
+        indices[i] = source;
+    }
+    return true;
+}
+
+bool isPermutation(const std::vector<uint32_t> &remap, size_t count)
+{
+    std::vector<bool> seen(count, false);
+    for (uint32_t target : remap)
+    {
+        if (target == UINT32_MAX)
+            continue;
+        if (target >= count || seen[target])
+            return false;
+        seen[target] = true;
+    }
+    return std::all_of(seen.begin(), seen.end(), [](bool hit) { return hit; });
+}
+} // namespace
+
+int main()
+{
+    const struct
+    {
+        SphereType type;
+        uint32_t segments;
+    } spheres[] = {{SphereType::UvSphere, 48}, {SphereType::Icosphere, 12}};
+
+    for (const auto &sphere : spheres)
+        for (bool shuffled : {false, true})
+        {
+            const MeshData original = taggedSphere(sphere.type, sphere.segments, shuffled);
+            MeshData mesh = original;
+            const MeshOptimizationReport report = optimizeMesh(mesh);
+
+            // Only unreferenced vertices are dropped (a UV sphere's pole rows have some)
+            std::vector<bool> referenced(original.vertexCount(), false);
+            for (uint32_t index : original.indices)
+                referenced[index] = true;
+            CHECK(mesh.vertexCount() == static_cast<size_t>(std::count(referenced.begin(), referenced.end(), true)));
+            CHECK(mesh.indices.size() == original.indices.size());
+            std::vector<uint32_t> indices;
+            CHECK(originalIndices(mesh, original, indices));
+            CHECK(canonical(indices) == canonical(original.indices));
+
+            CHECK(report.after.acmr <= report.before.acmr);
+            CHECK(report.after.atvr <= report.before.atvr);
+            CHECK(report.after.acmr < 1.0f);
+            if (shuffled)
+                CHECK(report.after.acmr < 0.6f * report.before.acmr);
+
+            // After the pass the fetch order is first use: the remap of the result is the identity
+            std::vector<uint32_t> remap;
+            CHECK(buildVertexFetchRemap(remap, mesh.indices.data(), mesh.indices.size(), mesh.vertexCount()) ==
+                  mesh.vertexCount());
+            bool identity = true;
+            for (size_t v = 0; v < remap.size(); ++v)
+                identity = identity && remap[v] == v;
+            CHECK(identity);
+        }
+
+    // The remap of a shuffled list is a permutation; unreferenced vertices are dropped
+    {
+        MeshData mesh = taggedSphere(SphereType::Icosphere, 6, true);
+        std::vector<uint32_t> remap;
+        CHECK(buildVertexFetchRemap(remap, mesh.indices.data(), mesh.indices.size(), mesh.vertexCount()) ==
+              mesh.vertexCount());
+        CHECK(remap.size() == mesh.vertexCount() && isPermutation(remap, mesh.vertexCount()));
+        CHECK(remap[mesh.indices[0]] == 0 && remap[mesh.indices[1]] == 1 && remap[mesh.indices[2]] == 2);
+
+        const size_t unused = mesh.vertexCount();
+        mesh.positions.push_back({9.0f, 9.0f, 9.0f, 1.0f});
+        mesh.colors.push_back({static_cast<float>(unused), 0.0f, 0.0f, 1.0f});
+        CHECK(buildVertexFetchRemap(remap, mesh.indices.data(), mesh.indices.size(), mesh.vertexCount()) == unused);
+        CHECK(remap[unused] == UINT32_MAX && isPermutation(remap, unused));
+
+        const MeshData original = mesh;
+        optimizeMesh(mesh);
+        CHECK(mesh.vertexCount() == unused);
+        std::vector<uint32_t> indices;
+        CHECK(originalIndices(mesh, original, indices));
+        CHECK(canonical(indices) == canonical(original.indices));
+    }
+
+    std::printf("optimizeMesh keeps the triangle set and never worsens ACMR\n");
+    return check::finish();
+}
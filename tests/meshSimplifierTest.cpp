@@ -0,0 +1,179 @@
+#include "check.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+#include "../src/MeshOptimizer/meshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/*
+  The simplifier against what it promises, on a unit icosphere: every LOD holds at most its
+  target triangle count, errors grow level by level, and every point of a level lies within its
+  recorded error of the sphere (plus LOD 0's own distance from it, measured with the exact closest
+  point of each triangle). simplifyMesh stops at its error budget short of the target, and a flat
+  grid keeps its outline (same area, no triangle flipped) however far it is reduced.
+*/
+namespace
+{
+struct Vec3
+{
+    double x, y, z;
+};
+
+Vec3 operator-(Vec3 a, Vec3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+Vec3 operator+(Vec3 a, Vec3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+Vec3 operator*(Vec3 a, double s) { return {a.x * s, a.y * s, a.z * s}; }
+double dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+Vec3 toVec3(const Position &p) { return {p.x, p.y, p.z}; }
+
+// Closest point of triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5)
+Vec3 closestPoint(Vec3 p, Vec3 a, Vec3 b, Vec3 c)
+{
+    const Vec3 ab = b - a, ac = c - a, ap = p - a;
+    const double d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0)
+        return a;
+    const Vec3 bp = p - b;
+    const double d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3)
+        return b;
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+        return a + ab * (d1 / (d1 - d3));
+    const Vec3 cp = p - c;
+    const double d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6)
+        return c;
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+        return a + ac * (d2 / (d2 - d6));
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    const double denom = 1.0 / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// Farthest any point of the triangles gets from the unit sphere: every vertex is on it, so the
+// deepest point is the one closest to the centre
+double sphereDeviation(const MeshData &mesh, const uint32_t *indices, size_t indexCount)
+{
+    double deviation = 0.0;
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        const Vec3 closest = closestPoint({0.0, 0.0, 0.0}, toVec3(mesh.positions[indices[i]]),
+                                          toVec3(mesh.positions[indices[i + 1]]), toVec3(mesh.positions[indices[i + 2]]));
+        deviation = std::max(deviation, 1.0 - std::sqrt(dot(closest, closest)));
+    }
+    return deviation;
+}
+
+// Signed area in xy, counter-clockwise positive
+double signedArea(const MeshData &mesh, const uint32_t *triangle)
+{
+    const Position &a = mesh.positions[triangle[0]], &b = mesh.positions[triangle[1]], &c = mesh.positions[triangle[2]];
+    return 0.5 * ((double(b.x) - a.x) * (double(c.y) - a.y) - (double(c.x) - a.x) * (double(b.y) - a.y));
+}
+
+MeshData grid(uint32_t cells)
+{
+    MeshData mesh;
+    for (uint32_t y = 0; y <= cells; ++y)
+        for (uint32_t x = 0; x <= cells; ++x)
+            mesh.positions.push_back({static_cast<float>(x) / cells, static_cast<float>(y) / cells, 0.0f, 1.0f});
+    for (uint32_t y = 0; y < cells; ++y)
+        for (uint32_t x = 0; x < cells; ++x)
+        {
+            const uint32_t a = y * (cells + 1) + x, b = a + 1, c = a + cells + 2, d = a + cells + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, c, c, d, a});
+        }
+    return mesh;
+}
+
+// Every level at most `reduction` of the one before, errors non-decreasing and bounding the geometry
+void checkChain(const MeshData &mesh, const LodChain &chain, float reduction, const char *name)
+{
+    const double baseDeviation = sphereDeviation(mesh, chain.indices.data(), chain.levels[0].indexCount);
+    bool withinTarget = true, errorsGrow = true, withinError = true;
+    for (size_t level = 1; level < chain.levels.size(); ++level)
+    {
+        const LodLevel &previous = chain.levels[level - 1], &current = chain.levels[level];
+        const size_t target = static_cast<size_t>(double(previous.indexCount / 3) * reduction) * 3;
+        withinTarget = withinTarget && current.indexCount <= target;
+        errorsGrow = errorsGrow && current.error >= previous.error;
+        const double deviation = sphereDeviation(mesh, chain.indices.data() + current.indexOffset, current.indexCount);
+        withinError = withinError && deviation <= current.error + baseDeviation;
+        std::printf("%s LOD %zu: %u triangles, error %.4f, off the sphere by %.4f\n", name, level,
+                    current.indexCount / 3, current.error, deviation);
+    }
+    CHECK(withinTarget);
+    CHECK(errorsGrow);
+    CHECK(withinError);
+}
+} // namespace
+
+int main()
+{
+    const MeshData sphere = getSphere(SphereType::Icosphere, 16)->toMeshData();
+    CHECK(sphere.indices.size() % 3 == 0);
+
+    // An unlimited error budget: every level meets its triangle target
+    {
+        SimplifyOptions options;
+        options.targetError = 1e9f;
+        const LodChain chain = buildLodChain(sphere, 8, 0.5f, options);
+        CHECK(chain.levels.size() == 8);
+        CHECK(chain.levels[0].indexCount == sphere.indices.size() && chain.levels[0].error == 0.0f);
+        checkChain(sphere, chain, 0.5f, "unbounded");
+    }
+
+    // The default budget: levels stop short of the target rather than pass their error, and a
+    // level is only kept when it saves at least a tenth
+    {
+        const LodChain chain = buildLodChain(sphere);
+        CHECK(chain.levels.size() > 2);
+        checkChain(sphere, chain, 0.9f, "default");
+    }
+
+    // simplifyMesh on its own: the target caps the count; a tight budget stops it first
+    {
+        std::vector<uint32_t> simplified;
+        float error = 0.0f;
+        SimplifyOptions loose;
+        loose.targetError = 1e9f;
+        const size_t target = sphere.indices.size() / 4 / 3 * 3;
+        CHECK(simplifyMesh(simplified, sphere, sphere.indices, target, loose, &error) == simplified.size());
+        CHECK(simplified.size() <= target && simplified.size() % 3 == 0);
+        CHECK(sphereDeviation(sphere, simplified.data(), simplified.size()) <=
+              error + sphereDeviation(sphere, sphere.indices.data(), sphere.indices.size()));
+
+        SimplifyOptions tight;
+        tight.targetError = 1e-4f;
+        simplifyMesh(simplified, sphere, sphere.indices, target, tight, &error);
+        CHECK(simplified.size() > target && error <= tight.targetError);
+    }
+
+    // A flat open grid: border vertices only slide along the border, so the outline and area stay
+    {
+        const MeshData flat = grid(32);
+        std::vector<uint32_t> simplified;
+        float error = 0.0f;
+        simplifyMesh(simplified, flat, flat.indices, 3 * 16, {}, &error);
+        CHECK(simplified.size() < flat.indices.size() / 8 && error == 0.0f);
+        double area = 0.0;
+        bool flipped = false;
+        for (size_t i = 0; i < simplified.size(); i += 3)
+        {
+            const double triangleArea = signedArea(flat, &simplified[i]);
+            flipped = flipped || triangleArea <= 0.0;
+            area += triangleArea;
+        }
+        CHECK(!flipped);
+        CHECK(std::abs(area - 1.0) < 1e-6);
+    }
+
+    std::printf("every LOD within its triangle target and error bound\n");
+    return check::finish();
+}
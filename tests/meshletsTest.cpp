@@ -0,0 +1,171 @@
+#include "check.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+#include "../src/MeshOptimizer/meshOptimizer.h"
+#include "../src/MeshOptimizer/meshlets.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/*
+  buildMeshlets on generated spheres, optimized and not, with the default limits and smaller ones:
+  no meshlet passes kMeshletMaxVertices / kMeshletMaxTriangles (or the limits asked for), local
+  indices stay inside their meshlet, every source triangle lands in exactly one meshlet with its
+  winding, every vertex is inside its meshlet's sphere, and a cluster the cone culls only holds
+  back faces. With culling off, cullMeshlets hands back the whole mesh.
+*/
+namespace
+{
+using Triangle = std::array<uint32_t, 3>;
+
+// Rotated so the smallest index leads, keeping the winding; sorted, so two lists compare as multisets
+std::vector<Triangle> canonical(const std::vector<uint32_t> &indices)
+{
+    std::vector<Triangle> triangles(indices.size() / 3);
+    for (size_t t = 0; t < triangles.size(); ++t)
+    {
+        Triangle triangle = {indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles[t] = triangle;
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// Every meshlet within the limits and self-consistent, and together they hold the source triangles once each
+void checkMeshlets(const MeshData &mesh, const MeshletSet &set, size_t maxVertices, size_t maxTriangles)
+{
+    CHECK(set.bounds.size() == set.meshlets.size());
+    bool withinLimits = true, localIndices = true, uniqueVertices = true, packed = true, reachesLimit = false;
+    bool insideBounds = true;
+    uint32_t vertexOffset = 0, triangleOffset = 0;
+    std::vector<uint32_t> decoded;
+    for (size_t m = 0; m < set.meshlets.size(); ++m)
+    {
+        const Meshlet &meshlet = set.meshlets[m];
+        withinLimits = withinLimits && meshlet.vertexCount <= maxVertices && meshlet.triangleCount <= maxTriangles &&
+                       meshlet.triangleCount > 0;
+        reachesLimit = reachesLimit || meshlet.vertexCount == maxVertices || meshlet.triangleCount == maxTriangles;
+        packed = packed && meshlet.vertexOffset == vertexOffset && meshlet.triangleOffset == triangleOffset;
+        vertexOffset += meshlet.vertexCount;
+        triangleOffset += meshlet.triangleCount * 3;
+
+        const uint32_t *vertices = &set.vertices[meshlet.vertexOffset];
+        std::vector<uint32_t> sorted(vertices, vertices + meshlet.vertexCount);
+        std::sort(sorted.begin(), sorted.end());
+        uniqueVertices = uniqueVertices && std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+
+        const MeshletBounds &bounds = set.bounds[m];
+        for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+        {
+            const Position &p = mesh.positions[vertices[i]];
+            const float dx = p.x - bounds.center[0], dy = p.y - bounds.center[1], dz = p.z - bounds.center[2];
+            insideBounds = insideBounds && std::sqrt(dx * dx + dy * dy + dz * dz) <= bounds.radius * 1.0001f;
+        }
+
+        const uint8_t *triangles = &set.triangles[meshlet.triangleOffset];
+        for (uint32_t i = 0; i < meshlet.triangleCount * 3; ++i)
+        {
+            localIndices = localIndices && triangles[i] < meshlet.vertexCount;
+            decoded.push_back(vertices[std::min<uint32_t>(triangles[i], meshlet.vertexCount - 1)]);
+        }
+    }
+    CHECK(withinLimits);
+    CHECK(reachesLimit);
+    CHECK(packed && vertexOffset == set.vertices.size() && triangleOffset == set.triangles.size());
+    CHECK(localIndices);
+    CHECK(uniqueVertices);
+    CHECK(insideBounds);
+    CHECK(canonical(decoded) == canonical(mesh.indices));
+}
+
+// Back facing under the test's view direction (+z): dot(cross(b - a, c - a), view) <= 0
+bool isBackFacing(const MeshData &mesh, const uint32_t *triangle)
+{
+    const Position &a = mesh.positions[triangle[0]], &b = mesh.positions[triangle[1]], &c = mesh.positions[triangle[2]];
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x) <= 0.0f;
+}
+} // namespace
+
+int main()
+{
+    const struct
+    {
+        SphereType type;
+        uint32_t segments;
+        bool optimized;
+    } spheres[] = {{SphereType::UvSphere, 64, false},
+                   {SphereType::UvSphere, 64, true},
+                   {SphereType::Icosphere, 24, false},
+                   {SphereType::Icosphere, 24, true}};
+    const struct
+    {
+        size_t vertices, triangles;
+    } limits[] = {{kMeshletMaxVertices, kMeshletMaxTriangles}, {32, 64}, {16, 8}, {3, 1}};
+
+    for (const auto &sphere : spheres)
+    {
+        MeshData mesh = getSphere(sphere.type, sphere.segments)->toMeshData();
+        if (sphere.optimized)
+            optimizeMesh(mesh);
+        for (const auto &limit : limits)
+            checkMeshlets(mesh, buildMeshlets(mesh, limit.vertices, limit.triangles), limit.vertices, limit.triangles);
+
+        // Culling off: the whole mesh comes back, in 16-bit indices as in 32-bit
+        const MeshletSet set = buildMeshlets(mesh);
+        ClusterCullParams everything{};
+        everything.frustumCulling = false;
+        everything.backfaceCulling = false;
+        std::vector<uint32_t> indices(mesh.indices.size());
+        std::vector<uint16_t> shortIndices(mesh.indices.size());
+        ClusterCullStats stats;
+        CHECK(cullMeshlets(indices.data(), set, everything, &stats) == mesh.indices.size());
+        CHECK(stats.visibleClusters == set.meshlets.size());
+        CHECK(stats.visibleTriangles == mesh.triangleCount() && stats.totalTriangles == mesh.triangleCount());
+        CHECK(canonical(indices) == canonical(mesh.indices));
+        CHECK(cullMeshlets(shortIndices.data(), set, everything) == mesh.indices.size());
+        CHECK(std::equal(indices.begin(), indices.end(), shortIndices.begin()));
+
+        // Looking down +z: a culled cluster holds nothing but back faces, and some clusters go
+        ClusterCullParams backfaces{};
+        backfaces.frustumCulling = false;
+        backfaces.viewDirection[2] = 1.0f;
+        bool onlyBackFaces = true;
+        for (size_t m = 0; m < set.meshlets.size(); ++m)
+        {
+            if (!isMeshletCulled(set.bounds[m], backfaces))
+                continue;
+            const Meshlet &meshlet = set.meshlets[m];
+            for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+            {
+                const uint8_t *local = &set.triangles[meshlet.triangleOffset + t * 3];
+                const uint32_t *vertices = &set.vertices[meshlet.vertexOffset];
+                const uint32_t triangle[3] = {vertices[local[0]], vertices[local[1]], vertices[local[2]]};
+                onlyBackFaces = onlyBackFaces && isBackFacing(mesh, triangle);
+            }
+        }
+        CHECK(onlyBackFaces);
+        cullMeshlets(indices.data(), set, backfaces, &stats);
+        CHECK(stats.visibleTriangles < stats.totalTriangles && stats.visibleTriangles > 0);
+
+        // A plane with the whole sphere behind it culls every cluster
+        ClusterCullParams outside{};
+        outside.backfaceCulling = false;
+        for (auto &plane : outside.planes)
+            plane[3] = 1.0f;
+        outside.planes[0][0] = 1.0f;
+        outside.planes[0][3] = -2.0f;       // inside when x >= 2
+        CHECK(cullMeshlets(indices.data(), set, outside, &stats) == 0 && stats.visibleClusters == 0);
+    }
+
+    // Local indices are 8-bit: a larger vertex limit is held to 255
+    {
+        const MeshData mesh = getSphere(SphereType::Icosphere, 24)->toMeshData();
+        checkMeshlets(mesh, buildMeshlets(mesh, 1000, 255), 255, 255);
+    }
+
+    std::printf("every triangle in exactly one meshlet, within the vertex and triangle limits\n");
+    return check::finish();
+}
@@ -0,0 +1,157 @@
+#include "check.h"
+#include "../src/Procedural/proceduralShapes.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/*
+  The CPU reference against vertex_procedural itself: CMake copies the procedural section of
+  shaders.metal into proceduralShader.inc and it compiles here against just enough of the Metal
+  types. Every vertex must match bit for bit, including unknown kinds and clamped segment counts.
+*/
+namespace shader
+{
+using uint = uint32_t;
+
+struct float2
+{
+    float x, y;
+    float2(float v = 0.0f) : x(v), y(v) {}
+    float2(float x, float y) : x(x), y(y) {}
+    float2 operator*(float s) const { return {x * s, y * s}; }
+};
+using packed_float2 = float2;
+
+struct uint2
+{
+    uint x, y;
+};
+
+struct float4
+{
+    float x, y, z, w;
+    float4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    float4 operator*(float s) const { return {x * s, y * s, z * s, w * s}; }
+};
+
+// The transform runs after the reference's output; the test only binds the identity
+struct float4x4
+{
+    float4 operator*(const float4 &v) const { return v; }
+};
+
+struct VertexOut
+{
+    float4 position{0.0f, 0.0f, 0.0f, 0.0f};
+    float4 color{0.0f, 0.0f, 0.0f, 0.0f};
+};
+
+inline uint clamp(uint v, uint lo, uint hi) { return v < lo ? lo : (v > hi ? hi : v); }
+inline float fma(float a, float b, float c) { return std::fma(a, b, c); }
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunknown-attributes"
+#elif defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#endif
+#define constant const
+#define vertex
+#include "proceduralShader.inc"
+#undef vertex
+#undef constant
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#elif defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+static_assert(sizeof(ProceduralInstance) == sizeof(::ProceduralInstance), "Shader and CPU layouts differ");
+} // namespace shader
+
+namespace
+{
+bool sameBits(const float *a, const float *b)
+{
+    return std::memcmp(a, b, 4 * sizeof(float)) == 0;
+}
+
+size_t compareInstance(const ProceduralInstance &instance, uint32_t vertexCount)
+{
+    shader::ProceduralInstance gpu;
+    gpu.center = {instance.center[0], instance.center[1]};
+    gpu.radius = instance.radius;
+    gpu.kind = instance.kind;
+    gpu.segments = instance.segments;
+    gpu.color = instance.color;
+    gpu.padding = {instance.padding[0], instance.padding[1]};
+    const shader::float4x4 identity;
+
+    size_t mismatches = 0;
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        const ProceduralVertex cpu = generateProceduralVertex(instance, v);
+        const shader::VertexOut out = shader::vertex_procedural(&gpu, identity, v, 0);
+        const float position[4] = {out.position.x, out.position.y, out.position.z, out.position.w};
+        const float color[4] = {out.color.x, out.color.y, out.color.z, out.color.w};
+        if (!sameBits(cpu.position, position) || !sameBits(cpu.color, color))
+            ++mismatches;
+    }
+    return mismatches;
+}
+} // namespace
+
+int main()
+{
+    for (uint32_t phase = 0; phase < 65536; ++phase)
+        CHECK(sinPhaseQ15(phase) == shader::sinPhaseQ15(phase));
+
+    std::mt19937 random(30);
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.001f, 0.5f);
+
+    const uint32_t kinds[] = {0, 1, 2, 3, 7, 0xffffffffu};
+    const uint32_t segmentCounts[] = {0, 1, 3, 4, 7, 100, 1000, 65535, 70000};
+    for (uint32_t kind : kinds)
+    {
+        for (uint32_t segments : segmentCounts)
+        {
+            ProceduralInstance instance{};
+            instance.center[0] = coordinate(random);
+            instance.center[1] = coordinate(random);
+            instance.radius = size(random);
+            instance.kind = kind;
+            instance.segments = segments;
+            instance.color = static_cast<uint32_t>(random());
+
+            // A few spare vertices past the shape's own, as drawn in a batch with larger shapes
+            const uint32_t count = verticesPerInstance(instance);
+            CHECK(compareInstance(instance, count + 6) == 0);
+            CHECK(kind <= 2 ? count > 0 : count == 0);
+
+            // Unknown kinds draw nothing: every vertex on the center
+            if (kind > 2)
+            {
+                const ProceduralVertex vertex = generateProceduralVertex(instance, 1);
+                CHECK(vertex.position[0] == instance.center[0] && vertex.position[1] == instance.center[1]);
+            }
+        }
+    }
+
+    // Every color channel value
+    ProceduralInstance instance{};
+    instance.radius = 0.25f;
+    instance.kind = static_cast<uint32_t>(ShapeKind::Quad);
+    for (uint32_t value = 0; value < 256; ++value)
+    {
+        instance.color = value * 0x01010101u;
+        CHECK(compareInstance(instance, 1) == 0);
+    }
+
+    std::printf("vertex_procedural matches the CPU reference\n");
+    return check::finish();
+}
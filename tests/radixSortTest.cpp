@@ -0,0 +1,122 @@
+#include "check.h"
+#include "../src/common/radixSort.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+/*
+  FloatRadixSort against std::stable_sort, bit for bit, at several sizes (either side of
+  kMinKeysPerTask) and thread counts: ties keep their order, -0 sorts just below +0, infinities
+  at the ends and NaNs beyond them by sign. Nearby keys skip the passes they all share.
+*/
+namespace
+{
+uint32_t bitsOf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Float order with -0 below +0, the order the sorter promises for non-NaN keys
+bool before(float a, float b)
+{
+    return a < b || (a == b && std::signbit(a) && !std::signbit(b));
+}
+
+std::vector<float> keysFor(size_t count, std::mt19937 &random)
+{
+    // Few distinct values so ties are common, plus signed zeros and infinities
+    const float special[] = {0.0f, -0.0f, std::numeric_limits<float>::infinity(),
+                             -std::numeric_limits<float>::infinity(), 1e-30f, -1e-30f};
+    std::uniform_int_distribution<int> pick(0, 15);
+    std::uniform_real_distribution<float> value(-1000.0f, 1000.0f);
+    std::vector<float> keys(count);
+    for (float &key : keys)
+    {
+        const int choice = pick(random);
+        key = choice < 6 ? special[choice] : (choice < 10 ? std::round(value(random) / 100.0f) : value(random));
+    }
+    return keys;
+}
+
+bool matchesStableSort(std::vector<float> keys, unsigned threads, RadixSortStats *stats = nullptr)
+{
+    std::vector<uint32_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::vector<uint32_t> expected = order;
+    std::stable_sort(expected.begin(), expected.end(), [&keys](uint32_t a, uint32_t b) { return before(keys[a], keys[b]); });
+
+    const std::vector<float> original = keys;
+    FloatRadixSort sorter(threads);
+    sorter.sort(keys, order);
+    if (stats)
+        *stats = sorter.getStats();
+
+    for (size_t i = 0; i < keys.size(); ++i)
+        if (order[i] != expected[i] || bitsOf(keys[i]) != bitsOf(original[expected[i]]))
+            return false;
+    return true;
+}
+} // namespace
+
+int main()
+{
+    std::mt19937 random(50);
+    const size_t sizes[] = {0, 1, 2, 200, FloatRadixSort::kMinKeysPerTask - 1, 3 * FloatRadixSort::kMinKeysPerTask + 7};
+    for (size_t count : sizes)
+        for (unsigned threads : {1u, 2u, 3u, 8u})
+            CHECK(matchesStableSort(keysFor(count, random), threads));
+
+    // Large inputs split into tasks, and the split doesn't change the result
+    RadixSortStats stats;
+    CHECK(matchesStableSort(keysFor(4 * FloatRadixSort::kMinKeysPerTask, random), 4, &stats));
+    CHECK(stats.keys == 4 * FloatRadixSort::kMinKeysPerTask && stats.tasks == 4);
+    CHECK(stats.passes + stats.skippedPasses == 4);
+
+    // Depths in [1, 2) share their exponent: the top byte's pass is skipped
+    {
+        std::uniform_real_distribution<float> depth(1.0f, 2.0f);
+        std::vector<float> keys(1000);
+        for (float &key : keys)
+            key = depth(random);
+        CHECK(matchesStableSort(keys, 1, &stats));
+        CHECK(stats.skippedPasses >= 1 && stats.tasks == 1);
+    }
+
+    // NaNs go past the infinities on their sign's side
+    {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        const float inf = std::numeric_limits<float>::infinity();
+        std::vector<float> keys = {1.0f, nan, -inf, -nan, inf, -1.0f};
+        std::vector<uint32_t> values = {0, 1, 2, 3, 4, 5};
+        FloatRadixSort sorter(1);
+        sorter.sort(keys, values);
+        const std::vector<uint32_t> expected = {3, 2, 5, 0, 4, 1};
+        CHECK(values == expected);
+    }
+
+    // Mismatched spans
+    bool threw = false;
+    try
+    {
+        std::vector<float> keys(3);
+        std::vector<uint32_t> values(2);
+        FloatRadixSort().sort(keys, values);
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+
+    std::printf("radix sort matches std::stable_sort\n");
+    return check::finish();
+}
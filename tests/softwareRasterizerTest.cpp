@@ -0,0 +1,98 @@
+#include "check.h"
+#include "../src/Draw/softwareRasterizer.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*
+  SoftwareRasterizer's counters on scenes with known answers: full-screen layers shade every pixel
+  once per layer without depth and once in total front to back (the far layer rejected a tile at
+  a time), and a jittered mesh of shared edges shades each pixel exactly once (fill rule).
+*/
+namespace
+{
+constexpr uint32_t kWidth = 64;
+constexpr uint32_t kHeight = 48;
+constexpr uint64_t kPixels = uint64_t{kWidth} * kHeight;
+
+// A clip-space square past the screen edges, at depth `z`
+Eigen::Matrix4f layer(float z)
+{
+    Eigen::Matrix4f transform = Eigen::Matrix4f::Identity();
+    transform(0, 0) = transform(1, 1) = 3.0f;
+    transform(2, 3) = z;
+    return transform;
+}
+} // namespace
+
+int main()
+{
+    const std::vector<float> quad = {-0.5f, -0.5f, 0, 1, 0.5f, -0.5f, 0, 1, 0.5f, 0.5f, 0, 1, -0.5f, 0.5f, 0, 1};
+    const std::vector<uint32_t> quadIndices = {0, 1, 2, 2, 3, 0};
+    SoftwareRasterizer rasterizer(kWidth, kHeight);
+
+    // No depth attachment: both layers shade everything
+    rasterizer.drawTriangles(quad, quadIndices, layer(0.2f), false);
+    rasterizer.drawTriangles(quad, quadIndices, layer(0.6f), false);
+    CHECK(rasterizer.getStats().fragmentsShaded == 2 * kPixels);
+    CHECK(rasterizer.getCoveredPixels() == kPixels && rasterizer.getOverdraw() == 2.0);
+
+    // Front to back: the far layer is rejected tile by tile without testing a pixel
+    rasterizer.clear();
+    rasterizer.drawTriangles(quad, quadIndices, layer(0.2f));
+    const RasterStats nearOnly = rasterizer.getStats();
+    rasterizer.drawTriangles(quad, quadIndices, layer(0.6f));
+    const RasterStats &frontToBack = rasterizer.getStats();
+    CHECK(frontToBack.fragmentsShaded == kPixels && rasterizer.getOverdraw() == 1.0);
+    CHECK(frontToBack.fragmentsTested == nearOnly.fragmentsTested);
+    CHECK(frontToBack.tilesRejected - nearOnly.tilesRejected == frontToBack.tilesTested - nearOnly.tilesTested);
+
+    // Back to front: everything shades twice and the near depth stays
+    rasterizer.clear();
+    rasterizer.drawTriangles(quad, quadIndices, layer(0.6f));
+    rasterizer.drawTriangles(quad, quadIndices, layer(0.2f));
+    CHECK(rasterizer.getStats().fragmentsShaded == 2 * kPixels);
+    bool nearDepth = true;
+    for (float d : rasterizer.getDepth())
+        nearDepth = nearDepth && d == 0.2f;
+    CHECK(nearDepth);
+
+    // A jittered grid of shared edges: pixels on an edge go to exactly one side
+    {
+        const int cells = 7;
+        std::mt19937 random(49);
+        std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+        std::vector<float> grid;
+        for (int y = 0; y <= cells; ++y)
+            for (int x = 0; x <= cells; ++x)
+            {
+                const bool inner = x > 0 && x < cells && y > 0 && y < cells;
+                grid.push_back(-1.0f + 2.0f * (static_cast<float>(x) + (inner ? jitter(random) : 0.0f)) / cells);
+                grid.push_back(-1.0f + 2.0f * (static_cast<float>(y) + (inner ? jitter(random) : 0.0f)) / cells);
+                grid.push_back(0.5f);
+                grid.push_back(1.0f);
+            }
+        std::vector<uint32_t> gridIndices;
+        for (uint32_t y = 0; y < cells; ++y)
+            for (uint32_t x = 0; x < cells; ++x)
+            {
+                const uint32_t a = y * (cells + 1) + x, b = a + 1, c = a + cells + 2, d = a + cells + 1;
+                gridIndices.insert(gridIndices.end(), {a, b, c, c, d, a});
+            }
+        rasterizer.clear();
+        rasterizer.drawTriangles(grid, gridIndices, Eigen::Matrix4f::Identity(), false);
+        CHECK(rasterizer.getCoveredPixels() == kPixels);
+        CHECK(rasterizer.getStats().fragmentsShaded == kPixels);
+    }
+
+    // Behind the eye: dropped whole
+    rasterizer.clear();
+    Eigen::Matrix4f behind = Eigen::Matrix4f::Identity();
+    behind(3, 3) = -1.0f;
+    rasterizer.drawTriangles(quad, quadIndices, behind);
+    CHECK(rasterizer.getStats().trianglesRejected == 2 && rasterizer.getStats().fragmentsShaded == 0);
+
+    std::printf("software rasterizer counts fragments and overdraw exactly\n");
+    return check::finish();
+}
@@ -0,0 +1,213 @@
+#include "check.h"
+#include "../src/MeshGenerator/meshGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+  The generated geometry, then getSphere's memo under a byte budget.
+
+  Geometry: vertex and index counts match sphereCounts (and the closed forms written out below),
+  every vertex sits on the sphere with its unit normal, the surface is closed (once the UV
+  sphere's seam and pole copies are welded, every edge is shared by exactly two triangles, once in
+  each direction) and every triangle winds counter-clockwise seen from outside. The thread count
+  doesn't change the output.
+
+  Memo: repeated calls share one sphere, the least recently used one goes first when the budget
+  runs out, a sphere larger than the budget is never kept, and geometry a caller still holds
+  survives eviction.
+*/
+namespace
+{
+size_t bytesOf(const SphereGeometry &sphere)
+{
+    return sphere.positions.size() * sizeof(float) + sphere.normals.size() * sizeof(float) +
+           sphere.indices.size() * sizeof(uint32_t);
+}
+
+struct Generated
+{
+    std::vector<float> positions, normals;
+    std::vector<uint32_t> indices;
+};
+
+Generated generate(SphereType type, uint32_t segments, float radius, unsigned threads)
+{
+    const SphereCounts counts = sphereCounts(type, segments);
+    Generated sphere;
+    sphere.positions.resize(counts.vertexCount * 4);
+    sphere.normals.resize(counts.vertexCount * 3);
+    sphere.indices.resize(counts.indexCount);
+    generateSphere(type, segments, radius, sphere.positions.data(), sphere.normals.data(), sphere.indices.data(),
+                   threads);
+    return sphere;
+}
+
+// Vertex -> the first vertex at the same place (within `tolerance`), so seams and poles share one id
+std::vector<uint32_t> weld(const std::vector<float> &positions, float tolerance)
+{
+    const size_t count = positions.size() / 4;
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return positions[a * 4] < positions[b * 4]; });
+
+    std::vector<uint32_t> welded(count);
+    std::iota(welded.begin(), welded.end(), 0u);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float *a = &positions[order[i] * 4];
+        for (size_t j = i + 1; j < count && positions[order[j] * 4] - a[0] <= tolerance; ++j)
+        {
+            const float *b = &positions[order[j] * 4];
+            if (std::abs(a[1] - b[1]) <= tolerance && std::abs(a[2] - b[2]) <= tolerance)
+            {
+                const uint32_t low = std::min(welded[order[i]], welded[order[j]]);
+                welded[order[i]] = welded[order[j]] = low;
+            }
+        }
+    }
+    // Chains (a ~ b ~ c) settle on their smallest id
+    for (uint32_t &id : welded)
+        while (welded[id] != id)
+            id = welded[id];
+    return welded;
+}
+
+// Every directed edge once and its reverse once: closed, manifold and consistently wound
+bool isClosed(const Generated &sphere, const std::vector<uint32_t> &welded)
+{
+    std::map<std::pair<uint32_t, uint32_t>, int> edges;
+    for (size_t i = 0; i < sphere.indices.size(); i += 3)
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t a = welded[sphere.indices[i + k]], b = welded[sphere.indices[i + (k + 1) % 3]];
+            if (a == b)
+                return false;       // degenerate after welding
+            ++edges[{a, b}];
+        }
+    for (const auto &[edge, uses] : edges)
+    {
+        const auto reverse = edges.find({edge.second, edge.first});
+        if (uses != 1 || reverse == edges.end() || reverse->second != 1)
+            return false;
+    }
+    return true;
+}
+
+// Counter-clockwise from outside: the face normal points away from the centre
+bool facesOutward(const Generated &sphere)
+{
+    const float *p = sphere.positions.data();
+    for (size_t i = 0; i < sphere.indices.size(); i += 3)
+    {
+        const float *a = &p[sphere.indices[i] * 4], *b = &p[sphere.indices[i + 1] * 4], *c = &p[sphere.indices[i + 2] * 4];
+        const double e1[3] = {double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2]};
+        const double e2[3] = {double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2]};
+        const double n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        const double centroid[3] = {double(a[0]) + b[0] + c[0], double(a[1]) + b[1] + c[1], double(a[2]) + b[2] + c[2]};
+        if (n[0] * centroid[0] + n[1] * centroid[1] + n[2] * centroid[2] <= 0.0)
+            return false;
+    }
+    return true;
+}
+
+bool onSphere(const Generated &sphere, float radius)
+{
+    for (size_t v = 0; v < sphere.positions.size() / 4; ++v)
+    {
+        const float *p = &sphere.positions[v * 4], *n = &sphere.normals[v * 3];
+        const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (std::abs(length - 1.0f) > 1e-5f || p[3] != 1.0f)
+            return false;
+        for (int k = 0; k < 3; ++k)
+            if (std::abs(p[k] - n[k] * radius) > 1e-5f * radius)
+                return false;
+    }
+    return true;
+}
+
+void checkGeometry(SphereType type, uint32_t segments, size_t vertexCount, size_t indexCount)
+{
+    const SphereCounts counts = sphereCounts(type, segments);
+    CHECK(counts.vertexCount == vertexCount && counts.indexCount == indexCount);
+
+    const float radius = 2.5f;
+    const Generated sphere = generate(type, segments, radius, 1);
+    bool inRange = true;
+    for (uint32_t index : sphere.indices)
+        inRange = inRange && index < vertexCount;
+    CHECK(inRange);
+    CHECK(onSphere(sphere, radius));
+    CHECK(isClosed(sphere, weld(sphere.positions, 1e-5f * radius)));
+    CHECK(facesOutward(sphere));
+
+    // Bands / faces split across threads write the same buffers
+    const Generated threaded = generate(type, segments, radius, 4);
+    CHECK(threaded.positions == sphere.positions && threaded.normals == sphere.normals &&
+          threaded.indices == sphere.indices);
+}
+} // namespace
+
+int main()
+{
+    // UV: (segments + 1)^2 vertices with the seam and pole copies, 2 * segments * (segments - 1)
+    // triangles. Ico: 10 * segments^2 + 2 vertices, 20 * segments^2 triangles.
+    checkGeometry(SphereType::UvSphere, 3, 16, 36);
+    checkGeometry(SphereType::UvSphere, 4, 25, 72);
+    checkGeometry(SphereType::UvSphere, 10, 121, 540);
+    checkGeometry(SphereType::UvSphere, 100, 10201, 59400);
+    checkGeometry(SphereType::Icosphere, 1, 12, 60);
+    checkGeometry(SphereType::Icosphere, 2, 42, 240);
+    checkGeometry(SphereType::Icosphere, 7, 492, 2940);
+    checkGeometry(SphereType::Icosphere, 40, 16002, 96000);
+
+    bool rejected = false;
+    try
+    {
+        sphereCounts(SphereType::UvSphere, 2);
+    }
+    catch (const std::invalid_argument &)
+    {
+        rejected = true;
+    }
+    CHECK(rejected);
+
+    clearSphereCache();
+    CHECK(getSphereCacheBytes() == 0);
+
+    const std::shared_ptr<const SphereGeometry> a = getSphere(SphereType::Icosphere, 8);
+    CHECK(getSphere(SphereType::Icosphere, 8) == a);
+    CHECK(getSphereCacheBytes() == bytesOf(*a));
+
+    // Room for a and b, not c: touching a makes b the oldest
+    const std::shared_ptr<const SphereGeometry> b = getSphere(SphereType::UvSphere, 16);
+    setSphereCacheBudget(bytesOf(*a) + bytesOf(*b) + 1024);
+    getSphere(SphereType::Icosphere, 8);
+    const std::shared_ptr<const SphereGeometry> c = getSphere(SphereType::UvSphere, 12);
+    CHECK(getSphereCacheBytes() <= bytesOf(*a) + bytesOf(*b) + 1024);
+    CHECK(getSphere(SphereType::Icosphere, 8) == a);
+    CHECK(getSphere(SphereType::UvSphere, 12) == c);
+    CHECK(getSphere(SphereType::UvSphere, 16) != b);        // regenerated
+    CHECK(b->indices.size() == sphereCounts(SphereType::UvSphere, 16).indexCount);
+
+    // Too large for the budget: generated, returned, not kept
+    setSphereCacheBudget(bytesOf(*a));
+    CHECK(getSphereCacheBytes() <= bytesOf(*a));
+    const std::shared_ptr<const SphereGeometry> large = getSphere(SphereType::Icosphere, 32);
+    CHECK(large && getSphere(SphereType::Icosphere, 32) != large);
+    CHECK(getSphereCacheBytes() <= bytesOf(*a));
+
+    setSphereCacheBudget(0);
+    CHECK(getSphereCacheBytes() == 0);
+    CHECK(a->vertexCount() == sphereCounts(SphereType::Icosphere, 8).vertexCount);
+
+    std::printf("spheres closed and wound outward, memo within its budget\n");
+    return check::finish();
+}
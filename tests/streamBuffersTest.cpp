@@ -0,0 +1,166 @@
+#include "check.h"
+#include "../src/Primitive/streamBuffers.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/*
+  Primitive's buffer creation paths over a heap-backed device that counts every copy it makes:
+  builders must write straight into buffer memory, adopted memory must become the buffer itself,
+  and a span costs exactly one copy (Float4) or none (encoded in place). The creation stats must
+  agree with what the device saw.
+*/
+namespace
+{
+struct HeapBlock
+{
+    std::vector<char> owned;
+    void *data{nullptr};
+    size_t size{0};
+};
+
+struct HeapDevice
+{
+    using Buffer = std::shared_ptr<HeapBlock>;
+
+    size_t allocations{0};
+    size_t copies{0};
+    size_t wraps{0};
+
+    Buffer newBuffer(size_t bytes)
+    {
+        auto block = std::make_shared<HeapBlock>();
+        block->owned.resize(bytes);
+        block->data = block->owned.data();
+        block->size = bytes;
+        ++allocations;
+        return block;
+    }
+    Buffer newBuffer(const void *source, size_t bytes)
+    {
+        Buffer block = newBuffer(bytes);
+        std::memcpy(block->data, source, bytes);
+        ++copies;
+        return block;
+    }
+    Buffer newBufferNoCopy(void *memory, size_t bytes)
+    {
+        auto block = std::make_shared<HeapBlock>();
+        block->data = memory;
+        block->size = bytes;
+        ++wraps;
+        return block;
+    }
+    static void *contents(const Buffer &buffer) { return buffer->data; }
+    static void didModify(const Buffer &, size_t) {}
+};
+
+constexpr size_t kCount = 1000;
+
+std::vector<float> ramp(float w)
+{
+    std::vector<float> values(kCount * 4);
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        values[i * 4 + 0] = static_cast<float>(i) * 0.001f;
+        values[i * 4 + 1] = 1.0f - static_cast<float>(i) * 0.001f;
+        values[i * 4 + 2] = 0.5f;
+        values[i * 4 + 3] = w;
+    }
+    return values;
+}
+
+void fillRamp(std::span<float> values)
+{
+    const std::vector<float> source = ramp(1.0f);
+    std::copy(source.begin(), source.end(), values.begin());
+}
+} // namespace
+
+int main()
+{
+    const std::vector<float> xyzw = ramp(1.0f);
+    const size_t floatBytes = kCount * 4 * sizeof(float);
+    VertexDequant dequant;
+    Bounds bounds;
+
+    // Span, Float4: one copy, by the device
+    {
+        StreamBuffers<HeapDevice> buffers{HeapDevice{}};
+        const auto buffer = buffers.positions(PositionFormat::Float4, xyzw, dequant, bounds);
+        CHECK(buffers.getDevice().copies == 1 && buffers.getDevice().allocations == 1);
+        CHECK(buffers.stats.allocations == 1 && buffers.stats.bytesCopied == floatBytes);
+        CHECK(buffers.stats.stagingAllocations == 0 && buffers.stats.bytesAdopted == 0);
+        CHECK(std::memcmp(buffer->data, xyzw.data(), floatBytes) == 0);
+        CHECK(bounds.box.min[0] == 0.0f && bounds.box.max[1] == 1.0f);
+    }
+
+    // Span, compact: encoded in place, no copy
+    {
+        StreamBuffers<HeapDevice> buffers{HeapDevice{}};
+        buffers.positions(PositionFormat::Half4, xyzw, dequant, bounds);
+        buffers.colors(ColorFormat::Unorm8x4, xyzw);
+        CHECK(buffers.getDevice().copies == 0 && buffers.getDevice().allocations == 2);
+        CHECK(buffers.stats.allocations == 2 && buffers.stats.bytesCopied == 0 && buffers.stats.stagingAllocations == 0);
+        CHECK(buffers.stats.bytesAllocated == kCount * (positionStride(PositionFormat::Half4) + colorStride(ColorFormat::Unorm8x4)));
+    }
+
+    // Builder, Float4: the writer gets the buffer's own memory
+    {
+        StreamBuffers<HeapDevice> buffers{HeapDevice{}};
+        const float *written = nullptr;
+        const auto buffer = buffers.positions(PositionFormat::Float4, kCount, [&written](std::span<float> values) {
+            written = values.data();
+            fillRamp(values);
+        }, dequant, bounds);
+        CHECK(written == buffer->data);
+        const float *colorsWritten = nullptr;
+        const auto colors = buffers.colors(ColorFormat::Float4, kCount, [&colorsWritten](std::span<float> values) {
+            colorsWritten = values.data();
+            fillRamp(values);
+        });
+        CHECK(colorsWritten == colors->data);
+        CHECK(buffers.getDevice().copies == 0 && buffers.getDevice().allocations == 2);
+        CHECK(buffers.stats.allocations == 2 && buffers.stats.bytesAllocated == 2 * floatBytes);
+        CHECK(buffers.stats.bytesCopied == 0 && buffers.stats.stagingAllocations == 0);
+        CHECK(std::memcmp(buffer->data, xyzw.data(), floatBytes) == 0);
+        CHECK(bounds.box.min[0] == 0.0f && bounds.box.max[1] == 1.0f);
+    }
+
+    // Builder, compact: staged once, still no copy
+    {
+        StreamBuffers<HeapDevice> buffers{HeapDevice{}};
+        buffers.positions(PositionFormat::Half4, kCount, fillRamp, dequant, bounds);
+        CHECK(buffers.getDevice().copies == 0);
+        CHECK(buffers.stats.allocations == 1 && buffers.stats.bytesCopied == 0 && buffers.stats.stagingAllocations == 1);
+        CHECK(bounds.box.max[1] == 1.0f);
+    }
+
+    // Adopted: the caller's pages are the buffer
+    {
+        StreamBuffers<HeapDevice> buffers{HeapDevice{}};
+        const std::shared_ptr<void> memory = allocatePageAligned(floatBytes);
+        fillRamp(std::span<float>(static_cast<float *>(memory.get()), kCount * 4));
+        const auto buffer = buffers.adopted(memory.get(), floatBytes);
+        CHECK(buffer->data == memory.get() && buffer->size == roundUpToPage(floatBytes));
+        CHECK(buffers.getDevice().copies == 0 && buffers.getDevice().allocations == 0 && buffers.getDevice().wraps == 1);
+        CHECK(buffers.stats.allocations == 0 && buffers.stats.bytesCopied == 0 && buffers.stats.bytesAdopted == floatBytes);
+
+        bool threw = false;
+        try
+        {
+            buffers.adopted(static_cast<char *>(memory.get()) + 16, 64);
+        }
+        catch (const std::runtime_error &)
+        {
+            threw = true;
+        }
+        CHECK(threw && buffers.getDevice().wraps == 1);
+    }
+
+    std::printf("builders and adopted memory create buffers without a copy\n");
+    return check::finish();
+}
@@ -0,0 +1,128 @@
+#include "check.h"
+#include "../src/Tessellation/triangulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+/*
+  triangulatePolygon over the degenerate outlines it claims to handle: the triangles must cover
+  the polygon exactly (triangulationAreaError ~0), index only real vertices and all wind
+  counter-clockwise. Self-intersecting input has no exact answer over the input vertices; the
+  bowtie only has to come back with valid indices.
+*/
+namespace
+{
+constexpr double kTolerance = 1e-9;
+
+struct Result
+{
+    std::vector<uint32_t> indices;
+    TriangulationStats stats;
+    double error{0.0};
+    bool valid{true};               // Indices in range, no clockwise triangle
+};
+
+Result triangulate(const std::vector<float> &xy, const std::vector<uint32_t> &holeStarts = {})
+{
+    Result r;
+    triangulatePolygon(xy, holeStarts, r.indices, &r.stats);
+    r.error = triangulationAreaError(xy, holeStarts, r.indices);
+    for (size_t t = 0; t + 2 < r.indices.size(); t += 3)
+    {
+        const uint32_t a = r.indices[t], b = r.indices[t + 1], c = r.indices[t + 2];
+        if (std::max({a, b, c}) >= xy.size() / 2)
+        {
+            r.valid = false;
+            break;
+        }
+        const double cross = (double(xy[2 * b]) - xy[2 * a]) * (double(xy[2 * c + 1]) - xy[2 * a + 1]) -
+                             (double(xy[2 * b + 1]) - xy[2 * a + 1]) * (double(xy[2 * c]) - xy[2 * a]);
+        r.valid = r.valid && cross >= 0.0;
+    }
+    return r;
+}
+
+bool exact(const std::vector<float> &xy, const std::vector<uint32_t> &holeStarts = {})
+{
+    const Result r = triangulate(xy, holeStarts);
+    return r.valid && r.error < kTolerance && !r.indices.empty();
+}
+} // namespace
+
+int main()
+{
+    // Either winding
+    CHECK(exact({0, 0, 4, 0, 4, 1, 0, 1}));
+    CHECK(exact({0, 1, 4, 1, 4, 0, 0, 0}));
+
+    // Duplicate and collinear vertices, including a closing duplicate
+    CHECK(exact({0, 0, 0, 0, 2, 0, 4, 0, 4, 0, 4, 1, 2, 1, 0, 1, 0, 0}));
+
+    // Zero-width collinear spikes: into the polygon, out of it, and from an edge's midpoint
+    CHECK(exact({0, 0, 4, 0, 4, 1, 2, 1, 2, 0.5f, 3, 0.5f, 2, 0.5f, 0, 1}));
+    CHECK(exact({0, 0, 4, 0, 4, 1, 0, 1, 0, 0.5f, 2, 0.5f, 0, 0.5f}));
+    CHECK(exact({0, 0, 2, 0, 2, 0.5f, 3, 0.5f, 2, 0.5f, 2, 1, 0, 1}));
+    CHECK(exact({0, 0, 4, 0, 4, 1, 2, 1, 2, 0.5f, 2, 1, 0, 1}));
+
+    // Outline touching itself at a vertex: two squares sharing a corner, as one ring
+    CHECK(exact({0, 0, 1, 0, 1, 1, 2, 1, 2, 2, 1, 2, 1, 1, 0, 1}));
+
+    // Holes touching the outline, touching each other, and a single-vertex hole
+    CHECK(exact({0, 0, 4, 0, 4, 4, 0, 4, 0, 1, 1, 2, 0, 3}, {4}));
+    CHECK(exact({0, 0, 6, 0, 6, 4, 0, 4, 1, 1, 3, 1, 3, 3, 1, 3, 3, 1, 5, 1, 5, 3, 3, 3}, {4, 8}));
+    CHECK(exact({0, 0, 4, 0, 4, 4, 0, 4, 2, 2}, {4}));
+
+    // A hole with a spike of its own
+    CHECK(exact({0, 0, 6, 0, 6, 6, 0, 6, 2, 2, 4, 2, 4, 3, 5, 3, 4, 3, 4, 4, 2, 4}, {4}));
+
+    // Nothing to fill: a line and a lone point give no triangles
+    CHECK(triangulate({0, 0, 1, 1, 2, 2}).indices.empty());
+    CHECK(triangulate({1, 1}).indices.empty());
+
+    // A large jittered star goes through the reflex grid and stays exact
+    {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> jitter(0.8f, 1.2f);
+        std::vector<float> star;
+        const size_t points = 5000;
+        for (size_t i = 0; i < points; ++i)
+        {
+            const double angle = 2.0 * M_PI * static_cast<double>(i) / points;
+            const float radius = jitter(random) * (i % 2 ? 0.5f : 1.0f);
+            star.push_back(radius * static_cast<float>(std::cos(angle)));
+            star.push_back(radius * static_cast<float>(std::sin(angle)));
+        }
+        const Result r = triangulate(star);
+        CHECK(r.stats.indexed && r.valid);
+        CHECK(r.error < 1e-6);
+        CHECK(r.stats.triangles == points - 2);
+    }
+
+    // Bowtie: its lobes meet at a point that is not an input vertex, so only valid indices are promised
+    {
+        const Result r = triangulate({0, 0, 1, 1, 1, 0, 0, 1});
+        CHECK(r.valid);
+    }
+
+    // Hole starts out of order
+    bool threw = false;
+    try
+    {
+        std::vector<uint32_t> indices;
+        const std::vector<float> xy = {0, 0, 4, 0, 4, 4, 0, 4, 1, 1, 2, 1, 2, 2};
+        const std::vector<uint32_t> holes = {5, 4};
+        triangulatePolygon(xy, holes, indices);
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+
+    std::printf("degenerate outlines triangulate exactly\n");
+    return check::finish();
+}
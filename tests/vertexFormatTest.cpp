@@ -0,0 +1,204 @@
+#include "check.h"
+#include "../src/VertexFormat/vertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*
+  decode(encode(x)) against positionErrorBound for every position format, and the color
+  and half conversions, over counts that exercise both the SIMD bodies and the scalar tails.
+  Built once per kernel set (see CMakeLists.txt), VERTEX_FORMAT_KERNELS names the one tested.
+*/
+namespace
+{
+constexpr PositionFormat kPositionFormats[] = {PositionFormat::Float4, PositionFormat::PackedFloat3,
+                                               PositionFormat::Half4, PositionFormat::Snorm16x4};
+constexpr size_t kCounts[] = {1, 2, 3, 7, 8, 1001};
+
+bool normalized(PositionFormat format)
+{
+    return format == PositionFormat::Half4 || format == PositionFormat::Snorm16x4;
+}
+
+// Random xyzw points in [lo, hi]^3, with w = 1
+std::vector<float> randomPositions(std::mt19937 &random, size_t count, float lo, float hi)
+{
+    std::uniform_real_distribution<float> coordinate(lo, hi);
+    std::vector<float> positions(count * 4);
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+            positions[i * 4 + c] = coordinate(random);
+        positions[i * 4 + 3] = 1.0f;
+    }
+    return positions;
+}
+
+std::vector<float> roundTrip(PositionFormat format, const std::vector<float> &positions, const VertexDequant &dequant)
+{
+    const size_t count = positions.size() / 4;
+    std::vector<unsigned char> encoded(count * positionStride(format));
+    std::vector<float> decoded(count * 4);
+    encodePositions(format, positions.data(), count, dequant, encoded.data());
+    decodePositions(format, encoded.data(), count, dequant, decoded.data());
+    return decoded;
+}
+
+void testPositionsInsideBounds(std::mt19937 &random)
+{
+    for (float extent : {0.5f, 1.0f, 1000.0f})
+    {
+        for (size_t count : kCounts)
+        {
+            const std::vector<float> positions = randomPositions(random, count, -extent, 0.25f * extent);
+            const VertexDequant dequant = computeDequant(positions.data(), count);
+            for (PositionFormat format : kPositionFormats)
+            {
+                const std::vector<float> decoded = roundTrip(format, positions, dequant);
+                const float bound = positionErrorBound(format, dequant);
+                float worst = 0.0f;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    for (int c = 0; c < 3; ++c)
+                        worst = std::max(worst, std::fabs(decoded[i * 4 + c] - positions[i * 4 + c]));
+                    CHECK(decoded[i * 4 + 3] == 1.0f);
+                }
+                CHECK(worst <= bound);
+                if (!normalized(format))
+                    CHECK(worst == 0.0f);
+            }
+        }
+    }
+}
+
+// A flat axis (every z equal) keeps scale 1 and decodes exactly
+void testFlatAxis(std::mt19937 &random)
+{
+    std::vector<float> positions = randomPositions(random, 33, -1.0f, 1.0f);
+    for (size_t i = 0; i < 33; ++i)
+        positions[i * 4 + 2] = 0.25f;
+    const VertexDequant dequant = computeDequant(positions.data(), 33);
+    CHECK(dequant.scale[2] == 1.0f);
+    for (PositionFormat format : kPositionFormats)
+    {
+        const std::vector<float> decoded = roundTrip(format, positions, dequant);
+        for (size_t i = 0; i < 33; ++i)
+            CHECK(decoded[i * 4 + 2] == 0.25f);
+    }
+}
+
+// Points outside the dequant box (dynamic updates) land on its faces, within the format's bound
+void testPositionsOutsideBoundsClamp(std::mt19937 &random)
+{
+    for (size_t count : kCounts)
+    {
+        const std::vector<float> inside = randomPositions(random, count, -1.0f, 1.0f);
+        VertexDequant dequant = computeDequant(inside.data(), count);
+        const std::vector<float> outside = randomPositions(random, count, -8.0f, 8.0f);
+        for (PositionFormat format : {PositionFormat::Half4, PositionFormat::Snorm16x4})
+        {
+            const std::vector<float> decoded = roundTrip(format, outside, dequant);
+            const float bound = positionErrorBound(format, dequant);
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float lo = dequant.offset[c] - dequant.scale[c], hi = dequant.offset[c] + dequant.scale[c];
+                    const float expected = std::clamp(outside[i * 4 + c], lo, hi);
+                    CHECK(std::fabs(decoded[i * 4 + c] - expected) <= bound);
+                }
+            }
+        }
+    }
+}
+
+// SIMD and scalar Half4 encoders agree bit for bit with floatToHalf on the normalized value
+void testHalfEncodeMatchesScalar(std::mt19937 &random)
+{
+    const size_t count = 1001;
+    const std::vector<float> positions = randomPositions(random, count, -3.0f, 2.0f);
+    VertexDequant dequant = computeDequant(positions.data(), count);
+    std::vector<uint16_t> encoded(count * 4);
+    encodePositions(PositionFormat::Half4, positions.data(), count, dequant, encoded.data());
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            const float unit = (positions[i * 4 + c] - dequant.offset[c]) * (1.0f / dequant.scale[c]);
+            CHECK(encoded[i * 4 + c] == floatToHalf(std::clamp(unit, -1.0f, 1.0f)));
+        }
+        CHECK(encoded[i * 4 + 3] == 0);
+    }
+}
+
+void testColors(std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> channel(-0.25f, 1.25f);
+    for (size_t count : kCounts)
+    {
+        std::vector<float> colors(count * 4);
+        for (float &value : colors)
+            value = channel(random);
+
+        for (ColorFormat format : {ColorFormat::Float4, ColorFormat::Unorm8x4})
+        {
+            std::vector<unsigned char> encoded(count * colorStride(format));
+            std::vector<float> decoded(count * 4);
+            encodeColors(format, colors.data(), count, encoded.data());
+            decodeColors(format, encoded.data(), count, decoded.data());
+            for (size_t i = 0; i < count * 4; ++i)
+            {
+                if (format == ColorFormat::Float4)
+                    CHECK(decoded[i] == colors[i]);
+                else
+                    CHECK(std::fabs(decoded[i] - std::clamp(colors[i], 0.0f, 1.0f)) <= 0.5f / 255.0f + 1e-6f);
+            }
+        }
+    }
+}
+
+// Every finite half survives half -> float -> half; floats round to the nearest half
+void testHalfConversion(std::mt19937 &random)
+{
+    for (uint32_t bits = 0; bits <= 0xffffu; ++bits)
+    {
+        const uint16_t half = static_cast<uint16_t>(bits);
+        const float value = halfToFloat(half);
+        if (std::isnan(value))
+            CHECK((floatToHalf(value) & 0x7c00u) == 0x7c00u && (floatToHalf(value) & 0x03ffu) != 0);
+        else
+            CHECK(floatToHalf(value) == half);
+    }
+
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (int i = 0; i < 100000; ++i)
+    {
+        const float value = unit(random);
+        const float rounded = halfToFloat(floatToHalf(value));
+        CHECK(std::fabs(rounded - value) <= std::ldexp(1.0f, -12));
+    }
+}
+} // namespace
+
+int main()
+{
+#ifdef VERTEX_FORMAT_REQUIRES_F16C
+    if (!__builtin_cpu_supports("f16c"))
+    {
+        std::printf("vertex format kernels: f16c unsupported on this CPU, skipped\n");
+        return 77;
+    }
+#endif
+    std::printf("vertex format kernels: %s\n", VERTEX_FORMAT_KERNELS);
+    std::mt19937 random(26);
+    testPositionsInsideBounds(random);
+    testFlatAxis(random);
+    testPositionsOutsideBoundsClamp(random);
+    testHalfEncodeMatchesScalar(random);
+    testColors(random);
+    testHalfConversion(random);
+    return check::finish();
+}